@@ -31,7 +31,7 @@ def generate_unix_makefile_x64(platform, repo_root, src_files):
         extra_flags = "-D__PCL_AVX2 -D__PCL_FMA -mavx2 -mfma -fnon-call-exceptions"
         output_ext = "so"
         linker_flags = '-m64 -fPIC -pthread -Wl,-fuse-ld=gold -Wl,--enable-new-dtags -Wl,-z,noexecstack -Wl,-O1 -Wl,--gc-sections -s -shared -L"$(PCLLIBDIR64)" -L"$(PCLBINDIR64)/lib"'
-        linker_libs = "-lpthread -lPCL-pxi -llz4-pxi -lzstd-pxi -lzlib-pxi -lRFC6234-pxi -llcms-pxi -lcminpack-pxi"
+        linker_libs = "-lpthread -ldl -lPCL-pxi -llz4-pxi -lzstd-pxi -lzlib-pxi -lRFC6234-pxi -llcms-pxi -lcminpack-pxi"
         obj_dir = f"{repo_root}/{platform}/g++/x64/Release"
         bin_dir = "linux"
     else:  # macosx
@@ -0,0 +1,413 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// ENGINE BENCHMARK:
+//
+// Standalone executable timing the engine stages on synthetic star fields:
+// a vignetted sky gradient with Gaussian noise, a power-law population of
+// Gaussian stars (the brightest saturated) and a few hot pixels, stored as
+// 16-bit integer images like raw camera data. Every size is generated in
+// mono and RGB from a fixed seed, so runs are comparable across machines
+// and revisions.
+//
+// Each stage is run several times and its best time is reported as JSON.
+// Given a baseline (a previous JSON report), stages slower than the
+// baseline by more than the tolerance are reported and the exit code is 1,
+// so CI can fail the build on a performance regression.
+//
+// Built with VERALUX_HEADLESS defined (see VeraLuxParallel), without the
+// PixInsight core application or the GUI. See build.sh --benchmark.
+//
+// Peak memory is about 32 bytes per RGB pixel (13 GB at 400 MP). Use
+// --sizes to limit the sizes on small CI runners.
+//
+// ----------------------------------------------------------------------------
+
+#include "../src/core/SensorProfiles.h"
+#include "../src/core/VeraLuxEngine.h"
+#include "VeraLuxBenchmarkSupport.h"
+
+#include <pcl/ElapsedTime.h>
+#include <pcl/Image.h>
+#include <pcl/ImageVariant.h>
+#include <pcl/Math.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pcl;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Stretch parameters: the process defaults.
+    */
+   const double LogD = 2.0;
+   const double ProtectB = 6.0;
+   const double ColorConvergence = 3.5;
+   const double ColorGrip = 1.0;
+   const double ShadowConvergence = 0.0;
+   const double TargetBackground = 0.20;
+
+   struct Options
+   {
+      std::vector<double> sizes = { 4, 25, 100, 400 };   // megapixels
+      std::vector<int>    channels = { 1, 3 };
+      int                 repeat = 3;
+      double              tolerance = 0.10;
+      uint64              seed = 1;
+      std::string         output;
+      std::string         baseline;
+   };
+
+   struct Result
+   {
+      std::string name;
+      int         width = 0;
+      int         height = 0;
+      int         channels = 0;
+      double      seconds = 0;
+   };
+
+   // -------------------------------------------------------------------------
+
+   /*
+    * Best time of repeat runs of a stage. setup() runs before every run and
+    * is not timed.
+    */
+   double TimeStage( int repeat, const std::function<void()>& setup, const std::function<void()>& stage )
+   {
+      double best = 0;
+      for ( int i = 0; i < repeat; ++i )
+      {
+         if ( setup )
+            setup();
+         ElapsedTime T;
+         stage();
+         double t = T();
+         if ( i == 0 || t < best )
+            best = t;
+      }
+      return best;
+   }
+
+   void Report( std::vector<Result>& results, const std::string& prefix, const Image& image,
+                const char* stage, double seconds )
+   {
+      Result r;
+      r.name = prefix + '/' + stage;
+      r.width = image.Width();
+      r.height = image.Height();
+      r.channels = image.NumberOfChannels();
+      r.seconds = seconds;
+      results.push_back( r );
+      std::fprintf( stderr, "  %-28s %10.3f ms  %8.1f MP/s\n", stage, seconds*1000,
+                    image.NumberOfPixels()/1e6/Max( seconds, 1e-9 ) );
+   }
+
+   /*
+    * Runs all stages on one synthetic image, in processing order, freeing
+    * each intermediate as soon as it is no longer needed.
+    */
+   void RunImage( std::vector<Result>& results, double megapixels, int channels, const Options& options )
+   {
+      const SensorProfile& profile = g_sensorProfiles[g_defaultSensorProfileIndex];
+      const double D = Pow10( LogD );
+      const std::string prefix = (channels == 3 ? "rgb-" : "mono-") + std::to_string( RoundInt( megapixels ) ) + "MP";
+
+      UInt16Image raw = SyntheticStarField( megapixels, channels, options.seed );
+      std::fprintf( stderr, "%s (%dx%d)\n", prefix.c_str(), raw.Width(), raw.Height() );
+
+      Image normalized;
+      Report( results, prefix, raw, "NormalizeInput",
+              TimeStage( options.repeat, nullptr,
+                         [&]() { VeraLuxEngine::NormalizeInput( normalized, ImageVariant( &raw ) ); } ) );
+      raw.FreeData();
+
+      double anchor = 0;
+      Report( results, prefix, normalized, "CalculateAnchor",
+              TimeStage( options.repeat, nullptr,
+                         [&]() { anchor = VeraLuxEngine::CalculateAnchor( normalized ); } ) );
+
+      double adaptiveAnchor = 0;
+      Report( results, prefix, normalized, "CalculateAnchorAdaptive",
+              TimeStage( options.repeat, nullptr,
+                         [&]() { adaptiveAnchor = VeraLuxEngine::CalculateAnchorAdaptive( normalized, profile ); } ) );
+      anchor = adaptiveAnchor;
+
+      Image luma;
+      Report( results, prefix, normalized, "ExtractLuminance",
+              TimeStage( options.repeat, nullptr,
+                         [&]() { VeraLuxEngine::ExtractLuminance( luma, normalized, anchor, profile ); } ) );
+
+      Image anchored;
+      if ( channels == 3 )
+         VeraLuxEngine::SubtractAnchor( anchored, normalized, anchor );
+      normalized.FreeData();
+
+      Image stretched;
+      Report( results, prefix, luma, "HyperbolicStretch",
+              TimeStage( options.repeat,
+                         [&]() { stretched.Assign( luma ); },
+                         [&]() { VeraLuxEngine::HyperbolicStretch( stretched, D, ProtectB ); } ) );
+      luma.FreeData();
+
+      Image working;
+      if ( channels == 3 )
+      {
+         Report( results, prefix, anchored, "ReconstructColor",
+                 TimeStage( options.repeat,
+                            [&]() { working.Assign( anchored ); },
+                            [&]() { VeraLuxEngine::ReconstructColor( working, stretched, anchored,
+                                                   ColorConvergence, ColorGrip, ShadowConvergence, D, ProtectB ); } ) );
+         anchored.FreeData();
+         stretched.FreeData();
+      }
+      else
+         working = std::move( stretched );
+
+      Image scaled;
+      Report( results, prefix, working, "AdaptiveOutputScaling",
+              TimeStage( options.repeat,
+                         [&]() { scaled.Assign( working ); },
+                         [&]() { VeraLuxEngine::AdaptiveOutputScaling( scaled, profile, TargetBackground ); } ) );
+   }
+
+   // -------------------------------------------------------------------------
+
+   std::string ToJSON( const std::vector<Result>& results, const Options& options )
+   {
+      std::string json = "{\n";
+      char buffer[ 512 ];
+      std::snprintf( buffer, sizeof( buffer ),
+                     "  \"version\": 1,\n  \"threads\": %d,\n  \"repeat\": %d,\n  \"seed\": %llu,\n  \"results\": [\n",
+                     Max( 1, int( std::thread::hardware_concurrency() ) ), options.repeat,
+                     (unsigned long long)options.seed );
+      json += buffer;
+      for ( size_type i = 0; i < results.size(); ++i )
+      {
+         const Result& r = results[i];
+         const double pixels = double( r.width )*r.height;
+         std::snprintf( buffer, sizeof( buffer ),
+                        "    { \"name\": \"%s\", \"width\": %d, \"height\": %d, \"channels\": %d, "
+                        "\"seconds\": %.6f, \"mpixPerSecond\": %.3f }%s\n",
+                        r.name.c_str(), r.width, r.height, r.channels, r.seconds,
+                        pixels/1e6/Max( r.seconds, 1e-9 ), (i + 1 < results.size()) ? "," : "" );
+         json += buffer;
+      }
+      json += "  ]\n}\n";
+      return json;
+   }
+
+   bool ReadFile( std::string& text, const std::string& path )
+   {
+      FILE* f = std::fopen( path.c_str(), "rb" );
+      if ( f == nullptr )
+         return false;
+      char buffer[ 65536 ];
+      for ( size_t n; (n = std::fread( buffer, 1, sizeof( buffer ), f )) > 0; )
+         text.append( buffer, n );
+      std::fclose( f );
+      return true;
+   }
+
+   /*
+    * Extracts the (name, seconds) pairs of a report written by ToJSON().
+    * Only that layout needs to be understood, not arbitrary JSON.
+    */
+   std::vector<Result> ParseBaseline( const std::string& json )
+   {
+      std::vector<Result> baseline;
+      const std::string nameKey = "\"name\": \"";
+      const std::string secondsKey = "\"seconds\": ";
+      for ( size_t p = json.find( nameKey ); p != std::string::npos; p = json.find( nameKey, p ) )
+      {
+         p += nameKey.size();
+         size_t q = json.find( '"', p );
+         size_t s = json.find( secondsKey, q );
+         if ( q == std::string::npos || s == std::string::npos )
+            break;
+         Result r;
+         r.name = json.substr( p, q - p );
+         r.seconds = std::strtod( json.c_str() + s + secondsKey.size(), nullptr );
+         baseline.push_back( r );
+         p = q;
+      }
+      return baseline;
+   }
+
+   /*
+    * Returns the number of stages slower than the baseline by more than the
+    * tolerance. Differences under a millisecond are timer noise.
+    */
+   int CompareBaseline( const std::vector<Result>& results, const std::vector<Result>& baseline, double tolerance )
+   {
+      int regressions = 0;
+      for ( const Result& r : results )
+      {
+         const Result* b = nullptr;
+         for ( const Result& c : baseline )
+            if ( c.name == r.name )
+            {
+               b = &c;
+               break;
+            }
+         if ( b == nullptr )
+         {
+            std::fprintf( stderr, "  %-40s no baseline\n", r.name.c_str() );
+            continue;
+         }
+
+         const double ratio = r.seconds/Max( b->seconds, 1e-9 );
+         const bool regression = ratio > 1 + tolerance && r.seconds - b->seconds > 0.001;
+         if ( regression )
+            ++regressions;
+         std::fprintf( stderr, "  %-40s %10.3f ms  baseline %10.3f ms  %+7.1f%%%s\n", r.name.c_str(),
+                       r.seconds*1000, b->seconds*1000, (ratio - 1)*100, regression ? "  REGRESSION" : "" );
+      }
+      return regressions;
+   }
+
+   // -------------------------------------------------------------------------
+
+   void Usage()
+   {
+      std::fprintf( stderr,
+         "Usage: VeraLuxBenchmark [options]\n"
+         "\n"
+         "  --sizes=<MP,...>      Image sizes in megapixels (default 4,25,100,400)\n"
+         "  --channels=<n,...>    1 (mono) and/or 3 (RGB) (default 1,3)\n"
+         "  --repeat=<n>          Runs per stage; the best time is reported (default 3)\n"
+         "  --seed=<n>            Synthetic field seed (default 1)\n"
+         "  --output=<file>       Write the JSON report to a file (default stdout)\n"
+         "  --baseline=<file>     Compare with a previous report; exit code 1 on regression\n"
+         "  --tolerance=<x>       Allowed slowdown over the baseline (default 0.10)\n" );
+   }
+
+   bool ParseOptions( Options& options, int argc, char** argv )
+   {
+      for ( int i = 1; i < argc; ++i )
+      {
+         const char* value;
+         if ( ParseOption( argv[i], "--sizes", value ) )
+            options.sizes = ParseList<double>( value, []( const char* p, char** e ) { return std::strtod( p, e ); } );
+         else if ( ParseOption( argv[i], "--channels", value ) )
+            options.channels = ParseList<int>( value, []( const char* p, char** e ) { return int( std::strtol( p, e, 10 ) ); } );
+         else if ( ParseOption( argv[i], "--repeat", value ) )
+            options.repeat = std::atoi( value );
+         else if ( ParseOption( argv[i], "--seed", value ) )
+            options.seed = std::strtoull( value, nullptr, 10 );
+         else if ( ParseOption( argv[i], "--output", value ) )
+            options.output = value;
+         else if ( ParseOption( argv[i], "--baseline", value ) )
+            options.baseline = value;
+         else if ( ParseOption( argv[i], "--tolerance", value ) )
+            options.tolerance = std::strtod( value, nullptr );
+         else
+            return false;
+      }
+
+      if ( options.sizes.empty() || options.channels.empty() || options.repeat < 1 || options.tolerance < 0 )
+         return false;
+      for ( double mp : options.sizes )
+         if ( mp <= 0 )
+            return false;
+      for ( int c : options.channels )
+         if ( c != 1 && c != 3 )
+            return false;
+      return true;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+   Options options;
+   if ( !ParseOptions( options, argc, argv ) )
+   {
+      Usage();
+      return 2;
+   }
+
+   std::vector<Result> baseline;
+   if ( !options.baseline.empty() )
+   {
+      std::string text;
+      if ( !ReadFile( text, options.baseline ) )
+      {
+         std::fprintf( stderr, "Cannot read baseline: %s\n", options.baseline.c_str() );
+         return 2;
+      }
+      baseline = ParseBaseline( text );
+   }
+
+   std::vector<Result> results;
+   try
+   {
+      for ( double mp : options.sizes )
+         for ( int channels : options.channels )
+            RunImage( results, mp, channels, options );
+   }
+   catch ( const std::bad_alloc& )
+   {
+      std::fprintf( stderr, "Out of memory.\n" );
+      return 2;
+   }
+   catch ( ... )
+   {
+      std::fprintf( stderr, "Benchmark failed.\n" );
+      return 2;
+   }
+
+   const std::string json = ToJSON( results, options );
+   if ( options.output.empty() )
+      std::fputs( json.c_str(), stdout );
+   else
+   {
+      FILE* f = std::fopen( options.output.c_str(), "wb" );
+      if ( f == nullptr || std::fputs( json.c_str(), f ) < 0 )
+      {
+         std::fprintf( stderr, "Cannot write report: %s\n", options.output.c_str() );
+         return 2;
+      }
+      std::fclose( f );
+   }
+
+   if ( !baseline.empty() )
+   {
+      std::fprintf( stderr, "Comparison with %s (tolerance %.0f%%):\n", options.baseline.c_str(), options.tolerance*100 );
+      int regressions = CompareBaseline( results, baseline, options.tolerance );
+      if ( regressions > 0 )
+      {
+         std::fprintf( stderr, "%d stage(s) regressed.\n", regressions );
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,188 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// Shared by the engine tools (VeraLuxBenchmark, VeraLuxValidation):
+// synthetic star fields generated from a fixed seed, and command line
+// parsing.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxBenchmarkSupport_h
+#define __VeraLuxBenchmarkSupport_h
+
+#include "../src/core/VeraLuxParallel.h"
+
+#include <pcl/Image.h>
+#include <pcl/Math.h>
+
+#include <cstring>
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*
+ * SplitMix64: small, seedable and identical on every platform, unlike
+ * the distributions of <random>.
+ */
+class SplitMix64
+{
+public:
+
+   SplitMix64( uint64 seed )
+      : m_state( seed )
+   {
+   }
+
+   uint64 Next()
+   {
+      uint64 z = (m_state += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27))*0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+   }
+
+   // Uniform in [0,1)
+   double Uniform()
+   {
+      return (Next() >> 11)*(1.0/9007199254740992.0);
+   }
+
+   // Approximately normal (Irwin-Hall, four terms): fast enough for
+   // hundreds of millions of samples
+   double Normal()
+   {
+      return (Uniform() + Uniform() + Uniform() + Uniform() - 2.0)*1.7320508075688772;
+   }
+
+private:
+
+   uint64 m_state;
+};
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Synthetic star field of about the given size, 3:2 aspect ratio.
+ */
+inline UInt16Image SyntheticStarField( double megapixels, int channels, uint64 seed )
+{
+   const double N = megapixels*1e6;
+   const int width = Max( 16, RoundInt( Sqrt( N*1.5 ) ) );
+   const int height = Max( 16, RoundInt( N/width ) );
+
+   // Background: pedestal, gradient, vignetting and read noise. Rows are
+   // seeded independently so the result does not depend on the threads.
+   Image sky( width, height, channels == 3 ? ColorSpace::RGB : ColorSpace::Gray );
+   const double tint[ 3 ] = { 1.00, 0.93, 0.85 };
+   VeraLuxParallel::ForEachRowBand( height, VeraLuxParallel::MaxThreads( sky ),
+      [&]( int startRow, int endRow )
+      {
+         for ( int y = startRow; y < endRow; ++y )
+         {
+            SplitMix64 R( seed*0x100000001B3ull + uint64( y ) );
+            const double dy = 2.0*y/height - 1;
+            for ( int x = 0; x < width; ++x )
+            {
+               const double dx = 2.0*x/width - 1;
+               const double v = 0.020 + 0.010*x/width + 0.005*y/height - 0.004*(dx*dx + dy*dy);
+               for ( int c = 0; c < channels; ++c )
+                  sky( x, y, c ) = float( v*tint[c] + 0.002*R.Normal() );
+            }
+         }
+      } );
+
+   // Stars: one per 4000 pixels, peak flux following a power law
+   SplitMix64 R( seed );
+   const size_type stars = size_type( N/4000 );
+   const double sigma = 1.2;
+   const int radius = 5;
+   for ( size_type i = 0; i < stars; ++i )
+   {
+      const double cx = R.Uniform()*width;
+      const double cy = R.Uniform()*height;
+      const double peak = Min( 0.05*Pow( Max( R.Uniform(), 1e-6 ), -1.5 ), 3.0 );
+      const double color[ 3 ] = { 0.8 + 0.4*R.Uniform(), 1.0, 0.8 + 0.4*R.Uniform() };
+      const int x0 = Max( 0, int( cx ) - radius ), x1 = Min( width, int( cx ) + radius + 1 );
+      const int y0 = Max( 0, int( cy ) - radius ), y1 = Min( height, int( cy ) + radius + 1 );
+      for ( int y = y0; y < y1; ++y )
+         for ( int x = x0; x < x1; ++x )
+         {
+            const double r2 = ((x - cx)*(x - cx) + (y - cy)*(y - cy))/(2*sigma*sigma);
+            const double f = peak*Exp( -r2 );
+            for ( int c = 0; c < channels; ++c )
+               sky( x, y, c ) += float( f*(channels == 3 ? color[c] : 1.0) );
+         }
+   }
+
+   // Hot pixels: one per million pixels, at full scale
+   for ( size_type i = 0, n = Max( size_type( 1 ), size_type( N/1e6 ) ); i < n; ++i )
+   {
+      const int x = Min( width - 1, int( R.Uniform()*width ) );
+      const int y = Min( height - 1, int( R.Uniform()*height ) );
+      for ( int c = 0; c < channels; ++c )
+         sky( x, y, c ) = 1;
+   }
+
+   UInt16Image raw( width, height, channels == 3 ? ColorSpace::RGB : ColorSpace::Gray );
+   for ( int c = 0; c < channels; ++c )
+   {
+      const float* s = sky[c];
+      uint16* r = raw[c];
+      for ( size_type k = 0, n = sky.NumberOfPixels(); k < n; ++k )
+         r[k] = uint16( RoundInt( Range( double( s[k] ), 0.0, 1.0 )*65535 ) );
+   }
+   return raw;
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename T, class F>
+std::vector<T> ParseList( const char* text, F convert )
+{
+   std::vector<T> list;
+   for ( const char* p = text; *p != '\0'; )
+   {
+      char* end;
+      T value = convert( p, &end );
+      if ( end == p )
+         break;
+      list.push_back( value );
+      p = (*end == ',') ? end + 1 : end;
+   }
+   return list;
+}
+
+inline bool ParseOption( const char* arg, const char* name, const char*& value )
+{
+   size_t n = std::strlen( name );
+   if ( std::strncmp( arg, name, n ) != 0 || arg[n] != '=' )
+      return false;
+   value = arg + n + 1;
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxBenchmarkSupport_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,591 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// ENGINE VALIDATION:
+//
+// Standalone executable measuring the accuracy of every evaluation mode of
+// the engine against its reference path: the step-by-step stages with the
+// Scalar instruction set, Mixed compute precision, direct transfer
+// evaluation and exact percentiles. That path is the direct port of the
+// Python implementation it was validated against.
+//
+// Input normalization is checked first, on the fields converted to every
+// integer sample type and to float samples in the 16-bit range.
+//
+// Every mode stretches the same synthetic star fields (see VeraLuxBenchmark)
+// with two parameter sets, one per processing mode. The maximum and RMS
+// absolute errors of each stage output are compared with the bounds of the
+// mode, and a JSON report is written. Some modes must also reproduce another
+// mode bit for bit: Float precision on the vector kernels and on the Scalar
+// path, and one thread against all processors. Any violated bound or
+// difference makes the exit code 1, so CI can check every build.
+//
+// Built with VERALUX_HEADLESS defined (see VeraLuxParallel), by build.sh
+// --benchmark.
+//
+// ----------------------------------------------------------------------------
+
+#include "../src/core/SensorProfiles.h"
+#include "../src/core/VeraLuxContext.h"
+#include "../src/core/VeraLuxEngine.h"
+#include "../src/core/VeraLuxPipeline.h"
+#include "../src/core/VeraLuxSIMD.h"
+#include "VeraLuxBenchmarkSupport.h"
+
+#include <pcl/Image.h>
+#include <pcl/ImageVariant.h>
+#include <pcl/Math.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pcl;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Largest anchor difference accepted in any mode: two bins of the 65536
+    * bin histogram of the adaptive anchor.
+    */
+   const double AnchorBound = 2.0/65536;
+
+   /*
+    * Effective stretch parameters of one processing mode, as returned by
+    * HyperMetricStretchInstance::GetEffectiveParams().
+    */
+   struct Scenario
+   {
+      const char* name;
+      bool        readyToUse;        // output scaling and soft clip
+      double      logD;
+      double      protectB;
+      double      colorConvergence;
+      double      colorGrip;
+      double      shadowConvergence;
+      double      linearExpansion;
+      double      targetBackground;
+   };
+
+   const Scenario Scenarios[] =
+   {
+      // Process defaults
+      { "ready-to-use", true,  2.0, 6.0, 3.5, 1.0, 0.0, 0.0, 0.20 },
+      // Hybrid blend, shadow convergence and linear expansion
+      { "scientific",   false, 2.5, 4.0, 3.5, 0.7, 1.0, 0.5, 0.20 }
+   };
+
+   /*
+    * Evaluation mode, with its error bounds on [0,1] pixel stages.
+    */
+   struct Mode
+   {
+      const char*                     name;
+      bool                            vector;       // best instruction set, or Scalar
+      ComputePrecision::value_type    precision;
+      TransferEvaluation::value_type  transfer;
+      StatisticsEstimator::value_type estimator;
+      bool                            fused;        // VeraLuxPipeline instead of the stages
+      bool                            singleThread;
+      double                          maxBound;
+      double                          rmsBound;
+      const char*                     twin;         // mode reproduced bit for bit, or nullptr
+   };
+
+   const Mode Reference = { "reference", false, ComputePrecision::Mixed, TransferEvaluation::Direct,
+                            StatisticsEstimator::Exact, false, false, 0, 0, nullptr };
+
+   /*
+    * Kernel errors are a few 1e-6 (see VeraLuxSIMD); the pixel bounds
+    * leave room for a histogram bin of anchor difference amplified by the
+    * stretch. Lookup tables add up to half a 16-bit step per transfer
+    * function. The Histogram and MAD estimators change the expansion bounds
+    * and the soft ceiling within their own documented errors.
+    */
+   const Mode Modes[] =
+   {
+      { "float",        false, ComputePrecision::Float, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     false, false, 1e-3, 1e-5, nullptr },
+      { "simd",         true,  ComputePrecision::Mixed, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     false, false, 1e-3, 1e-5, nullptr },
+      { "simd-float",   true,  ComputePrecision::Float, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     false, false, 1e-3, 1e-5, "float" },
+      { "simd-1thread", true,  ComputePrecision::Mixed, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     false, true,  1e-3, 1e-5, "simd" },
+      { "lut",          true,  ComputePrecision::Mixed, TransferEvaluation::LookupTable,
+                        StatisticsEstimator::Exact,     false, false, 1e-3, 2e-5, nullptr },
+      { "histogram",    true,  ComputePrecision::Mixed, TransferEvaluation::Direct,
+                        StatisticsEstimator::Histogram, false, false, 1e-3, 1e-4, nullptr },
+      { "mad",          true,  ComputePrecision::Mixed, TransferEvaluation::Direct,
+                        StatisticsEstimator::MAD,       false, false, 2e-2, 5e-3, nullptr },
+      { "fused",        true,  ComputePrecision::Mixed, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     true,  false, 1e-3, 1e-5, nullptr },
+      { "fused-float",  true,  ComputePrecision::Float, TransferEvaluation::Direct,
+                        StatisticsEstimator::Exact,     true,  false, 1e-3, 1e-5, nullptr }
+   };
+
+   struct Options
+   {
+      std::vector<double> sizes = { 2 };   // megapixels
+      std::vector<int>    channels = { 1, 3 };
+      uint64              seed = 1;
+      std::string         output;
+   };
+
+   struct Result
+   {
+      std::string image;
+      std::string scenario;
+      std::string mode;
+      std::string stage;
+      double      maxError = 0;
+      double      rmsError = 0;
+      double      maxBound = 0;
+      double      rmsBound = 0;
+      bool        identical = true;  // only checked for modes with a twin
+      bool        pass = true;
+   };
+
+   /*
+    * Output of one stage: a pixel image, or a value (the anchor).
+    */
+   struct StageOutput
+   {
+      std::string stage;
+      Image       image;
+      double      value = 0;
+   };
+
+   typedef std::vector<StageOutput>                                       stage_list;
+   typedef std::function<void( const char*, const Image*, double )>     stage_callback;
+
+   // -------------------------------------------------------------------------
+
+   void SelectInstructionSet( const Mode& mode )
+   {
+      VeraLuxSIMD::SetMaximumInstructionSet( mode.vector ? SIMDInstructionSet::NumberOfInstructionSets :
+                                                           SIMDInstructionSet::Scalar );
+   }
+
+   /*
+    * Stretches a normalized image with the sequence of
+    * HyperMetricStretchInstance::ExecuteOn(), reporting every stage output.
+    */
+   void Stretch( const Image& normalized, const SensorProfile& profile, const Scenario& s, const Mode& mode,
+                 const stage_callback& report )
+   {
+      SelectInstructionSet( mode );
+      VeraLuxContext context;
+      context.precision = mode.precision;
+      VeraLuxContext::Scope scope( context );
+
+      Image working;
+      working.Assign( normalized );
+      working.EnableParallelProcessing( !mode.singleThread );
+
+      const double D = Pow10( s.logD );
+      const double anchor = VeraLuxEngine::CalculateAnchorAdaptive( working, profile );
+      report( "Anchor", nullptr, anchor );
+
+      if ( mode.fused )
+      {
+         FusedStretchParameters params;
+         params.anchor = anchor;
+         params.D = D;
+         params.b = s.protectB;
+         params.colorConvergence = s.colorConvergence;
+         params.colorGrip = s.colorGrip;
+         params.shadowConvergence = s.shadowConvergence;
+         params.linearExpansion = s.linearExpansion;
+         params.estimator = mode.estimator;
+         params.transfer = mode.transfer;
+         VeraLuxPipeline::Run( working, profile, params );
+      }
+      else
+      {
+         Image luma;
+         VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+         report( "Luminance", &luma, 0 );
+
+         VeraLuxEngine::HyperbolicStretch( luma, D, s.protectB, 0.0, mode.transfer );
+         report( "Stretch", &luma, 0 );
+
+         if ( s.linearExpansion > 0.001 )
+         {
+            VeraLuxEngine::ApplyLinearExpansion( luma, float( s.linearExpansion ), nullptr, mode.estimator );
+            report( "Expansion", &luma, 0 );
+         }
+
+         Image anchored;
+         VeraLuxEngine::SubtractAnchor( anchored, working, anchor );
+         VeraLuxEngine::ReconstructColor( working, luma, anchored, s.colorConvergence, s.colorGrip,
+                                          s.shadowConvergence, D, s.protectB, mode.transfer );
+      }
+      report( "Pipeline", &working, 0 );
+
+      if ( s.readyToUse )
+      {
+         VeraLuxEngine::AdaptiveOutputScaling( working, profile, s.targetBackground, mode.estimator,
+                                               nullptr, mode.transfer );
+         report( "OutputScaling", &working, 0 );
+
+         VeraLuxEngine::ApplyReadyToUseSoftClip( working, 0.98, 2.0, mode.transfer );
+         report( "SoftClip", &working, 0 );
+      }
+   }
+
+   const StageOutput* FindStage( const stage_list& stages, const char* stage )
+   {
+      for ( const StageOutput& s : stages )
+         if ( s.stage == stage )
+            return &s;
+      return nullptr;
+   }
+
+   /*
+    * Maximum and RMS absolute differences over all samples.
+    */
+   void Compare( double& maxError, double& rmsError, bool& identical, const Image& a, const Image& b )
+   {
+      if ( a.Width() != b.Width() || a.Height() != b.Height() || a.NumberOfChannels() != b.NumberOfChannels() )
+         throw std::runtime_error( "Stage geometry mismatch" );
+
+      double max = 0, sum2 = 0;
+      identical = true;
+      for ( int c = 0; c < a.NumberOfChannels(); ++c )
+      {
+         const float* p = a[c];
+         const float* q = b[c];
+         for ( size_type i = 0, n = a.NumberOfPixels(); i < n; ++i )
+         {
+            double d = Abs( double( p[i] ) - double( q[i] ) );
+            if ( d > max )
+               max = d;
+            sum2 += d*d;
+         }
+         if ( std::memcmp( p, q, a.NumberOfPixels()*sizeof( float ) ) != 0 )
+            identical = false;
+      }
+      maxError = max;
+      rmsError = Sqrt( sum2/(double( a.NumberOfPixels() )*a.NumberOfChannels()) );
+   }
+
+   /*
+    * Runs the reference and every mode on one image and scenario. The stage
+    * outputs of the reference and of the twins of other modes are kept for
+    * the comparisons; the others are compared as they are produced.
+    */
+   void ValidateImage( std::vector<Result>& results, const std::string& imageName, const Image& normalized,
+                       const SensorProfile& profile, const Scenario& scenario )
+   {
+      std::map<std::string, stage_list> kept;
+      auto keep = [&]( stage_list& list )
+      {
+         return [&list]( const char* stage, const Image* image, double value )
+         {
+            StageOutput s;
+            s.stage = stage;
+            if ( image != nullptr )
+               s.image.Assign( *image );
+            s.value = value;
+            list.push_back( std::move( s ) );
+         };
+      };
+
+      Stretch( normalized, profile, scenario, Reference, keep( kept[Reference.name] ) );
+
+      for ( const Mode& mode : Modes )
+      {
+         const stage_list& reference = kept[Reference.name];
+         const stage_list* twin = (mode.twin != nullptr) ? &kept[mode.twin] : nullptr;
+         bool keepMode = false;
+         for ( const Mode& other : Modes )
+            if ( other.twin != nullptr && mode.name == std::string( other.twin ) )
+               keepMode = true;
+         stage_list* list = keepMode ? &kept[mode.name] : nullptr;
+         stage_callback store = keepMode ? keep( *list ) : stage_callback();
+
+         Stretch( normalized, profile, scenario, mode,
+            [&]( const char* stage, const Image* image, double value )
+            {
+               const StageOutput* ref = FindStage( reference, stage );
+               if ( ref == nullptr )
+                  throw std::runtime_error( std::string( "Missing reference stage: " ) + stage );
+
+               Result r;
+               r.image = imageName;
+               r.scenario = scenario.name;
+               r.mode = mode.name;
+               r.stage = stage;
+               if ( image != nullptr )
+               {
+                  Compare( r.maxError, r.rmsError, r.identical, *image, ref->image );
+                  r.maxBound = mode.maxBound;
+                  r.rmsBound = mode.rmsBound;
+               }
+               else
+               {
+                  r.maxError = r.rmsError = Abs( value - ref->value );
+                  r.maxBound = r.rmsBound = AnchorBound;
+               }
+               r.pass = r.maxError <= r.maxBound && r.rmsError <= r.rmsBound;
+
+               if ( twin != nullptr )
+               {
+                  const StageOutput* t = FindStage( *twin, stage );
+                  if ( t == nullptr )
+                     throw std::runtime_error( std::string( "Missing twin stage: " ) + stage );
+                  if ( image != nullptr )
+                  {
+                     double maxError, rmsError;
+                     Compare( maxError, rmsError, r.identical, *image, t->image );
+                  }
+                  else
+                     r.identical = value == t->value;
+                  if ( !r.identical )
+                     r.pass = false;
+               }
+               else
+                  r.identical = true;
+
+               std::fprintf( stderr, "  %-14s %-14s %-14s max %.3e  rms %.3e%s\n", scenario.name, mode.name, stage,
+                             r.maxError, r.rmsError,
+                             r.pass ? "" : (r.identical ? "  OUT OF BOUNDS" : "  NOT IDENTICAL") );
+               results.push_back( r );
+
+               if ( store )
+                  store( stage, image, value );
+            } );
+      }
+
+      SelectInstructionSet( Reference );
+   }
+
+   /*
+    * Input normalization of the field in every integer sample type, and as
+    * float samples in the 16-bit range. The reference is the conversion of
+    * Image::Assign(), x / range for integer samples; each sample type must
+    * be divided by its range once.
+    */
+   template <class I>
+   void ValidateNormalization( std::vector<Result>& results, const std::string& imageName, const char* name,
+                               I& input, const Image& reference )
+   {
+      Image normalized;
+      VeraLuxEngine::NormalizeInput( normalized, ImageVariant( &input ) );
+
+      Result r;
+      r.image = imageName;
+      r.scenario = "normalize";
+      r.mode = name;
+      r.stage = "NormalizeInput";
+      Compare( r.maxError, r.rmsError, r.identical, normalized, reference );
+      r.identical = true;
+      r.maxBound = 1e-6;
+      r.rmsBound = 1e-7;
+      r.pass = r.maxError <= r.maxBound && r.rmsError <= r.rmsBound;
+
+      std::fprintf( stderr, "  %-14s %-14s %-14s max %.3e  rms %.3e%s\n", r.scenario.c_str(), name, r.stage.c_str(),
+                    r.maxError, r.rmsError, r.pass ? "" : "  OUT OF BOUNDS" );
+      results.push_back( r );
+   }
+
+   void ValidateNormalization( std::vector<Result>& results, const std::string& imageName, UInt16Image& raw )
+   {
+      {
+         UInt8Image input;
+         input.Assign( raw );
+         Image reference;
+         reference.Assign( input );
+         ValidateNormalization( results, imageName, "uint8", input, reference );
+      }
+
+      Image reference;
+      reference.Assign( raw );
+      ValidateNormalization( results, imageName, "uint16", raw, reference );
+      {
+         UInt32Image input;
+         input.Assign( raw );
+         Image reference32;
+         reference32.Assign( input );
+         ValidateNormalization( results, imageName, "uint32", input, reference32 );
+      }
+      {
+         Image input;
+         input.Assign( reference );
+         input *= 65535.0;
+         ValidateNormalization( results, imageName, "float-65535", input, reference );
+      }
+   }
+
+   void RunImage( std::vector<Result>& results, double megapixels, int channels, const Options& options )
+   {
+      const SensorProfile& profile = g_sensorProfiles[g_defaultSensorProfileIndex];
+      const std::string name = (channels == 3 ? "rgb-" : "mono-") + std::to_string( RoundInt( megapixels ) ) + "MP";
+
+      Image normalized;
+      {
+         UInt16Image raw = SyntheticStarField( megapixels, channels, options.seed );
+         std::fprintf( stderr, "%s (%dx%d)\n", name.c_str(), raw.Width(), raw.Height() );
+         ValidateNormalization( results, name, raw );
+         VeraLuxEngine::NormalizeInput( normalized, ImageVariant( &raw ) );
+      }
+
+      for ( const Scenario& scenario : Scenarios )
+         ValidateImage( results, name, normalized, profile, scenario );
+   }
+
+   // -------------------------------------------------------------------------
+
+   std::string ToJSON( const std::vector<Result>& results, const Options& options )
+   {
+      std::string json = "{\n";
+      char buffer[ 512 ];
+      std::snprintf( buffer, sizeof( buffer ),
+                     "  \"version\": 1,\n  \"instructionSet\": \"%s\",\n  \"seed\": %llu,\n  \"results\": [\n",
+                     VeraLuxSIMD::InstructionSetName( VeraLuxSIMD::DetectedInstructionSet() ),
+                     (unsigned long long)options.seed );
+      json += buffer;
+      for ( size_type i = 0; i < results.size(); ++i )
+      {
+         const Result& r = results[i];
+         std::snprintf( buffer, sizeof( buffer ),
+                        "    { \"image\": \"%s\", \"scenario\": \"%s\", \"mode\": \"%s\", \"stage\": \"%s\", "
+                        "\"maxError\": %.6e, \"rmsError\": %.6e, \"maxBound\": %.1e, \"rmsBound\": %.1e, "
+                        "\"identical\": %s, \"pass\": %s }%s\n",
+                        r.image.c_str(), r.scenario.c_str(), r.mode.c_str(), r.stage.c_str(),
+                        r.maxError, r.rmsError, r.maxBound, r.rmsBound,
+                        r.identical ? "true" : "false", r.pass ? "true" : "false",
+                        (i + 1 < results.size()) ? "," : "" );
+         json += buffer;
+      }
+      json += "  ]\n}\n";
+      return json;
+   }
+
+   // -------------------------------------------------------------------------
+
+   void Usage()
+   {
+      std::fprintf( stderr,
+         "Usage: VeraLuxValidation [options]\n"
+         "\n"
+         "  --sizes=<MP,...>      Image sizes in megapixels (default 2)\n"
+         "  --channels=<n,...>    1 (mono) and/or 3 (RGB) (default 1,3)\n"
+         "  --seed=<n>            Synthetic field seed (default 1)\n"
+         "  --output=<file>       Write the JSON report to a file (default stdout)\n" );
+   }
+
+   bool ParseOptions( Options& options, int argc, char** argv )
+   {
+      for ( int i = 1; i < argc; ++i )
+      {
+         const char* value;
+         if ( ParseOption( argv[i], "--sizes", value ) )
+            options.sizes = ParseList<double>( value, []( const char* p, char** e ) { return std::strtod( p, e ); } );
+         else if ( ParseOption( argv[i], "--channels", value ) )
+            options.channels = ParseList<int>( value, []( const char* p, char** e ) { return int( std::strtol( p, e, 10 ) ); } );
+         else if ( ParseOption( argv[i], "--seed", value ) )
+            options.seed = std::strtoull( value, nullptr, 10 );
+         else if ( ParseOption( argv[i], "--output", value ) )
+            options.output = value;
+         else
+            return false;
+      }
+
+      if ( options.sizes.empty() || options.channels.empty() )
+         return false;
+      for ( double mp : options.sizes )
+         if ( mp <= 0 )
+            return false;
+      for ( int c : options.channels )
+         if ( c != 1 && c != 3 )
+            return false;
+      return true;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int main( int argc, char** argv )
+{
+   Options options;
+   if ( !ParseOptions( options, argc, argv ) )
+   {
+      Usage();
+      return 2;
+   }
+
+   std::vector<Result> results;
+   try
+   {
+      for ( double mp : options.sizes )
+         for ( int channels : options.channels )
+            RunImage( results, mp, channels, options );
+   }
+   catch ( const std::bad_alloc& )
+   {
+      std::fprintf( stderr, "Out of memory.\n" );
+      return 2;
+   }
+   catch ( const std::exception& x )
+   {
+      std::fprintf( stderr, "Validation failed: %s\n", x.what() );
+      return 2;
+   }
+   catch ( ... )
+   {
+      std::fprintf( stderr, "Validation failed.\n" );
+      return 2;
+   }
+
+   const std::string json = ToJSON( results, options );
+   if ( options.output.empty() )
+      std::fputs( json.c_str(), stdout );
+   else
+   {
+      FILE* f = std::fopen( options.output.c_str(), "wb" );
+      if ( f == nullptr || std::fputs( json.c_str(), f ) < 0 )
+      {
+         std::fprintf( stderr, "Cannot write report: %s\n", options.output.c_str() );
+         return 2;
+      }
+      std::fclose( f );
+   }
+
+   int failures = 0;
+   for ( const Result& r : results )
+      if ( !r.pass )
+         ++failures;
+   if ( failures > 0 )
+   {
+      std::fprintf( stderr, "%d stage result(s) failed validation.\n", failures );
+      return 1;
+   }
+
+   return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -38,6 +38,8 @@ REPO_ROOT="$SCRIPT_DIR"
 PLATFORM=""
 PCL_PATH=""
 MSBUILD_CMD=""  # Global variable to store MSBuild command path
+BENCHMARK=false
+LIBRARY=false
 
 # Parse command line arguments
 while [[ $# -gt 0 ]]; do
@@ -50,9 +52,17 @@ while [[ $# -gt 0 ]]; do
             PCL_PATH="${1#*=}"
             shift
             ;;
+        --benchmark)
+            BENCHMARK=true
+            shift
+            ;;
+        --library)
+            LIBRARY=true
+            shift
+            ;;
         *)
             log_error "Unknown option: $1"
-            echo "Usage: $0 [--platform=<linux|macosx|windows>] [--pcl-path=<path>]"
+            echo "Usage: $0 [--platform=<linux|macosx|windows>] [--pcl-path=<path>] [--benchmark] [--library]"
             exit 1
             ;;
     esac
@@ -458,6 +468,138 @@ build_module() {
     log_success "Module built successfully"
 }
 
+# Function to select the compiler settings of the headless engine builds.
+# ENGINE_FLAGS are the code generation and warning flags of the module
+# makefiles (.github/scripts/generate_build_files.py), so the tools measure
+# and validate the engine the module ships.
+headless_platform() {
+    case "$PLATFORM" in
+        linux)
+            PCL_PLATFORM_DEFINE="-D__PCL_LINUX"
+            ENGINE_FLAGS="-pipe -pthread -m64 -fPIC -D_REENTRANT -D__PCL_AVX2 -D__PCL_FMA -mavx2 -mfma \
+-minline-all-stringops -O3 -ffunction-sections -fdata-sections -ffast-math \
+-fvisibility=hidden -fvisibility-inlines-hidden -fnon-call-exceptions -std=c++17 -Wall -Wno-parentheses"
+            JOBS=$(nproc)
+            SHARED_EXT="so"
+            SHARED_FLAGS="-shared -Wl,-soname,libVeraLux.so -Wl,-z,noexecstack"
+            LINK_FLAGS="-m64 -pthread"
+            SYSTEM_LIBS="-lpthread -ldl"
+            ;;
+        macosx)
+            PCL_PLATFORM_DEFINE="-D__PCL_MACOSX"
+            ENGINE_FLAGS="-pipe -pthread -arch x86_64 -fPIC -mmacosx-version-min=12 -D_REENTRANT -msse4.2 \
+-minline-all-stringops -O3 -ffunction-sections -fdata-sections -ffast-math \
+-fvisibility=hidden -fvisibility-inlines-hidden -std=c++17 -stdlib=libc++ -Wall -Wno-parentheses -Wno-extern-c-compat"
+            JOBS=$(sysctl -n hw.ncpu)
+            SHARED_EXT="dylib"
+            SHARED_FLAGS="-dynamiclib -install_name @rpath/libVeraLux.dylib"
+            LINK_FLAGS="-arch x86_64 -mmacosx-version-min=12 -stdlib=libc++"
+            SYSTEM_LIBS="-lpthread"
+            ;;
+        windows)
+            return 1
+            ;;
+    esac
+    CXX="${CXX:-g++}"
+    return 0
+}
+
+# Function to compile sources in parallel: compile_headless <objdir> <flags> <sources...>
+# Object file paths are returned in OBJECTS. Exits if any source fails to
+# compile; stale objects are removed first, so they are never linked.
+compile_headless() {
+    local OBJDIR="$1"
+    local FLAGS="$2"
+    shift 2
+    mkdir -p "$OBJDIR"
+    OBJECTS=""
+    local PIDS=""
+    for SRC in "$@"; do
+        OBJ="$OBJDIR/$(basename "${SRC%.cpp}").o"
+        OBJECTS="$OBJECTS $OBJ"
+        rm -f "$OBJ"
+        "$CXX" $FLAGS -c "$SRC" -o "$OBJ" &
+        PIDS="$PIDS $!"
+        while [ "$(jobs -rp | wc -l)" -ge "$JOBS" ]; do
+            sleep 0.1
+        done
+    done
+    local FAILED=0
+    for PID in $PIDS; do
+        wait "$PID" || FAILED=1
+    done
+    if [ $FAILED -ne 0 ]; then
+        log_error "Compilation failed in $OBJDIR"
+        exit 1
+    fi
+}
+
+# Function to build the standalone engine benchmark and validation harness
+build_benchmark() {
+    log_info "Building VeraLuxBenchmark and VeraLuxValidation for $PLATFORM..."
+
+    if ! headless_platform; then
+        log_warning "The benchmark is not built on Windows, skipping"
+        return 0
+    fi
+
+    # Engine sources only: the tools run without the PixInsight core
+    # application, so PCL threads are replaced by std::thread
+    CXXFLAGS="$ENGINE_FLAGS -D__PCL_X64 $PCL_PLATFORM_DEFINE -DVERALUX_HEADLESS -I$PCLINCDIR"
+    OBJDIR="$REPO_ROOT/benchmark/x64/Release"
+    compile_headless "$OBJDIR" "$CXXFLAGS" "$REPO_ROOT"/src/core/*.cpp
+    ENGINE_OBJECTS="$OBJECTS"
+    compile_headless "$OBJDIR" "$CXXFLAGS" \
+        "$REPO_ROOT/benchmark/VeraLuxBenchmark.cpp" "$REPO_ROOT/benchmark/VeraLuxValidation.cpp"
+
+    for TOOL in VeraLuxBenchmark VeraLuxValidation; do
+        BINARY="$REPO_ROOT/bin/$PLATFORM/$TOOL"
+        rm -f "$BINARY"
+        "$CXX" $LINK_FLAGS $ENGINE_OBJECTS "$OBJDIR/$TOOL.o" -o "$BINARY" -L"$PCLLIBDIR64" \
+            -lPCL-pxi -llz4-pxi -lzstd-pxi -lzlib-pxi -lRFC6234-pxi -llcms-pxi -lcminpack-pxi $SYSTEM_LIBS
+
+        if [ ! -f "$BINARY" ]; then
+            log_error "$TOOL build failed"
+            exit 1
+        fi
+
+        log_success "$TOOL built: $BINARY"
+    done
+}
+
+# Function to build the headless engine library with its C interface
+build_library() {
+    log_info "Building the VeraLux engine library for $PLATFORM..."
+
+    if ! headless_platform; then
+        log_warning "The engine library is not built on Windows, skipping"
+        return 0
+    fi
+
+    # Position-independent objects (as in ENGINE_FLAGS) serve both
+    # libraries. Only the C interface is exported from the shared library.
+    CXXFLAGS="$ENGINE_FLAGS -D__PCL_X64 $PCL_PLATFORM_DEFINE -DVERALUX_HEADLESS -DVERALUX_BUILDING_LIBRARY -I$PCLINCDIR"
+    compile_headless "$REPO_ROOT/library/x64/Release" "$CXXFLAGS" \
+        "$REPO_ROOT"/src/core/*.cpp "$REPO_ROOT/library/VeraLuxC.cpp"
+
+    LIBDIR="$REPO_ROOT/bin/$PLATFORM/lib"
+    mkdir -p "$LIBDIR" "$REPO_ROOT/bin/$PLATFORM/include"
+    rm -f "$LIBDIR/libVeraLux.a"
+    ar rcs "$LIBDIR/libVeraLux.a" $OBJECTS
+
+    # The shared library embeds the PCL static libraries
+    "$CXX" $LINK_FLAGS $SHARED_FLAGS $OBJECTS -o "$LIBDIR/libVeraLux.$SHARED_EXT" -L"$PCLLIBDIR64" \
+        -lPCL-pxi -llz4-pxi -lzstd-pxi -lzlib-pxi -lRFC6234-pxi -llcms-pxi -lcminpack-pxi $SYSTEM_LIBS
+    cp "$REPO_ROOT/library/VeraLuxC.h" "$REPO_ROOT/bin/$PLATFORM/include/"
+
+    if [ ! -f "$LIBDIR/libVeraLux.a" ] || [ ! -f "$LIBDIR/libVeraLux.$SHARED_EXT" ]; then
+        log_error "Engine library build failed"
+        exit 1
+    fi
+
+    log_success "Engine library built: $LIBDIR/libVeraLux.a, $LIBDIR/libVeraLux.$SHARED_EXT"
+}
+
 # Function to verify output
 verify_output() {
     log_info "Verifying build output..."
@@ -514,6 +656,16 @@ main() {
     
     # Step 8: Verify output
     verify_output
+
+    # Step 9: Build the engine benchmark if requested
+    if [ "$BENCHMARK" = true ]; then
+        build_benchmark
+    fi
+
+    # Step 10: Build the engine library if requested
+    if [ "$LIBRARY" = true ]; then
+        build_library
+    fi
     
     echo ""
     echo "======================================================================"
@@ -0,0 +1,279 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxC.h"
+
+#include "../src/core/SensorProfiles.h"
+#include "../src/core/VeraLuxEngine.h"
+#include "../src/core/VeraLuxPipeline.h"
+#include "../src/core/VeraLuxTopology.h"
+#include "../src/core/VeraLuxWorkspace.h"
+
+#include <pcl/Exception.h>
+#include <pcl/Image.h>
+#include <pcl/Math.h>
+
+#include <new>
+#include <string>
+
+using namespace pcl;
+
+struct veralux_workspace
+{
+   VeraLuxWorkspace pool;
+
+   veralux_workspace( size_type capacity )
+      : pool( capacity )
+   {
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   thread_local std::string t_lastError;
+
+   veralux_status Fail( veralux_status status, const char* message )
+   {
+      t_lastError = message;
+      return status;
+   }
+
+   bool InRange( double x, double a, double b )
+   {
+      return x >= a && x <= b;   // false for NaN
+   }
+
+   const char* InvalidParameter( const veralux_params& p )
+   {
+      if ( p.mode != VERALUX_READY_TO_USE && p.mode != VERALUX_SCIENTIFIC )
+         return "Invalid processing mode.";
+      if ( p.sensor_profile < 0 || size_t( p.sensor_profile ) >= g_numSensorProfiles )
+         return "Invalid sensor profile index.";
+      if ( !InRange( p.log_d, 0.0, 7.0 ) )
+         return "Log D out of range [0,7].";
+      if ( !InRange( p.protect_b, 0.1, 15.0 ) )
+         return "Highlight protection out of range [0.1,15].";
+      if ( !InRange( p.color_convergence, 1.0, 10.0 ) )
+         return "Color convergence out of range [1,10].";
+      if ( p.color_strategy < -100 || p.color_strategy > 100 )
+         return "Color strategy out of range [-100,100].";
+      if ( !InRange( p.color_grip, 0.0, 1.0 ) )
+         return "Color grip out of range [0,1].";
+      if ( !InRange( p.shadow_convergence, 0.0, 3.0 ) )
+         return "Shadow convergence out of range [0,3].";
+      if ( !InRange( p.linear_expansion, 0.0, 1.0 ) )
+         return "Linear expansion out of range [0,1].";
+      if ( !InRange( p.target_background, 0.05, 0.50 ) )
+         return "Target background out of range [0.05,0.5].";
+      return nullptr;
+   }
+
+   /*
+    * Pipeline parameters, with the effective grip, shadow convergence and
+    * linear expansion of HyperMetricStretchInstance::GetEffectiveParams().
+    */
+   FusedStretchParameters FusedParameters( const veralux_params& p, double anchor, double logD )
+   {
+      FusedStretchParameters fused;
+      fused.anchor = anchor;
+      fused.D = Pow10( logD );
+      fused.b = p.protect_b;
+      fused.colorConvergence = p.color_convergence;
+      if ( p.mode == VERALUX_READY_TO_USE )
+      {
+         if ( p.color_strategy < 0 )
+            fused.shadowConvergence = (Abs( p.color_strategy )/100.0)*3.0;
+         else
+            fused.colorGrip = 1.0 - (p.color_strategy/100.0)*0.6;
+      }
+      else
+      {
+         fused.colorGrip = p.color_grip;
+         fused.shadowConvergence = p.shadow_convergence;
+         if ( p.linear_expansion > 0.001 )
+            fused.linearExpansion = p.linear_expansion;
+      }
+      fused.transfer = VeraLuxEngine::TransferEvaluationFor( 32, true/*floatSample*/ );
+      return fused;
+   }
+
+   /*
+    * Float image over the caller's planes. The pixel data is detached again
+    * before the image is destroyed, so it is never freed or reallocated.
+    */
+   class BorrowedImage
+   {
+   public:
+
+      BorrowedImage( float* data, int width, int height, int channels )
+      {
+         for ( int c = 0; c < channels; ++c )
+            m_planes[c] = data + size_type( c )*size_type( width )*size_type( height );
+         m_image.ImportData( m_planes, width, height, channels,
+                             (channels == 3) ? ColorSpace::RGB : ColorSpace::Gray );
+      }
+
+      ~BorrowedImage()
+      {
+         (void)m_image.ReleaseData();
+      }
+
+      BorrowedImage( const BorrowedImage& ) = delete;
+      BorrowedImage& operator =( const BorrowedImage& ) = delete;
+
+      Image& operator *()
+      {
+         return m_image;
+      }
+
+   private:
+
+      float* m_planes[ 3 ];
+      Image  m_image;
+   };
+
+   void Stretch( Image& image, const veralux_params& p, VeraLuxWorkspace* workspace )
+   {
+      const SensorProfile& profile = g_sensorProfiles[p.sensor_profile];
+
+      VeraLuxEngine::NormalizeInPlace( image );
+
+      const double anchor = p.adaptive_anchor ? VeraLuxEngine::CalculateAnchorAdaptive( image, profile ) :
+                                                VeraLuxEngine::CalculateAnchor( image );
+
+      const double logD = p.auto_log_d ?
+         VeraLuxEngine::SolveLogD( VeraLuxEngine::LuminanceMedian( image, anchor, profile ),
+                                   p.target_background, p.protect_b ) : p.log_d;
+
+      const FusedStretchParameters fused = FusedParameters( p, anchor, logD );
+      VeraLuxPipeline::Run( image, profile, fused, nullptr, workspace );
+
+      if ( p.mode == VERALUX_READY_TO_USE )
+      {
+         VeraLuxEngine::AdaptiveOutputScaling( image, profile, p.target_background, fused.estimator,
+                                               nullptr, fused.transfer, nullptr, workspace );
+         VeraLuxEngine::ApplyReadyToUseSoftClip( image, 0.98, 2.0, fused.transfer );
+      }
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+void veralux_default_params( veralux_params* params )
+{
+   if ( params == nullptr )
+      return;
+   params->mode = VERALUX_READY_TO_USE;
+   params->sensor_profile = int( g_defaultSensorProfileIndex );
+   params->adaptive_anchor = 1;
+   params->auto_log_d = 0;
+   params->log_d = 2.0;
+   params->protect_b = 6.0;
+   params->color_convergence = 3.5;
+   params->color_strategy = 0;
+   params->color_grip = 1.0;
+   params->shadow_convergence = 0.0;
+   params->linear_expansion = 0.0;
+   params->target_background = 0.20;
+   params->max_threads = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+int veralux_sensor_profile_count( void )
+{
+   return int( g_numSensorProfiles );
+}
+
+// ----------------------------------------------------------------------------
+
+const char* veralux_sensor_profile_name( int index )
+{
+   if ( index < 0 || size_t( index ) >= g_numSensorProfiles )
+      return nullptr;
+   return g_sensorProfiles[index].name.c_str();
+}
+
+// ----------------------------------------------------------------------------
+
+veralux_workspace* veralux_workspace_create( size_t capacity )
+{
+   return new (std::nothrow) veralux_workspace( (capacity > 0) ? size_type( capacity ) :
+                                                                 VeraLuxWorkspace::DefaultCapacity );
+}
+
+// ----------------------------------------------------------------------------
+
+void veralux_workspace_destroy( veralux_workspace* workspace )
+{
+   delete workspace;
+}
+
+// ----------------------------------------------------------------------------
+
+veralux_status veralux_stretch( float* data, int width, int height, int channels,
+                                const veralux_params* params, veralux_workspace* workspace )
+{
+   t_lastError.clear();
+
+   if ( data == nullptr || params == nullptr )
+      return Fail( VERALUX_INVALID_ARGUMENT, "Null image or parameters." );
+   if ( width <= 0 || height <= 0 )
+      return Fail( VERALUX_INVALID_ARGUMENT, "Empty image." );
+   if ( channels != 1 && channels != 3 )
+      return Fail( VERALUX_INVALID_ARGUMENT, "Only mono and RGB images are supported." );
+   if ( const char* message = InvalidParameter( *params ) )
+      return Fail( VERALUX_INVALID_ARGUMENT, message );
+
+   try
+   {
+      // Bands of this call stay on the reserved processors
+      VeraLuxTopology::Reservation reservation( params->max_threads );
+
+      BorrowedImage image( data, width, height, channels );
+      Stretch( *image, *params, (workspace != nullptr) ? &workspace->pool : nullptr );
+      return VERALUX_OK;
+   }
+   catch ( const std::bad_alloc& )
+   {
+      return Fail( VERALUX_OUT_OF_MEMORY, "Out of memory." );
+   }
+   catch ( const Exception& x )
+   {
+      return Fail( VERALUX_ENGINE_ERROR, x.Message().ToUTF8().c_str() );
+   }
+   catch ( const std::exception& x )
+   {
+      return Fail( VERALUX_ENGINE_ERROR, x.what() );
+   }
+   catch ( ... )
+   {
+      return Fail( VERALUX_ENGINE_ERROR, "Unknown error." );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+const char* veralux_last_error( void )
+{
+   return t_lastError.c_str();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,175 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// ENGINE LIBRARY:
+//
+// C interface of the VeraLux engine (src/core) for applications running
+// without PixInsight, such as ingest and reduction servers. Built by
+// build.sh --library as a static and a shared library, with the engine
+// compiled headless (see VeraLuxParallel).
+//
+// veralux_stretch() applies the HyperMetric Stretch to a caller-owned
+// planar float buffer in place, with the same steps as the process on a
+// 32-bit float image: in-place normalization, anchor, fused stretch
+// pipeline and, in Ready-to-Use mode, adaptive output scaling and soft
+// clip. The pixels are not copied. The full-size temporaries of linear
+// expansion and output scaling (luminance plane, percentile subsamples)
+// are taken from an optional workspace, so a server stretching frames of
+// the same geometry allocates them once; the anchor and Log D statistics
+// only need small buffers of bounded size.
+//
+// All functions are thread-safe. A workspace may be shared by concurrent
+// calls.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxC_h
+#define __VeraLuxC_h
+
+#include <stddef.h>
+
+#if defined( _WIN32 )
+#  ifdef VERALUX_BUILDING_LIBRARY
+#     define VERALUX_API __declspec( dllexport )
+#  else
+#     define VERALUX_API
+#  endif
+#else
+#  define VERALUX_API __attribute__(( visibility( "default" ) ))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Version of this interface, incremented when veralux_params changes.
+ */
+#define VERALUX_API_VERSION 1
+
+/*!
+ * \brief Result of a library call.
+ */
+typedef enum veralux_status
+{
+   VERALUX_OK = 0,                  /*!< Success */
+   VERALUX_INVALID_ARGUMENT = 1,    /*!< Null pointer, bad geometry or parameter out of range */
+   VERALUX_OUT_OF_MEMORY = 2,       /*!< A temporary could not be allocated */
+   VERALUX_ENGINE_ERROR = 3         /*!< The engine failed; see veralux_last_error() */
+} veralux_status;
+
+/*!
+ * \brief Processing modes, as the HyperMetric Stretch process.
+ */
+typedef enum veralux_mode
+{
+   VERALUX_READY_TO_USE = 0,  /*!< Color strategy, output scaling and soft clip */
+   VERALUX_SCIENTIFIC = 1     /*!< Explicit grip, shadow convergence and linear expansion */
+} veralux_mode;
+
+/*!
+ * \brief Stretch parameters.
+ *
+ * Initialize with veralux_default_params(), which sets the defaults of the
+ * HyperMetric Stretch process, then change the members of interest.
+ */
+typedef struct veralux_params
+{
+   int    mode;                /*!< veralux_mode */
+   int    sensor_profile;      /*!< Index in [0,veralux_sensor_profile_count()) */
+   int    adaptive_anchor;     /*!< Nonzero: morphological anchor; zero: statistical anchor */
+   int    auto_log_d;          /*!< Nonzero: solve Log D for target_background, ignoring log_d */
+   double log_d;               /*!< Stretch intensity, [0,7] */
+   double protect_b;           /*!< Highlight protection, [0.1,15] */
+   double color_convergence;   /*!< Star core white point power, [1,10] */
+   int    color_strategy;      /*!< Ready-to-Use: [-100,100], negative damps shadow noise, positive softens grip */
+   double color_grip;          /*!< Scientific: vector preservation, [0,1] */
+   double shadow_convergence;  /*!< Scientific: shadow noise damping, [0,3] */
+   double linear_expansion;    /*!< Scientific: linear expansion amount, [0,1] */
+   double target_background;   /*!< Target background level, [0.05,0.5] */
+   int    max_threads;         /*!< Threads used by one call; zero or negative: all processors */
+} veralux_params;
+
+/*!
+ * \brief Opaque pool of engine temporaries.
+ */
+typedef struct veralux_workspace veralux_workspace;
+
+/*!
+ * \brief Fills \a params with the process defaults.
+ */
+VERALUX_API void veralux_default_params( veralux_params* params );
+
+/*!
+ * \brief Number of built-in sensor profiles.
+ */
+VERALUX_API int veralux_sensor_profile_count( void );
+
+/*!
+ * \brief Name of a built-in sensor profile, or NULL for an invalid index.
+ */
+VERALUX_API const char* veralux_sensor_profile_name( int index );
+
+/*!
+ * \brief Creates a workspace pooling up to \a capacity bytes of
+ * temporaries; zero selects the engine default (1 GiB).
+ *
+ * Returns NULL if the workspace cannot be allocated.
+ */
+VERALUX_API veralux_workspace* veralux_workspace_create( size_t capacity );
+
+/*!
+ * \brief Frees a workspace and all of its pooled memory. NULL is ignored.
+ *
+ * No call using the workspace may be running.
+ */
+VERALUX_API void veralux_workspace_destroy( veralux_workspace* workspace );
+
+/*!
+ * \brief Stretches a planar float image in place.
+ *
+ * \param data       Pixel samples: \a channels planes of \a width x
+ *                   \a height samples each, one after another, rows top to
+ *                   bottom. Values in any positive range are normalized to
+ *                   [0,1] first, as by the process; NaN and infinite values
+ *                   are replaced.
+ * \param width      Width in pixels
+ * \param height     Height in pixels
+ * \param channels   1 (mono) or 3 (RGB)
+ * \param params     Stretch parameters
+ * \param workspace  Optional pool of temporaries, or NULL to allocate them
+ *                   on each call
+ *
+ * On failure \a data may be partially stretched.
+ */
+VERALUX_API veralux_status veralux_stretch( float* data, int width, int height, int channels,
+                                            const veralux_params* params, veralux_workspace* workspace );
+
+/*!
+ * \brief Description of the last failure of a call on the calling thread,
+ * or an empty string. Valid until the next call on the same thread.
+ */
+VERALUX_API const char* veralux_last_error( void );
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif   // __VeraLuxC_h
+
+// ----------------------------------------------------------------------------
@@ -18,6 +18,12 @@
 
 #include "SensorProfiles.h"
 
+#include <pcl/Exception.h>
+#include <pcl/File.h>
+
+#include <cstdlib>
+#include <utility>
+
 namespace pcl
 {
 
@@ -228,6 +234,433 @@ const size_t g_numSensorProfiles = sizeof( s_sensorProfilesData ) / sizeof( Sens
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+   /*
+    * Minimal JSON reader for profile files. Values are parsed into a small
+    * tree; numbers are returned as doubles and strings as UTF-8.
+    */
+   struct JSONValue
+   {
+      enum Type { Null, Boolean, Number, String, Array, Object };
+
+      Type                                              type = Null;
+      int                                               line = 1;
+      double                                            number = 0;
+      IsoString                                         string;
+      std::vector<JSONValue>                            items;
+      std::vector<std::pair<IsoString, JSONValue>>      members;
+
+      const JSONValue* Member( const char* key ) const
+      {
+         for ( const auto& m : members )
+            if ( m.first == IsoString( key ) )
+               return &m.second;
+         return nullptr;
+      }
+   };
+
+   class JSONReader
+   {
+   public:
+
+      JSONReader( const IsoString& text )
+         : m_p( text.c_str() )
+         , m_end( text.c_str() + text.Length() )
+      {
+      }
+
+      JSONValue Parse()
+      {
+         // UTF-8 byte order mark
+         if ( m_end - m_p >= 3 && uint8( m_p[0] ) == 0xEF && uint8( m_p[1] ) == 0xBB && uint8( m_p[2] ) == 0xBF )
+            m_p += 3;
+         JSONValue value = ParseValue( 0 );
+         SkipSpace();
+         if ( m_p != m_end )
+            Fail( "unexpected data after the document" );
+         return value;
+      }
+
+      [[noreturn]] void Fail( const char* what ) const
+      {
+         throw Error( String().Format( "Sensor profiles, line %d: ", m_line ) + what );
+      }
+
+   private:
+
+      const char* m_p;
+      const char* m_end;
+      int         m_line = 1;
+
+      static constexpr int MaxDepth = 64;
+
+      void SkipSpace()
+      {
+         for ( ; m_p != m_end; ++m_p )
+            if ( *m_p == '\n' )
+               ++m_line;
+            else if ( *m_p != ' ' && *m_p != '\t' && *m_p != '\r' )
+               break;
+      }
+
+      bool Match( const char* literal )
+      {
+         const char* q = m_p;
+         for ( ; *literal != '\0'; ++literal, ++q )
+            if ( q == m_end || *q != *literal )
+               return false;
+         m_p = q;
+         return true;
+      }
+
+      JSONValue ParseValue( int depth )
+      {
+         if ( depth > MaxDepth )
+            Fail( "nesting too deep" );
+
+         SkipSpace();
+         if ( m_p == m_end )
+            Fail( "unexpected end of document" );
+
+         JSONValue value;
+         value.line = m_line;
+         switch ( *m_p )
+         {
+         case '{':
+            value.type = JSONValue::Object;
+            ++m_p;
+            SkipSpace();
+            if ( m_p != m_end && *m_p == '}' )
+            {
+               ++m_p;
+               break;
+            }
+            for ( ;; )
+            {
+               SkipSpace();
+               if ( m_p == m_end || *m_p != '"' )
+                  Fail( "expected a member name" );
+               IsoString key = ParseString();
+               SkipSpace();
+               if ( m_p == m_end || *m_p != ':' )
+                  Fail( "expected ':'" );
+               ++m_p;
+               value.members.emplace_back( key, ParseValue( depth+1 ) );
+               SkipSpace();
+               if ( m_p != m_end && *m_p == ',' )
+               {
+                  ++m_p;
+                  continue;
+               }
+               if ( m_p == m_end || *m_p != '}' )
+                  Fail( "expected ',' or '}'" );
+               ++m_p;
+               break;
+            }
+            break;
+
+         case '[':
+            value.type = JSONValue::Array;
+            ++m_p;
+            SkipSpace();
+            if ( m_p != m_end && *m_p == ']' )
+            {
+               ++m_p;
+               break;
+            }
+            for ( ;; )
+            {
+               value.items.push_back( ParseValue( depth+1 ) );
+               SkipSpace();
+               if ( m_p != m_end && *m_p == ',' )
+               {
+                  ++m_p;
+                  continue;
+               }
+               if ( m_p == m_end || *m_p != ']' )
+                  Fail( "expected ',' or ']'" );
+               ++m_p;
+               break;
+            }
+            break;
+
+         case '"':
+            value.type = JSONValue::String;
+            value.string = ParseString();
+            break;
+
+         default:
+            if ( Match( "true" ) )
+            {
+               value.type = JSONValue::Boolean;
+               value.number = 1;
+            }
+            else if ( Match( "false" ) )
+               value.type = JSONValue::Boolean;
+            else if ( Match( "null" ) )
+               value.type = JSONValue::Null;
+            else
+            {
+               value.type = JSONValue::Number;
+               value.number = ParseNumber();
+            }
+            break;
+         }
+         return value;
+      }
+
+      double ParseNumber()
+      {
+         // Validated against the JSON grammar, then converted by strtod()
+         const char* q = m_p;
+         auto digits = [&]()
+         {
+            const char* d = q;
+            while ( q != m_end && *q >= '0' && *q <= '9' )
+               ++q;
+            return q != d;
+         };
+         if ( q != m_end && *q == '-' )
+            ++q;
+         if ( !digits() )
+            Fail( "invalid value" );
+         if ( q != m_end && *q == '.' )
+         {
+            ++q;
+            if ( !digits() )
+               Fail( "invalid number" );
+         }
+         if ( q != m_end && (*q == 'e' || *q == 'E') )
+         {
+            ++q;
+            if ( q != m_end && (*q == '+' || *q == '-') )
+               ++q;
+            if ( !digits() )
+               Fail( "invalid number" );
+         }
+
+         IsoString token;
+         for ( ; m_p != q; ++m_p )
+            token += *m_p;
+         return std::strtod( token.c_str(), nullptr );
+      }
+
+      IsoString ParseString()
+      {
+         IsoString s;
+         for ( ++m_p; ; ++m_p )
+         {
+            if ( m_p == m_end || *m_p == '\n' )
+               Fail( "unterminated string" );
+            char c = *m_p;
+            if ( c == '"' )
+            {
+               ++m_p;
+               return s;
+            }
+            if ( c != '\\' )
+            {
+               s += c;
+               continue;
+            }
+            if ( ++m_p == m_end )
+               Fail( "unterminated string" );
+            switch ( *m_p )
+            {
+            case '"':  s += '"'; break;
+            case '\\': s += '\\'; break;
+            case '/':  s += '/'; break;
+            case 'b':  s += '\b'; break;
+            case 'f':  s += '\f'; break;
+            case 'n':  s += '\n'; break;
+            case 'r':  s += '\r'; break;
+            case 't':  s += '\t'; break;
+            case 'u':
+               AppendUTF8( s, ParseCodePoint() );
+               break;
+            default:
+               Fail( "invalid escape sequence" );
+            }
+         }
+      }
+
+      unsigned ParseHex4()
+      {
+         unsigned u = 0;
+         for ( int i = 0; i < 4; ++i )
+         {
+            if ( ++m_p == m_end )
+               Fail( "unterminated string" );
+            char c = *m_p;
+            u <<= 4;
+            if ( c >= '0' && c <= '9' )
+               u |= unsigned( c - '0' );
+            else if ( c >= 'a' && c <= 'f' )
+               u |= unsigned( c - 'a' + 10 );
+            else if ( c >= 'A' && c <= 'F' )
+               u |= unsigned( c - 'A' + 10 );
+            else
+               Fail( "invalid \\u escape" );
+         }
+         return u;
+      }
+
+      // Called on the 'u' of a \u escape; leaves m_p on its last digit.
+      unsigned ParseCodePoint()
+      {
+         unsigned u = ParseHex4();
+         if ( u >= 0xD800 && u < 0xDC00 )
+         {
+            // Surrogate pair
+            if ( m_end - m_p < 3 || m_p[1] != '\\' || m_p[2] != 'u' )
+               Fail( "invalid surrogate pair" );
+            m_p += 2;
+            unsigned low = ParseHex4();
+            if ( low < 0xDC00 || low >= 0xE000 )
+               Fail( "invalid surrogate pair" );
+            u = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+         }
+         else if ( u >= 0xDC00 && u < 0xE000 )
+            Fail( "invalid surrogate pair" );
+         return u;
+      }
+
+      static void AppendUTF8( IsoString& s, unsigned u )
+      {
+         if ( u < 0x80 )
+            s += char( u );
+         else if ( u < 0x800 )
+         {
+            s += char( 0xC0 | (u >> 6) );
+            s += char( 0x80 | (u & 0x3F) );
+         }
+         else if ( u < 0x10000 )
+         {
+            s += char( 0xE0 | (u >> 12) );
+            s += char( 0x80 | ((u >> 6) & 0x3F) );
+            s += char( 0x80 | (u & 0x3F) );
+         }
+         else
+         {
+            s += char( 0xF0 | (u >> 18) );
+            s += char( 0x80 | ((u >> 12) & 0x3F) );
+            s += char( 0x80 | ((u >> 6) & 0x3F) );
+            s += char( 0x80 | (u & 0x3F) );
+         }
+      }
+   };
+
+   [[noreturn]] void ProfileError( const JSONValue& value, const char* what )
+   {
+      throw Error( String().Format( "Sensor profiles, line %d: ", value.line ) + what );
+   }
+
+   IsoString OptionalString( const JSONValue& profile, const char* key, const char* defaultValue )
+   {
+      const JSONValue* v = profile.Member( key );
+      if ( v == nullptr )
+         return IsoString( defaultValue );
+      if ( v->type != JSONValue::String )
+         ProfileError( *v, "expected a string" );
+      return v->string;
+   }
+
+   double Weight( const JSONValue& value )
+   {
+      if ( value.type != JSONValue::Number )
+         ProfileError( value, "channel weights must be numbers" );
+      if ( !(value.number >= 0) || value.number > 1.0e+06 )  // also rejects NaN
+         ProfileError( value, "channel weights must be finite and non-negative" );
+      return value.number;
+   }
+
+   SensorProfile ReadProfile( const JSONValue& profile )
+   {
+      if ( profile.type != JSONValue::Object )
+         ProfileError( profile, "expected a profile object" );
+
+      const JSONValue* name = profile.Member( "name" );
+      if ( name == nullptr || name->type != JSONValue::String || name->string.IsEmpty() )
+         ProfileError( profile, "profile without a name" );
+
+      double w[ 3 ];
+      if ( const JSONValue* weights = profile.Member( "weights" ) )
+      {
+         if ( weights->type != JSONValue::Array || weights->items.size() != 3 )
+            ProfileError( *weights, "\"weights\" must be an array of three numbers" );
+         for ( int i = 0; i < 3; ++i )
+            w[i] = Weight( weights->items[i] );
+      }
+      else
+      {
+         const char* keys[] = { "r", "g", "b" };
+         for ( int i = 0; i < 3; ++i )
+         {
+            const JSONValue* v = profile.Member( keys[i] );
+            if ( v == nullptr )
+               ProfileError( profile, "profile without \"weights\" or \"r\", \"g\", \"b\"" );
+            w[i] = Weight( *v );
+         }
+      }
+      if ( w[0] + w[1] + w[2] <= 0 )
+         ProfileError( profile, "channel weights must add up to a positive value" );
+
+      return SensorProfile( name->string,
+                            OptionalString( profile, "description", "" ),
+                            OptionalString( profile, "category", "custom" ),
+                            w[0], w[1], w[2] );
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+std::vector<SensorProfile> ParseSensorProfiles( const IsoString& json )
+{
+   JSONReader reader( json );
+   const JSONValue document = reader.Parse();
+
+   const JSONValue* list = &document;
+   if ( document.type == JSONValue::Object )
+   {
+      list = document.Member( "profiles" );
+      if ( list == nullptr )
+         ProfileError( document, "missing \"profiles\" array" );
+   }
+   if ( list->type != JSONValue::Array )
+      ProfileError( *list, "expected an array of profiles" );
+
+   std::vector<SensorProfile> profiles;
+   profiles.reserve( list->items.size() );
+   for ( const JSONValue& item : list->items )
+   {
+      SensorProfile profile = ReadProfile( item );
+      for ( const SensorProfile& p : profiles )
+         if ( p.name == profile.name )
+            ProfileError( item, "duplicate profile name" );
+      profiles.push_back( profile );
+   }
+   return profiles;
+}
+
+// ----------------------------------------------------------------------------
+
+std::vector<SensorProfile> LoadSensorProfiles( const String& filePath )
+{
+   if ( !File::Exists( filePath ) )
+      throw Error( "Sensor profiles file not found: " + filePath );
+   try
+   {
+      return ParseSensorProfiles( File::ReadTextFile( filePath ) );
+   }
+   catch ( Error& x )
+   {
+      throw Error( filePath + ": " + x.Message() );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 // ----------------------------------------------------------------------------
@@ -21,11 +21,54 @@
 
 #include <pcl/String.h>
 
+#include <vector>
+
 namespace pcl
 {
 
 // ----------------------------------------------------------------------------
 
+/*!
+ * \struct SensorWeights
+ * \brief Luminance weights of a sensor profile, in the forms the kernels use.
+ *
+ * One cache line per profile, free of strings: the luminance loops copy the
+ * weights they need into registers without touching the descriptive fields
+ * of the profile. The double weights feed the double-precision accumulation
+ * of the CPU kernels; the float weights are rounded once for
+ * single-precision vector code.
+ */
+struct alignas( 64 ) SensorWeights
+{
+   double r;   //!< Red channel weight
+   double g;   //!< Green channel weight
+   double b;   //!< Blue channel weight
+   float  rf;  //!< Red channel weight, single precision
+   float  gf;  //!< Green channel weight, single precision
+   float  bf;  //!< Blue channel weight, single precision
+
+   /*!
+    * Constructs a set of weights with precomputed single-precision forms.
+    */
+   constexpr SensorWeights( double r_, double g_, double b_ )
+      : r( r_ ), g( g_ ), b( b_ )
+      , rf( float( r_ ) ), gf( float( g_ ) ), bf( float( b_ ) )
+   {
+   }
+
+   bool operator ==( const SensorWeights& x ) const
+   {
+      return r == x.r && g == x.g && b == x.b;
+   }
+
+   bool operator !=( const SensorWeights& x ) const
+   {
+      return !(*this == x);
+   }
+};
+
+// ----------------------------------------------------------------------------
+
 /*!
  * \struct SensorProfile
  * \brief Sensor quantum efficiency profile for photometric luminance extraction.
@@ -40,18 +83,16 @@ namespace pcl
  */
 struct SensorProfile
 {
-   IsoString name;         //!< Profile name (user-facing)
-   IsoString description;  //!< Technical description
-   IsoString category;     //!< Category: "standard", "sensor-specific", "narrowband"
-   double rWeight;      //!< Red channel weight (Quantum Efficiency)
-   double gWeight;      //!< Green channel weight (Quantum Efficiency)
-   double bWeight;      //!< Blue channel weight (Quantum Efficiency)
+   SensorWeights weights;      //!< Channel weights (Quantum Efficiency)
+   IsoString     name;         //!< Profile name (user-facing)
+   IsoString     description;  //!< Technical description
+   IsoString     category;     //!< Category: "standard", "sensor-specific", "narrowband", "custom"
 
    /*!
-    * Default constructor.
+    * Default constructor (Rec.709 weights).
     */
    SensorProfile()
-      : rWeight( 0.2126 ), gWeight( 0.7152 ), bWeight( 0.0722 )
+      : weights( 0.2126, 0.7152, 0.0722 )
    {
    }
 
@@ -60,8 +101,8 @@ struct SensorProfile
     */
    SensorProfile( const IsoString& n, const IsoString& d, const IsoString& c,
                   double r, double g, double b )
-      : name( n ), description( d ), category( c )
-      , rWeight( r ), gWeight( g ), bWeight( b )
+      : weights( r, g, b )
+      , name( n ), description( d ), category( c )
    {
    }
 };
@@ -89,6 +130,30 @@ constexpr size_t g_defaultSensorProfileIndex = 0;
 
 // ----------------------------------------------------------------------------
 
+/*!
+ * \brief Parses custom sensor profiles from a JSON document.
+ *
+ * The document is either an array of profile objects or an object with a
+ * "profiles" array member. Each profile object has a "name" string, either
+ * a "weights" array of three numbers or "r", "g" and "b" number members,
+ * and optional "description" and "category" strings. Unknown members are
+ * ignored. The category defaults to "custom".
+ *
+ * Throws an Error, with the offending line, for malformed documents,
+ * missing names, duplicate names and weights that are negative or do not
+ * add up to a positive value.
+ */
+std::vector<SensorProfile> ParseSensorProfiles( const IsoString& json );
+
+/*!
+ * \brief Reads custom sensor profiles from a JSON file.
+ *
+ * See ParseSensorProfiles() for the file format.
+ */
+std::vector<SensorProfile> LoadSensorProfiles( const String& filePath );
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 #endif   // __SensorProfiles_h
@@ -0,0 +1,96 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxAnalysis.h"
+#include "VeraLuxEngine.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Stage flags including all prerequisite stages.
+    */
+   unsigned ExpandStages( unsigned stages )
+   {
+      if ( stages & (AnalysisStage::Luminance | AnalysisStage::Median) )
+         stages |= AnalysisStage::Anchor;
+      if ( stages & AnalysisStage::Anchor )
+         stages |= AnalysisStage::Normalized;
+      return stages;
+   }
+
+   void ComputeNormalized( VeraLuxAnalysis& a, const ImageVariant& source, VeraLuxWorkspace* workspace = nullptr )
+   {
+      if ( workspace != nullptr )
+         a.normalized = workspace->AcquireImage( source.Width(), source.Height(), source.NumberOfChannels() );
+      VeraLuxEngine::NormalizeInput( a.normalized, source );
+      a.stages = AnalysisStage::Normalized;
+   }
+
+   void ComputeAnchor( VeraLuxAnalysis& a, bool adaptiveAnchor, const SensorProfile& profile )
+   {
+      a.anchor = adaptiveAnchor ?
+         VeraLuxEngine::CalculateAnchorAdaptive( a.normalized, profile ) :
+         VeraLuxEngine::CalculateAnchor( a.normalized );
+      a.stages = (a.stages & AnalysisStage::Normalized) | AnalysisStage::Anchor;
+   }
+
+   void ComputeLuminance( VeraLuxAnalysis& a, const SensorProfile& profile, VeraLuxWorkspace* workspace = nullptr )
+   {
+      if ( workspace != nullptr )
+         a.luminance = workspace->AcquireImage( a.normalized.Width(), a.normalized.Height(), 1 );
+      VeraLuxEngine::ExtractLuminance( a.luminance, a.normalized, a.anchor, profile );
+      a.stages = (a.stages & (AnalysisStage::Normalized | AnalysisStage::Anchor)) | AnalysisStage::Luminance;
+   }
+
+   void ComputeMedian( VeraLuxAnalysis& a, const SensorProfile& profile, StatusMonitor* monitor )
+   {
+      a.luminanceMedian = VeraLuxEngine::LuminanceMedian( a.normalized, a.anchor, profile, monitor );
+      a.stages |= AnalysisStage::Median;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+VeraLuxAnalysis VeraLuxAnalysis::Compute( const ImageVariant& source, bool adaptiveAnchor,
+                                          const SensorProfile& profile, unsigned stages,
+                                          VeraLuxWorkspace* workspace, StatusMonitor* monitor )
+{
+   stages = ExpandStages( stages );
+
+   VeraLuxAnalysis a;
+   if ( stages & AnalysisStage::Normalized )
+      ComputeNormalized( a, source, workspace );
+   if ( stages & AnalysisStage::Anchor )
+      ComputeAnchor( a, adaptiveAnchor, profile );
+   if ( stages & AnalysisStage::Luminance )
+      ComputeLuminance( a, profile, workspace );
+   if ( stages & AnalysisStage::Median )
+      ComputeMedian( a, profile, monitor );
+   return a;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,93 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxAnalysis_h
+#define __VeraLuxAnalysis_h
+
+#include "SensorProfiles.h"
+#include "VeraLuxWorkspace.h"
+
+#include <pcl/Image.h>
+#include <pcl/ImageVariant.h>
+
+namespace pcl
+{
+
+class StatusMonitor;
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace AnalysisStage
+ * \brief Stages of the input analysis. Each stage implies all previous ones,
+ * except Median, which only implies Anchor.
+ */
+namespace AnalysisStage
+{
+   enum mask_type
+   {
+      Normalized = 0x01,  //!< Normalized [0,1] working image
+      Anchor     = 0x02,  //!< Black point, depends on the anchor method
+      Luminance  = 0x04,  //!< Anchored photometric luminance, depends on the sensor profile
+      Median     = 0x08,  //!< Luminance median, without the luminance image
+      All        = 0x0F
+   };
+}
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxAnalysis
+ * \brief Parameter-independent analysis of an input image.
+ *
+ * Everything computed here depends only on the source image, the anchor
+ * method and the sensor profile, so it can be shared by every stretch of the
+ * same image, e.g. all variants of a parameter sweep.
+ */
+struct VeraLuxAnalysis
+{
+   Image    normalized;           //!< VeraLuxEngine::NormalizeInput() result
+   double   anchor = 0.0;         //!< Black point
+   Image    luminance;            //!< VeraLuxEngine::ExtractLuminance() result
+   double   luminanceMedian = 0;  //!< Median of the anchored luminance (Median)
+   unsigned stages = 0;           //!< Available AnalysisStage flags
+
+   /*!
+    * \brief Computes the requested analysis stages.
+    *
+    * The normalized and luminance images are acquired from \a workspace,
+    * if specified. Callers may return them with
+    * VeraLuxWorkspace::ReleaseImage() when done.
+    *
+    * \a monitor, if specified, is incremented while the Median stage is
+    * computed, as documented for VeraLuxEngine::LuminanceMedian().
+    */
+   static VeraLuxAnalysis Compute( const ImageVariant& source, bool adaptiveAnchor,
+                                   const SensorProfile& profile,
+                                   unsigned stages = AnalysisStage::Anchor,
+                                   VeraLuxWorkspace* workspace = nullptr,
+                                   StatusMonitor* monitor = nullptr );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxAnalysis_h
+
+// ----------------------------------------------------------------------------
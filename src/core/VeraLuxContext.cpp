@@ -0,0 +1,60 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxContext.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   const VeraLuxContext s_defaultContext;
+
+   thread_local const VeraLuxContext* t_context = nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+const VeraLuxContext& VeraLuxContext::Current()
+{
+   return (t_context != nullptr) ? *t_context : s_defaultContext;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxContext::Scope::Scope( const VeraLuxContext& context )
+   : m_context( context )
+   , m_previous( t_context )
+{
+   t_context = &m_context;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxContext::Scope::~Scope()
+{
+   t_context = m_previous;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
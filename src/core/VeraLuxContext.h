@@ -0,0 +1,117 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// EXECUTION CONTEXT:
+//
+// A view execution, a batch worker, a real-time preview render and an
+// Auto-Calc analysis can all run at the same time, each with the settings of
+// its own instance: compute precision, GPU acceleration and thread limits.
+// These settings change the arithmetic or the scheduling of every stage of a
+// run, so they must stay fixed for the whole run and must not leak into
+// other runs.
+//
+// Every run installs its settings with a VeraLuxContext::Scope on the thread
+// that drives it, for as long as the run lasts. The engine reads them from
+// VeraLuxContext::Current(), and the row band threads of VeraLuxParallel
+// inherit the context of the thread that starts them. Threads without a
+// scope use the default settings.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxContext_h
+#define __VeraLuxContext_h
+
+#include "VeraLuxSIMD.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxContext
+ * \brief Engine settings of one execution, scoped to the threads running it.
+ */
+struct VeraLuxContext
+{
+   /*!
+    * Arithmetic of the transfer function kernels and luminance sums.
+    */
+   ComputePrecision::value_type precision = ComputePrecision::Default;
+
+   /*!
+    * Whether solved-parameter stretches may run on the GPU (see VeraLuxGPU).
+    */
+   bool gpuAcceleration = false;
+
+   /*!
+    * Limit of threads of every row band pass run in this context (see
+    * VeraLuxParallel), or zero when unlimited.
+    */
+   int maxThreads = 0;
+
+   /*!
+    * Limit of threads on each NUMA node for processor reservations made in
+    * this context (see VeraLuxTopology), or zero when unlimited.
+    */
+   int maxThreadsPerNode = 0;
+
+   /*!
+    * \brief Settings of the calling thread.
+    *
+    * Those of its innermost scope, or the defaults if it has none.
+    */
+   static const VeraLuxContext& Current();
+
+   class Scope;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class pcl::VeraLuxContext::Scope
+ * \brief Installs execution settings on the calling thread.
+ *
+ * The settings are copied, so the scope does not depend on the lifetime of
+ * its argument. Scopes must be destroyed by the thread that created them, in
+ * reverse order of creation.
+ */
+class VeraLuxContext::Scope
+{
+public:
+
+   Scope( const VeraLuxContext& context );
+
+   ~Scope();
+
+   Scope( const Scope& ) = delete;
+   Scope& operator =( const Scope& ) = delete;
+
+private:
+
+   const VeraLuxContext  m_context;
+   const VeraLuxContext* m_previous;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxContext_h
+
+// ----------------------------------------------------------------------------
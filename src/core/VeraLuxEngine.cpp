@@ -17,11 +17,22 @@
 // ----------------------------------------------------------------------------
 
 #include "VeraLuxEngine.h"
+#include "VeraLuxLUT.h"
+#include "VeraLuxParallel.h"
+#include "VeraLuxSIMD.h"
+#include "VeraLuxSmartMax.h"
+#include "VeraLuxStatistics.h"
 
+#include <pcl/AutoLock.h>
+#include <pcl/ElapsedTime.h>
 #include <pcl/ImageStatistics.h>
 #include <pcl/Math.h>
+#include <pcl/Mutex.h>
+#include <pcl/StatusMonitor.h>
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <vector>
 
 namespace pcl
@@ -36,32 +47,9 @@ namespace
     * - Percentile is computed on a subsample (stride), with NumPy's default
     *   linear interpolation between adjacent ranks.
     */
-   static double PercentileFromSorted( const std::vector<float>& sorted, double pct )
-   {
-      if ( sorted.empty() )
-         return 0.0;
-
-      pct = Max( 0.0, Min( pct, 100.0 ) );
-      if ( sorted.size() == 1 )
-         return sorted[0];
-
-      const double pos = (pct/100.0) * double( sorted.size() - 1 );
-      const size_t i0 = size_t( Floor( pos ) );
-      const size_t i1 = Min( i0 + 1, sorted.size() - 1 );
-      const double f = pos - double( i0 );
-
-      const double v0 = sorted[i0];
-      const double v1 = sorted[i1];
-      return v0 + f * (v1 - v0);
-   }
-
    static double PercentileInPlace( std::vector<float>& sample, double pct )
    {
-      if ( sample.empty() )
-         return 0.0;
-
-      std::sort( sample.begin(), sample.end() );
-      return PercentileFromSorted( sample, pct );
+      return VeraLuxStatistics::Percentile( sample, pct );
    }
 
    static double SubsamplePercentile( const float* data, size_t count, size_t stride, double pct )
@@ -78,10 +66,265 @@ namespace
       return PercentileInPlace( sample, pct );
    }
 
+   /*
+    * Engine temporaries follow the parallel processing settings (enabled
+    * state and maximum number of threads) of the image they derive from.
+    */
+   inline void InheritParallelism( AbstractImage& target, const AbstractImage& source )
+   {
+      target.EnableParallelProcessing( source.IsParallelProcessingEnabled(), source.MaxProcessors() );
+   }
+
+   /*
+    * Applies a transfer table to all channels, in parallel row bands.
+    */
+   void ApplyLUT( Image& target, const VeraLuxTransferLUT& lut )
+   {
+      const int nChannels = target.NumberOfChannels();
+      VeraLuxParallel::ForEachPixelBand( target,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+               lut.Apply( target[c] + begin, end - begin );
+         } );
+   }
+
+   /*
+    * Ready-to-Use linear range expansion above a pedestal, clamped to [0,1].
+    */
+   void ApplyLinearScaling( Image& target, double floor, double scale )
+   {
+      const double PEDESTAL = 0.001;
+      const int nChannels = target.NumberOfChannels();
+      VeraLuxParallel::ForEachPixelBand( target,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+            {
+               float* data = target[c];
+               for ( size_type i = begin; i < end; ++i )
+               {
+                  double val = data[i];
+                  double scaled = (val - floor) * scale + PEDESTAL;
+                  data[i] = float( Max( 0.0, Min( scaled, 1.0 ) ) );
+               }
+            }
+         } );
+   }
+
+   /*
+    * Scales by 1/divisor, maps NaN/Inf and negative samples to zero and
+    * truncates to one, in a single pass.
+    */
+   void SanitizeUnitRange( Image& target, double divisor )
+   {
+      const int nChannels = target.NumberOfChannels();
+      const float d = float( divisor );
+      const bool rescale = divisor != 1.0;
+      VeraLuxParallel::ForEachPixelBand( target,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+            {
+               float* data = target[c];
+               for ( size_type i = begin; i < end; ++i )
+               {
+                  float v = rescale ? data[i] / d : data[i];
+                  if ( !IsFinite( v ) || v < 0 )
+                     v = 0;
+                  else if ( v > 1 )
+                     v = 1;
+                  data[i] = v;
+               }
+            }
+         } );
+   }
+
+   /*
+    * Maps native samples to normalized [0,1] floats: scaled by 1/divisor,
+    * with NaN/Inf and negative samples set to zero and truncated to one, as
+    * SanitizeUnitRange() does after a float conversion.
+    */
+   template <class P>
+   class SampleNormalizer
+   {
+   public:
+
+      SampleNormalizer( double divisor )
+         : m_divisor( float( divisor ) )
+         , m_rescale( divisor != 1.0 )
+      {
+      }
+
+      float operator()( typename P::sample s ) const
+      {
+         float v = m_rescale ? float( s ) / m_divisor : float( s );
+         if ( !IsFinite( v ) || v < 0 )
+            return 0;
+         return (v > 1) ? 1.0f : v;
+      }
+
+   private:
+
+      float m_divisor;
+      bool  m_rescale;
+   };
+
+   /*
+    * 8 and 16-bit samples are normalized by table lookup: one load per
+    * sample, with exactly the values of the float division.
+    */
+   template <class P>
+   class TableSampleNormalizer
+   {
+   public:
+
+      TableSampleNormalizer( double divisor )
+         : m_table( size_type( 1 ) << (8*sizeof( typename P::sample )) )
+      {
+         SampleNormalizer<FloatPixelTraits> normalize( divisor );
+         for ( size_type i = 0; i < m_table.size(); ++i )
+            m_table[i] = normalize( float( i ) );
+      }
+
+      float operator()( typename P::sample s ) const
+      {
+         return m_table[s];
+      }
+
+   private:
+
+      std::vector<float> m_table;
+   };
+
+   template <>
+   class SampleNormalizer<UInt8PixelTraits> : public TableSampleNormalizer<UInt8PixelTraits>
+   {
+   public:
+
+      SampleNormalizer( double divisor )
+         : TableSampleNormalizer<UInt8PixelTraits>( divisor )
+      {
+      }
+   };
+
+   template <>
+   class SampleNormalizer<UInt16PixelTraits> : public TableSampleNormalizer<UInt16PixelTraits>
+   {
+   public:
+
+      SampleNormalizer( double divisor )
+         : TableSampleNormalizer<UInt16PixelTraits>( divisor )
+      {
+      }
+   };
+
+   /*
+    * Normalizes a region of an image of any real or integer sample type into
+    * a float image in a single pass over the native samples, without an
+    * intermediate float copy. The target keeps its allocation when its
+    * geometry already matches, as for successive strips of the same size.
+    */
+   template <class P>
+   void NormalizeSamples( Image& target, const GenericImage<P>& source, const Rect& rect, double divisor )
+   {
+      const Rect r = rect.IsRect() ? rect.Intersection( source.Bounds() ) : source.Bounds();
+      if ( !r.IsRect() )
+      {
+         target.FreeData();
+         return;
+      }
+
+      const int nChannels = source.NumberOfChannels();
+      if ( target.Width() != r.Width() || target.Height() != r.Height()
+        || target.NumberOfChannels() != nChannels || target.IsShared() )
+         target.AllocateData( r.Width(), r.Height(), nChannels, source.ColorSpace() );
+      else if ( target.ColorSpace() != source.ColorSpace() )
+         target.SetColorSpace( source.ColorSpace() );
+      InheritParallelism( target, source );
+
+      const SampleNormalizer<P> normalize( divisor );
+      const int width = r.Width();
+      VeraLuxParallel::ForEachRowBand( r.Height(), VeraLuxParallel::MaxThreads( target ),
+         [&]( int startRow, int endRow )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+               for ( int y = startRow; y < endRow; ++y )
+               {
+                  const typename P::sample* s = source.ScanLine( r.y0 + y, c ) + r.x0;
+                  float* t = target.ScanLine( y, c );
+                  for ( int x = 0; x < width; ++x )
+                     t[x] = normalize( s[x] );
+               }
+         } );
+   }
+
+   /*
+    * Converts a [0,1] float image into rows of an image of the same width
+    * and number of channels, starting at startRow.
+    */
+   template <class P>
+   void StoreConverted( GenericImage<P>& target, const Image& source, int startRow )
+   {
+      if ( target.Width() != source.Width() || target.NumberOfChannels() != source.NumberOfChannels()
+        || startRow < 0 || startRow + source.Height() > target.Height() )
+      {
+         if ( startRow != 0 )
+            throw Error( "StoreOutput(): Incompatible image geometry." );
+         target.Assign( source );
+         return;
+      }
+
+      const int nChannels = source.NumberOfChannels();
+      const size_type offset = size_type( startRow )*size_type( target.Width() );
+      VeraLuxParallel::ForEachPixelBand( source,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+            {
+               const float* f = source[c];
+               typename P::sample* t = target[c] + offset;
+               for ( size_type i = begin; i < end; ++i )
+                  t[i] = P::ToSample( f[i] );
+            }
+         } );
+   }
+
+   /*
+    * Weighted luminance of an RGB image, or a copy of a mono image.
+    */
+   void ComputeWeightedLuma( Image& luma, const Image& target, const SensorProfile& profile )
+   {
+      if ( target.NumberOfChannels() == 3 )
+      {
+         if ( luma.Width() != target.Width() || luma.Height() != target.Height() || luma.NumberOfChannels() != 1 )
+            luma.AllocateData( target.Width(), target.Height(), 1 );
+
+         const float* r = target[0];
+         const float* g = target[1];
+         const float* b = target[2];
+         float* l = luma[0];
+         const LuminanceWeights weights( profile.weights );
+
+         VeraLuxParallel::ForEachPixelBand( target,
+            [&]( size_type begin, size_type end )
+            {
+               for ( size_type i = begin; i < end; ++i )
+                  l[i] = weights( r[i], g[i], b[i] );
+            } );
+      }
+      else
+      {
+         luma.Assign( target );
+      }
+   }
+
    /*
     * Approximate NumPy:
     *   np.convolve(hist, np.ones(50)/50, mode='same')
-    * using an explicit 50-wide box filter with zero padding.
+    * using a 50-wide box filter with zero padding. The window sum is
+    * updated incrementally; integer arithmetic keeps it exact, so results
+    * are identical to summing every window from scratch.
     */
    static void SmoothHistogramBox50( std::vector<double>& out,
                                      const std::vector<uint64>& hist )
@@ -94,109 +337,579 @@ namespace
       const int window = 50;
       const int half = window/2; // 25
 
+      // window spans [i-half, i-half+window-1] i.e. 50 samples
+      uint64 sum = 0;
+      for ( int j = 0; j < Min( bins, window - half ); ++j )
+         sum += hist[j];
+
       for ( int i = 0; i < bins; ++i )
       {
-         uint64 sum = 0;
-         // window spans [i-half, i-half+window-1] i.e. 50 samples
-         for ( int k = 0; k < window; ++k )
-         {
-            int j = i - half + k;
-            if ( j >= 0 && j < bins )
-               sum += hist[j];
-         }
          out[i] = double( sum ) / double( window );
+
+         int enter = i - half + window;
+         int leave = i - half;
+         if ( enter < bins )
+            sum += hist[enter];
+         if ( leave >= 0 )
+            sum -= hist[leave];
       }
    }
-} // namespace
 
-void VeraLuxEngine::NormalizeInput( Image& target, const ImageVariant& source )
-{
-   // Handle different input formats
-   if ( source.IsFloatSample() )
+   /*
+    * Log D solver for one input median and highlight protection.
+    *
+    * The stretched median as a function of u = log10(D),
+    *
+    *   f(u) = (asinh(D*m + b) - asinh(b)) / (asinh(D + b) - asinh(b)),
+    *
+    * is smooth and increasing on [0,7] for 0 < m < 1, so f(u) = t is solved
+    * with Newton steps on the analytic derivative, safeguarded by bisection:
+    * a step that leaves the current bracket, or does not halve the residual,
+    * falls back to the bracket midpoint. The initial guess comes from the
+    * large-D asymptote asinh(x) ~ ln(2x) with b = 0, f(u) ~ 1 + log10(m)/u.
+    */
+   class LogDSolver
    {
-      if ( source.BitsPerSample() == 32 )
+   public:
+
+      static constexpr double MinLogD = 0.0;
+      static constexpr double MaxLogD = 7.0;
+      static constexpr double DefaultLogD = 2.0;
+
+      LogDSolver( double medianIn, double bVal )
+         : m_median( medianIn )
+         , m_b( bVal )
+         , m_asinhB( ArcSinh( bVal ) )
       {
-         const Image& img = static_cast<const Image&>( *source );
-         target.Assign( img );
+         m_fLow = Evaluate( MinLogD );
+         m_fHigh = Evaluate( MaxLogD );
       }
-      else if ( source.BitsPerSample() == 64 )
+
+      double Solve( double target ) const
+      {
+         if ( m_median < 1e-9 )
+            return DefaultLogD;
+
+         /*
+          * Targets outside [f(0), f(7)] have no solution. Within the
+          * tolerance of the former bisection solver they are snapped to the
+          * bracket ends; otherwise the default Log D is returned, as before.
+          */
+         double gLow = m_fLow - target;
+         double gHigh = m_fHigh - target;
+         if ( gLow >= 0 )
+            return (gLow < Tolerance) ? MinLogD : DefaultLogD;
+         if ( gHigh <= 0 )
+            return (-gHigh < Tolerance) ? MaxLogD : DefaultLogD;
+
+         double lo = MinLogD, hi = MaxLogD;
+         double u = (target < 1) ? Log( m_median )/Ln10()/(target - 1) : 0.5*(lo + hi);
+         if ( !(u > lo && u < hi) )
+            u = 0.5*(lo + hi);
+
+         double previous = Abs( hi - lo );
+         for ( int iter = 0; iter < 50; ++iter )
+         {
+            double d;
+            double g = Evaluate( u, &d ) - target;
+            if ( Abs( g ) < 1e-12 )
+               break;
+            if ( g < 0 )
+               lo = u;
+            else
+               hi = u;
+
+            double next = (d > 0) ? u - g/d : lo - 1;
+            if ( next <= lo || next >= hi || Abs( next - u ) > 0.5*previous )
+               next = 0.5*(lo + hi);
+            previous = Abs( next - u );
+            u = next;
+            if ( previous < 1e-13 || hi - lo < 1e-13 )
+               break;
+         }
+         return u;
+      }
+
+   private:
+
+      // Residual within which the former bisection solver stopped
+      static constexpr double Tolerance = 0.0001;
+
+      double m_median;
+      double m_b;
+      double m_asinhB;
+      double m_fLow;
+      double m_fHigh;
+
+      /*
+       * f(u), and optionally df/du.
+       */
+      double Evaluate( double u, double* derivative = nullptr ) const
       {
-         const DImage& img = static_cast<const DImage&>( *source );
-         target.Assign( img );
+         double D = Pow10( u );
+         double x = D*m_median + m_b;
+         double numerator = ArcSinh( x ) - m_asinhB;
+         double normFactor = ArcSinh( D + m_b ) - m_asinhB;
+         if ( normFactor == 0 )
+            normFactor = 1e-6;
+         double f = numerator/normFactor;
+         if ( derivative != nullptr )
+         {
+            // d/dD asinh(D*m + b) = m/sqrt(x^2 + 1), and dD/du = D*ln(10)
+            double dNumerator = m_median/Sqrt( x*x + 1 );
+            double dNormFactor = 1/Sqrt( (D + m_b)*(D + m_b) + 1 );
+            *derivative = (dNumerator - f*dNormFactor)/normFactor * D*Ln10();
+         }
+         return f;
       }
-      
+   };
+
+   /*
+    * Distribution of a per-pixel value, see MeasureDistribution().
+    */
+   struct Distribution
+   {
+      double median  = 0;
+      double mean    = 0;
+      double stdDev  = 0;  // sample standard deviation (n-1), as ImageStatistics
+      double minimum = 0;
+      double maximum = 0;
+   };
+
+   /*
+    * Exact median of valueAt(i) over the pixels of image, in two streamed
+    * passes without materializing the values: a 65536-bin histogram over
+    * [0,1] locates the bins holding the central ranks, then only the values
+    * in those bins are collected and selected exactly. Out-of-range values
+    * go to the extreme bins, which keeps the result exact for any data.
+    *
+    * With Moments, the first pass also accumulates the extremes, mean and
+    * standard deviation. Row sums are taken relative to the first value of
+    * each row, stored by row, and combined in row order with the parallel
+    * variance formula once the pass is complete, so the result does not
+    * depend on the number of threads or on the order in which they finish.
+    *
+    * Rows are scanned in chunks of about four million pixels, so the
+    * monitor is updated (and aborts are honored) regularly.
+    */
+   template <bool Moments, class F>
+   Distribution MeasureDistribution( const Image& image, F valueAt, StatusMonitor* monitor )
+   {
+      Distribution d;
+      const size_type N = image.NumberOfPixels();
+      if ( N == 0 )
+         return d;
+
+      const int bins = 65536;
+      auto binOf = [=]( float v ) -> int
+      {
+         return (v > 0) ? ((v < 1) ? Min( int( v * bins ), bins - 1 ) : bins - 1) : 0;
+      };
+
+      const int width = image.Width();
+      const int height = image.Height();
+      const int chunkRows = Max( 1, int( (size_type( 1 ) << 22)/size_type( width ) ) );
+      const int maxThreads = VeraLuxParallel::MaxThreads( image );
+      Mutex mutex;
+
+      auto forEachChunk = [&]( auto kernel )
+      {
+         for ( int y0 = 0; y0 < height; y0 += chunkRows )
+         {
+            const int y1 = Min( height, y0 + chunkRows );
+            VeraLuxParallel::ForEachRowBand( y1 - y0, maxThreads,
+               [&]( int startRow, int endRow )
+               {
+                  kernel( size_type( y0 + startRow )*width, size_type( y0 + endRow )*width );
+               } );
+            if ( monitor != nullptr )
+               *monitor += size_type( y1 - y0 );
+         }
+      };
+
+      // Moments of one row, merged in row order after pass 1
+      struct RowMoments
+      {
+         double mean = 0;
+         double m2 = 0;
+         float  minimum = 0;
+         float  maximum = 0;
+      };
+      std::vector<RowMoments> rows( Moments ? height : 0 );
+
+      // Pass 1: histogram, and moments of the values. Integer bin counts
+      // are exact in any order, so only they are merged under the lock.
+      std::vector<uint64> hist( bins, 0 );
+      forEachChunk(
+         [&]( size_type begin, size_type end )
+         {
+            std::vector<uint32> bandHist( bins, 0 );
+            for ( size_type rowBegin = begin; rowBegin < end; rowBegin += width )
+            {
+               const size_type rowEnd = rowBegin + width;
+               double shift = 0, s1 = 0, s2 = 0;
+               float rowMin = 0, rowMax = 0;
+               if ( Moments )
+               {
+                  rowMin = rowMax = valueAt( rowBegin );
+                  shift = rowMin;
+               }
+               for ( size_type i = rowBegin; i < rowEnd; ++i )
+               {
+                  float v = valueAt( i );
+                  ++bandHist[binOf( v )];
+                  if ( Moments )
+                  {
+                     double x = v - shift;
+                     s1 += x;
+                     s2 += x*x;
+                     if ( v < rowMin )
+                        rowMin = v;
+                     else if ( v > rowMax )
+                        rowMax = v;
+                  }
+               }
+               if ( Moments )
+               {
+                  RowMoments& r = rows[rowBegin/width];
+                  r.mean = shift + s1/width;
+                  r.m2 = Max( 0.0, s2 - s1*s1/width );
+                  r.minimum = rowMin;
+                  r.maximum = rowMax;
+               }
+            }
+
+            volatile AutoLock lock( mutex );
+            for ( int k = 0; k < bins; ++k )
+               hist[k] += bandHist[k];
+         } );
+
+      if ( Moments )
+      {
+         const double n = width;
+         double count = 0, mean = 0, m2 = 0;
+         double minimum = std::numeric_limits<double>::max();
+         double maximum = -std::numeric_limits<double>::max();
+         for ( const RowMoments& r : rows )
+         {
+            double delta = r.mean - mean;
+            double total = count + n;
+            mean += delta*n/total;
+            m2 += r.m2 + delta*delta*count*n/total;
+            count = total;
+            minimum = Min( minimum, double( r.minimum ) );
+            maximum = Max( maximum, double( r.maximum ) );
+         }
+         d.mean = mean;
+         d.stdDev = (N > 1) ? Sqrt( m2/(N - 1) ) : 0.0;
+         d.minimum = minimum;
+         d.maximum = maximum;
+      }
+
+      // Bins holding the central ranks; the median of an even count is the
+      // mean of both
+      const size_type k1 = (N - 1)/2;
+      const size_type k2 = N/2;
+      int lowBin = 0, highBin = 0;
+      size_type below = 0;
+      for ( size_type cumulative = 0; highBin < bins; ++highBin )
+      {
+         if ( cumulative + hist[highBin] > k1 && cumulative <= k1 )
+         {
+            lowBin = highBin;
+            below = cumulative;
+         }
+         cumulative += hist[highBin];
+         if ( cumulative > k2 )
+            break;
+      }
+
+      // Pass 2: exact selection among the values of those bins
+      size_type central = 0;
+      for ( int k = lowBin; k <= highBin; ++k )
+         central += hist[k];
+      std::vector<float> values;
+      values.reserve( central );
+      forEachChunk(
+         [&]( size_type begin, size_type end )
+         {
+            std::vector<float> band;
+            for ( size_type i = begin; i < end; ++i )
+            {
+               float v = valueAt( i );
+               int k = binOf( v );
+               if ( k >= lowBin && k <= highBin )
+                  band.push_back( v );
+            }
+
+            volatile AutoLock lock( mutex );
+            values.insert( values.end(), band.begin(), band.end() );
+         } );
+
+      double m1 = VeraLuxStatistics::OrderStatistic( values, k1 - below );
+      double mk2 = (k2 == k1) ? m1 : VeraLuxStatistics::OrderStatistic( values, k2 - below );
+      d.median = 0.5*(m1 + mk2);
+      return d;
+   }
+
+   /*
+    * ApplyLinearScaling() that also returns the median of the luminance of
+    * the scaled image, as ComputeWeightedLuma() would produce it.
+    *
+    * Luminance is linear in the channels and the scaling is affine, so the
+    * median follows analytically from the median of the luminance before
+    * scaling. Only pixels with a channel clipped to [0,1] break the affine
+    * relation. They only matter if they cross the median, which is checked
+    * during the scaling pass by computing their scaled luminance. If any
+    * pixel crosses, the median is measured on the scaled channels instead,
+    * computing the luminance on the fly. Without crossings the result is
+    * exact up to float rounding, or for an even pixel count, up to half the
+    * gap between the two central ranks.
+    */
+   double ScaleWithLuminanceMedian( Image& target, const Image& luma, double medianL,
+                                    const SensorProfile& profile, double floor, double scale )
+   {
+      const double PEDESTAL = 0.001;
+      const bool rgb = target.NumberOfChannels() == 3;
+      const double rw = rgb ? profile.weights.r : 1.0;
+      const double gw = rgb ? profile.weights.g : 0.0;
+      const double bw = rgb ? profile.weights.b : 0.0;
+      const double weightSum = rw + gw + bw;
+      const LuminanceWeights weights( rgb ? profile.weights : SensorWeights( 1, 0, 0 ) );
+      const double median = Range( (medianL - floor*weightSum)*scale + PEDESTAL*weightSum, 0.0, 1.0 );
+
+      if ( !rgb )
+      {
+         // Monotonic: pixels cross the median only if it is clipped itself
+         ApplyLinearScaling( target, floor, scale );
+         if ( median > 0 && median < 1 )
+            return median;
+         const float* v = target[0];
+         return MeasureDistribution<false>( target, [=]( size_type i ) { return v[i]; }, nullptr ).median;
+      }
+
+      float* r = target[0];
+      float* g = target[1];
+      float* b = target[2];
+      const float* l = luma[0];
+      bool crossed = false;
+      Mutex mutex;
+      VeraLuxParallel::ForEachPixelBand( target,
+         [&]( size_type begin, size_type end )
+         {
+            bool bandCrossed = false;
+            for ( size_type i = begin; i < end; ++i )
+            {
+               double sr = (double( r[i] ) - floor) * scale + PEDESTAL;
+               double sg = (double( g[i] ) - floor) * scale + PEDESTAL;
+               double sb = (double( b[i] ) - floor) * scale + PEDESTAL;
+               r[i] = float( Max( 0.0, Min( sr, 1.0 ) ) );
+               g[i] = float( Max( 0.0, Min( sg, 1.0 ) ) );
+               b[i] = float( Max( 0.0, Min( sb, 1.0 ) ) );
+               if ( sr < 0 || sr > 1 || sg < 0 || sg > 1 || sb < 0 || sb > 1 )
+               {
+                  float scaled = weights( r[i], g[i], b[i] );
+                  if ( (l[i] < medianL) != (scaled < median) || (l[i] > medianL) != (scaled > median) )
+                     bandCrossed = true;
+               }
+            }
+            if ( bandCrossed )
+            {
+               volatile AutoLock lock( mutex );
+               crossed = true;
+            }
+         } );
+
+      if ( !crossed )
+         return median;
+
+      return MeasureDistribution<false>( target,
+         [=]( size_type i ) -> float
+         {
+            return weights( r[i], g[i], b[i] );
+         }, nullptr ).median;
+   }
+} // namespace
+
+void VeraLuxEngine::NormalizeInput( Image& target, const ImageVariant& source )
+{
+   NormalizeInput( target, source, Rect( 0 ), NormalizationDivisor( source ) );
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::NormalizationDivisor( double maximum, bool floatSample, int bitsPerSample )
+{
+   if ( floatSample )
+   {
       // Check if data is in [0,1] or needs scaling
-      double maxVal = target.MaximumSampleValue();
-      if ( maxVal > 1.1 )
+      if ( maximum > 1.1 )
       {
          // Assume 16-bit range
-         if ( maxVal < 100000.0 )
-            target /= 65535.0;
-         else
-            target /= 4294967295.0;
+         if ( maximum < 100000.0 )
+            return 65535.0;
+         return 4294967295.0;
       }
+      return 1.0;
    }
-   else if ( source.IsComplexSample() )
+
+   /*
+    * Integer samples are scaled by the range of their sample type once, as
+    * data / range in the Python reference.
+    */
+   switch ( bitsPerSample )
    {
+   case 8:  return 255.0;
+   case 16: return 65535.0;
+   default: return 4294967295.0;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::NormalizationDivisor( const ImageVariant& source )
+{
+   double maximum = 0;
+   if ( source.IsFloatSample() )
+      maximum = (source.BitsPerSample() == 64) ?
+         static_cast<const DImage&>( *source ).MaximumSampleValue() :
+         static_cast<const Image&>( *source ).MaximumSampleValue();
+
+   return NormalizationDivisor( maximum, source.IsFloatSample(), source.BitsPerSample() );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::NormalizeInput( Image& target, const ImageVariant& source, const Rect& rect, double divisor )
+{
+   // Handle different input formats
+   if ( source.IsComplexSample() )
       throw Error( "Complex images are not supported." );
+
+   // Native samples are read, scaled and sanitized in a single pass
+   if ( source.IsFloatSample() )
+   {
+      if ( source.BitsPerSample() == 32 )
+         NormalizeSamples( target, static_cast<const Image&>( *source ), rect, divisor );
+      else if ( source.BitsPerSample() == 64 )
+         NormalizeSamples( target, static_cast<const DImage&>( *source ), rect, divisor );
    }
    else // Integer samples
    {
       if ( source.BitsPerSample() == 8 )
-      {
-         const UInt8Image& img = static_cast<const UInt8Image&>( *source );
-         target.Assign( img );
-         target /= 255.0;
-      }
+         NormalizeSamples( target, static_cast<const UInt8Image&>( *source ), rect, divisor );
       else if ( source.BitsPerSample() == 16 )
-      {
-         const UInt16Image& img = static_cast<const UInt16Image&>( *source );
-         target.Assign( img );
-         target /= 65535.0;
-      }
+         NormalizeSamples( target, static_cast<const UInt16Image&>( *source ), rect, divisor );
       else if ( source.BitsPerSample() == 32 )
-      {
-         const UInt32Image& img = static_cast<const UInt32Image&>( *source );
-         target.Assign( img );
-         target /= 4294967295.0;
-      }
+         NormalizeSamples( target, static_cast<const UInt32Image&>( *source ), rect, divisor );
    }
-   
-   // Sanitize NaN/Inf
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::NormalizeInPlace( Image& image )
+{
+   /*
+    * NaN, Inf and negative samples become zero whatever the divisor, so they
+    * are sanitized while the maximum is measured. The maximum includes +Inf,
+    * as MaximumSampleValue() does.
+    */
+   double maximum = 0;
+   Mutex mutex;
+   const int nChannels = image.NumberOfChannels();
+   VeraLuxParallel::ForEachPixelBand( image,
+      [&]( size_type begin, size_type end )
+      {
+         float bandMax = 0;
+         for ( int c = 0; c < nChannels; ++c )
+         {
+            float* data = image[c];
+            for ( size_type i = begin; i < end; ++i )
+            {
+               float v = data[i];
+               if ( v > bandMax )
+                  bandMax = v;
+               if ( !IsFinite( v ) || v < 0 )
+                  data[i] = 0;
+            }
+         }
+
+         volatile AutoLock lock( mutex );
+         maximum = Max( maximum, double( bandMax ) );
+      } );
+
+   // Scaling and truncation once the range is known
+   const double divisor = NormalizationDivisor( maximum, true/*floatSample*/, 32 );
+   if ( divisor != 1.0 || maximum > 1 )
+      SanitizeUnitRange( image, divisor );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::StoreOutput( ImageVariant& target, const Image& source, int startRow )
+{
+   if ( target.IsComplexSample() )
+      throw Error( "Complex images are not supported." );
+
+   if ( target.IsFloatSample() )
    {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
+      if ( target.BitsPerSample() == 32 )
       {
-         if ( !IsFinite( *i ) || *i < 0 )
-            *i = 0;
+         Image& image = static_cast<Image&>( *target );
+         if ( &image != &source || startRow != 0 )
+            StoreConverted( image, source, startRow );
       }
+      else if ( target.BitsPerSample() == 64 )
+         StoreConverted( static_cast<DImage&>( *target ), source, startRow );
+   }
+   else
+   {
+      if ( target.BitsPerSample() == 8 )
+         StoreConverted( static_cast<UInt8Image&>( *target ), source, startRow );
+      else if ( target.BitsPerSample() == 16 )
+         StoreConverted( static_cast<UInt16Image&>( *target ), source, startRow );
+      else if ( target.BitsPerSample() == 32 )
+         StoreConverted( static_cast<UInt32Image&>( *target ), source, startRow );
    }
-   
-   target.Truncate( 0.0, 1.0 );
 }
 
 // ----------------------------------------------------------------------------
 
 double VeraLuxEngine::CalculateAnchor( const Image& img )
+{
+   return CalculateAnchor( img, AnchorStride( img.NumberOfPixels(), img.NumberOfChannels() ) );
+}
+
+// ----------------------------------------------------------------------------
+
+size_type VeraLuxEngine::AnchorStride( size_type numberOfPixels, int numberOfChannels )
 {
    /*
     * Python reference:
     *   stride = max(1, data_norm.size // 500000)   # RGB
+    *   stride = max(1, data_norm.size // 200000)   # mono
+    */
+   const size_type totalSize = numberOfPixels * size_type( Max( 1, numberOfChannels ) );
+   return Max( size_type( 1 ), totalSize/((numberOfChannels == 3) ? 500000 : 200000) );
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::CalculateAnchor( const Image& img, size_type stride )
+{
+   /*
+    * Python reference:
     *   floor  = np.percentile(channel.flatten()[::stride], 0.5)
-    *   anchor = max(0.0, min(floors) - 0.00025)
+    *   anchor = max(0.0, min(floors) - 0.00025)   # RGB
     *
-    *   stride = max(1, data_norm.size // 200000)   # mono
     *   floor  = np.percentile(data_norm.flatten()[::stride], 0.5)
-    *   anchor = max(0.0, floor - 0.00025)
+    *   anchor = max(0.0, floor - 0.00025)         # mono
     */
    const int nChannels = img.NumberOfChannels();
    const size_t nPixels = img.NumberOfPixels();
-   const size_t totalSize = nPixels * size_t( Max( 1, nChannels ) );
 
    if ( nChannels == 3 )
    {
-      const size_t stride = Max( size_t( 1 ), totalSize / 500000 );
       double minFloor = 1.0;
 
       for ( int c = 0; c < 3; ++c )
@@ -210,70 +923,61 @@ double VeraLuxEngine::CalculateAnchor( const Image& img )
    }
 
    // Mono (and any non-RGB): treat as single-channel, as in Python's mono branches.
-   const size_t stride = Max( size_t( 1 ), totalSize / 200000 );
    const float* ch = img[0];
    const double floor = SubsamplePercentile( ch, nPixels, stride, 0.5 );
    return Max( 0.0, floor - 0.00025 );
 }
-
-// ----------------------------------------------------------------------------
-
-double VeraLuxEngine::CalculateAnchorAdaptive( const Image& img, 
-                                                 const SensorProfile& profile )
-{
-   // Build luminance sample for histogram analysis
-   Image luma;
-   
-   if ( img.NumberOfChannels() == 3 )
-   {
-      // Extract sensor-weighted luminance
-      luma.AllocateData( img.Width(), img.Height(), 1 );
-      
-      const float* r = img[0];
-      const float* g = img[1];
-      const float* b = img[2];
-      float* l = luma[0];
-      size_t N = img.NumberOfPixels();
-      
-      double rw = profile.rWeight;
-      double gw = profile.gWeight;
-      double bw = profile.bWeight;
-      
-      for ( size_t i = 0; i < N; ++i )
-         l[i] = rw * r[i] + gw * g[i] + bw * b[i];
-   }
-   else
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::CalculateAnchorAdaptive( const Image& img, 
+                                                 const SensorProfile& profile )
+{
+   /*
+    * Sensor-weighted luminance (or the mono channel) is only evaluated at
+    * the subsampled pixels and accumulated into per-band histograms, which
+    * are merged at the end. Counts are integers, so the merged histogram is
+    * independent of the number of threads.
+    */
+   const bool rgb = img.NumberOfChannels() == 3;
+   const float* r = img[0];
+   const float* g = rgb ? img[1] : nullptr;
+   const float* b = rgb ? img[2] : nullptr;
+   const LuminanceWeights weights( profile.weights );
+
+   auto lumaAt = [=]( size_t i ) -> float
    {
-      // Mono: use directly
-      luma.Assign( img );
-   }
-   
+      float v = rgb ? weights( r[i], g[i], b[i] ) : r[i];
+      // Keep within histogram range [0,1] (Python uses range=(0,1)).
+      return Max( 0.0f, Min( v, 1.0f ) );
+   };
+
    // Build histogram (65536 bins for precision) on a subsample (Python stride logic).
    const int bins = 65536;
    std::vector<uint64> hist( bins, 0 );
 
-   const float* data = luma[0];
-   const size_t N = luma.NumberOfPixels();
+   const size_t N = img.NumberOfPixels();
    const size_t stride = Max( size_t( 1 ), N / 2000000 );
 
-   // Keep the subsample for percentile fallback (matches Python).
-   std::vector<float> sample;
-   sample.reserve( N/stride + 1 );
-
-   for ( size_t i = 0; i < N; i += stride )
-   {
-      float v = data[i];
-      // Keep within histogram range [0,1] (Python uses range=(0,1)).
-      v = Max( 0.0f, Min( v, 1.0f ) );
-      sample.push_back( v );
+   Mutex mutex;
+   VeraLuxParallel::ForEachPixelBand( img,
+      [&]( size_type begin, size_type end )
+      {
+         std::vector<uint32> bandHist( bins, 0 );
+         for ( size_t i = (begin + stride - 1)/stride*stride; i < end; i += stride )
+         {
+            // Avoid overflow bin==bins for v==1 by nudging into last bin.
+            float vv = Min( lumaAt( i ), 0.999999f );
+            int bin = int( vv * bins );
+            if ( bin < 0 ) bin = 0;
+            if ( bin >= bins ) bin = bins - 1;
+            bandHist[bin]++;
+         }
 
-      // Avoid overflow bin==bins for v==1 by nudging into last bin.
-      float vv = Min( v, 0.999999f );
-      int bin = int( vv * bins );
-      if ( bin < 0 ) bin = 0;
-      if ( bin >= bins ) bin = bins - 1;
-      hist[bin]++;
-   }
+         volatile AutoLock lock( mutex );
+         for ( int k = 0; k < bins; ++k )
+            hist[k] += bandHist[k];
+      } );
 
    // Smooth histogram exactly like NumPy convolution with zero padding.
    std::vector<double> histSmooth;
@@ -318,7 +1022,11 @@ double VeraLuxEngine::CalculateAnchorAdaptive( const Image& img,
    }
    else
    {
-      // Fallback: np.percentile(sample, 0.5)
+      // Fallback: np.percentile(sample, 0.5), over the same subsample.
+      std::vector<float> sample;
+      sample.reserve( N/stride + 1 );
+      for ( size_t i = 0; i < N; i += stride )
+         sample.push_back( lumaAt( i ) );
       anchor = PercentileInPlace( sample, 0.5 );
    }
 
@@ -334,30 +1042,33 @@ void VeraLuxEngine::ExtractLuminance( Image& luma, const Image& rgb,
    {
       // RGB: extract weighted luminance
       luma.AllocateData( rgb.Width(), rgb.Height(), 1 );
+      InheritParallelism( luma, rgb );
       
       const float* r = rgb[0];
       const float* g = rgb[1];
       const float* b = rgb[2];
       float* l = luma[0];
-      size_t N = rgb.NumberOfPixels();
       
-      double rw = profile.rWeight;
-      double gw = profile.gWeight;
-      double bw = profile.bWeight;
+      const LuminanceWeights weights( profile.weights );
       float anchorF = float( anchor );
       
-      for ( size_t i = 0; i < N; ++i )
-      {
-         float ra = Max( 0.0f, r[i] - anchorF );
-         float ga = Max( 0.0f, g[i] - anchorF );
-         float ba = Max( 0.0f, b[i] - anchorF );
-         l[i] = rw * ra + gw * ga + bw * ba;
-      }
+      VeraLuxParallel::ForEachPixelBand( rgb,
+         [&]( size_type begin, size_type end )
+         {
+            for ( size_type i = begin; i < end; ++i )
+            {
+               float ra = Max( 0.0f, r[i] - anchorF );
+               float ga = Max( 0.0f, g[i] - anchorF );
+               float ba = Max( 0.0f, b[i] - anchorF );
+               l[i] = weights( ra, ga, ba );
+            }
+         } );
    }
    else
    {
       // Mono: just subtract anchor
       luma.Assign( rgb );
+      InheritParallelism( luma, rgb );
       luma.Truncate( float( anchor ), 1.0f );
       luma -= anchor;
    }
@@ -365,111 +1076,141 @@ void VeraLuxEngine::ExtractLuminance( Image& luma, const Image& rgb,
 
 // ----------------------------------------------------------------------------
 
-void VeraLuxEngine::HyperbolicStretch( Image& target, double D, double b, double SP )
+void VeraLuxEngine::SubtractAnchor( Image& anchored, const Image& rgb, double anchor )
+{
+   if ( rgb.NumberOfChannels() == 3 )
+   {
+      anchored.AllocateData( rgb.Width(), rgb.Height(), 3 );
+      InheritParallelism( anchored, rgb );
+      
+      float anchorF = float( anchor );
+      VeraLuxParallel::ForEachPixelBand( rgb,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < 3; ++c )
+            {
+               const float* src = rgb[c];
+               float* dst = anchored[c];
+               for ( size_type i = begin; i < end; ++i )
+                  dst[i] = Max( 0.0f, src[i] - anchorF );
+            }
+         } );
+   }
+   else
+   {
+      anchored.Assign( rgb );
+      InheritParallelism( anchored, rgb );
+      anchored.Truncate( float( anchor ), 1.0f );
+      anchored -= anchor;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::HyperbolicStretch( Image& target, double D, double b, double SP,
+                                        TransferEvaluation::value_type transfer )
 {
    // arcsinh(D*(x-SP)+b) normalized
-   D = Max( D, 0.1 );
-   b = Max( b, 0.1 );
-   
-   double term2 = ArcSinh( b );
-   double normFactor = ArcSinh( D * (1.0 - SP) + b ) - term2;
-   if ( normFactor == 0 )
-      normFactor = 1e-6;
+   const StretchCoefficients curve( D, b, SP );
    
-   // Apply to all channels
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
+   if ( transfer == TransferEvaluation::LookupTable )
    {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
-      {
-         double val = *i;
-         double term1 = ArcSinh( D * (val - SP) + b );
-         *i = float( (term1 - term2) / normFactor );
-      }
+      ApplyLUT( target, *VeraLuxTransferLUT::Stretch( curve ) );
+      return;
    }
    
-   target.Truncate( 0.0, 1.0 );
+   // Apply to all channels
+   const int nChannels = target.NumberOfChannels();
+   VeraLuxParallel::ForEachPixelBand( target,
+      [&]( size_type begin, size_type end )
+      {
+         for ( int c = 0; c < nChannels; ++c )
+            VeraLuxSIMD::Stretch( target[c] + begin, end - begin, curve );
+      } );
 }
 
 // ----------------------------------------------------------------------------
 
 double VeraLuxEngine::SolveLogD( const Image& luma, double targetMedian, double bVal )
 {
-   // Binary search for Log D
-   ImageStatistics stats;
-   stats.DisableVariance();
-   stats.DisableExtremes();
-   stats.DisableMean();
-   stats << luma;
-   
-   double medianIn = stats.Median();
-   if ( medianIn < 1e-9 )
-      return 2.0;
-   
-   double lowLog = 0.0;
-   double highLog = 7.0;
-   double bestLogD = 2.0;
-   
-   for ( int iter = 0; iter < 40; ++iter )
+   const float* l = luma[0];
+   double median = MeasureDistribution<false>( luma, [=]( size_type i ) { return l[i]; }, nullptr ).median;
+   return SolveLogD( median, targetMedian, bVal );
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::SolveLogD( double medianIn, double targetMedian, double bVal )
+{
+   return LogDSolver( medianIn, bVal ).Solve( targetMedian );
+}
+
+// ----------------------------------------------------------------------------
+
+std::vector<double> VeraLuxEngine::SolveLogD( double medianIn, const std::vector<double>& targetMedians, double bVal )
+{
+   // Bracket values are shared by all targets
+   LogDSolver solver( medianIn, bVal );
+   std::vector<double> logD( targetMedians.size() );
+   for ( size_type i = 0; i < targetMedians.size(); ++i )
+      logD[i] = solver.Solve( targetMedians[i] );
+   return logD;
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::LuminanceMedian( const Image& rgb, double anchor, const SensorProfile& profile,
+                                       StatusMonitor* monitor )
+{
+   const bool color = rgb.NumberOfChannels() == 3;
+   const float anchorF = float( anchor );
+   const LuminanceWeights weights( profile.weights );
+   const float* r = rgb[0];
+   const float* g = color ? rgb[1] : nullptr;
+   const float* b = color ? rgb[2] : nullptr;
+
+   // Same arithmetic as ExtractLuminance()
+   auto lumaAt = [=]( size_type i ) -> float
    {
-      double midLog = (lowLog + highLog) / 2.0;
-      double midD = Pow10( midLog );
-      
-      // Simulate stretch on median value
-      double term1 = ArcSinh( midD * medianIn + bVal );
-      double term2 = ArcSinh( bVal );
-      double normFactor = ArcSinh( midD + bVal ) - term2;
-      if ( normFactor == 0 )
-         normFactor = 1e-6;
-      
-      double testVal = (term1 - term2) / normFactor;
-      
-      if ( Abs( testVal - targetMedian ) < 0.0001 )
+      if ( color )
       {
-         bestLogD = midLog;
-         break;
+         float ra = Max( 0.0f, r[i] - anchorF );
+         float ga = Max( 0.0f, g[i] - anchorF );
+         float ba = Max( 0.0f, b[i] - anchorF );
+         return weights( ra, ga, ba );
       }
-      
-      if ( testVal < targetMedian )
-         lowLog = midLog;
-      else
-         highLog = midLog;
-   }
-   
-   return bestLogD;
+      return Range( r[i], anchorF, 1.0f ) - anchorF;
+   };
+
+   return MeasureDistribution<false>( rgb, lumaAt, monitor ).median;
 }
 
 // ----------------------------------------------------------------------------
 
-void VeraLuxEngine::ApplyMTF( Image& target, double m )
+void VeraLuxEngine::ApplyMTF( Image& target, double m, TransferEvaluation::value_type transfer )
 {
-   // Midtone transfer function
-   double m1 = m - 1.0;
-   double m2 = 2.0 * m - 1.0;
-   
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
+   if ( transfer == TransferEvaluation::LookupTable )
    {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
-      {
-         double v = *i;
-         double term1 = m1 * v;
-         double term2 = m2 * v - m;
-         
-         if ( term2 != 0 )
-            *i = float( term1 / term2 );
-         else
-            *i = 0;
-      }
+      ApplyLUT( target, *VeraLuxTransferLUT::MTF( m ) );
+      return;
    }
    
-   target.Truncate( 0.0, 1.0 );
+   // Midtone transfer function
+   const int nChannels = target.NumberOfChannels();
+   VeraLuxParallel::ForEachPixelBand( target,
+      [&]( size_type begin, size_type end )
+      {
+         for ( int c = 0; c < nChannels; ++c )
+            VeraLuxSIMD::MTF( target[c] + begin, end - begin, m );
+      } );
 }
 
 // ----------------------------------------------------------------------------
 
 void VeraLuxEngine::ApplyLinearExpansion( Image& target, float factor,
-                                           LinearExpansionStats* diagnostics )
+                                           LinearExpansionStats* diagnostics,
+                                           StatisticsEstimator::value_type estimator,
+                                           const Image* peak )
 {
    if ( factor <= 0.001f )
    {
@@ -485,86 +1226,80 @@ void VeraLuxEngine::ApplyLinearExpansion( Image& target, float factor,
    
    factor = Max( 0.0f, Min( factor, 1.0f ) );
    
-   // Analyze maximum (Smart Max logic for hot pixel rejection)
-   double absMax = target.MaximumSampleValue();
-   bool useAbsoluteMax = false;
+   // Smart Max: brightest star core, skipping brighter hot pixels
+   double absMax = VeraLuxSmartMax::PhysicalMaximum( (peak != nullptr && !peak->IsEmpty()) ? *peak : target );
+   bool useAbsoluteMax = absMax > 0.001;
    
-   if ( absMax > 0.001 )
+   // Calculate bounds
+   double low, high;
+   ElapsedTime T;
+   
+   if ( estimator == StatisticsEstimator::MAD )
    {
-      // Find max pixel location
-      Point maxPos;
-      target.LocateMaximumSampleValue( maxPos );
+      // Fast MAD approximation (10-100x faster, < 0.001 typical error)
+      ImageStatistics stats;
+      stats.DisableVariance();
+      stats.DisableExtremes();
+      stats.DisableMean();
+      stats << target;
       
-      // Check 3x3 neighborhood
-      int y0 = Max( 0, maxPos.y - 1 );
-      int y1 = Min( int( target.Height() ), maxPos.y + 2 );
-      int x0 = Max( 0, maxPos.x - 1 );
-      int x1 = Min( int( target.Width() ), maxPos.x + 2 );
-      
-      double maxNeighbor = 0;
-      for ( int y = y0; y < y1; ++y )
-      {
-         for ( int x = x0; x < x1; ++x )
-         {
-            double val = target( x, y );
-            if ( val < absMax )
-               maxNeighbor = Max( maxNeighbor, val );
-         }
-      }
+      // Low bound: MAD approximation of 0.001 percentile
+      low = Max( 0.0, stats.Median() - 3.5 * stats.MAD() );
       
-      // If bright neighbors exist, it's a real star
-      if ( maxNeighbor >= absMax * 0.20 )
-         useAbsoluteMax = true;
+      // High bound: use absolute max or MAD approximation of 99.999 percentile
+      if ( useAbsoluteMax )
+         high = absMax;
+      else
+         high = Min( 1.0, stats.Median() + 4.0 * stats.MAD() );
    }
-   
-   // Calculate bounds
-   double low, high;
-   
-#ifdef HMS_USE_MAD
-   // Fast MAD approximation (10-100x faster, < 0.001 typical error)
-   ImageStatistics stats;
-   stats.DisableVariance();
-   stats.DisableExtremes();
-   stats.DisableMean();
-   stats << target;
-   
-   // Low bound: MAD approximation of 0.001 percentile
-   low = Max( 0.0, stats.Median() - 3.5 * stats.MAD() );
-   
-   // High bound: use absolute max or MAD approximation of 99.999 percentile
-   if ( useAbsoluteMax )
-      high = absMax;
-   else
-      high = Min( 1.0, stats.Median() + 4.0 * stats.MAD() );
-#else
-   // Exact percentiles (matches Python implementation exactly)
-   // Build subsample for percentile calculation (matching Python stride logic)
-   const size_t stride = Max( size_t( 1 ), target.NumberOfPixels() / 500000 );
-   std::vector<float> sample;
-   sample.reserve( target.NumberOfPixels() * target.NumberOfChannels() / stride + 1 );
-   
-   // Collect all channels into sample (matching Python behavior)
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
+   else if ( estimator == StatisticsEstimator::Histogram )
    {
-      const float* ch = target[c];
-      size_t N = target.NumberOfPixels();
-      for ( size_t i = 0; i < N; i += stride )
-         sample.push_back( ch[i] );
+      // Same subsample as the exact estimator, accumulated without storage
+      const size_t stride = Max( size_t( 1 ), target.NumberOfPixels() / 500000 );
+      StreamingHistogram H;
+      for ( int c = 0; c < target.NumberOfChannels(); ++c )
+         H.Add( target[c], target.NumberOfPixels(), stride );
+      
+      low = H.Percentile( 0.001 );
+      high = useAbsoluteMax ? absMax : H.Percentile( 99.999 );
    }
-   
-   // Low bound: exact 0.001 percentile
-   low = PercentileInPlace( sample, 0.001 );
-   
-   // High bound: use absolute max or exact 99.999 percentile
-   if ( useAbsoluteMax )
-      high = absMax;
    else
    {
-      // Reuse sample for high percentile
-      std::sort( sample.begin(), sample.end() );
-      high = PercentileFromSorted( sample, 99.999 );
+      // Exact percentiles (matches Python implementation exactly)
+      // Build subsample for percentile calculation (matching Python stride logic)
+      const size_t stride = Max( size_t( 1 ), target.NumberOfPixels() / 500000 );
+      std::vector<float> sample;
+      sample.reserve( target.NumberOfPixels() * target.NumberOfChannels() / stride + 1 );
+      
+      // Collect all channels into sample (matching Python behavior)
+      for ( int c = 0; c < target.NumberOfChannels(); ++c )
+      {
+         const float* ch = target[c];
+         size_t N = target.NumberOfPixels();
+         for ( size_t i = 0; i < N; i += stride )
+            sample.push_back( ch[i] );
+      }
+      
+      // Low bound: exact 0.001 percentile
+      // High bound: use absolute max or exact 99.999 percentile
+      if ( useAbsoluteMax )
+      {
+         low = PercentileInPlace( sample, 0.001 );
+         high = absMax;
+      }
+      else
+      {
+         // Both bounds from a single selection pass over the sample
+         const double pct[] = { 0.001, 99.999 };
+         double bounds[ 2 ];
+         VeraLuxStatistics::Percentiles( sample, pct, bounds, 2 );
+         low = bounds[0];
+         high = bounds[1];
+      }
    }
-#endif
+   
+   if ( diagnostics )
+      diagnostics->estimatorTime = T();
    
    if ( high <= low )
    {
@@ -583,16 +1318,26 @@ void VeraLuxEngine::ApplyLinearExpansion( Image& target, float factor,
    {
       size_t totalPixels = target.NumberOfPixels() * target.NumberOfChannels();
       size_t countLow = 0, countHigh = 0;
+      Mutex mutex;
       
-      for ( int c = 0; c < target.NumberOfChannels(); ++c )
-      {
-         Image::const_sample_iterator i( target, c );
-         for ( ; i; ++i )
+      VeraLuxParallel::ForEachPixelBand( target,
+         [&]( size_type begin, size_type end )
          {
-            if ( *i <= low ) countLow++;
-            if ( *i >= high ) countHigh++;
-         }
-      }
+            size_t bandLow = 0, bandHigh = 0;
+            for ( int c = 0; c < target.NumberOfChannels(); ++c )
+            {
+               const float* data = target[c];
+               for ( size_type i = begin; i < end; ++i )
+               {
+                  if ( data[i] <= low ) bandLow++;
+                  if ( data[i] >= high ) bandHigh++;
+               }
+            }
+            
+            volatile AutoLock lock( mutex );
+            countLow += bandLow;
+            countHigh += bandHigh;
+         } );
       
       diagnostics->pctLow = double( countLow ) * 100.0 / totalPixels;
       diagnostics->pctHigh = double( countHigh ) * 100.0 / totalPixels;
@@ -600,21 +1345,38 @@ void VeraLuxEngine::ApplyLinearExpansion( Image& target, float factor,
       diagnostics->high = high;
    }
    
+   ApplyLinearExpansion( target, factor, low, high );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::ApplyLinearExpansion( Image& target, float factor, double low, double high )
+{
+   if ( factor <= 0.001f || high <= low )
+      return;
+   
+   factor = Max( 0.0f, Min( factor, 1.0f ) );
+   
    // Apply expansion
    double range = high - low;
    float factorInv = 1.0f - factor;
    
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
-   {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
+   const int nChannels = target.NumberOfChannels();
+   VeraLuxParallel::ForEachPixelBand( target,
+      [&]( size_type begin, size_type end )
       {
-         float original = *i;
-         double temp = (double( original ) - low) / range;
-         float normalized = float( Max( 0.0, Min( temp, 1.0 ) ) );
-         *i = original * factorInv + normalized * factor;
-      }
-   }
+         for ( int c = 0; c < nChannels; ++c )
+         {
+            float* data = target[c];
+            for ( size_type i = begin; i < end; ++i )
+            {
+               float original = data[i];
+               double temp = (double( original ) - low) / range;
+               float normalized = float( Max( 0.0, Min( temp, 1.0 ) ) );
+               data[i] = original * factorInv + normalized * factor;
+            }
+         }
+      } );
 }
 
 // ----------------------------------------------------------------------------
@@ -641,14 +1403,12 @@ double VeraLuxEngine::EstimateStarPressure( const Image& luma )
    if ( sample.size() < 100 )
       return 0.0;
    
-   // Sort for percentile calculation
-   std::sort( sample.begin(), sample.end() );
-   
+   // Direct rank selection (same ranks as indexing the sorted sample)
    size_t idx999 = size_t( sample.size() * 0.999 );
    size_t idx9999 = size_t( sample.size() * 0.9999 );
    
-   double p999 = sample[idx999];
-   double p9999 = sample[idx9999];
+   double p999 = VeraLuxStatistics::OrderStatistic( sample, idx999 );
+   double p9999 = VeraLuxStatistics::OrderStatistic( sample, idx9999 );
    
    // Fraction in extreme tail
    size_t countBright = 0;
@@ -656,11 +1416,16 @@ double VeraLuxEngine::EstimateStarPressure( const Image& luma )
       if ( v > p999 )
          countBright++;
    
-   double brightFrac = double( countBright ) / sample.size();
-   
+   return StarPressure( p999, p9999, double( countBright ) / sample.size() );
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxEngine::StarPressure( double p999, double p9999, double brightFraction )
+{
    // Normalize
    double pTerm = Max( 0.0, Min( (p9999 / (p999 + 1e-9) - 1.0) / 4.0, 1.0 ) );
-   double fTerm = Max( 0.0, Min( brightFrac * 200.0, 1.0 ) );
+   double fTerm = Max( 0.0, Min( brightFraction * 200.0, 1.0 ) );
    
    double starPressure = 0.7 * pTerm + 0.3 * fTerm;
    return Max( 0.0, Min( starPressure, 1.0 ) );
@@ -670,106 +1435,98 @@ double VeraLuxEngine::EstimateStarPressure( const Image& luma )
 
 void VeraLuxEngine::AdaptiveOutputScaling( Image& target,
                                              const SensorProfile& profile,
-                                             double targetBg )
+                                             double targetBg,
+                                             StatisticsEstimator::value_type estimator,
+                                             OutputScalingStats* diagnostics,
+                                             TransferEvaluation::value_type transfer,
+                                             const Image* peak,
+                                             VeraLuxWorkspace* workspace )
 {
    // Extract luminance for analysis
-   Image luma;
-   if ( target.NumberOfChannels() == 3 )
-   {
-      luma.AllocateData( target.Width(), target.Height(), 1 );
-      
-      const float* r = target[0];
-      const float* g = target[1];
-      const float* b = target[2];
-      float* l = luma[0];
-      size_t N = target.NumberOfPixels();
-      
-      for ( size_t i = 0; i < N; ++i )
-         l[i] = profile.rWeight * r[i] + profile.gWeight * g[i] + profile.bWeight * b[i];
-   }
-   else
-   {
-      luma.Assign( target );
-   }
+   VeraLuxWorkspace::ImageLease lumaLease( workspace, target.Width(), target.Height(), 1 );
+   Image& luma = *lumaLease;
+   ComputeWeightedLuma( luma, target, profile );
    
-   // Calculate statistics
-   ImageStatistics stats;
-   stats << luma;
+   // Calculate statistics: one streamed pass plus the exact median refinement
+   const float* lumaData = luma[0];
+   const Distribution stats = MeasureDistribution<true>( luma, [=]( size_type i ) { return lumaData[i]; }, nullptr );
    
-   double medianL = stats.Median();
-   double stdL = stats.StdDev();
-   double minL = stats.Minimum();
+   double medianL = stats.median;
+   double stdL = stats.stdDev;
+   double minL = stats.minimum;
    
    // Global floor (2.7 sigma clip)
    double globalFloor = Max( minL, medianL - 2.7 * stdL );
    const double PEDESTAL = 0.001;
    
-   // Analyze max (Smart Max logic)
-   double absMax = stats.Maximum();
+   // Smart Max: brightest star core, skipping brighter hot pixels
+   double absMax = stats.maximum;
    bool validPhysicalMax = true;
    
    if ( absMax > 0.001 )
    {
-      Point maxPos;
-      luma.LocateMaximumSampleValue( maxPos );
-      
-      int y0 = Max( 0, maxPos.y - 1 );
-      int y1 = Min( int( luma.Height() ), maxPos.y + 2 );
-      int x0 = Max( 0, maxPos.x - 1 );
-      int x1 = Min( int( luma.Width() ), maxPos.x + 2 );
-      
-      double maxNeighbor = 0;
-      for ( int y = y0; y < y1; ++y )
-      {
-         for ( int x = x0; x < x1; ++x )
-         {
-            double val = luma( x, y );
-            if ( val < absMax )
-               maxNeighbor = Max( maxNeighbor, val );
-         }
-      }
-      
-      if ( maxNeighbor < absMax * 0.20 )
-         validPhysicalMax = false;
+      Image peakLuma;
+      if ( peak != nullptr && !peak->IsEmpty() )
+         ComputeWeightedLuma( peakLuma, *peak, profile );
+      double physicalMax = VeraLuxSmartMax::PhysicalMaximum( peakLuma.IsEmpty() ? luma : peakLuma );
+      validPhysicalMax = physicalMax > 0;
+      if ( validPhysicalMax )
+         absMax = physicalMax;
    }
    
    // Calculate soft ceiling (99th percentile)
    double softCeil;
+   ElapsedTime T;
    
-#ifdef HMS_USE_MAD
-   // Fast standard deviation approximation (10-100x faster, < 0.005 typical error)
-   softCeil = medianL + 3.0 * stdL;
-   softCeil = Max( globalFloor + 1e-6, Min( softCeil, 1.0 ) );
-#else
-   // Exact 99th percentile (matches Python RTU_SOFT_CEIL_PERCENTILE = 99.0)
-   if ( target.NumberOfChannels() == 3 )
+   if ( estimator == StatisticsEstimator::MAD )
+   {
+      // Fast standard deviation approximation (10-100x faster, < 0.005 typical error)
+      softCeil = medianL + 3.0 * stdL;
+   }
+   else if ( target.NumberOfChannels() == 3 )
    {
       // RGB: calculate per-channel and take max (matching Python)
       size_t N = target.NumberOfPixels();
       const size_t stride = Max( size_t( 1 ), N / 500000 );
       
-      std::vector<float> sampleR, sampleG, sampleB;
-      sampleR.reserve( N / stride + 1 );
-      sampleG.reserve( N / stride + 1 );
-      sampleB.reserve( N / stride + 1 );
-      
-      // Subsample each channel
-      const float* r = target[0];
-      const float* g = target[1];
-      const float* b = target[2];
-      
-      for ( size_t i = 0; i < N; i += stride )
+      if ( estimator == StatisticsEstimator::Histogram )
+      {
+         softCeil = 0;
+         for ( int c = 0; c < 3; ++c )
+         {
+            StreamingHistogram H;
+            H.Add( target[c], N, stride );
+            softCeil = Max( softCeil, H.Percentile( 99.0 ) );
+         }
+      }
+      else
       {
-         sampleR.push_back( r[i] );
-         sampleG.push_back( g[i] );
-         sampleB.push_back( b[i] );
+         // Exact 99th percentile (matches Python RTU_SOFT_CEIL_PERCENTILE = 99.0)
+         VeraLuxWorkspace::SampleLease leaseR( workspace, N / stride + 1 );
+         VeraLuxWorkspace::SampleLease leaseG( workspace, N / stride + 1 );
+         VeraLuxWorkspace::SampleLease leaseB( workspace, N / stride + 1 );
+         std::vector<float>& sampleR = *leaseR;
+         std::vector<float>& sampleG = *leaseG;
+         std::vector<float>& sampleB = *leaseB;
+         
+         // Subsample each channel
+         const float* r = target[0];
+         const float* g = target[1];
+         const float* b = target[2];
+         
+         for ( size_t i = 0; i < N; i += stride )
+         {
+            sampleR.push_back( r[i] );
+            sampleG.push_back( g[i] );
+            sampleB.push_back( b[i] );
+         }
+         
+         double p99R = PercentileInPlace( sampleR, 99.0 );
+         double p99G = PercentileInPlace( sampleG, 99.0 );
+         double p99B = PercentileInPlace( sampleB, 99.0 );
+         
+         softCeil = Max( p99R, Max( p99G, p99B ) );
       }
-      
-      double p99R = PercentileInPlace( sampleR, 99.0 );
-      double p99G = PercentileInPlace( sampleG, 99.0 );
-      double p99B = PercentileInPlace( sampleB, 99.0 );
-      
-      softCeil = Max( p99R, Max( p99G, p99B ) );
    }
    else
    {
@@ -777,19 +1534,30 @@ void VeraLuxEngine::AdaptiveOutputScaling( Image& target,
       size_t N = luma.NumberOfPixels();
       const size_t stride = Max( size_t( 1 ), N / 200000 );
       
-      std::vector<float> sample;
-      sample.reserve( N / stride + 1 );
-      
-      const float* data = luma[0];
-      
-      for ( size_t i = 0; i < N; i += stride )
-         sample.push_back( data[i] );
-      
-      softCeil = PercentileInPlace( sample, 99.0 );
+      if ( estimator == StatisticsEstimator::Histogram )
+      {
+         StreamingHistogram H;
+         H.Add( luma[0], N, stride );
+         softCeil = H.Percentile( 99.0 );
+      }
+      else
+      {
+         VeraLuxWorkspace::SampleLease lease( workspace, N / stride + 1 );
+         std::vector<float>& sample = *lease;
+         
+         const float* data = luma[0];
+         
+         for ( size_t i = 0; i < N; i += stride )
+            sample.push_back( data[i] );
+         
+         softCeil = PercentileInPlace( sample, 99.0 );
+      }
    }
    
    softCeil = Max( globalFloor + 1e-6, Min( softCeil, 1.0 ) );
-#endif
+   
+   if ( diagnostics )
+      diagnostics->estimatorTime = T();
    
    if ( absMax <= softCeil )
       absMax = softCeil + 1e-6;
@@ -808,68 +1576,56 @@ void VeraLuxEngine::AdaptiveOutputScaling( Image& target,
       finalScale = scaleContrast;
    }
    
-   // Apply scaling
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
-   {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
-      {
-         double val = *i;
-         double scaled = (val - globalFloor) * finalScale + PEDESTAL;
-         *i = float( Max( 0.0, Min( scaled, 1.0 ) ) );
-      }
-   }
-   
-   // Recalculate luminance for MTF
-   if ( target.NumberOfChannels() == 3 )
-   {
-      const float* r = target[0];
-      const float* g = target[1];
-      const float* b = target[2];
-      float* l = luma[0];
-      size_t N = target.NumberOfPixels();
-      
-      for ( size_t i = 0; i < N; ++i )
-         l[i] = profile.rWeight * r[i] + profile.gWeight * g[i] + profile.bWeight * b[i];
-   }
-   else
+   if ( diagnostics )
    {
-      luma.Assign( target );
+      diagnostics->floor = globalFloor;
+      diagnostics->softCeiling = softCeil;
+      diagnostics->scale = finalScale;
    }
    
-   stats << luma;
-   double currentBg = stats.Median();
+   // Apply scaling; the luminance median follows from the one measured above
+   double currentBg = ScaleWithLuminanceMedian( target, luma, medianL, profile, globalFloor, finalScale );
    
    // Apply MTF if needed
    if ( currentBg > 0.0 && currentBg < 1.0 && Abs( currentBg - targetBg ) > 1e-3 )
    {
       double m = (currentBg * (targetBg - 1.0)) / (currentBg * (2.0 * targetBg - 1.0) - targetBg);
-      ApplyMTF( target, m );
+      ApplyMTF( target, m, transfer );
+      if ( diagnostics )
+         diagnostics->midtones = m;
    }
+   else if ( diagnostics )
+      diagnostics->midtones = 0.5;
 }
 
 // ----------------------------------------------------------------------------
 
-void VeraLuxEngine::ApplyReadyToUseSoftClip( Image& target, double threshold, double rolloff )
+void VeraLuxEngine::ApplyOutputScaling( Image& target, const OutputScalingStats& scaling,
+                                         TransferEvaluation::value_type transfer )
 {
-   float threshF = float( threshold );
-   float rangeInv = float( 1.0 / (1.0 - threshold + 1e-9) );
-   
-   for ( int c = 0; c < target.NumberOfChannels(); ++c )
+   ApplyLinearScaling( target, scaling.floor, scaling.scale );
+   if ( scaling.midtones != 0.5 )
+      ApplyMTF( target, scaling.midtones, transfer );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxEngine::ApplyReadyToUseSoftClip( Image& target, double threshold, double rolloff,
+                                              TransferEvaluation::value_type transfer )
+{
+   if ( transfer == TransferEvaluation::LookupTable )
    {
-      Image::sample_iterator i( target, c );
-      for ( ; i; ++i )
-      {
-         if ( *i > threshF )
-         {
-            float t = Max( 0.0f, Min( (*i - threshF) * rangeInv, 1.0f ) );
-            float soft = 1.0f - Pow( 1.0f - t, float( rolloff ) );
-            *i = threshF + (1.0f - threshF) * soft;
-         }
-      }
+      ApplyLUT( target, *VeraLuxTransferLUT::SoftClip( threshold, rolloff ) );
+      return;
    }
    
-   target.Truncate( 0.0, 1.0 );
+   const int nChannels = target.NumberOfChannels();
+   VeraLuxParallel::ForEachPixelBand( target,
+      [&]( size_type begin, size_type end )
+      {
+         for ( int c = 0; c < nChannels; ++c )
+            VeraLuxSIMD::SoftClip( target[c] + begin, end - begin, threshold, rolloff );
+      } );
 }
 
 // ----------------------------------------------------------------------------
@@ -879,7 +1635,8 @@ void VeraLuxEngine::ReconstructColor( Image& rgb, const Image& luma,
                                        double colorConvergence,
                                        double colorGrip,
                                        double shadowConvergence,
-                                       double D, double b )
+                                       double D, double b,
+                                       TransferEvaluation::value_type transfer )
 {
    if ( rgb.NumberOfChannels() != 3 )
    {
@@ -888,79 +1645,101 @@ void VeraLuxEngine::ReconstructColor( Image& rgb, const Image& luma,
       return;
    }
    
-   size_t N = rgb.NumberOfPixels();
    const float epsilon = 1e-9f;
-   
-   // Extract ratios from original RGB (anchored)
-   std::vector<float> rRatio( N ), gRatio( N ), bRatio( N );
+   const float convergence = float( colorConvergence );
+   const float grip = float( colorGrip );
+   const bool shadow = shadowConvergence > 0.01;
+   const float shadowPower = float( shadowConvergence );
+   const bool hybrid = (colorGrip < 1.0) || shadow;
+   const size_type blockSize = size_type( VeraLuxSIMD::BlockSize );
+   
+   // Scalar stretch of the original RGB, evaluated per block when blending
+   const StretchCoefficients curve( D, b );
+   const std::shared_ptr<const VeraLuxTransferLUT> lut =
+      (hybrid && transfer == TransferEvaluation::LookupTable) ? VeraLuxTransferLUT::Stretch( curve ) : nullptr;
+   auto stretch = [&]( float* data, size_type count )
+   {
+      if ( lut )
+         lut->Apply( data, count );
+      else
+         VeraLuxSIMD::Stretch( data, count, curve );
+   };
    
    const float* origR = originalRGB[0];
    const float* origG = originalRGB[1];
    const float* origB = originalRGB[2];
-   
-   for ( size_t i = 0; i < N; ++i )
-   {
-      float L = origR[i] + origG[i] + origB[i] + epsilon;
-      rRatio[i] = origR[i] / L;
-      gRatio[i] = origG[i] / L;
-      bRatio[i] = origB[i] / L;
-   }
-   
-   // Apply stretched luminance with color convergence
    const float* L_str = luma[0];
    float* outR = rgb[0];
    float* outG = rgb[1];
    float* outB = rgb[2];
    
-   for ( size_t i = 0; i < N; ++i )
-   {
-      float L = L_str[i];
-      
-      // Color convergence (white point)
-      float k = Pow( L, float( colorConvergence ) );
-      float rFinal = rRatio[i] * (1.0f - k) + 1.0f * k;
-      float gFinal = gRatio[i] * (1.0f - k) + 1.0f * k;
-      float bFinal = bRatio[i] * (1.0f - k) + 1.0f * k;
-      
-      outR[i] = L * rFinal;
-      outG[i] = L * gFinal;
-      outB[i] = L * bFinal;
-   }
-   
-   // Hybrid blending (if needed)
-   bool needsHybrid = (colorGrip < 1.0) || (shadowConvergence > 0.01);
-   
-   if ( needsHybrid )
-   {
-      // Compute scalar stretch of original RGB
-      Image scalar;
-      scalar.Assign( originalRGB );
-      HyperbolicStretch( scalar, D, b );
-      
-      // Blend based on grip and shadow convergence
-      for ( size_t i = 0; i < N; ++i )
+   /*
+    * Color ratios, convergence, scalar stretch, hybrid blend and pedestal
+    * in one pass: the transcendental parts run on block buffers, so no
+    * image-sized temporaries are needed.
+    */
+   VeraLuxParallel::ForEachPixelBand( rgb,
+      [&]( size_type begin, size_type end )
       {
-         float L = L_str[i];
-         float gripMap = float( colorGrip );
+         float kBlock[ VeraLuxSIMD::BlockSize ], dampingBlock[ VeraLuxSIMD::BlockSize ];
+         float sR[ VeraLuxSIMD::BlockSize ], sG[ VeraLuxSIMD::BlockSize ], sB[ VeraLuxSIMD::BlockSize ];
          
-         if ( shadowConvergence > 0.01 )
+         for ( size_type i0 = begin; i0 < end; i0 += blockSize )
          {
-            float damping = Pow( L, float( shadowConvergence ) );
-            gripMap *= damping;
+            size_type n = Min( blockSize, end - i0 );
+            
+            // Color convergence (white point)
+            VeraLuxSIMD::Pow( L_str + i0, kBlock, n, convergence );
+            
+            if ( hybrid )
+            {
+               ::memcpy( sR, origR + i0, n*sizeof( float ) );
+               ::memcpy( sG, origG + i0, n*sizeof( float ) );
+               ::memcpy( sB, origB + i0, n*sizeof( float ) );
+               stretch( sR, n );
+               stretch( sG, n );
+               stretch( sB, n );
+               if ( shadow )
+                  VeraLuxSIMD::Pow( L_str + i0, dampingBlock, n, shadowPower );
+            }
+            
+            for ( size_type j = 0; j < n; ++j )
+            {
+               size_type i = i0 + j;
+               float L = L_str[i];
+               float k = kBlock[j];
+               float kInv = 1.0f - k;
+               float sum = origR[i] + origG[i] + origB[i] + epsilon;
+               float r = L * ((origR[i]/sum) * kInv + k);
+               float g = L * ((origG[i]/sum) * kInv + k);
+               float bl = L * ((origB[i]/sum) * kInv + k);
+               
+               // Blend based on grip and shadow convergence
+               if ( hybrid )
+               {
+                  float gripMap = shadow ? grip * dampingBlock[j] : grip;
+                  float gripInv = 1.0f - gripMap;
+                  r = r * gripMap + sR[j] * gripInv;
+                  g = g * gripMap + sG[j] * gripInv;
+                  bl = bl * gripMap + sB[j] * gripInv;
+               }
+               
+               // Pedestal and truncation
+               outR[i] = Range( r * 0.995f + 0.005f, 0.0f, 1.0f );
+               outG[i] = Range( g * 0.995f + 0.005f, 0.0f, 1.0f );
+               outB[i] = Range( bl * 0.995f + 0.005f, 0.0f, 1.0f );
+            }
          }
-         
-         float gripInv = 1.0f - gripMap;
-         
-         outR[i] = outR[i] * gripMap + scalar[0][i] * gripInv;
-         outG[i] = outG[i] * gripMap + scalar[1][i] * gripInv;
-         outB[i] = outB[i] * gripMap + scalar[2][i] * gripInv;
-      }
-   }
-   
-   // Apply pedestal and truncate
-   rgb *= 0.995f;
-   rgb += 0.005f;
-   rgb.Truncate( 0.0, 1.0 );
+      } );
+}
+
+// ----------------------------------------------------------------------------
+
+TransferEvaluation::value_type VeraLuxEngine::TransferEvaluationFor( int bitsPerSample, bool floatSample )
+{
+   if ( !floatSample && bitsPerSample <= 16 && VeraLuxTransferLUT::IsFasterThanDirect() )
+      return TransferEvaluation::LookupTable;
+   return TransferEvaluation::Direct;
 }
 
 // ----------------------------------------------------------------------------
@@ -16,23 +16,21 @@
 // this program. If not, see <https://www.gnu.org/licenses/>.
 // ----------------------------------------------------------------------------
 //
-// COMPILE-TIME OPTIONS:
+// STATISTICS ESTIMATORS (selected at run time, see StatisticsEstimator):
 //
-// HMS_USE_MAD: Use MAD (Median Absolute Deviation) approximations instead of
-//              exact percentiles for bounds calculation in Linear Expansion
-//              and Adaptive Output Scaling. Provides 10-100x performance gain
-//              with < 0.001 typical error.
-//
-// Default behavior (HMS_USE_MAD not defined):
+// Exact (default):
 //   - Linear Expansion: exact 0.001 and 99.999 percentiles
 //   - Adaptive Scaling: exact 99th percentile
 //   - Exact match to Python implementation
-//   - Slightly slower but mathematically identical
+//   - Linear-time selection (VeraLuxStatistics), no full sorts
+//
+// Histogram:
+//   - Same percentiles and subsamples, from a streaming 65536-bin histogram
+//   - No sample buffer, error bounded by one bin width (~1.5e-5)
 //
-// With HMS_USE_MAD defined:
+// MAD:
 //   - Linear Expansion: MAD approximation (median ± 3.5σ / ± 4σ)
 //   - Adaptive Scaling: stddev approximation (median ± 3σ)
-//   - 10-100x faster
 //   - < 0.001 typical error, < 0.005 worst case
 //
 // ----------------------------------------------------------------------------
@@ -41,13 +39,53 @@
 #define __VeraLuxEngine_h
 
 #include "SensorProfiles.h"
+#include "VeraLuxWorkspace.h"
 
 #include <pcl/Image.h>
 #include <pcl/ImageVariant.h>
 
+#include <vector>
+
 namespace pcl
 {
 
+class StatusMonitor;
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace StatisticsEstimator
+ * \brief Estimators for the robust bounds of Linear Expansion and Adaptive
+ * Output Scaling.
+ */
+namespace StatisticsEstimator
+{
+   enum value_type
+   {
+      Exact,      //!< Exact percentiles of a strided subsample (Python reference)
+      Histogram,  //!< Streaming histogram quantiles of the same subsample
+      MAD,        //!< Median/MAD and median/sigma approximations
+      NumberOfEstimators,
+      Default = Exact
+   };
+}
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace TransferEvaluation
+ * \brief Evaluation of the stretch, MTF and soft clip transfer functions.
+ */
+namespace TransferEvaluation
+{
+   enum value_type
+   {
+      Direct,       //!< VeraLuxSIMD kernels for every sample
+      LookupTable,  //!< Cached interpolated tables (VeraLuxTransferLUT), for up to 16-bit results
+      Default = Direct
+   };
+}
+
 // ----------------------------------------------------------------------------
 
 /*!
@@ -63,6 +101,22 @@ struct LinearExpansionStats
    double pctHigh = 0.0;  //!< Percentage of pixels clamped to one
    double low     = 0.0;  //!< Lower bound value
    double high    = 0.0;  //!< Upper bound value
+   double estimatorTime = 0.0;  //!< Seconds spent estimating the bounds
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct OutputScalingStats
+ * \brief Diagnostic statistics from adaptive output scaling.
+ */
+struct OutputScalingStats
+{
+   double floor         = 0.0;  //!< Global floor (black point)
+   double softCeiling   = 0.0;  //!< Soft ceiling (99th percentile or estimate)
+   double scale         = 1.0;  //!< Final linear scale factor
+   double midtones      = 0.5;  //!< Midtones balance of the final MTF (0.5 = identity)
+   double estimatorTime = 0.0;  //!< Seconds spent estimating the soft ceiling
 };
 
 // ----------------------------------------------------------------------------
@@ -75,6 +129,10 @@ struct LinearExpansionStats
  * algorithm. All methods are static and thread-safe. This is a direct port
  * of the Python VeraLuxCore class to C++/PCL.
  *
+ * Per-pixel kernels run in parallel row bands (see VeraLuxParallel). The
+ * number of threads follows the parallel processing settings of the image
+ * being processed, and results are identical for any thread count.
+ *
  * Key Features:
  * - Inverse hyperbolic sine (arcsinh) based stretching
  * - Sensor-specific photometric luminance extraction
@@ -92,11 +150,73 @@ public:
     * Handles various input formats: 8/16/32-bit integer and float images.
     * Sanitizes NaN/Inf values. Result is always a float Image in [0,1].
     *
+    * Native samples are scaled and sanitized in a single pass, without an
+    * intermediate float copy; 8 and 16-bit samples by table lookup.
+    *
     * \param[out] target    Normalized float image (output)
     * \param[in]  source    Source image variant (any bit depth)
     */
    static void NormalizeInput( Image& target, const ImageVariant& source );
 
+   /*!
+    * \brief Normalizes a rectangular region of an input image to [0,1].
+    *
+    * Same conversion as NormalizeInput(), with the divisor given explicitly
+    * so that separately normalized regions (e.g. row strips in streamed
+    * execution) are consistent with each other.
+    *
+    * \param[out] target    Normalized float image (output)
+    * \param[in]  source    Source image variant (any bit depth)
+    * \param      rect      Source region; an empty rectangle selects the whole image
+    * \param      divisor   Value of NormalizationDivisor() for the whole source image
+    */
+   static void NormalizeInput( Image& target, const ImageVariant& source, const Rect& rect, double divisor );
+
+   /*!
+    * \brief Returns the divisor mapping the samples of an image to [0,1].
+    *
+    * The full range of the sample type for integer images. For float images,
+    * 1 unless the maximum sample exceeds 1.1, in which case 16-bit or 32-bit
+    * integer data stored as float is assumed.
+    *
+    * \param maximum         Maximum sample value; only used for float images
+    * \param floatSample     Whether the image has floating point samples
+    * \param bitsPerSample   Bits per sample of the image
+    */
+   static double NormalizationDivisor( double maximum, bool floatSample, int bitsPerSample );
+
+   /*!
+    * \brief Returns the normalization divisor of an image.
+    *
+    * Measures the maximum sample of float images.
+    */
+   static double NormalizationDivisor( const ImageVariant& source );
+
+   /*!
+    * \brief Normalizes a 32-bit float image to [0,1] in place.
+    *
+    * Same result as NormalizeInput() without a working copy. Range
+    * detection and NaN/Inf sanitization share a single pass; a second pass
+    * is only needed when samples exceed one.
+    *
+    * \param[in,out] image   Float image to normalize
+    */
+   static void NormalizeInPlace( Image& image );
+
+   /*!
+    * \brief Writes a [0,1] float result over an image of any real sample type.
+    *
+    * Equivalent to ImageVariant::CopyImage(), but converts in parallel row
+    * bands directly into the existing pixel data of \a target. \a source
+    * may also be a strip of rows of \a target, with the same width and
+    * number of channels.
+    *
+    * \param[in,out] target     Output image
+    * \param         source     Normalized result
+    * \param         startRow   First row of \a target written
+    */
+   static void StoreOutput( ImageVariant& target, const Image& source, int startRow = 0 );
+
    /*!
     * \brief Calculates black point using statistical percentile method.
     *
@@ -108,6 +228,23 @@ public:
     */
    static double CalculateAnchor( const Image& img );
 
+   /*!
+    * \brief Calculates the statistical black point on an explicit stride.
+    *
+    * Same estimate as CalculateAnchor( const Image& ), taking every
+    * \a stride-th pixel of each channel. A stride of one uses all pixels, as
+    * required for a subsample already drawn on AnchorStride().
+    */
+   static double CalculateAnchor( const Image& img, size_type stride );
+
+   /*!
+    * \brief Reference subsample stride of the statistical black point.
+    *
+    * Pixel stride used by CalculateAnchor( const Image& ) for an image of
+    * \a numberOfPixels pixels and \a numberOfChannels channels.
+    */
+   static size_type AnchorStride( size_type numberOfPixels, int numberOfChannels );
+
    /*!
     * \brief Calculates black point using adaptive morphological method.
     *
@@ -136,6 +273,18 @@ public:
    static void ExtractLuminance( Image& luma, const Image& rgb, 
                                   double anchor, const SensorProfile& profile );
 
+   /*!
+    * \brief Subtracts the black point from every channel, clamping at zero.
+    *
+    * Produces the anchored RGB (or mono) data used as the color reference
+    * by ReconstructColor().
+    *
+    * \param[out] anchored  Output anchored image
+    * \param[in]  rgb       Input normalized image
+    * \param      anchor    Black point to subtract
+    */
+   static void SubtractAnchor( Image& anchored, const Image& rgb, double anchor );
+
    /*!
     * \brief Applies inverse hyperbolic sine stretch.
     *
@@ -146,15 +295,18 @@ public:
     * \param         D         Stretch factor (10^logD)
     * \param         b         Highlight protection parameter
     * \param         SP        Shadow protection (default 0.0)
+    * \param         transfer  Transfer function evaluation
     */
    static void HyperbolicStretch( Image& target, double D, double b, 
-                                   double SP = 0.0 );
+                                   double SP = 0.0,
+                                   TransferEvaluation::value_type transfer = TransferEvaluation::Default );
 
    /*!
-    * \brief Binary search solver for optimal Log D parameter.
+    * \brief Solver for optimal Log D parameter.
     *
     * Finds the Log D value that places the luminance median at the target
-    * background level. Uses iterative bisection for precision.
+    * background level. See SolveLogD( double, double, double ). The median
+    * of \a luma is found exactly in two streamed histogram passes.
     *
     * \param luma           Input luminance image
     * \param targetMedian   Desired median value
@@ -164,6 +316,50 @@ public:
    static double SolveLogD( const Image& luma, double targetMedian, 
                              double bVal );
 
+   /*!
+    * \brief Log D solver for a precomputed luminance median.
+    *
+    * Solves the analytic stretched median for Log D in [0,7] with Newton
+    * iterations safeguarded by bisection, typically converging to full
+    * precision in a few steps. Returns 2.0 when the input median is zero or
+    * the target cannot be reached in that range.
+    *
+    * \param medianIn       Median of the input luminance
+    * \param targetMedian   Desired median value
+    * \param bVal           Highlight protection parameter
+    * \return               Optimal Log D value
+    */
+   static double SolveLogD( double medianIn, double targetMedian, double bVal );
+
+   /*!
+    * \brief Solves Log D for several target medians at once.
+    *
+    * Returns the Log D value of each element of \a targetMedians, as
+    * SolveLogD( double, double, double ) does. Solving a grid of targets
+    * costs a few evaluations of the analytic curve per target, so target
+    * background sweeps need no pipeline runs.
+    */
+   static std::vector<double> SolveLogD( double medianIn, const std::vector<double>& targetMedians,
+                                         double bVal );
+
+   /*!
+    * \brief Median of the anchored luminance, without a luminance image.
+    *
+    * Equal to the median of the ExtractLuminance() result. Luminance values
+    * are computed on the fly in two passes: a 65536-bin histogram locates
+    * the bins holding the central ranks, then only the values in those bins
+    * are collected and selected exactly.
+    *
+    * \param rgb       Normalized image
+    * \param anchor    Black point
+    * \param profile   Sensor profile for luminance weights
+    * \param monitor   Optional monitor, incremented by rows scanned (twice
+    *                  the image height in total). Aborting it interrupts
+    *                  the computation.
+    */
+   static double LuminanceMedian( const Image& rgb, double anchor, const SensorProfile& profile,
+                                  StatusMonitor* monitor = nullptr );
+
    /*!
     * \brief Applies Midtone Transfer Function (MTF).
     *
@@ -172,8 +368,10 @@ public:
     *
     * \param[in,out] target    Image to transform
     * \param         m         MTF parameter
+    * \param         transfer  Transfer function evaluation
     */
-   static void ApplyMTF( Image& target, double m );
+   static void ApplyMTF( Image& target, double m,
+                         TransferEvaluation::value_type transfer = TransferEvaluation::Default );
 
    /*!
     * \brief Applies smart linear expansion with hot pixel rejection.
@@ -185,9 +383,24 @@ public:
     * \param[in,out] target        Image to expand
     * \param         factor        Expansion amount [0,1]
     * \param[out]    diagnostics   Optional clipping statistics
+    * \param         estimator     Estimator used for the bounds
+    * \param         peak          Optional neighborhoods of the brightest pixels,
+    *                              see AdaptiveOutputScaling()
     */
    static void ApplyLinearExpansion( Image& target, float factor,
-                                      LinearExpansionStats* diagnostics = nullptr );
+                                      LinearExpansionStats* diagnostics = nullptr,
+                                      StatisticsEstimator::value_type estimator = StatisticsEstimator::Default,
+                                      const Image* peak = nullptr );
+
+   /*!
+    * \brief Applies linear expansion with known bounds.
+    *
+    * \param[in,out] target   Image to expand
+    * \param         factor   Expansion amount [0,1]
+    * \param         low      Low bound, as returned in LinearExpansionStats::low
+    * \param         high     High bound, as returned in LinearExpansionStats::high
+    */
+   static void ApplyLinearExpansion( Image& target, float factor, double low, double high );
 
    /*!
     * \brief Estimates global star pressure metric.
@@ -201,6 +414,16 @@ public:
     */
    static double EstimateStarPressure( const Image& luma );
 
+   /*!
+    * \brief Star pressure from tail statistics.
+    *
+    * \param p999            99.9th percentile of the nonzero luminance
+    * \param p9999           99.99th percentile of the nonzero luminance
+    * \param brightFraction  Fraction of nonzero luminance above \a p999
+    * \return                Star pressure [0,1]
+    */
+   static double StarPressure( double p999, double p9999, double brightFraction );
+
    /*!
     * \brief Applies Ready-to-Use mode adaptive output scaling.
     *
@@ -208,13 +431,55 @@ public:
     * Uses "Smart Max" logic to preserve bright stars while rejecting hot
     * pixels. Then applies MTF to reach target background.
     *
+    * The luminance floor statistics (median, standard deviation, extremes)
+    * are measured in one streamed pass with an exact median refinement. The
+    * luminance median after the linear scaling, which sets the MTF, is
+    * derived from the measured one through the affine transform. It is only
+    * measured again, without building a luminance image, if clipped pixels
+    * cross the median.
+    *
     * \param[in,out] target      Image to scale
     * \param         profile     Sensor profile for luminance calculation
     * \param         targetBg    Target background level
+    * \param         estimator   Estimator used for the soft ceiling
+    * \param[out]    diagnostics Optional scaling statistics
+    * \param         transfer    Transfer function evaluation for the MTF
+    * \param         peak        Optional neighborhoods of the brightest pixels (see below)
+    * \param         workspace   Optional pool for the luminance plane and subsamples
+    *
+    * Smart Max takes the brightest local maximum of \a target that passes
+    * the star test of VeraLuxSmartMax as the physical maximum; brighter
+    * candidates are hot pixels.
+    *
+    * When \a target is a sparse sample of a larger image, as in streamed
+    * execution, the pixels around its brightest samples are not neighbors
+    * in the image. Smart Max then searches \a peak instead: a mosaic of the
+    * 3x3 neighborhoods of the brightest local maxima of the full image,
+    * transformed like \a target. The same applies to ApplyLinearExpansion().
     */
    static void AdaptiveOutputScaling( Image& target, 
                                        const SensorProfile& profile,
-                                       double targetBg );
+                                       double targetBg,
+                                       StatisticsEstimator::value_type estimator = StatisticsEstimator::Default,
+                                       OutputScalingStats* diagnostics = nullptr,
+                                       TransferEvaluation::value_type transfer = TransferEvaluation::Default,
+                                       const Image* peak = nullptr,
+                                       VeraLuxWorkspace* workspace = nullptr );
+
+   /*!
+    * \brief Applies a previously computed Ready-to-Use output scaling.
+    *
+    * Repeats the linear range expansion and final MTF described by \a scaling,
+    * as returned by AdaptiveOutputScaling(), without measuring \a target.
+    * Used to give several images (e.g. mosaic panels) identical output
+    * transfer functions.
+    *
+    * \param[in,out] target     Image to scale
+    * \param         scaling    Floor, scale and midtones balance to apply
+    * \param         transfer   Transfer function evaluation for the MTF
+    */
+   static void ApplyOutputScaling( Image& target, const OutputScalingStats& scaling,
+                                   TransferEvaluation::value_type transfer = TransferEvaluation::Default );
 
    /*!
     * \brief Applies soft-clipping to highlights (Ready-to-Use mode).
@@ -225,9 +490,11 @@ public:
     * \param[in,out] target       Image to clip
     * \param         threshold    Clipping threshold (e.g., 0.98)
     * \param         rolloff      Roll-off power (e.g., 2.0)
+    * \param         transfer     Transfer function evaluation
     */
    static void ApplyReadyToUseSoftClip( Image& target, double threshold, 
-                                         double rolloff );
+                                         double rolloff,
+                                         TransferEvaluation::value_type transfer = TransferEvaluation::Default );
 
    /*!
     * \brief Reconstructs RGB from stretched luminance using vector preservation.
@@ -236,6 +503,9 @@ public:
     * luminance stretch. Implements color convergence (white point physics)
     * and optional hybrid blending (color grip, shadow convergence).
     *
+    * Runs as a single blocked pass without image-sized temporaries. \a rgb
+    * may be the same image as \a originalRGB.
+    *
     * \param[in,out] rgb                 RGB image to reconstruct
     * \param         luma                Stretched luminance
     * \param         originalRGB         Original anchored RGB
@@ -244,13 +514,27 @@ public:
     * \param         shadowConvergence   Shadow noise damping power
     * \param         D                   Stretch factor (for scalar blend)
     * \param         b                   Highlight protection (for scalar blend)
+    * \param         transfer            Evaluation of the scalar blend stretch
     */
    static void ReconstructColor( Image& rgb, const Image& luma,
                                   const Image& originalRGB,
                                   double colorConvergence,
                                   double colorGrip,
                                   double shadowConvergence,
-                                  double D, double b );
+                                  double D, double b,
+                                  TransferEvaluation::value_type transfer = TransferEvaluation::Default );
+
+   /*!
+    * \brief Fastest transfer evaluation for results of the given precision.
+    *
+    * Lookup tables are used for 8 and 16-bit integer results, where their
+    * interpolation error is below half a quantization step, as long as they
+    * are faster than the active vector kernels.
+    *
+    * \param bitsPerSample   Bits per sample of the result
+    * \param floatSample     Whether the result has floating point samples
+    */
+   static TransferEvaluation::value_type TransferEvaluationFor( int bitsPerSample, bool floatSample );
 };
 
 // ----------------------------------------------------------------------------
@@ -0,0 +1,548 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxContext.h"
+#include "VeraLuxGPU.h"
+#include "VeraLuxSIMD.h"
+
+#include <pcl/AutoLock.h>
+#include <pcl/Exception.h>
+#include <pcl/Math.h>
+#include <pcl/Mutex.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#ifdef __PCL_WINDOWS
+#  include <windows.h>
+#else
+#  include <dlfcn.h>
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * The subset of the OpenCL 1.2 API used here, declared locally since the
+    * runtime is loaded dynamically and no OpenCL headers are required.
+    */
+#ifdef __PCL_WINDOWS
+#  define VERALUX_CL_CALL __stdcall
+#else
+#  define VERALUX_CL_CALL
+#endif
+
+   typedef int32_t  cl_int;
+   typedef uint32_t cl_uint;
+   typedef uint64_t cl_ulong;
+   typedef uint64_t cl_bitfield;
+   typedef intptr_t cl_context_properties;
+
+   typedef struct _cl_platform_id*   cl_platform_id;
+   typedef struct _cl_device_id*     cl_device_id;
+   typedef struct _cl_context*       cl_context;
+   typedef struct _cl_command_queue* cl_command_queue;
+   typedef struct _cl_mem*           cl_mem;
+   typedef struct _cl_program*       cl_program;
+   typedef struct _cl_kernel*        cl_kernel;
+   typedef struct _cl_event*         cl_event;
+
+   const cl_int      CL_SUCCESS                  = 0;
+   const cl_uint     CL_FALSE                    = 0;
+   const cl_uint     CL_TRUE                     = 1;
+   const cl_bitfield CL_DEVICE_TYPE_GPU          = 1 << 2;
+   const cl_bitfield CL_MEM_READ_WRITE           = 1 << 0;
+   const cl_uint     CL_DEVICE_MAX_MEM_ALLOC_SIZE = 0x1010;
+   const cl_uint     CL_DEVICE_NAME              = 0x102B;
+
+   struct OpenCLAPI
+   {
+      cl_int (VERALUX_CL_CALL *GetPlatformIDs)( cl_uint, cl_platform_id*, cl_uint* );
+      cl_int (VERALUX_CL_CALL *GetDeviceIDs)( cl_platform_id, cl_bitfield, cl_uint, cl_device_id*, cl_uint* );
+      cl_int (VERALUX_CL_CALL *GetDeviceInfo)( cl_device_id, cl_uint, size_t, void*, size_t* );
+      cl_context (VERALUX_CL_CALL *CreateContext)( const cl_context_properties*, cl_uint, const cl_device_id*,
+                                                   void (VERALUX_CL_CALL *)( const char*, const void*, size_t, void* ),
+                                                   void*, cl_int* );
+      cl_command_queue (VERALUX_CL_CALL *CreateCommandQueue)( cl_context, cl_device_id, cl_bitfield, cl_int* );
+      cl_program (VERALUX_CL_CALL *CreateProgramWithSource)( cl_context, cl_uint, const char**, const size_t*, cl_int* );
+      cl_int (VERALUX_CL_CALL *BuildProgram)( cl_program, cl_uint, const cl_device_id*, const char*,
+                                              void (VERALUX_CL_CALL *)( cl_program, void* ), void* );
+      cl_kernel (VERALUX_CL_CALL *CreateKernel)( cl_program, const char*, cl_int* );
+      cl_mem (VERALUX_CL_CALL *CreateBuffer)( cl_context, cl_bitfield, size_t, void*, cl_int* );
+      cl_int (VERALUX_CL_CALL *SetKernelArg)( cl_kernel, cl_uint, size_t, const void* );
+      cl_int (VERALUX_CL_CALL *EnqueueWriteBuffer)( cl_command_queue, cl_mem, cl_uint, size_t, size_t, const void*,
+                                                    cl_uint, const cl_event*, cl_event* );
+      cl_int (VERALUX_CL_CALL *EnqueueReadBuffer)( cl_command_queue, cl_mem, cl_uint, size_t, size_t, void*,
+                                                   cl_uint, const cl_event*, cl_event* );
+      cl_int (VERALUX_CL_CALL *EnqueueNDRangeKernel)( cl_command_queue, cl_kernel, cl_uint, const size_t*,
+                                                      const size_t*, const size_t*, cl_uint, const cl_event*, cl_event* );
+      cl_int (VERALUX_CL_CALL *Finish)( cl_command_queue );
+      cl_int (VERALUX_CL_CALL *ReleaseMemObject)( cl_mem );
+   };
+
+   /*
+    * Per-pixel kernels. KernelParameters below must have the same layout:
+    * 4-byte members only, so host and device agree on the offsets.
+    */
+   const char* const s_kernelSource = R"CL(
+typedef struct
+{
+   float anchor, rw, gw, bw;
+   float D, b, term2, normFactor;
+   float expansion, expansionLow, expansionRange;
+   float convergence, grip, shadowPower;
+   float floor, scale, midtones, threshold, rolloff;
+   int   expand, hybrid, shadow, scaled, mtf, soft;
+   uint  count, channels;
+} Parameters;
+
+float Stretch( float x, const Parameters* p )
+{
+   return clamp( (asinh( p->D*x + p->b ) - p->term2)/p->normFactor, 0.0f, 1.0f );
+}
+
+float Expand( float x, const Parameters* p )
+{
+   if ( !p->expand )
+      return x;
+   return x*(1.0f - p->expansion) + clamp( (x - p->expansionLow)/p->expansionRange, 0.0f, 1.0f )*p->expansion;
+}
+
+float Power( float x, float e )
+{
+   return (x > 0.0f) ? powr( x, e ) : 0.0f;
+}
+
+float Finish( float v, const Parameters* p )
+{
+   if ( p->scaled )
+   {
+      v = clamp( (v - p->floor)*p->scale + 0.001f, 0.0f, 1.0f );
+      if ( p->mtf )
+      {
+         float t = (2.0f*p->midtones - 1.0f)*v - p->midtones;
+         v = (t != 0.0f) ? clamp( (p->midtones - 1.0f)*v/t, 0.0f, 1.0f ) : 0.0f;
+      }
+   }
+   if ( p->soft && v > p->threshold )
+   {
+      float t = clamp( (v - p->threshold)/(1.0f - p->threshold + 1e-9f), 0.0f, 1.0f );
+      v = p->threshold + (1.0f - p->threshold)*(1.0f - pow( 1.0f - t, p->rolloff ));
+   }
+   return clamp( v, 0.0f, 1.0f );
+}
+
+__kernel void StretchRGB( __global float* data, const Parameters p )
+{
+   const uint i = get_global_id( 0 );
+   if ( i >= p.count )
+      return;
+
+   __global float* R = data + i;
+   __global float* G = R + p.count;
+   __global float* B = G + p.count;
+
+   float ra = fmax( 0.0f, *R - p.anchor );
+   float ga = fmax( 0.0f, *G - p.anchor );
+   float ba = fmax( 0.0f, *B - p.anchor );
+   float L = Expand( Stretch( p.rw*ra + p.gw*ga + p.bw*ba, &p ), &p );
+
+   float sum = ra + ga + ba + 1e-9f;
+   float k = Power( L, p.convergence );
+   float kInv = 1.0f - k;
+   float outR = L*((ra/sum)*kInv + k);
+   float outG = L*((ga/sum)*kInv + k);
+   float outB = L*((ba/sum)*kInv + k);
+
+   if ( p.hybrid )
+   {
+      float gripMap = p.shadow ? p.grip*Power( L, p.shadowPower ) : p.grip;
+      float gripInv = 1.0f - gripMap;
+      outR = outR*gripMap + Stretch( ra, &p )*gripInv;
+      outG = outG*gripMap + Stretch( ga, &p )*gripInv;
+      outB = outB*gripMap + Stretch( ba, &p )*gripInv;
+   }
+
+   *R = Finish( clamp( outR*0.995f + 0.005f, 0.0f, 1.0f ), &p );
+   *G = Finish( clamp( outG*0.995f + 0.005f, 0.0f, 1.0f ), &p );
+   *B = Finish( clamp( outB*0.995f + 0.005f, 0.0f, 1.0f ), &p );
+}
+
+__kernel void StretchMono( __global float* data, const Parameters p )
+{
+   const uint i = get_global_id( 0 );
+   if ( i >= p.count )
+      return;
+
+   for ( uint c = 0; c < p.channels; ++c )
+   {
+      __global float* v = data + c*p.count + i;
+      *v = Finish( Expand( Stretch( fmax( 0.0f, *v - p.anchor ), &p ), &p ), &p );
+   }
+}
+)CL";
+
+   struct KernelParameters
+   {
+      float  anchor, rw, gw, bw;
+      float  D, b, term2, normFactor;
+      float  expansion, expansionLow, expansionRange;
+      float  convergence, grip, shadowPower;
+      float  floor, scale, midtones, threshold, rolloff;
+      int32  expand, hybrid, shadow, scaled, mtf, soft;
+      uint32 count, channels;
+   };
+
+   /*
+    * Pipeline stages of VeraLuxStreaming::Stretch() as kernel parameters,
+    * with the same stage conditions as VeraLuxPipeline and VeraLuxEngine.
+    */
+   KernelParameters ParametersOf( const Image& image, const SensorProfile& profile,
+                                  const FusedStretchParameters& params, const OutputScalingStats* scaling )
+   {
+      const StretchCoefficients curve( params.D, params.b );
+
+      KernelParameters k = {};
+      k.anchor = float( params.anchor );
+      k.rw = profile.weights.rf;
+      k.gw = profile.weights.gf;
+      k.bw = profile.weights.bf;
+      k.D = float( curve.D );
+      k.b = float( curve.b );
+      k.term2 = float( curve.term2 );
+      k.normFactor = float( curve.normFactor );
+
+      const double factor = Max( 0.0, Min( params.linearExpansion, 1.0 ) );
+      k.expand = params.linearExpansion > 0.001 && params.expansionHigh > params.expansionLow;
+      k.expansion = float( factor );
+      k.expansionLow = float( params.expansionLow );
+      k.expansionRange = float( k.expand ? params.expansionHigh - params.expansionLow : 1.0 );
+
+      k.convergence = float( params.colorConvergence );
+      k.grip = float( params.colorGrip );
+      k.shadowPower = float( params.shadowConvergence );
+      k.shadow = params.shadowConvergence > 0.01;
+      k.hybrid = params.colorGrip < 1.0 || k.shadow;
+
+      if ( scaling != nullptr )
+      {
+         k.scaled = k.soft = 1;
+         k.floor = float( scaling->floor );
+         k.scale = float( scaling->scale );
+         k.midtones = float( scaling->midtones );
+         k.mtf = scaling->midtones != 0.5;
+         k.threshold = 0.98f;
+         k.rolloff = 2.0f;
+      }
+
+      k.count = uint32( image.NumberOfPixels() );
+      k.channels = uint32( image.NumberOfChannels() );
+      return k;
+   }
+
+   void* LoadOpenCL()
+   {
+#if defined( __PCL_WINDOWS )
+      return (void*)::LoadLibraryA( "OpenCL.dll" );
+#elif defined( __PCL_MACOSX )
+      return ::dlopen( "/System/Library/Frameworks/OpenCL.framework/OpenCL", RTLD_NOW | RTLD_LOCAL );
+#else
+      void* library = ::dlopen( "libOpenCL.so.1", RTLD_NOW | RTLD_LOCAL );
+      return (library != nullptr) ? library : ::dlopen( "libOpenCL.so", RTLD_NOW | RTLD_LOCAL );
+#endif
+   }
+
+   template <typename F>
+   bool Resolve( void* library, F& function, const char* name )
+   {
+#ifdef __PCL_WINDOWS
+      function = reinterpret_cast<F>( ::GetProcAddress( (HMODULE)library, name ) );
+#else
+      function = reinterpret_cast<F>( ::dlsym( library, name ) );
+#endif
+      return function != nullptr;
+   }
+
+   /*
+    * The selected device, initialized on first use and kept for the
+    * lifetime of the process. The mutex serializes stretches and guards
+    * the resident buffer.
+    */
+   struct Device
+   {
+      bool             available = false;
+      IsoString        name;
+      OpenCLAPI        cl = {};
+      cl_context       context = nullptr;
+      cl_command_queue queue = nullptr;
+      cl_kernel        rgbKernel = nullptr;
+      cl_kernel        monoKernel = nullptr;
+      size_type        maxAllocation = 0;
+
+      Mutex            mutex;
+      cl_mem           buffer = nullptr;
+      size_type        bufferSize = 0;
+
+      Device()
+      {
+         available = Initialize();
+      }
+
+      bool Initialize()
+      {
+         void* library = LoadOpenCL();
+         if ( library == nullptr )
+            return false;
+
+         if ( !Resolve( library, cl.GetPlatformIDs, "clGetPlatformIDs" ) ||
+              !Resolve( library, cl.GetDeviceIDs, "clGetDeviceIDs" ) ||
+              !Resolve( library, cl.GetDeviceInfo, "clGetDeviceInfo" ) ||
+              !Resolve( library, cl.CreateContext, "clCreateContext" ) ||
+              !Resolve( library, cl.CreateCommandQueue, "clCreateCommandQueue" ) ||
+              !Resolve( library, cl.CreateProgramWithSource, "clCreateProgramWithSource" ) ||
+              !Resolve( library, cl.BuildProgram, "clBuildProgram" ) ||
+              !Resolve( library, cl.CreateKernel, "clCreateKernel" ) ||
+              !Resolve( library, cl.CreateBuffer, "clCreateBuffer" ) ||
+              !Resolve( library, cl.SetKernelArg, "clSetKernelArg" ) ||
+              !Resolve( library, cl.EnqueueWriteBuffer, "clEnqueueWriteBuffer" ) ||
+              !Resolve( library, cl.EnqueueReadBuffer, "clEnqueueReadBuffer" ) ||
+              !Resolve( library, cl.EnqueueNDRangeKernel, "clEnqueueNDRangeKernel" ) ||
+              !Resolve( library, cl.Finish, "clFinish" ) ||
+              !Resolve( library, cl.ReleaseMemObject, "clReleaseMemObject" ) )
+            return false;
+
+         cl_uint platformCount = 0;
+         if ( cl.GetPlatformIDs( 0, nullptr, &platformCount ) != CL_SUCCESS || platformCount == 0 )
+            return false;
+         std::vector<cl_platform_id> platforms( platformCount );
+         if ( cl.GetPlatformIDs( platformCount, platforms.data(), nullptr ) != CL_SUCCESS )
+            return false;
+
+         cl_device_id device = nullptr;
+         for ( cl_platform_id platform : platforms )
+            if ( cl.GetDeviceIDs( platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr ) == CL_SUCCESS )
+               break;
+            else
+               device = nullptr;
+         if ( device == nullptr )
+            return false;
+
+         char deviceName[ 256 ] = {};
+         cl.GetDeviceInfo( device, CL_DEVICE_NAME, sizeof( deviceName ) - 1, deviceName, nullptr );
+         cl_ulong maxAlloc = 0;
+         cl.GetDeviceInfo( device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof( maxAlloc ), &maxAlloc, nullptr );
+         maxAllocation = size_type( maxAlloc );
+
+         cl_int status;
+         context = cl.CreateContext( nullptr, 1, &device, nullptr, nullptr, &status );
+         if ( status != CL_SUCCESS )
+            return false;
+         queue = cl.CreateCommandQueue( context, device, 0, &status );
+         if ( status != CL_SUCCESS )
+            return false;
+
+         const char* source = s_kernelSource;
+         cl_program program = cl.CreateProgramWithSource( context, 1, &source, nullptr, &status );
+         if ( status != CL_SUCCESS || cl.BuildProgram( program, 1, &device, "", nullptr, nullptr ) != CL_SUCCESS )
+            return false;
+         rgbKernel = cl.CreateKernel( program, "StretchRGB", &status );
+         if ( status != CL_SUCCESS )
+            return false;
+         monoKernel = cl.CreateKernel( program, "StretchMono", &status );
+         if ( status != CL_SUCCESS )
+            return false;
+
+         name = deviceName;
+         return true;
+      }
+
+      /*
+       * Device buffer of at least \a size bytes. Called with the mutex locked.
+       */
+      bool Reserve( size_type size )
+      {
+         if ( buffer != nullptr && bufferSize >= size )
+            return true;
+         Release();
+         cl_int status;
+         buffer = cl.CreateBuffer( context, CL_MEM_READ_WRITE, size, nullptr, &status );
+         if ( status != CL_SUCCESS )
+         {
+            buffer = nullptr;
+            return false;
+         }
+         bufferSize = size;
+         return true;
+      }
+
+      void Release()
+      {
+         if ( buffer != nullptr )
+            cl.ReleaseMemObject( buffer );
+         buffer = nullptr;
+         bufferSize = 0;
+      }
+   };
+
+   std::atomic<bool> s_initialized( false );
+   std::atomic<bool> s_faulted( false );   // a result could not be read back
+
+   Device& TheDevice()
+   {
+      static Device device;
+      s_initialized.store( true, std::memory_order_release );
+      return device;
+   }
+
+   /*
+    * Holds a mutex acquired with TryLock().
+    */
+   class TryLockGuard
+   {
+   public:
+
+      TryLockGuard( Mutex& mutex )
+         : m_mutex( mutex )
+         , m_locked( mutex.TryLock() )
+      {
+      }
+
+      ~TryLockGuard()
+      {
+         if ( m_locked )
+            m_mutex.Unlock();
+      }
+
+      TryLockGuard( const TryLockGuard& ) = delete;
+      TryLockGuard& operator =( const TryLockGuard& ) = delete;
+
+      explicit operator bool() const
+      {
+         return m_locked;
+      }
+
+   private:
+
+      Mutex& m_mutex;
+      bool   m_locked;
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxGPU::IsAvailable()
+{
+   return TheDevice().available && !s_faulted.load( std::memory_order_relaxed );
+}
+
+// ----------------------------------------------------------------------------
+
+IsoString VeraLuxGPU::DeviceName()
+{
+   return IsAvailable() ? TheDevice().name : IsoString();
+}
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxGPU::IsEnabled()
+{
+   return VeraLuxContext::Current().gpuAcceleration;
+}
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxGPU::Stretch( Image& image, const SensorProfile& profile, const FusedStretchParameters& params,
+                          const OutputScalingStats* scaling )
+{
+   if ( !IsEnabled() || !IsAvailable() )
+      return false;
+   if ( params.linearExpansion > 0.001 && !params.fixedExpansionBounds )
+      return false;
+
+   const size_type N = image.NumberOfPixels();
+   const int nChannels = image.NumberOfChannels();
+   if ( N == 0 || nChannels <= 0 || N > size_type( uint32_max ) )
+      return false;
+
+   Device& device = TheDevice();
+   const OpenCLAPI& cl = device.cl;
+   const size_type planeBytes = N*sizeof( float );
+   const size_type bytes = planeBytes*size_type( nChannels );
+   if ( device.maxAllocation > 0 && bytes > device.maxAllocation )
+      return false;
+
+   // A busy device leaves this image to the CPU
+   TryLockGuard lock( device.mutex );
+   if ( !lock )
+      return false;
+   if ( !device.Reserve( bytes ) )
+      return false;
+
+   const KernelParameters k = ParametersOf( image, profile, params, scaling );
+   cl_kernel kernel = (nChannels == 3) ? device.rgbKernel : device.monoKernel;
+
+   bool ok = true;
+   for ( int c = 0; c < nChannels && ok; ++c )
+      ok = cl.EnqueueWriteBuffer( device.queue, device.buffer, CL_FALSE, size_type( c )*planeBytes, planeBytes,
+                                  image[c], 0, nullptr, nullptr ) == CL_SUCCESS;
+   const size_t globalSize = size_t( N );
+   ok = ok && cl.SetKernelArg( kernel, 0, sizeof( cl_mem ), &device.buffer ) == CL_SUCCESS
+           && cl.SetKernelArg( kernel, 1, sizeof( k ), &k ) == CL_SUCCESS
+           && cl.EnqueueNDRangeKernel( device.queue, kernel, 1, nullptr, &globalSize, nullptr,
+                                       0, nullptr, nullptr ) == CL_SUCCESS;
+   if ( !ok )
+   {
+      // Pending writes still read the image
+      cl.Finish( device.queue );
+      return false;
+   }
+
+   for ( int c = 0; c < nChannels; ++c )
+      if ( cl.EnqueueReadBuffer( device.queue, device.buffer, CL_TRUE, size_type( c )*planeBytes, planeBytes,
+                                 image[c], 0, nullptr, nullptr ) != CL_SUCCESS )
+      {
+         cl.Finish( device.queue );
+         s_faulted.store( true, std::memory_order_relaxed );
+         throw Error( "VeraLuxGPU: failed to read back the stretched image; GPU acceleration disabled." );
+      }
+
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxGPU::ReleaseBuffers()
+{
+   // Does not load the runtime if the backend was never used
+   if ( !s_initialized.load( std::memory_order_acquire ) || !IsAvailable() )
+      return;
+   Device& device = TheDevice();
+   volatile AutoLock lock( device.mutex );
+   device.Release();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// GPU BACKEND:
+//
+// Once the global statistics and the stretch solution are known (anchor,
+// fixed linear expansion bounds, output scaling), every output pixel of the
+// fused pipeline depends on its input pixel alone: anchor subtraction,
+// luminance, arcsinh stretch, linear expansion, vector color reconstruction,
+// hybrid blend, pedestal, output scaling, MTF and soft clip. This is the
+// work of VeraLuxStreaming::Stretch(), which renders the real-time preview
+// tiles and the strips of streamed execution.
+//
+// The GPU backend evaluates that whole chain in a single OpenCL kernel, one
+// work item per pixel. The CPU still computes all statistics. The OpenCL
+// runtime is loaded dynamically, so the module has no build or run-time
+// dependency on it: without a runtime, a GPU device or a successful kernel
+// build, or while the device is busy with another image, stretches run on
+// the CPU as before.
+//
+// The device context, the compiled kernel and the device buffer are kept
+// across calls, so a preview update only pays for the transfer of the tiles
+// to be rendered and one kernel launch. The buffer only grows, up to the
+// largest image stretched, until ReleaseBuffers().
+//
+// The kernel evaluates in single precision with the device's math library.
+// Results agree with the vector kernels within about 1e-5, well below the
+// resolution of 16-bit output.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxGPU_h
+#define __VeraLuxGPU_h
+
+#include "SensorProfiles.h"
+#include "VeraLuxEngine.h"
+#include "VeraLuxPipeline.h"
+
+#include <pcl/Image.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxGPU
+ * \brief OpenCL evaluation of the fused pipeline with solved parameters.
+ *
+ * The first GPU device of the first OpenCL platform that has one is
+ * selected once, on first use. The backend is used by executions that
+ * enable it in their context (VeraLuxContext::gpuAcceleration). All member
+ * functions are thread-safe; the device runs one stretch at a time.
+ */
+class VeraLuxGPU
+{
+public:
+
+   /*!
+    * \brief Whether an OpenCL GPU device is ready for use.
+    *
+    * The first call loads the OpenCL runtime, selects the device and builds
+    * the kernel. False for the rest of the session once a result could not
+    * be read back from the device.
+    */
+   static bool IsAvailable();
+
+   /*!
+    * \brief Name of the selected device, or an empty string if none.
+    */
+   static IsoString DeviceName();
+
+   /*!
+    * \brief Whether the execution context of the calling thread enables the
+    * backend. It may still be unavailable.
+    */
+   static bool IsEnabled();
+
+   /*!
+    * \brief Stretches \a image on the device with solved parameters.
+    *
+    * Same transformation as VeraLuxPipeline::Run() followed, when
+    * \a scaling is given, by VeraLuxEngine::ApplyOutputScaling() and the
+    * Ready-to-Use soft clip. Linear expansion, if enabled in \a params,
+    * requires fixed expansion bounds.
+    *
+    * Returns false, leaving \a image unchanged, when the backend is disabled
+    * or unavailable, the device is busy, the image does not fit in device
+    * memory or a device call fails; the caller then runs the CPU path.
+    * Throws an Error, after making the device unavailable, only if the result
+    * could not be read back, since \a image may have been partially
+    * overwritten.
+    */
+   static bool Stretch( Image& image, const SensorProfile& profile, const FusedStretchParameters& params,
+                        const OutputScalingStats* scaling );
+
+   /*!
+    * \brief Frees the resident device buffer.
+    *
+    * The context and the kernel are kept.
+    */
+   static void ReleaseBuffers();
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxGPU_h
+
+// ----------------------------------------------------------------------------
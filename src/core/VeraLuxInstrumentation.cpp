@@ -0,0 +1,141 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxInstrumentation.h"
+
+#include <pcl/AutoLock.h>
+#include <pcl/File.h>
+
+#ifdef __PCL_WINDOWS
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <sys/resource.h>
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxRunLog::Add( const VeraLuxStageRecord& record )
+{
+   volatile AutoLock lock( m_mutex );
+   m_records.Add( record );
+}
+
+// ----------------------------------------------------------------------------
+
+Array<VeraLuxStageRecord> VeraLuxRunLog::Records() const
+{
+   volatile AutoLock lock( m_mutex );
+   return m_records;
+}
+
+// ----------------------------------------------------------------------------
+
+String VeraLuxRunLog::Report() const
+{
+   Array<VeraLuxStageRecord> records = Records();
+
+   String report = "Stage timings:";
+   double totalSeconds = 0;
+   size_type totalBytes = 0;
+   for ( const VeraLuxStageRecord& r : records )
+   {
+      report += String().Format( "\n  %-28s %10.3f ms %9.2f MP/s %10.1f MiB",
+                                 r.name.c_str(), r.seconds*1000, r.PixelsPerSecond()/1e6, r.bytes/1048576.0 );
+      if ( r.peakResident > 0 )
+         report += String().Format( "   peak %.1f MiB", r.peakResident/1048576.0 );
+      totalSeconds += r.seconds;
+      totalBytes += r.bytes;
+   }
+   report += String().Format( "\n  %-28s %10.3f ms %15s %10.1f MiB (run %.3f ms)",
+                              "Total", totalSeconds*1000, "", totalBytes/1048576.0, ElapsedSeconds()*1000 );
+   return report;
+}
+
+// ----------------------------------------------------------------------------
+
+IsoString VeraLuxRunLog::ToJSON( const IsoString& label, int width, int height, int channels ) const
+{
+   Array<VeraLuxStageRecord> records = Records();
+
+   // Identifiers and file names need only quotes and backslashes escaped
+   IsoString escaped;
+   for ( size_type i = 0; i < label.Length(); ++i )
+   {
+      if ( label[i] == '"' || label[i] == '\\' )
+         escaped += '\\';
+      escaped += label[i];
+   }
+
+   IsoString json = IsoString().Format( "{\"label\":\"%s\",\"width\":%d,\"height\":%d,\"channels\":%d,"
+                                        "\"seconds\":%.6f,\"peakResidentBytes\":%llu,\"stages\":[",
+                                        escaped.c_str(), width, height, channels, ElapsedSeconds(),
+                                        (unsigned long long)PeakResidentSize() );
+   for ( size_type i = 0; i < records.Length(); ++i )
+   {
+      const VeraLuxStageRecord& r = records[i];
+      json += IsoString().Format( "%s{\"name\":\"%s\",\"seconds\":%.6f,\"pixels\":%llu,\"pixelsPerSecond\":%.1f,"
+                                  "\"bytes\":%llu,\"peakResidentBytes\":%llu}",
+                                  (i > 0) ? "," : "", r.name.c_str(), r.seconds, (unsigned long long)r.pixels,
+                                  r.PixelsPerSecond(), (unsigned long long)r.bytes,
+                                  (unsigned long long)r.peakResident );
+   }
+   json += "]}";
+   return json;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxRunLog::AppendToFile( const String& path, const IsoString& label, int width, int height, int channels ) const
+{
+   File f;
+   f.OpenOrCreate( path );
+   f.SeekEnd();
+   f.OutTextLn( ToJSON( label, width, height, channels ) );
+   f.Close();
+}
+
+// ----------------------------------------------------------------------------
+
+size_type VeraLuxRunLog::PeakResidentSize()
+{
+#ifdef __PCL_WINDOWS
+   PROCESS_MEMORY_COUNTERS counters;
+   if ( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+      return size_type( counters.PeakWorkingSetSize );
+   return 0;
+#else
+   struct rusage usage;
+   if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+      return 0;
+#  ifdef __PCL_MACOSX
+   return size_type( usage.ru_maxrss );         // bytes
+#  else
+   return size_type( usage.ru_maxrss )*1024;    // KiB
+#  endif
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,204 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// STAGE INSTRUMENTATION:
+//
+// Opt-in timing of the engine stages of a run. A VeraLuxStageTimer measures
+// the scope of one stage call and appends a record to a VeraLuxRunLog:
+// elapsed time, pixels processed, bytes of the images the stage allocates
+// and the process peak resident size when the stage ends, so a run that
+// suddenly takes several times longer, or starts swapping, points at the
+// stage responsible.
+//
+// A null log pointer disables all timers; the engine is not slowed down
+// when instrumentation is off.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxInstrumentation_h
+#define __VeraLuxInstrumentation_h
+
+#include <pcl/Array.h>
+#include <pcl/ElapsedTime.h>
+#include <pcl/Mutex.h>
+#include <pcl/String.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxStageRecord
+ * \brief Measurements of one stage of a run.
+ */
+struct VeraLuxStageRecord
+{
+   IsoString name;                 //!< Stage identifier, usually the engine function
+   double    seconds = 0;          //!< Elapsed time
+   size_type pixels = 0;           //!< Pixels processed
+   size_type bytes = 0;            //!< Bytes of the images allocated by the stage
+   size_type peakResident = 0;     //!< Process peak resident size at the end of the stage, 0 if unknown
+
+   /*!
+    * Throughput in pixels per second.
+    */
+   double PixelsPerSecond() const
+   {
+      return (seconds > 0) ? pixels/seconds : 0.0;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxRunLog
+ * \brief Stage records of one run, in completion order.
+ *
+ * Thread-safe, so stages running concurrently may share a log.
+ */
+class VeraLuxRunLog
+{
+public:
+
+   VeraLuxRunLog() = default;
+
+   VeraLuxRunLog( const VeraLuxRunLog& ) = delete;
+   VeraLuxRunLog& operator =( const VeraLuxRunLog& ) = delete;
+
+   /*!
+    * \brief Appends a stage record.
+    */
+   void Add( const VeraLuxStageRecord& record );
+
+   /*!
+    * \brief Copy of the records.
+    */
+   Array<VeraLuxStageRecord> Records() const;
+
+   /*!
+    * \brief Elapsed time since the log was constructed, in seconds.
+    */
+   double ElapsedSeconds() const
+   {
+      return m_T();
+   }
+
+   /*!
+    * \brief Human-readable table of the records, one line per stage.
+    */
+   String Report() const;
+
+   /*!
+    * \brief The records as a single-line JSON object.
+    *
+    * \param label      Run identifier (e.g. the view or file name)
+    * \param width      Image width in pixels
+    * \param height     Image height in pixels
+    * \param channels   Number of channels
+    */
+   IsoString ToJSON( const IsoString& label, int width, int height, int channels ) const;
+
+   /*!
+    * \brief Appends ToJSON() as a line to a text file (JSON Lines).
+    *
+    * The file is created if it does not exist.
+    */
+   void AppendToFile( const String& path, const IsoString& label, int width, int height, int channels ) const;
+
+   /*!
+    * \brief Peak resident size of this process in bytes, 0 if unknown.
+    */
+   static size_type PeakResidentSize();
+
+private:
+
+   mutable Mutex             m_mutex;
+   Array<VeraLuxStageRecord> m_records;
+   ElapsedTime               m_T;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxStageTimer
+ * \brief Scoped timer of one stage.
+ *
+ * Records the stage in the log when destroyed, also when the stage throws.
+ * Does nothing when the log is null.
+ */
+class VeraLuxStageTimer
+{
+public:
+
+   /*!
+    * \brief Starts timing a stage.
+    *
+    * \param log     Destination log, or nullptr to disable the timer
+    * \param name    Stage identifier
+    * \param pixels  Pixels processed by the stage
+    * \param bytes   Bytes of the images allocated by the stage, if known
+    *                in advance (see AddBytes())
+    */
+   VeraLuxStageTimer( VeraLuxRunLog* log, const char* name, size_type pixels, size_type bytes = 0 )
+      : m_log( log )
+   {
+      if ( m_log != nullptr )
+      {
+         m_record.name = name;
+         m_record.pixels = pixels;
+         m_record.bytes = bytes;
+         m_T.Reset();
+      }
+   }
+
+   ~VeraLuxStageTimer()
+   {
+      if ( m_log != nullptr )
+      {
+         m_record.seconds = m_T();
+         m_record.peakResident = VeraLuxRunLog::PeakResidentSize();
+         m_log->Add( m_record );
+      }
+   }
+
+   VeraLuxStageTimer( const VeraLuxStageTimer& ) = delete;
+   VeraLuxStageTimer& operator =( const VeraLuxStageTimer& ) = delete;
+
+   /*!
+    * \brief Accounts for bytes allocated by the stage.
+    */
+   void AddBytes( size_type bytes )
+   {
+      m_record.bytes += bytes;
+   }
+
+private:
+
+   VeraLuxRunLog*     m_log;
+   VeraLuxStageRecord m_record;
+   ElapsedTime        m_T;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxInstrumentation_h
+
+// ----------------------------------------------------------------------------
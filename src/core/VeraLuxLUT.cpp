@@ -0,0 +1,219 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxLUT.h"
+
+#include <pcl/AutoLock.h>
+#include <pcl/Math.h>
+#include <pcl/Mutex.h>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Single-entry cache of the last table built for one curve type. Callers
+    * keep their own reference, so replacing the entry never invalidates a
+    * table in use by another thread. Tables are built with the kernels of
+    * the calling thread's compute precision, which is part of the key.
+    */
+   struct LUTCacheEntry
+   {
+      Mutex                                     mutex;
+      double                                    key[ 3 ] = { 0, 0, 0 };
+      ComputePrecision::value_type              precision = ComputePrecision::Default;
+      std::shared_ptr<const VeraLuxTransferLUT> table;
+
+      template <class F>
+      std::shared_ptr<const VeraLuxTransferLUT> Get( double k0, double k1, double k2, F build )
+      {
+         const ComputePrecision::value_type p = VeraLuxSIMD::Precision();
+         volatile AutoLock lock( mutex );
+         if ( !table || key[0] != k0 || key[1] != k1 || key[2] != k2 || precision != p )
+         {
+            table = build();
+            key[0] = k0;
+            key[1] = k1;
+            key[2] = k2;
+            precision = p;
+         }
+         return table;
+      }
+   };
+
+   LUTCacheEntry s_stretchCache;
+   LUTCacheEntry s_mtfCache;
+   LUTCacheEntry s_softClipCache;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+VeraLuxTransferLUT::VeraLuxTransferLUT( curve_type curve, const StretchCoefficients& stretch, double p1, double p2 )
+   : m_curve( curve )
+   , m_stretch( stretch )
+   , m_p1( p1 )
+   , m_p2( p2 )
+{
+   Build();
+}
+
+// ----------------------------------------------------------------------------
+
+std::shared_ptr<const VeraLuxTransferLUT> VeraLuxTransferLUT::Stretch( const StretchCoefficients& curve )
+{
+   return s_stretchCache.Get( curve.D, curve.b, curve.SP,
+      [&]() { return std::shared_ptr<const VeraLuxTransferLUT>(
+                        new VeraLuxTransferLUT( StretchCurve, curve, 0, 0 ) ); } );
+}
+
+// ----------------------------------------------------------------------------
+
+std::shared_ptr<const VeraLuxTransferLUT> VeraLuxTransferLUT::MTF( double m )
+{
+   return s_mtfCache.Get( m, 0, 0,
+      [&]() { return std::shared_ptr<const VeraLuxTransferLUT>(
+                        new VeraLuxTransferLUT( MTFCurve, StretchCoefficients( 1, 1 ), m, 0 ) ); } );
+}
+
+// ----------------------------------------------------------------------------
+
+std::shared_ptr<const VeraLuxTransferLUT> VeraLuxTransferLUT::SoftClip( double threshold, double rolloff )
+{
+   return s_softClipCache.Get( threshold, rolloff, 0,
+      [&]() { return std::shared_ptr<const VeraLuxTransferLUT>(
+                        new VeraLuxTransferLUT( SoftClipCurve, StretchCoefficients( 1, 1 ), threshold, rolloff ) ); } );
+}
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxTransferLUT::IsFasterThanDirect()
+{
+   return VeraLuxSIMD::ActiveInstructionSet() != SIMDInstructionSet::AVX512;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTransferLUT::Evaluate( float* data, size_type count ) const
+{
+   switch ( m_curve )
+   {
+   case StretchCurve:  VeraLuxSIMD::Stretch( data, count, m_stretch ); break;
+   case MTFCurve:      VeraLuxSIMD::MTF( data, count, m_p1 ); break;
+   case SoftClipCurve: VeraLuxSIMD::SoftClip( data, count, m_p1, m_p2 ); break;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTransferLUT::Build()
+{
+   // Nodes, plus a guard entry so x = 1 interpolates without a branch
+   m_table.resize( Resolution + 2 );
+   for ( int i = 0; i <= Resolution; ++i )
+      m_table[i] = float( double( i )/Resolution );
+   Evaluate( m_table.data(), Resolution + 1 );
+   m_table[Resolution + 1] = m_table[Resolution];
+
+   // Exact values at interval midpoints, where the interpolation error of a
+   // smooth curve peaks
+   std::vector<float> mid( Resolution );
+   for ( int i = 0; i < Resolution; ++i )
+      mid[i] = float( (i + 0.5)/Resolution );
+   Evaluate( mid.data(), Resolution );
+
+   // Inexact intervals are steep ends of the curve: the arcsinh and MTF
+   // shadows, or the MTF highlights for m close to one. Everything below the
+   // last inexact interval in the lower half, and above the first one in
+   // the upper half, is evaluated directly.
+   int low = 0, high = Resolution;
+   for ( int i = 0; i < Resolution; ++i )
+      if ( Abs( 0.5*(double( m_table[i] ) + m_table[i+1]) - mid[i] ) > Tolerance )
+      {
+         if ( i < Resolution/2 )
+            low = i + 1;
+         else if ( high == Resolution )
+            high = i;
+      }
+
+   m_maxError = 0;
+   for ( int i = low; i < high; ++i )
+      m_maxError = Max( m_maxError, Abs( 0.5*(double( m_table[i] ) + m_table[i+1]) - mid[i] ) );
+
+   m_directBelow = float( double( low )/Resolution );
+   m_directAbove = (high < Resolution) ? float( double( high )/Resolution ) : 2.0f;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTransferLUT::Apply( float* data, size_type count ) const
+{
+   const float* table = m_table.data();
+   const float scale = float( Resolution );
+
+   if ( m_directBelow <= 0 && m_directAbove > 1 )
+   {
+      for ( size_type i = 0; i < count; ++i )
+      {
+         float f = Range( data[i], 0.0f, 1.0f ) * scale;
+         int k = int( f );
+         data[i] = table[k] + (f - k)*(table[k+1] - table[k]);
+      }
+      return;
+   }
+
+   // Samples in the inexact ranges are gathered and evaluated directly
+   float direct[ VeraLuxSIMD::BlockSize ];
+   int index[ VeraLuxSIMD::BlockSize ];
+   for ( size_type i0 = 0; i0 < count; i0 += VeraLuxSIMD::BlockSize )
+   {
+      int n = int( Min( size_type( VeraLuxSIMD::BlockSize ), count - i0 ) );
+      float* block = data + i0;
+      int m = 0;
+      for ( int j = 0; j < n; ++j )
+      {
+         float x = Range( block[j], 0.0f, 1.0f );
+         if ( x < m_directBelow || x >= m_directAbove )
+         {
+            index[m] = j;
+            direct[m++] = x;
+         }
+         else
+         {
+            float f = x * scale;
+            int k = int( f );
+            block[j] = table[k] + (f - k)*(table[k+1] - table[k]);
+         }
+      }
+
+      if ( m > 0 )
+      {
+         Evaluate( direct, m );
+         for ( int j = 0; j < m; ++j )
+            block[index[j]] = direct[j];
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
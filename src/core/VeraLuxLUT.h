@@ -0,0 +1,149 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// LOOKUP TABLE TRANSFER FUNCTIONS:
+//
+// A transfer curve on [0,1] is sampled at 65537 uniformly spaced nodes with
+// the VeraLuxSIMD kernels and evaluated by linear interpolation. When the
+// table is built, the interpolation error is measured at the midpoint of
+// every interval. Intervals where it exceeds half of a 16-bit quantization
+// step (steep arcsinh shadows at very high Log D, MTF with tiny m) are
+// evaluated directly, so results stay within about 8e-6 of the direct
+// kernels: invisible once written to 8 or 16-bit integer images.
+//
+// Tables are cached per curve type and rebuilt only when the curve
+// coefficients change.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxLUT_h
+#define __VeraLuxLUT_h
+
+#include "VeraLuxSIMD.h"
+
+#include <memory>
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxTransferLUT
+ * \brief Interpolated lookup table of a VeraLuxSIMD transfer function.
+ *
+ * Instances are immutable once built and can be shared by any number of
+ * threads. Use the cached factory functions instead of building tables
+ * directly.
+ */
+class VeraLuxTransferLUT
+{
+public:
+
+   /*!
+    * Number of uniform intervals on [0,1].
+    */
+   static constexpr int Resolution = 65536;
+
+   /*!
+    * Maximum interpolation error: half of a 16-bit quantization step.
+    */
+   static constexpr double Tolerance = 0.5/65535;
+
+   /*!
+    * \brief Cached table of the normalized arcsinh stretch.
+    */
+   static std::shared_ptr<const VeraLuxTransferLUT> Stretch( const StretchCoefficients& curve );
+
+   /*!
+    * \brief Cached table of the midtone transfer function.
+    */
+   static std::shared_ptr<const VeraLuxTransferLUT> MTF( double m );
+
+   /*!
+    * \brief Cached table of the Ready-to-Use highlight soft clip.
+    */
+   static std::shared_ptr<const VeraLuxTransferLUT> SoftClip( double threshold, double rolloff );
+
+   /*!
+    * \brief Whether tables are expected to be faster than direct evaluation.
+    *
+    * True unless the AVX-512 kernels are active, which evaluate the
+    * transfer functions about as fast as the table can be interpolated.
+    */
+   static bool IsFasterThanDirect();
+
+   /*!
+    * \brief Transforms \a count samples in-place.
+    *
+    * Input samples are clamped to [0,1]. Samples outside the accurate range
+    * of the table are evaluated with the direct kernel.
+    */
+   void Apply( float* data, size_type count ) const;
+
+   /*!
+    * \brief Inputs below this value bypass the table.
+    */
+   float DirectBelow() const
+   {
+      return m_directBelow;
+   }
+
+   /*!
+    * \brief Inputs at or above this value bypass the table; greater than
+    * one when the table is accurate up to x = 1.
+    */
+   float DirectAbove() const
+   {
+      return m_directAbove;
+   }
+
+   /*!
+    * \brief Maximum interpolation error measured over the accurate range.
+    */
+   double MaxError() const
+   {
+      return m_maxError;
+   }
+
+private:
+
+   enum curve_type { StretchCurve, MTFCurve, SoftClipCurve };
+
+   curve_type          m_curve;
+   StretchCoefficients m_stretch;
+   double              m_p1 = 0, m_p2 = 0;  // m, or threshold and rolloff
+   std::vector<float>  m_table;             // Resolution+1 nodes plus one guard entry
+   float               m_directBelow = 0;
+   float               m_directAbove = 2;
+   double              m_maxError = 0;
+
+   VeraLuxTransferLUT( curve_type curve, const StretchCoefficients& stretch, double p1, double p2 );
+
+   void Evaluate( float* data, size_type count ) const;
+   void Build();
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxLUT_h
+
+// ----------------------------------------------------------------------------
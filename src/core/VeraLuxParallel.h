@@ -0,0 +1,224 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxParallel_h
+#define __VeraLuxParallel_h
+
+#include "VeraLuxContext.h"
+#include "VeraLuxTopology.h"
+
+#include <pcl/AbstractImage.h>
+
+#ifdef VERALUX_HEADLESS
+#  include <thread>
+#  include <vector>
+#else
+#  include <pcl/ReferenceArray.h>
+#  include <pcl/Thread.h>
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+#ifndef VERALUX_HEADLESS
+
+/*!
+ * \class VeraLuxRowBandThread
+ * \brief Worker thread that runs a kernel over a contiguous band of rows.
+ *
+ * The kernel is shared by all threads of a run and must only read shared
+ * state or write to disjoint regions (its own band). The kernel runs in the
+ * execution context of the thread that created the band.
+ */
+template <class K>
+class VeraLuxRowBandThread : public Thread
+{
+public:
+
+   VeraLuxRowBandThread( const K& kernel, const VeraLuxContext& context, int startRow, int endRow )
+      : m_kernel( kernel )
+      , m_context( context )
+      , m_startRow( startRow )
+      , m_endRow( endRow )
+   {
+   }
+
+   void Run() override
+   {
+      VeraLuxContext::Scope scope( m_context );
+      m_kernel( m_startRow, m_endRow );
+   }
+
+private:
+
+   const K&              m_kernel;
+   const VeraLuxContext& m_context;
+   int                   m_startRow;
+   int                   m_endRow;
+};
+
+#endif   // !VERALUX_HEADLESS
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxParallel
+ * \brief Row-band parallel execution layer for the VeraLux engine kernels.
+ *
+ * Splits an image into horizontal bands of rows and runs one PCL Thread per
+ * band. Every band is processed with exactly the same per-sample arithmetic
+ * as a serial loop, so results do not depend on the number of threads.
+ *
+ * The thread count is taken from the parallel processing settings of the
+ * image being processed (AbstractImage::EnableParallelProcessing), which in
+ * turn are bounded by the global PixInsight preferences through
+ * Thread::OptimalThreadLoads(), and by the processors available to the
+ * calling thread (VeraLuxTopology::Processors()). The thread limit of the
+ * execution context (VeraLuxContext::maxThreads) caps all of them.
+ *
+ * Every band runs in the execution context of the calling thread (see
+ * VeraLuxContext), so all bands of a pass use the same settings.
+ *
+ * Band i of n is pinned to the same processor in every pass, so each band
+ * runs on the NUMA node where the first parallel pass over the geometry
+ * placed its pages. Buffers written first by a row band pass are therefore
+ * local to the threads that read them later.
+ *
+ * PCL threads need the PixInsight core application. Standalone tools
+ * built with VERALUX_HEADLESS defined run the same bands on std::thread,
+ * pinned with VeraLuxTopology::PinCurrentThread().
+ */
+class VeraLuxParallel
+{
+public:
+
+   /*!
+    * Minimum number of rows assigned to a single thread.
+    */
+   static constexpr int RowsPerThreadLimit = 16;
+
+   /*!
+    * \brief Maximum number of threads allowed for the specified image.
+    */
+   static int MaxThreads( const AbstractImage& image )
+   {
+      return image.IsParallelProcessingEnabled() ? Max( 1, image.MaxProcessors() ) : 1;
+   }
+
+   /*!
+    * \brief Thread count of a pass limited to \a maxThreads, within the
+    * thread limit of the execution context. At least one.
+    */
+   static int ThreadLimit( int maxThreads )
+   {
+      const int contextLimit = VeraLuxContext::Current().maxThreads;
+      return Max( 1, (contextLimit > 0) ? Min( maxThreads, contextLimit ) : maxThreads );
+   }
+
+   /*!
+    * \brief Runs kernel( startRow, endRow ) over [0,rows) in row bands.
+    *
+    * Runs inline on the calling thread when a single band is enough.
+    */
+   template <class K>
+   static void ForEachRowBand( int rows, int maxThreads, const K& kernel )
+   {
+      if ( rows <= 0 )
+         return;
+
+      maxThreads = ThreadLimit( maxThreads );
+
+#ifdef VERALUX_HEADLESS
+      const std::vector<int> processors = VeraLuxTopology::Processors();
+      const int n = Max( 1, Min( Min( maxThreads, int( processors.size() ) ), rows/RowsPerThreadLimit ) );
+      if ( n == 1 )
+      {
+         kernel( 0, rows );
+         return;
+      }
+
+      const VeraLuxContext& context = VeraLuxContext::Current();
+      std::vector<std::thread> threads;
+      threads.reserve( n );
+      for ( int i = 0; i < n; ++i )
+      {
+         const int startRow = int( int64( rows )*i/n );
+         const int endRow = int( int64( rows )*(i + 1)/n );
+         const int processor = VeraLuxTopology::BandProcessor( processors, i, n );
+         threads.emplace_back( [&kernel, &context, startRow, endRow, processor]()
+                               {
+                                  VeraLuxContext::Scope scope( context );
+                                  VeraLuxTopology::PinCurrentThread( processor );
+                                  kernel( startRow, endRow );
+                               } );
+      }
+      for ( std::thread& thread : threads )
+         thread.join();
+#else
+      const std::vector<int> processors = VeraLuxTopology::Processors();
+      Array<size_type> L = Thread::OptimalThreadLoads( size_type( rows ),
+                                                       size_type( RowsPerThreadLimit ),
+                                                       Max( 1, Min( maxThreads, int( processors.size() ) ) ) );
+      if ( L.Length() <= 1 )
+      {
+         kernel( 0, rows );
+         return;
+      }
+
+      const VeraLuxContext& context = VeraLuxContext::Current();
+      ReferenceArray<VeraLuxRowBandThread<K> > threads;
+      for ( int i = 0, n = 0; i < int( L.Length() ); n += int( L[i++] ) )
+         threads.Add( new VeraLuxRowBandThread<K>( kernel, context, n, n + int( L[i] ) ) );
+
+      for ( int i = 0, n = int( threads.Length() ); i < n; ++i )
+         threads[i].Start( ThreadPriority::DefaultMax, VeraLuxTopology::BandProcessor( processors, i, n ) );
+      for ( int i = 0; i < int( threads.Length() ); ++i )
+         threads[i].Wait();
+
+      threads.Destroy();
+#endif
+   }
+
+   /*!
+    * \brief Runs kernel( begin, end ) over the pixel index range of an image.
+    *
+    * The image is split into row bands and each band is passed to the kernel
+    * as a half-open range of linear pixel offsets, suitable for indexing
+    * channel pointers directly.
+    */
+   template <class K>
+   static void ForEachPixelBand( const AbstractImage& image, const K& kernel )
+   {
+      const size_type width = size_type( image.Width() );
+      ForEachRowBand( image.Height(), MaxThreads( image ),
+         [&]( int startRow, int endRow )
+         {
+            kernel( size_type( startRow )*width, size_type( endRow )*width );
+         } );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxParallel_h
+
+// ----------------------------------------------------------------------------
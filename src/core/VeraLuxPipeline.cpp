@@ -0,0 +1,509 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxPipeline.h"
+#include "VeraLuxLUT.h"
+#include "VeraLuxParallel.h"
+#include "VeraLuxSIMD.h"
+
+#include <pcl/Math.h>
+
+#include <memory>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   inline float Clamp01( float v )
+   {
+      return (v < 0) ? 0.0f : ((v > 1) ? 1.0f : v);
+   }
+
+   /*
+    * Linear expansion of the stretched luminance. Measured bounds take the
+    * Smart Max peak from the neighborhoods of params.peak, stretched like
+    * the image, when given.
+    */
+   void ExpandLinear( Image& target, const SensorProfile& profile, const FusedStretchParameters& params,
+                      LinearExpansionStats* diagnostics )
+   {
+      if ( params.fixedExpansionBounds )
+      {
+         VeraLuxEngine::ApplyLinearExpansion( target, float( params.linearExpansion ),
+                                              params.expansionLow, params.expansionHigh );
+         if ( diagnostics )
+         {
+            diagnostics->low = params.expansionLow;
+            diagnostics->high = params.expansionHigh;
+         }
+         return;
+      }
+
+      Image peakLuma;
+      if ( params.peak != nullptr && !params.peak->IsEmpty() )
+      {
+         VeraLuxEngine::ExtractLuminance( peakLuma, *params.peak, params.anchor, profile );
+         VeraLuxEngine::HyperbolicStretch( peakLuma, params.D, params.b, 0.0, params.transfer );
+      }
+      VeraLuxEngine::ApplyLinearExpansion( target, float( params.linearExpansion ), diagnostics, params.estimator,
+                                           peakLuma.IsEmpty() ? nullptr : &peakLuma );
+   }
+
+   /*
+    * Arcsinh stretch of a variant, through its lookup table when the
+    * transfer evaluation uses one.
+    */
+   class StretchFunction
+   {
+   public:
+
+      StretchFunction( const FusedStretchParameters& params )
+         : m_curve( params.D, params.b )
+         , m_lut( (params.transfer == TransferEvaluation::LookupTable) ? VeraLuxTransferLUT::Stretch( m_curve ) : nullptr )
+      {
+      }
+
+      void operator()( float* data, size_type count ) const
+      {
+         if ( m_lut )
+            m_lut->Apply( data, count );
+         else
+            VeraLuxSIMD::Stretch( data, count, m_curve );
+      }
+
+   private:
+
+      StretchCoefficients                       m_curve;
+      std::shared_ptr<const VeraLuxTransferLUT> m_lut;
+   };
+
+   /*
+    * Input of the RGB color reconstruction, shared by all variants rendered
+    * from the same image.
+    */
+   struct RGBSource
+   {
+      const float*     R;
+      const float*     G;
+      const float*     B;
+      float            anchor;
+      LuminanceWeights weights;
+   };
+
+   /*
+    * Output and per-variant state of the RGB color reconstruction. The
+    * output planes may be the source planes.
+    */
+   struct RGBVariant
+   {
+      float*       R;
+      float*       G;
+      float*       B;
+      const float* stretchedLuma;  // expanded luminance plane, or nullptr
+      float        convergence;
+      float        grip;
+      float        shadowPower;
+   };
+
+   /*
+    * Anchored RGB and unstretched luminance of an L1-sized block.
+    */
+   struct RGBBlock
+   {
+      float ra[ VeraLuxSIMD::BlockSize ], ga[ VeraLuxSIMD::BlockSize ], ba[ VeraLuxSIMD::BlockSize ];
+      float L[ VeraLuxSIMD::BlockSize ];
+   };
+
+   template <bool Luminance>
+   void LoadRGBBlock( RGBBlock& block, const RGBSource& s, size_type i0, size_type n )
+   {
+      const float* R = s.R + i0;
+      const float* G = s.G + i0;
+      const float* B = s.B + i0;
+
+      // Anchor subtraction
+      for ( size_type j = 0; j < n; ++j )
+      {
+         block.ra[j] = Max( 0.0f, R[j] - s.anchor );
+         block.ga[j] = Max( 0.0f, G[j] - s.anchor );
+         block.ba[j] = Max( 0.0f, B[j] - s.anchor );
+      }
+
+      // Photometric luminance
+      if ( Luminance )
+         for ( size_type j = 0; j < n; ++j )
+            block.L[j] = s.weights( block.ra[j], block.ga[j], block.ba[j] );
+   }
+
+   /*
+    * RGB color reconstruction of a block, specialized at compile time on
+    * whether the luminance plane is precomputed (linear expansion), the
+    * hybrid blend is active and shadow convergence damps the grip. Inactive
+    * stages are removed by the compiler instead of being tested per pixel.
+    *
+    * The transcendental parts (stretch and powers) run through the vector
+    * kernels on block buffers, the rest stays in per-pixel loops.
+    */
+   template <bool Expanded, bool Hybrid, bool Shadow>
+   void RenderRGBBlock( const RGBBlock& block, const RGBVariant& v, const StretchFunction& stretch,
+                        size_type i0, size_type n )
+   {
+      static_assert( Hybrid || !Shadow, "Shadow convergence is part of the hybrid blend" );
+
+      const float epsilon = 1e-9f;
+      const float* ra = block.ra;
+      const float* ga = block.ga;
+      const float* ba = block.ba;
+
+      float sR[ VeraLuxSIMD::BlockSize ], sG[ VeraLuxSIMD::BlockSize ], sB[ VeraLuxSIMD::BlockSize ];
+      float L[ VeraLuxSIMD::BlockSize ], K[ VeraLuxSIMD::BlockSize ], damping[ VeraLuxSIMD::BlockSize ];
+
+      // Stretched luminance
+      if ( Expanded )
+      {
+         for ( size_type j = 0; j < n; ++j )
+            L[j] = v.stretchedLuma[i0 + j];
+      }
+      else
+      {
+         for ( size_type j = 0; j < n; ++j )
+            L[j] = block.L[j];
+         stretch( L, n );
+      }
+
+      // Convergence to white
+      VeraLuxSIMD::Pow( L, K, n, v.convergence );
+
+      // Scalar stretch and grip map for the hybrid blend
+      if ( Hybrid )
+      {
+         for ( size_type j = 0; j < n; ++j )
+         {
+            sR[j] = ra[j];
+            sG[j] = ga[j];
+            sB[j] = ba[j];
+         }
+         stretch( sR, n );
+         stretch( sG, n );
+         stretch( sB, n );
+         if ( Shadow )
+            VeraLuxSIMD::Pow( L, damping, n, v.shadowPower );
+      }
+
+      float* outputR = v.R + i0;
+      float* outputG = v.G + i0;
+      float* outputB = v.B + i0;
+      for ( size_type j = 0; j < n; ++j )
+      {
+         // Color vector with convergence to white
+         float sum = ra[j] + ga[j] + ba[j] + epsilon;
+         float k = K[j];
+         float kInv = 1.0f - k;
+         float outR = L[j] * ((ra[j]/sum) * kInv + k);
+         float outG = L[j] * ((ga[j]/sum) * kInv + k);
+         float outB = L[j] * ((ba[j]/sum) * kInv + k);
+
+         // Hybrid blend with the scalar stretch
+         if ( Hybrid )
+         {
+            float gripMap = Shadow ? v.grip * damping[j] : v.grip;
+            float gripInv = 1.0f - gripMap;
+            outR = outR * gripMap + sR[j] * gripInv;
+            outG = outG * gripMap + sG[j] * gripInv;
+            outB = outB * gripMap + sB[j] * gripInv;
+         }
+
+         // Pedestal
+         outputR[j] = Clamp01( outR * 0.995f + 0.005f );
+         outputG[j] = Clamp01( outG * 0.995f + 0.005f );
+         outputB[j] = Clamp01( outB * 0.995f + 0.005f );
+      }
+   }
+
+   template <bool Expanded, bool Hybrid, bool Shadow>
+   void ReconstructRGB( const Image& image, const RGBSource& s, const RGBVariant& v, const StretchFunction& stretch )
+   {
+      VeraLuxParallel::ForEachPixelBand( image,
+         [&]( size_type begin, size_type end )
+         {
+            const size_type blockSize = size_type( VeraLuxSIMD::BlockSize );
+            RGBBlock block;
+            for ( size_type i0 = begin; i0 < end; i0 += blockSize )
+            {
+               const size_type n = Min( blockSize, end - i0 );
+               LoadRGBBlock<!Expanded>( block, s, i0, n );
+               RenderRGBBlock<Expanded, Hybrid, Shadow>( block, v, stretch, i0, n );
+            }
+         } );
+   }
+
+   /*
+    * Selects the instantiation for the active stages.
+    */
+   template <bool Expanded>
+   void ReconstructRGB( const Image& image, const RGBSource& s, const RGBVariant& v, const StretchFunction& stretch,
+                        bool hybrid, bool shadow )
+   {
+      if ( shadow )
+         ReconstructRGB<Expanded, true, true>( image, s, v, stretch );
+      else if ( hybrid )
+         ReconstructRGB<Expanded, true, false>( image, s, v, stretch );
+      else
+         ReconstructRGB<Expanded, false, false>( image, s, v, stretch );
+   }
+
+   typedef void (*render_function)( const RGBBlock&, const RGBVariant&, const StretchFunction&, size_type, size_type );
+
+   /*
+    * Block renderer for the active stages of a variant, for passes that
+    * render several variants per block.
+    */
+   render_function SelectRender( bool expanded, bool hybrid, bool shadow )
+   {
+      if ( expanded )
+         return shadow ? RenderRGBBlock<true, true, true> :
+                         (hybrid ? RenderRGBBlock<true, true, false> : RenderRGBBlock<true, false, false>);
+      return shadow ? RenderRGBBlock<false, true, true> :
+                      (hybrid ? RenderRGBBlock<false, true, false> : RenderRGBBlock<false, false, false>);
+   }
+
+   /*
+    * Anchored, stretched and expanded luminance plane of a variant with
+    * linear expansion, whose bounds are statistics of the stretched data.
+    */
+   void ExpandedLuminance( Image& luma, const Image& image, const RGBSource& s, const StretchFunction& stretch,
+                           const SensorProfile& profile, const FusedStretchParameters& params,
+                           LinearExpansionStats* diagnostics )
+   {
+      luma.EnableParallelProcessing( image.IsParallelProcessingEnabled(), image.MaxProcessors() );
+
+      float* l = luma[0];
+      VeraLuxParallel::ForEachPixelBand( image,
+         [&]( size_type begin, size_type end )
+         {
+            for ( size_type i = begin; i < end; ++i )
+            {
+               float ra = Max( 0.0f, s.R[i] - s.anchor );
+               float ga = Max( 0.0f, s.G[i] - s.anchor );
+               float ba = Max( 0.0f, s.B[i] - s.anchor );
+               l[i] = s.weights( ra, ga, ba );
+            }
+            stretch( l + begin, end - begin );
+         } );
+
+      ExpandLinear( luma, profile, params, diagnostics );
+   }
+
+   RGBSource SourceOf( const Image& image, const SensorProfile& profile, double anchor )
+   {
+      return { image[0], image[1], image[2], float( anchor ),
+               LuminanceWeights( profile.weights ) };
+   }
+
+   RGBVariant VariantOf( Image& target, const FusedStretchParameters& params, const float* stretchedLuma )
+   {
+      RGBVariant v;
+      v.R = target[0];
+      v.G = target[1];
+      v.B = target[2];
+      v.stretchedLuma = stretchedLuma;
+      v.convergence = float( params.colorConvergence );
+      v.grip = float( params.colorGrip );
+      v.shadowPower = float( params.shadowConvergence );
+      return v;
+   }
+
+   bool HasShadow( const FusedStretchParameters& params )
+   {
+      return params.shadowConvergence > 0.01;
+   }
+
+   bool IsHybrid( const FusedStretchParameters& params )
+   {
+      return (params.colorGrip < 1.0) || HasShadow( params );
+   }
+
+   bool IsExpanded( const FusedStretchParameters& params )
+   {
+      return params.linearExpansion > 0.001;
+   }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxPipeline::Run( Image& image, const SensorProfile& profile,
+                           const FusedStretchParameters& params,
+                           LinearExpansionStats* diagnostics,
+                           VeraLuxWorkspace* workspace )
+{
+   const StretchFunction stretch( params );
+   const float anchorF = float( params.anchor );
+   const bool linearExpansion = IsExpanded( params );
+
+   if ( image.NumberOfChannels() != 3 )
+   {
+      /*
+       * Mono (and any non-RGB): every channel is its own luminance. The step
+       * path copies the stretched luminance without pedestal.
+       */
+      const int nChannels = image.NumberOfChannels();
+      VeraLuxParallel::ForEachPixelBand( image,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+            {
+               float* data = image[c];
+               for ( size_type i = begin; i < end; ++i )
+                  data[i] = Max( 0.0f, data[i] - anchorF );
+               stretch( data + begin, end - begin );
+            }
+         } );
+
+      if ( linearExpansion )
+         ExpandLinear( image, profile, params, diagnostics );
+      return;
+   }
+
+   const RGBSource s = SourceOf( image, profile, params.anchor );
+
+   /*
+    * Linear expansion bounds are statistics of the stretched luminance, so
+    * in that case the luminance plane is produced (and expanded) first.
+    */
+   VeraLuxWorkspace::ImageLease lumaLease( workspace, image.Width(), image.Height(), linearExpansion ? 1 : 0 );
+   Image& luma = *lumaLease;
+   if ( linearExpansion )
+      ExpandedLuminance( luma, image, s, stretch, profile, params, diagnostics );
+
+   const RGBVariant v = VariantOf( image, params, linearExpansion ? luma[0] : nullptr );
+
+   if ( linearExpansion )
+      ReconstructRGB<true>( image, s, v, stretch, IsHybrid( params ), HasShadow( params ) );
+   else
+      ReconstructRGB<false>( image, s, v, stretch, IsHybrid( params ), HasShadow( params ) );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxPipeline::Run( const Image& source, std::vector<Image>& targets, const SensorProfile& profile,
+                           const std::vector<FusedStretchParameters>& params,
+                           std::vector<LinearExpansionStats>* diagnostics,
+                           VeraLuxWorkspace* workspace )
+{
+   const size_type count = params.size();
+   targets.resize( count );
+   if ( diagnostics != nullptr )
+      diagnostics->assign( count, LinearExpansionStats() );
+   if ( count == 0 )
+      return;
+
+   for ( const FusedStretchParameters& p : params )
+      if ( p.anchor != params[0].anchor )
+         throw Error( "VeraLuxPipeline::Run(): all variants must share the same anchor." );
+
+   // Targets are first written by the row bands that render them
+   for ( Image& target : targets )
+   {
+      if ( target.Width() != source.Width() || target.Height() != source.Height() ||
+           target.NumberOfChannels() != source.NumberOfChannels() )
+         target.AllocateData( source.Width(), source.Height(), source.NumberOfChannels() );
+      target.EnableParallelProcessing( source.IsParallelProcessingEnabled(), source.MaxProcessors() );
+   }
+
+   std::vector<StretchFunction> stretch;
+   stretch.reserve( count );
+   for ( const FusedStretchParameters& p : params )
+      stretch.emplace_back( p );
+
+   const float anchorF = float( params[0].anchor );
+
+   if ( source.NumberOfChannels() != 3 )
+   {
+      const int nChannels = source.NumberOfChannels();
+      VeraLuxParallel::ForEachPixelBand( source,
+         [&]( size_type begin, size_type end )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+            {
+               const float* data = source[c];
+               for ( size_type k = 0; k < count; ++k )
+               {
+                  float* output = targets[k][c];
+                  for ( size_type i = begin; i < end; ++i )
+                     output[i] = Max( 0.0f, data[i] - anchorF );
+                  stretch[k]( output + begin, end - begin );
+               }
+            }
+         } );
+
+      for ( size_type k = 0; k < count; ++k )
+         if ( IsExpanded( params[k] ) )
+            ExpandLinear( targets[k], profile, params[k], (diagnostics != nullptr) ? &(*diagnostics)[k] : nullptr );
+      return;
+   }
+
+   const RGBSource s = SourceOf( source, profile, params[0].anchor );
+
+   // One extra pass over the source for each variant with linear expansion
+   std::vector<Image> luma( count );
+   std::vector<RGBVariant> variants( count );
+   std::vector<render_function> render( count );
+   for ( size_type k = 0; k < count; ++k )
+   {
+      const bool expanded = IsExpanded( params[k] );
+      if ( expanded )
+      {
+         luma[k] = (workspace != nullptr) ? workspace->AcquireImage( source.Width(), source.Height(), 1 ) : Image();
+         if ( luma[k].IsEmpty() )
+            luma[k].AllocateData( source.Width(), source.Height(), 1 );
+         ExpandedLuminance( luma[k], source, s, stretch[k], profile, params[k],
+                            (diagnostics != nullptr) ? &(*diagnostics)[k] : nullptr );
+      }
+      variants[k] = VariantOf( targets[k], params[k], expanded ? luma[k][0] : nullptr );
+      render[k] = SelectRender( expanded, IsHybrid( params[k] ), HasShadow( params[k] ) );
+   }
+
+   // Each source block is read and anchored once for all variants
+   VeraLuxParallel::ForEachPixelBand( source,
+      [&]( size_type begin, size_type end )
+      {
+         const size_type blockSize = size_type( VeraLuxSIMD::BlockSize );
+         RGBBlock block;
+         for ( size_type i0 = begin; i0 < end; i0 += blockSize )
+         {
+            const size_type n = Min( blockSize, end - i0 );
+            LoadRGBBlock<true>( block, s, i0, n );
+            for ( size_type k = 0; k < count; ++k )
+               render[k]( block, variants[k], stretch[k], i0, n );
+         }
+      } );
+
+   if ( workspace != nullptr )
+      for ( Image& plane : luma )
+         workspace->ReleaseImage( plane );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,143 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxPipeline_h
+#define __VeraLuxPipeline_h
+
+#include "SensorProfiles.h"
+#include "VeraLuxEngine.h"
+
+#include <pcl/Image.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct FusedStretchParameters
+ * \brief Per-pixel parameters of the fused stretch pipeline.
+ *
+ * Global statistics (the anchor) must be known before the pipeline runs.
+ * Linear expansion bounds are measured on the stretched image, unless they
+ * are given as fixed bounds, as in streamed execution, where each strip must
+ * be expanded with the bounds of the whole image.
+ * Effective grip/shadow/expansion values are those returned by
+ * HyperMetricStretchInstance::GetEffectiveParams().
+ */
+struct FusedStretchParameters
+{
+   double anchor            = 0.0;    //!< Black point subtracted from every channel
+   double D                 = 100.0;  //!< Stretch factor (10^logD)
+   double b                 = 6.0;    //!< Highlight protection
+   double colorConvergence  = 3.5;    //!< Star white point power
+   double colorGrip         = 1.0;    //!< Vector preservation [0,1]
+   double shadowConvergence = 0.0;    //!< Shadow noise damping power
+   double linearExpansion   = 0.0;    //!< Linear expansion amount, 0 = disabled
+   StatisticsEstimator::value_type estimator = StatisticsEstimator::Default; //!< Linear expansion bounds estimator
+   bool   fixedExpansionBounds = false; //!< Use expansionLow/High instead of measuring the stretched image
+   double expansionLow      = 0.0;    //!< Known linear expansion low bound
+   double expansionHigh     = 0.0;    //!< Known linear expansion high bound
+   const Image* peak        = nullptr; //!< Smart Max neighborhoods of the input (VeraLuxStreamAnalysis::peak), or nullptr to search the stretched image
+   TransferEvaluation::value_type transfer = TransferEvaluation::Default;    //!< Stretch evaluation
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxPipeline
+ * \brief Fused single-pass implementation of the HyperMetric Stretch core.
+ *
+ * Runs anchor subtraction, photometric luminance, arcsinh stretch, vector
+ * color reconstruction, hybrid blending and the output pedestal in a single
+ * streaming pass per row band, writing the result over the input buffer.
+ * No full-size temporaries are allocated, except for the stretched
+ * luminance plane when linear expansion is enabled, since its bounds are
+ * statistics of the stretched data. Each band is split into small blocks so
+ * the arcsinh and power functions can run through the VeraLuxSIMD kernels.
+ *
+ * The RGB block kernel is instantiated for each combination of
+ * precomputed luminance (linear expansion), hybrid blending and shadow
+ * convergence, and Run() selects one per call, so inactive stages cost
+ * nothing in the inner loops. Channel count and processing mode reduce to
+ * these choices: mono images take a separate single-channel loop, and
+ * linear expansion is only enabled by the Scientific mode. Each block is
+ * loaded (anchored, weighted into luminance) separately from its rendering,
+ * so parameter sweeps render all their variants from one load per block.
+ *
+ * Equivalent to the step-by-step sequence ExtractLuminance(),
+ * HyperbolicStretch(), ApplyLinearExpansion(), SubtractAnchor() and
+ * ReconstructColor(), which remains available for validation. Results agree
+ * within float rounding of the reordered operations.
+ */
+class VeraLuxPipeline
+{
+public:
+
+   /*!
+    * \brief Applies the fused stretch pipeline in-place.
+    *
+    * \param[in,out] image         Normalized input; stretched color output
+    * \param         profile       Sensor profile for luminance weights
+    * \param         params        Pipeline parameters
+    * \param[out]    diagnostics   Optional linear expansion statistics
+    * \param         workspace     Optional pool for the luminance plane
+    */
+   static void Run( Image& image, const SensorProfile& profile,
+                    const FusedStretchParameters& params,
+                    LinearExpansionStats* diagnostics = nullptr,
+                    VeraLuxWorkspace* workspace = nullptr );
+
+   /*!
+    * \brief Renders several parameter variants of one image in a single pass.
+    *
+    * Each block of \a source is read, anchored and weighted into luminance
+    * once, then stretched and reconstructed with every variant, so the input
+    * is streamed from memory once for all of them. Variants with linear
+    * expansion need their stretched luminance planes first: one extra pass
+    * over the source each.
+    *
+    * Every variant gives the same result as the in-place Run() on a copy of
+    * \a source. All variants must share the same anchor, a statistic of the
+    * input.
+    *
+    * \param         source        Normalized input
+    * \param[out]    targets       Stretched output of each variant, resized
+    *                              to the number of variants and reallocated
+    *                              to the source geometry as needed
+    * \param         profile       Sensor profile for luminance weights
+    * \param         params        Pipeline parameters of each variant
+    * \param[out]    diagnostics   Optional linear expansion statistics of
+    *                              each variant
+    * \param         workspace     Optional pool for the luminance planes
+    */
+   static void Run( const Image& source, std::vector<Image>& targets, const SensorProfile& profile,
+                    const std::vector<FusedStretchParameters>& params,
+                    std::vector<LinearExpansionStats>* diagnostics = nullptr,
+                    VeraLuxWorkspace* workspace = nullptr );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxPipeline_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,274 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxContext.h"
+#include "VeraLuxSIMD.h"
+#include "VeraLuxSIMDKernels.h"
+
+#include <pcl/Math.h>
+
+#include <atomic>
+
+#if defined( VERALUX_SIMD_X86 ) && defined( _MSC_VER ) && !defined( __clang__ )
+#  include <intrin.h>
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+StretchCoefficients::StretchCoefficients( double D_, double b_, double SP_ )
+{
+   D = Max( D_, 0.1 );
+   b = Max( b_, 0.1 );
+   SP = SP_;
+   term2 = ArcSinh( b );
+   sb = Sqrt( 1 + b*b );
+   normFactor = ArcSinh( D * (1.0 - SP) + b ) - term2;
+   if ( normFactor == 0 )
+      normFactor = 1e-6;
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   inline float Clamp01( float v )
+   {
+      return (v < 0) ? 0.0f : ((v > 1) ? 1.0f : v);
+   }
+
+   /*
+    * Scalar reference kernels: the original double precision engine code.
+    */
+   void ScalarStretch( float* data, size_type count, const StretchCoefficients& c )
+   {
+      for ( size_type i = 0; i < count; ++i )
+      {
+         double term1 = ArcSinh( c.D * (double( data[i] ) - c.SP) + c.b );
+         data[i] = Clamp01( float( (term1 - c.term2) / c.normFactor ) );
+      }
+   }
+
+   void ScalarPow( const float* x, float* y, size_type count, float exponent )
+   {
+      for ( size_type i = 0; i < count; ++i )
+         y[i] = (x[i] > 0) ? Pow( x[i], exponent ) : 0.0f;
+   }
+
+   void ScalarMTF( float* data, size_type count, double m )
+   {
+      double m1 = m - 1.0;
+      double m2 = 2.0 * m - 1.0;
+      for ( size_type i = 0; i < count; ++i )
+      {
+         double v = data[i];
+         double term1 = m1 * v;
+         double term2 = m2 * v - m;
+         data[i] = (term2 != 0) ? Clamp01( float( term1 / term2 ) ) : 0.0f;
+      }
+   }
+
+   void ScalarSoftClip( float* data, size_type count, double threshold, double rolloff )
+   {
+      float threshF = float( threshold );
+      float rangeInv = float( 1.0 / (1.0 - threshold + 1e-9) );
+      for ( size_type i = 0; i < count; ++i )
+      {
+         float v = data[i];
+         if ( v > threshF )
+         {
+            float t = Max( 0.0f, Min( (v - threshF) * rangeInv, 1.0f ) );
+            float soft = 1.0f - Pow( 1.0f - t, float( rolloff ) );
+            v = threshF + (1.0f - threshF) * soft;
+         }
+         data[i] = Clamp01( v );
+      }
+   }
+
+   const VeraLuxSIMDKernelTable s_scalarKernels = { ScalarStretch, ScalarPow, ScalarMTF, ScalarSoftClip };
+
+   // ----------------------------------------------------------------------------
+
+#ifdef VERALUX_SIMD_X86
+#  if defined( _MSC_VER ) && !defined( __clang__ )
+
+   bool CPUSupportsAVX2()
+   {
+      int r[ 4 ];
+      __cpuid( r, 1 );
+      bool fma = (r[2] & (1 << 12)) != 0;
+      bool osxsave = (r[2] & (1 << 27)) != 0;
+      if ( !fma || !osxsave || (_xgetbv( 0 ) & 0x06) != 0x06 )
+         return false;
+      __cpuidex( r, 7, 0 );
+      return (r[1] & (1 << 5)) != 0;
+   }
+
+   bool CPUSupportsAVX512()
+   {
+      if ( !CPUSupportsAVX2() || (_xgetbv( 0 ) & 0xe6) != 0xe6 )
+         return false;
+      int r[ 4 ];
+      __cpuidex( r, 7, 0 );
+      return (r[1] & (1 << 16)) != 0;
+   }
+
+#  else
+
+   bool CPUSupportsAVX2()
+   {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+   }
+
+   bool CPUSupportsAVX512()
+   {
+      __builtin_cpu_init();
+      return CPUSupportsAVX2() && __builtin_cpu_supports( "avx512f" );
+   }
+
+#  endif
+#endif   // VERALUX_SIMD_X86
+
+   SIMDInstructionSet::value_type DetectInstructionSet()
+   {
+#ifdef VERALUX_SIMD_X86
+      if ( CPUSupportsAVX512() && VeraLuxSIMDKernelsAVX512() != nullptr )
+         return SIMDInstructionSet::AVX512;
+      if ( CPUSupportsAVX2() && VeraLuxSIMDKernelsAVX2() != nullptr )
+         return SIMDInstructionSet::AVX2;
+#endif
+      if ( VeraLuxSIMDKernelsNEON() != nullptr )
+         return SIMDInstructionSet::NEON;
+      return SIMDInstructionSet::Scalar;
+   }
+
+   const VeraLuxSIMDKernelTable* KernelsFor( SIMDInstructionSet::value_type isa )
+   {
+      switch ( isa )
+      {
+      case SIMDInstructionSet::AVX512: return VeraLuxSIMDKernelsAVX512();
+      case SIMDInstructionSet::AVX2:   return VeraLuxSIMDKernelsAVX2();
+      case SIMDInstructionSet::NEON:   return VeraLuxSIMDKernelsNEON();
+      default:                         return (VeraLuxSIMD::Precision() == ComputePrecision::Float) ?
+                                                 VeraLuxSIMDKernelsFloat() : &s_scalarKernels;
+      }
+   }
+
+   std::atomic<int> s_maximumInstructionSet( SIMDInstructionSet::NumberOfInstructionSets );
+
+   const VeraLuxSIMDKernelTable* ActiveKernels()
+   {
+      const VeraLuxSIMDKernelTable* kernels = KernelsFor( VeraLuxSIMD::ActiveInstructionSet() );
+      return (kernels != nullptr) ? kernels : &s_scalarKernels;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+SIMDInstructionSet::value_type VeraLuxSIMD::DetectedInstructionSet()
+{
+   static const SIMDInstructionSet::value_type detected = DetectInstructionSet();
+   return detected;
+}
+
+// ----------------------------------------------------------------------------
+
+SIMDInstructionSet::value_type VeraLuxSIMD::ActiveInstructionSet()
+{
+   SIMDInstructionSet::value_type detected = DetectedInstructionSet();
+   int maximum = s_maximumInstructionSet.load( std::memory_order_relaxed );
+   if ( int( detected ) <= maximum )
+      return detected;
+
+   // NEON is not ordered with respect to the x86 sets: any limit below it
+   // selects the scalar path.
+   if ( detected == SIMDInstructionSet::AVX512 && maximum >= SIMDInstructionSet::AVX2 )
+      return SIMDInstructionSet::AVX2;
+   return SIMDInstructionSet::Scalar;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSIMD::SetMaximumInstructionSet( SIMDInstructionSet::value_type isa )
+{
+   s_maximumInstructionSet.store( int( isa ), std::memory_order_relaxed );
+}
+
+// ----------------------------------------------------------------------------
+
+const char* VeraLuxSIMD::InstructionSetName( SIMDInstructionSet::value_type isa )
+{
+   switch ( isa )
+   {
+   case SIMDInstructionSet::AVX2:   return "AVX2";
+   case SIMDInstructionSet::AVX512: return "AVX-512";
+   case SIMDInstructionSet::NEON:   return "NEON";
+   default:                         return "scalar";
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+ComputePrecision::value_type VeraLuxSIMD::Precision()
+{
+   return VeraLuxContext::Current().precision;
+}
+
+// ----------------------------------------------------------------------------
+
+const char* VeraLuxSIMD::PrecisionName( ComputePrecision::value_type precision )
+{
+   return (precision == ComputePrecision::Float) ? "float" : "mixed";
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSIMD::Stretch( float* data, size_type count, const StretchCoefficients& curve )
+{
+   ActiveKernels()->stretch( data, count, curve );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSIMD::Pow( const float* x, float* y, size_type count, float exponent )
+{
+   ActiveKernels()->pow( x, y, count, exponent );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSIMD::MTF( float* data, size_type count, double m )
+{
+   ActiveKernels()->mtf( data, count, m );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSIMD::SoftClip( float* data, size_type count, double threshold, double rolloff )
+{
+   ActiveKernels()->softClip( data, count, threshold, rolloff );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
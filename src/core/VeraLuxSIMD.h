@@ -0,0 +1,237 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+//
+// ACCURACY OF THE VECTOR KERNELS (against the Scalar reference path):
+//
+// The Scalar path evaluates every transfer function in double precision with
+// the standard library, exactly as the original engine did. The vector paths
+// work in single precision with Cephes-style log/exp polynomials. Maximum
+// absolute errors on outputs in [0,1], measured over 2^20 uniform inputs:
+//
+//   - Stretch (arcsinh):  < 2e-6   for 0.1 <= b <= 15, 1 <= D <= 1e7
+//   - Pow:                < 1e-6   for x in [0,1], exponent in [0.01,10]
+//   - MTF:                < 1e-6   for m in [0.001,0.999]
+//   - SoftClip:           < 1e-6
+//
+// Without -ffast-math all errors stay below 3e-7 (about 2 float ulps of 1).
+// All vector paths use the same sequence of fused multiply-add operations,
+// so AVX2, AVX-512 and NEON results agree within the same bounds.
+//
+// COMPUTE PRECISION (see ComputePrecision):
+//
+// Mixed (default) keeps the original engine arithmetic where it used double
+// precision: the Scalar path runs the double reference kernels, and sensor
+// weighted luminance sums are accumulated in double before being stored as
+// float. Float evaluates everything in single precision: luminance sums use
+// float weights, and the Scalar path runs the vector kernel sequence one
+// sample at a time, so its results do not depend on the instruction set.
+// The kernel translation units are compiled with strict floating point
+// (no fast-math, no contraction; see VeraLuxSIMDKernels.h), so they are
+// bit-identical on every instruction set, with or without -ffast-math.
+// The precision is a setting of each execution (see VeraLuxContext), so
+// concurrent runs never change each other's arithmetic. The errors of both
+// modes against the reference are measured by
+// benchmark/VeraLuxValidation.cpp.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxSIMD_h
+#define __VeraLuxSIMD_h
+
+#include <pcl/Defs.h>
+
+#include "SensorProfiles.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace SIMDInstructionSet
+ * \brief Instruction sets supported by the VeraLux vector kernels.
+ */
+namespace SIMDInstructionSet
+{
+   enum value_type
+   {
+      Scalar,  //!< Double precision reference, no vectorization
+      AVX2,    //!< x86-64 AVX2 + FMA, 8 lanes
+      AVX512,  //!< x86-64 AVX-512F, 16 lanes
+      NEON,    //!< AArch64 Advanced SIMD, 4 lanes
+      NumberOfInstructionSets
+   };
+}
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \namespace ComputePrecision
+ * \brief Floating point precision of the engine arithmetic.
+ */
+namespace ComputePrecision
+{
+   enum value_type
+   {
+      Mixed,  //!< Double precision luminance sums and scalar reference kernels
+      Float,  //!< Single precision throughout, independent of the instruction set
+      NumberOfPrecisions,
+      Default = Mixed
+   };
+}
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct StretchCoefficients
+ * \brief Precomputed constants of the normalized arcsinh stretch.
+ *
+ * y = (asinh( D*(x - SP) + b ) - asinh( b )) / (asinh( D*(1 - SP) + b ) - asinh( b ))
+ */
+struct StretchCoefficients
+{
+   double D;           //!< Stretch factor, at least 0.1
+   double b;           //!< Highlight protection, at least 0.1
+   double SP;          //!< Symmetry point
+   double term2;       //!< asinh( b )
+   double sb;          //!< sqrt( 1 + b^2 )
+   double normFactor;  //!< Normalization denominator, never zero
+
+   StretchCoefficients( double D, double b, double SP = 0.0 );
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxSIMD
+ * \brief Vectorized transfer functions with run-time instruction set dispatch.
+ *
+ * The best instruction set supported by the running CPU is detected once.
+ * Every kernel works on a contiguous array of float samples and can be
+ * called concurrently from the row-band threads of VeraLuxParallel.
+ */
+class VeraLuxSIMD
+{
+public:
+
+   /*!
+    * Recommended number of samples for stack buffers passed to Pow(), small
+    * enough to stay in L1 cache.
+    */
+   static constexpr int BlockSize = 256;
+
+   /*!
+    * \brief Best instruction set supported by this CPU and build.
+    */
+   static SIMDInstructionSet::value_type DetectedInstructionSet();
+
+   /*!
+    * \brief Instruction set currently used by the kernels.
+    */
+   static SIMDInstructionSet::value_type ActiveInstructionSet();
+
+   /*!
+    * \brief Restricts dispatch to instruction sets not above \a isa.
+    *
+    * Passing SIMDInstructionSet::Scalar selects the double precision
+    * reference path. Not meant to be changed while kernels are running.
+    */
+   static void SetMaximumInstructionSet( SIMDInstructionSet::value_type isa );
+
+   /*!
+    * \brief Human-readable name of an instruction set.
+    */
+   static const char* InstructionSetName( SIMDInstructionSet::value_type isa );
+
+   /*!
+    * \brief Precision of the kernels and luminance sums run by the calling
+    * thread, from its execution context (VeraLuxContext::precision).
+    */
+   static ComputePrecision::value_type Precision();
+
+   /*!
+    * \brief Human-readable name of a compute precision.
+    */
+   static const char* PrecisionName( ComputePrecision::value_type precision );
+
+   /*!
+    * \brief Normalized arcsinh stretch in-place, clamped to [0,1].
+    */
+   static void Stretch( float* data, size_type count, const StretchCoefficients& curve );
+
+   /*!
+    * \brief y[i] = x[i]^exponent, for x in [0,1] and exponent > 0.
+    *
+    * Non-positive bases produce zero. \a x and \a y may be the same array.
+    */
+   static void Pow( const float* x, float* y, size_type count, float exponent );
+
+   /*!
+    * \brief Midtone transfer function in-place, clamped to [0,1].
+    */
+   static void MTF( float* data, size_type count, double m );
+
+   /*!
+    * \brief Ready-to-Use highlight soft clip in-place, clamped to [0,1].
+    *
+    * Samples above \a threshold are compressed as
+    * threshold + (1 - threshold)*(1 - (1 - t)^rolloff).
+    */
+   static void SoftClip( float* data, size_type count, double threshold, double rolloff );
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct LuminanceWeights
+ * \brief Sensor-weighted luminance sum in the compute precision of the
+ * execution context.
+ *
+ * The precision is captured at construction, out of the pixel loops. Every
+ * luminance computation of the engine goes through this function, so that
+ * luminance planes, medians and histograms computed separately agree. The
+ * Float precision sum uses the single-precision weights of SensorWeights.
+ */
+struct LuminanceWeights
+{
+   double r, g, b;      //!< Weights of the Mixed precision sum
+   float  rf, gf, bf;   //!< Weights of the Float precision sum
+   bool   single;       //!< Whether the Float precision sum is used
+
+   LuminanceWeights( const SensorWeights& w )
+      : r( w.r ), g( w.g ), b( w.b )
+      , rf( w.rf ), gf( w.gf ), bf( w.bf )
+      , single( VeraLuxSIMD::Precision() == ComputePrecision::Float )
+   {
+   }
+
+   float operator()( float R, float G, float B ) const
+   {
+      if ( single )
+         return rf*R + gf*G + bf*B;
+      return float( r*R + g*G + b*B );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxSIMD_h
+
+// ----------------------------------------------------------------------------
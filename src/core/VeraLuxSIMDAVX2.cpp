@@ -0,0 +1,119 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxSIMDKernels.h"
+
+#ifdef VERALUX_SIMD_X86
+
+#include <immintrin.h>
+
+/*
+ * Everything below is compiled for AVX2 + FMA regardless of the global
+ * compiler flags; it is only called after run-time CPU detection.
+ */
+#if defined( __clang__ )
+#  pragma clang attribute push( __attribute__((target("avx2,fma"))), apply_to = function )
+#elif defined( __GNUC__ )
+#  pragma GCC push_options
+#  pragma GCC target( "avx2,fma" )
+#endif
+
+VERALUX_SIMD_STRICT_BEGIN
+#include "VeraLuxSIMDMath.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   struct AVX2Vector
+   {
+      typedef __m256 vec;
+      typedef __m256 mask;
+
+      static constexpr int Width = 8;
+
+      static vec Set( float x )                 { return _mm256_set1_ps( x ); }
+      static vec Load( const float* p )         { return _mm256_loadu_ps( p ); }
+      static void Store( float* p, vec x )      { _mm256_storeu_ps( p, x ); }
+      static vec Add( vec a, vec b )            { return _mm256_add_ps( a, b ); }
+      static vec Sub( vec a, vec b )            { return _mm256_sub_ps( a, b ); }
+      static vec Mul( vec a, vec b )            { return _mm256_mul_ps( a, b ); }
+      static vec Div( vec a, vec b )            { return _mm256_div_ps( a, b ); }
+      static vec MulAdd( vec a, vec b, vec c )  { return _mm256_fmadd_ps( a, b, c ); }
+      static vec Min( vec a, vec b )            { return _mm256_min_ps( a, b ); }
+      static vec Max( vec a, vec b )            { return _mm256_max_ps( a, b ); }
+      static vec Sqrt( vec x )                  { return _mm256_sqrt_ps( x ); }
+      static vec Floor( vec x )                 { return _mm256_floor_ps( x ); }
+      static mask Less( vec a, vec b )          { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+      static mask Greater( vec a, vec b )       { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+      static mask Equal( vec a, vec b )         { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+      static vec Select( mask m, vec a, vec b ) { return _mm256_blendv_ps( b, a, m ); }
+
+      static vec Frexp( vec x, vec& e )
+      {
+         __m256i i = _mm256_castps_si256( x );
+         e = _mm256_cvtepi32_ps( _mm256_sub_epi32( _mm256_srli_epi32( i, 23 ), _mm256_set1_epi32( 126 ) ) );
+         i = _mm256_or_si256( _mm256_and_si256( i, _mm256_set1_epi32( 0x007fffff ) ), _mm256_set1_epi32( 0x3f000000 ) );
+         return _mm256_castsi256_ps( i );
+      }
+
+      static vec Ldexp( vec x, vec n )
+      {
+         __m256i i = _mm256_slli_epi32( _mm256_add_epi32( _mm256_cvtps_epi32( n ), _mm256_set1_epi32( 127 ) ), 23 );
+         return _mm256_mul_ps( x, _mm256_castsi256_ps( i ) );
+      }
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX2()
+{
+   return VeraLuxSIMDKernelSet<AVX2Vector>::Table();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+VERALUX_SIMD_STRICT_END
+
+#if defined( __clang__ )
+#  pragma clang attribute pop
+#elif defined( __GNUC__ )
+#  pragma GCC pop_options
+#endif
+
+#else    // !VERALUX_SIMD_X86
+
+namespace pcl
+{
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX2()
+{
+   return nullptr;
+}
+
+} // pcl
+
+#endif   // VERALUX_SIMD_X86
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxSIMDKernels.h"
+
+#ifdef VERALUX_SIMD_X86
+
+#include <immintrin.h>
+
+/*
+ * Everything below is compiled for AVX-512F regardless of the global compiler
+ * flags; it is only called after run-time CPU detection.
+ */
+#if defined( __clang__ )
+#  pragma clang attribute push( __attribute__((target("avx512f,avx2,fma"))), apply_to = function )
+#elif defined( __GNUC__ )
+#  pragma GCC push_options
+#  pragma GCC target( "avx512f,avx2,fma" )
+// False positives on _mm512_undefined_ps() in GCC 12 intrinsics headers
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+VERALUX_SIMD_STRICT_BEGIN
+#include "VeraLuxSIMDMath.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   struct AVX512Vector
+   {
+      typedef __m512    vec;
+      typedef __mmask16 mask;
+
+      static constexpr int Width = 16;
+
+      static vec Set( float x )                 { return _mm512_set1_ps( x ); }
+      static vec Load( const float* p )         { return _mm512_loadu_ps( p ); }
+      static void Store( float* p, vec x )      { _mm512_storeu_ps( p, x ); }
+      static vec Add( vec a, vec b )            { return _mm512_add_ps( a, b ); }
+      static vec Sub( vec a, vec b )            { return _mm512_sub_ps( a, b ); }
+      static vec Mul( vec a, vec b )            { return _mm512_mul_ps( a, b ); }
+      static vec Div( vec a, vec b )            { return _mm512_div_ps( a, b ); }
+      static vec MulAdd( vec a, vec b, vec c )  { return _mm512_fmadd_ps( a, b, c ); }
+      static vec Min( vec a, vec b )            { return _mm512_min_ps( a, b ); }
+      static vec Max( vec a, vec b )            { return _mm512_max_ps( a, b ); }
+      static vec Sqrt( vec x )                  { return _mm512_sqrt_ps( x ); }
+      static vec Floor( vec x )                 { return _mm512_roundscale_ps( x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ); }
+      static mask Less( vec a, vec b )          { return _mm512_cmp_ps_mask( a, b, _CMP_LT_OQ ); }
+      static mask Greater( vec a, vec b )       { return _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ ); }
+      static mask Equal( vec a, vec b )         { return _mm512_cmp_ps_mask( a, b, _CMP_EQ_OQ ); }
+      static vec Select( mask m, vec a, vec b ) { return _mm512_mask_blend_ps( m, b, a ); }
+
+      static vec Frexp( vec x, vec& e )
+      {
+         __m512i i = _mm512_castps_si512( x );
+         e = _mm512_cvtepi32_ps( _mm512_sub_epi32( _mm512_srli_epi32( i, 23 ), _mm512_set1_epi32( 126 ) ) );
+         i = _mm512_or_si512( _mm512_and_si512( i, _mm512_set1_epi32( 0x007fffff ) ), _mm512_set1_epi32( 0x3f000000 ) );
+         return _mm512_castsi512_ps( i );
+      }
+
+      static vec Ldexp( vec x, vec n )
+      {
+         __m512i i = _mm512_slli_epi32( _mm512_add_epi32( _mm512_cvtps_epi32( n ), _mm512_set1_epi32( 127 ) ), 23 );
+         return _mm512_mul_ps( x, _mm512_castsi512_ps( i ) );
+      }
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX512()
+{
+   return VeraLuxSIMDKernelSet<AVX512Vector>::Table();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+VERALUX_SIMD_STRICT_END
+
+#if defined( __clang__ )
+#  pragma clang attribute pop
+#elif defined( __GNUC__ )
+#  pragma GCC diagnostic pop
+#  pragma GCC pop_options
+#endif
+
+#else    // !VERALUX_SIMD_X86
+
+namespace pcl
+{
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX512()
+{
+   return nullptr;
+}
+
+} // pcl
+
+#endif   // VERALUX_SIMD_X86
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxSIMDKernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+VERALUX_SIMD_STRICT_BEGIN
+#include "VeraLuxSIMDMath.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * One-lane "vector" with the semantics of the vector instructions: fused
+    * multiply-add, min/max returning the second operand unless the first is
+    * smaller/greater, and the same exponent bit manipulations.
+    */
+   struct FloatVector
+   {
+      typedef float vec;
+      typedef bool  mask;
+
+      static constexpr int Width = 1;
+
+      static vec Set( float x )                 { return x; }
+      static vec Load( const float* p )         { return *p; }
+      static void Store( float* p, vec x )      { *p = x; }
+      static vec Add( vec a, vec b )            { return a + b; }
+      static vec Sub( vec a, vec b )            { return a - b; }
+      static vec Mul( vec a, vec b )            { return a * b; }
+      static vec Div( vec a, vec b )            { return a / b; }
+      static vec MulAdd( vec a, vec b, vec c )  { return std::fma( a, b, c ); }
+      static vec Min( vec a, vec b )            { return (a < b) ? a : b; }
+      static vec Max( vec a, vec b )            { return (a > b) ? a : b; }
+      static vec Sqrt( vec x )                  { return std::sqrt( x ); }
+      static vec Floor( vec x )                 { return std::floor( x ); }
+      static mask Less( vec a, vec b )          { return a < b; }
+      static mask Greater( vec a, vec b )       { return a > b; }
+      static mask Equal( vec a, vec b )         { return a == b; }
+      static vec Select( mask m, vec a, vec b ) { return m ? a : b; }
+
+      static vec Frexp( vec x, vec& e )
+      {
+         uint32_t i;
+         std::memcpy( &i, &x, sizeof( i ) );
+         e = float( int32_t( i >> 23 ) - 126 );
+         i = (i & 0x007fffffu) | 0x3f000000u;
+         std::memcpy( &x, &i, sizeof( i ) );
+         return x;
+      }
+
+      static vec Ldexp( vec x, vec n )
+      {
+         uint32_t i = uint32_t( int32_t( n ) + 127 ) << 23;
+         float f;
+         std::memcpy( &f, &i, sizeof( f ) );
+         return x * f;
+      }
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsFloat()
+{
+   return VeraLuxSIMDKernelSet<FloatVector>::Table();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+VERALUX_SIMD_STRICT_END
+
+// ----------------------------------------------------------------------------
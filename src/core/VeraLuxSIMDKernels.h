@@ -0,0 +1,98 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+//
+// Internal interface between the VeraLuxSIMD dispatcher and the translation
+// units compiled for each instruction set. Not part of the engine API.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxSIMDKernels_h
+#define __VeraLuxSIMDKernels_h
+
+#include "VeraLuxSIMD.h"
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#  define VERALUX_SIMD_X86 1
+#endif
+
+#if defined( __aarch64__ ) || defined( _M_ARM64 )
+#  define VERALUX_SIMD_NEON 1
+#endif
+
+/*
+ * Strict IEEE evaluation of the kernel sequence, unaffected by -ffast-math and
+ * floating point contraction, so that every instruction set computes exactly
+ * the same operations (see ComputePrecision). Opened just before
+ * VeraLuxSIMDMath.h is included and closed at the end of the kernels.
+ */
+#if defined( __clang__ )
+#  define VERALUX_SIMD_STRICT_BEGIN _Pragma( "float_control( precise, on, push )" ) \
+                                    _Pragma( "clang fp contract( off )" )
+#  define VERALUX_SIMD_STRICT_END   _Pragma( "float_control( pop )" )
+#elif defined( __GNUC__ )
+#  define VERALUX_SIMD_STRICT_BEGIN _Pragma( "GCC push_options" ) \
+                                    _Pragma( "GCC optimize( \"no-fast-math\", \"fp-contract=off\" )" )
+#  define VERALUX_SIMD_STRICT_END   _Pragma( "GCC pop_options" )
+#elif defined( _MSC_VER )
+#  define VERALUX_SIMD_STRICT_BEGIN __pragma( float_control( precise, on, push ) ) \
+                                    __pragma( fp_contract( off ) )
+#  define VERALUX_SIMD_STRICT_END   __pragma( float_control( pop ) )
+#else
+#  define VERALUX_SIMD_STRICT_BEGIN
+#  define VERALUX_SIMD_STRICT_END
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxSIMDKernelTable
+ * \internal
+ * \brief Kernel entry points for one instruction set.
+ */
+struct VeraLuxSIMDKernelTable
+{
+   void (*stretch)( float*, size_type, const StretchCoefficients& );
+   void (*pow)( const float*, float*, size_type, float );
+   void (*mtf)( float*, size_type, double );
+   void (*softClip)( float*, size_type, double, double );
+};
+
+/*
+ * Kernel tables for each instruction set, or nullptr when the instruction set
+ * is not available for the target architecture of this build.
+ */
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX2();
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsAVX512();
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsNEON();
+
+/*
+ * Single precision kernels of the Scalar path in ComputePrecision::Float:
+ * the vector kernel sequence evaluated one sample at a time. Always available.
+ */
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsFloat();
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxSIMDKernels_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,282 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+//
+// Generic single precision vector math for the VeraLuxSIMD kernels.
+//
+// Every template here is parameterized by a vector traits class V, defined by
+// each instruction set translation unit, providing:
+//
+//   vec, mask, Width
+//   Set, Load, Store, Add, Sub, Mul, Div, MulAdd (a*b + c), Min, Max, Sqrt,
+//   Floor, Less, Greater, Equal, Select (m ? a : b),
+//   Frexp (mantissa in [0.5,1) and exponent as float), Ldexp (x*2^n)
+//
+// This header must be included after the target region of the instruction
+// set has been opened, and after VeraLuxSIMDKernels.h, so that no library
+// header is compiled inside the region.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxSIMDMath_h
+#define __VeraLuxSIMDMath_h
+
+#include "VeraLuxSIMDKernels.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+template <class V>
+struct VeraLuxSIMDMath
+{
+   typedef typename V::vec  vec;
+   typedef typename V::mask mask;
+
+   /*
+    * Natural logarithm for x >= FLT_MIN (Cephes logf, ~1 ulp).
+    */
+   static vec Log( vec x )
+   {
+      vec e;
+      vec m = V::Frexp( x, e );
+      mask small = V::Less( m, V::Set( 0.707106781186547524f ) );
+      e = V::Select( small, V::Sub( e, V::Set( 1.0f ) ), e );
+      m = V::Sub( V::Select( small, V::Add( m, m ), m ), V::Set( 1.0f ) );
+
+      vec z = V::Mul( m, m );
+      vec y =            V::Set(  7.0376836292e-2f );
+      y = V::MulAdd( y, m, V::Set( -1.1514610310e-1f ) );
+      y = V::MulAdd( y, m, V::Set(  1.1676998740e-1f ) );
+      y = V::MulAdd( y, m, V::Set( -1.2420140846e-1f ) );
+      y = V::MulAdd( y, m, V::Set(  1.4249322787e-1f ) );
+      y = V::MulAdd( y, m, V::Set( -1.6668057665e-1f ) );
+      y = V::MulAdd( y, m, V::Set(  2.0000714765e-1f ) );
+      y = V::MulAdd( y, m, V::Set( -2.4999993993e-1f ) );
+      y = V::MulAdd( y, m, V::Set(  3.3333331174e-1f ) );
+      y = V::Mul( V::Mul( y, m ), z );
+
+      y = V::MulAdd( e, V::Set( -2.12194440e-4f ), y );
+      y = V::MulAdd( z, V::Set( -0.5f ), y );
+      vec r = V::Add( m, y );
+      return V::MulAdd( e, V::Set( 0.693359375f ), r );
+   }
+
+   /*
+    * Exponential, clamped to the normal float range (Cephes expf, ~1 ulp).
+    */
+   static vec Exp( vec x )
+   {
+      x = V::Min( V::Max( x, V::Set( -87.0f ) ), V::Set( 88.0f ) );
+
+      vec n = V::Floor( V::MulAdd( x, V::Set( 1.44269504088896341f ), V::Set( 0.5f ) ) );
+      x = V::MulAdd( n, V::Set( -0.693359375f ), x );
+      x = V::MulAdd( n, V::Set( 2.12194440e-4f ), x );
+
+      vec z = V::Mul( x, x );
+      vec y =            V::Set( 1.9875691500e-4f );
+      y = V::MulAdd( y, x, V::Set( 1.3981999507e-3f ) );
+      y = V::MulAdd( y, x, V::Set( 8.3334519073e-3f ) );
+      y = V::MulAdd( y, x, V::Set( 4.1665795894e-2f ) );
+      y = V::MulAdd( y, x, V::Set( 1.6666665459e-1f ) );
+      y = V::MulAdd( y, x, V::Set( 5.0000001201e-1f ) );
+      y = V::Add( V::MulAdd( y, z, x ), V::Set( 1.0f ) );
+
+      return V::Ldexp( y, n );
+   }
+
+   /*
+    * log(1 + u) for u >= 0. The quotient u/(w - 1) compensates the rounding
+    * error of w = 1 + u.
+    */
+   static vec Log1p( vec u )
+   {
+      vec w = V::Add( V::Set( 1.0f ), u );
+      vec d = V::Sub( w, V::Set( 1.0f ) );
+      mask exact = V::Equal( d, V::Set( 0.0f ) );
+      vec r = V::Mul( Log( w ), V::Div( u, V::Select( exact, V::Set( 1.0f ), d ) ) );
+      return V::Select( exact, u, r );
+   }
+
+   /*
+    * asinh( b + d ) - asinh( b ) in log1p/sqrt form, for d >= -b:
+    *
+    *    log1p( d*(1 + (u + b)/(su + sb))/(b + sb) )
+    *
+    * with u = b + d, su = sqrt(1 + u^2) and sb = sqrt(1 + b^2). Evaluating
+    * the difference directly avoids the cancellation of two rounded arcsinh
+    * values, which otherwise dominates the error when asinh( b ) is large
+    * compared to the normalization range.
+    */
+   static vec ArcSinhDifference( vec d, vec b, vec sb )
+   {
+      vec u = V::Add( b, d );
+      vec su = V::Sqrt( V::MulAdd( u, u, V::Set( 1.0f ) ) );
+      vec ratio = V::Div( V::Add( u, b ), V::Add( su, sb ) );
+      vec z = V::Div( V::MulAdd( d, ratio, d ), V::Add( b, sb ) );
+      return Log1p( z );
+   }
+
+   /*
+    * x^e for x > 0. Non-positive bases return zero.
+    */
+   static vec Pow( vec x, vec e )
+   {
+      mask positive = V::Greater( x, V::Set( 0.0f ) );
+      vec r = Exp( V::Mul( e, Log( V::Max( x, V::Set( 1.17549435e-38f ) ) ) ) );
+      return V::Select( positive, r, V::Set( 0.0f ) );
+   }
+
+   static vec Clamp01( vec x )
+   {
+      return V::Min( V::Max( x, V::Set( 0.0f ) ), V::Set( 1.0f ) );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+template <class V>
+struct VeraLuxSIMDKernelSet
+{
+   typedef typename V::vec  vec;
+   typedef typename V::mask mask;
+   typedef VeraLuxSIMDMath<V> M;
+
+   /*
+    * Applies op to every element of in[0,count), writing to out. The tail is
+    * processed through a zero-padded full vector.
+    */
+   template <class Op>
+   static void Transform( const float* in, float* out, size_type count, const Op& op )
+   {
+      size_type i = 0;
+      for ( ; i + V::Width <= count; i += V::Width )
+         V::Store( out + i, op( V::Load( in + i ) ) );
+
+      if ( i < count )
+      {
+         float buffer[ V::Width ];
+         size_type n = count - i;
+         for ( size_type j = 0; j < size_type( V::Width ); ++j )
+            buffer[j] = (j < n) ? in[i+j] : 0.0f;
+         V::Store( buffer, op( V::Load( buffer ) ) );
+         for ( size_type j = 0; j < n; ++j )
+            out[i+j] = buffer[j];
+      }
+   }
+
+   struct StretchOp
+   {
+      vec D, SP, b, sb, normInv;
+
+      vec operator()( vec x ) const
+      {
+         vec t = M::ArcSinhDifference( V::Mul( D, V::Sub( x, SP ) ), b, sb );
+         return M::Clamp01( V::Mul( t, normInv ) );
+      }
+   };
+
+   static void Stretch( float* data, size_type count, const StretchCoefficients& c )
+   {
+      StretchOp op;
+      op.D = V::Set( float( c.D ) );
+      op.SP = V::Set( float( c.SP ) );
+      op.b = V::Set( float( c.b ) );
+      op.sb = V::Set( float( c.sb ) );
+      op.normInv = V::Set( float( 1/c.normFactor ) );
+      Transform( data, data, count, op );
+   }
+
+   struct PowOp
+   {
+      vec e;
+
+      vec operator()( vec x ) const
+      {
+         return M::Pow( x, e );
+      }
+   };
+
+   static void Pow( const float* x, float* y, size_type count, float exponent )
+   {
+      PowOp op;
+      op.e = V::Set( exponent );
+      Transform( x, y, count, op );
+   }
+
+   struct MTFOp
+   {
+      vec m, m1;
+
+      vec operator()( vec x ) const
+      {
+         // (2m - 1)*x - m = (m - 1)*x - m*(1 - x), free of cancellation
+         vec num = V::Mul( m1, x );
+         vec den = V::Sub( num, V::Mul( m, V::Sub( V::Set( 1.0f ), x ) ) );
+         mask zero = V::Equal( den, V::Set( 0.0f ) );
+         vec r = V::Div( num, V::Select( zero, V::Set( 1.0f ), den ) );
+         return V::Select( zero, V::Set( 0.0f ), M::Clamp01( r ) );
+      }
+   };
+
+   static void MTF( float* data, size_type count, double m )
+   {
+      MTFOp op;
+      op.m = V::Set( float( m ) );
+      op.m1 = V::Set( float( m - 1 ) );
+      Transform( data, data, count, op );
+   }
+
+   struct SoftClipOp
+   {
+      vec threshold, rangeInv, rolloff, headroom;
+
+      vec operator()( vec x ) const
+      {
+         vec t = M::Clamp01( V::Mul( V::Sub( x, threshold ), rangeInv ) );
+         vec soft = V::Sub( V::Set( 1.0f ), M::Pow( V::Sub( V::Set( 1.0f ), t ), rolloff ) );
+         vec clipped = V::MulAdd( headroom, soft, threshold );
+         return M::Clamp01( V::Select( V::Greater( x, threshold ), clipped, x ) );
+      }
+   };
+
+   static void SoftClip( float* data, size_type count, double threshold, double rolloff )
+   {
+      SoftClipOp op;
+      float t = float( threshold );
+      op.threshold = V::Set( t );
+      op.rangeInv = V::Set( float( 1.0/(1.0 - threshold + 1e-9) ) );
+      op.rolloff = V::Set( float( rolloff ) );
+      op.headroom = V::Set( 1.0f - t );
+      Transform( data, data, count, op );
+   }
+
+   static const VeraLuxSIMDKernelTable* Table()
+   {
+      static const VeraLuxSIMDKernelTable table = { Stretch, Pow, MTF, SoftClip };
+      return &table;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxSIMDMath_h
+
+// ----------------------------------------------------------------------------
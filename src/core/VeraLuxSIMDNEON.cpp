@@ -0,0 +1,103 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxSIMDKernels.h"
+
+#ifdef VERALUX_SIMD_NEON
+
+// Advanced SIMD is mandatory on AArch64, no target region is needed.
+#include <arm_neon.h>
+
+VERALUX_SIMD_STRICT_BEGIN
+#include "VeraLuxSIMDMath.h"
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   struct NEONVector
+   {
+      typedef float32x4_t vec;
+      typedef uint32x4_t  mask;
+
+      static constexpr int Width = 4;
+
+      static vec Set( float x )                 { return vdupq_n_f32( x ); }
+      static vec Load( const float* p )         { return vld1q_f32( p ); }
+      static void Store( float* p, vec x )      { vst1q_f32( p, x ); }
+      static vec Add( vec a, vec b )            { return vaddq_f32( a, b ); }
+      static vec Sub( vec a, vec b )            { return vsubq_f32( a, b ); }
+      static vec Mul( vec a, vec b )            { return vmulq_f32( a, b ); }
+      static vec Div( vec a, vec b )            { return vdivq_f32( a, b ); }
+      static vec MulAdd( vec a, vec b, vec c )  { return vfmaq_f32( c, a, b ); }
+      static vec Min( vec a, vec b )            { return vminq_f32( a, b ); }
+      static vec Max( vec a, vec b )            { return vmaxq_f32( a, b ); }
+      static vec Sqrt( vec x )                  { return vsqrtq_f32( x ); }
+      static vec Floor( vec x )                 { return vrndmq_f32( x ); }
+      static mask Less( vec a, vec b )          { return vcltq_f32( a, b ); }
+      static mask Greater( vec a, vec b )       { return vcgtq_f32( a, b ); }
+      static mask Equal( vec a, vec b )         { return vceqq_f32( a, b ); }
+      static vec Select( mask m, vec a, vec b ) { return vbslq_f32( m, a, b ); }
+
+      static vec Frexp( vec x, vec& e )
+      {
+         uint32x4_t i = vreinterpretq_u32_f32( x );
+         e = vcvtq_f32_s32( vsubq_s32( vreinterpretq_s32_u32( vshrq_n_u32( i, 23 ) ), vdupq_n_s32( 126 ) ) );
+         i = vorrq_u32( vandq_u32( i, vdupq_n_u32( 0x007fffff ) ), vdupq_n_u32( 0x3f000000 ) );
+         return vreinterpretq_f32_u32( i );
+      }
+
+      static vec Ldexp( vec x, vec n )
+      {
+         int32x4_t i = vshlq_n_s32( vaddq_s32( vcvtq_s32_f32( n ), vdupq_n_s32( 127 ) ), 23 );
+         return vmulq_f32( x, vreinterpretq_f32_s32( i ) );
+      }
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsNEON()
+{
+   return VeraLuxSIMDKernelSet<NEONVector>::Table();
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+VERALUX_SIMD_STRICT_END
+
+#else    // !VERALUX_SIMD_NEON
+
+namespace pcl
+{
+
+const VeraLuxSIMDKernelTable* VeraLuxSIMDKernelsNEON()
+{
+   return nullptr;
+}
+
+} // pcl
+
+#endif   // VERALUX_SIMD_NEON
+
+// ----------------------------------------------------------------------------
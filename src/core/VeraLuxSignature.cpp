@@ -0,0 +1,113 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxSignature.h"
+#include "VeraLuxEngine.h"
+#include "VeraLuxSmartMax.h"
+#include "VeraLuxStatistics.h"
+
+#include <pcl/Math.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+VeraLuxSignature VeraLuxSignature::Compute( const VeraLuxStreamAnalysis& analysis, bool adaptiveAnchor,
+                                            const SensorProfile& profile )
+{
+   VeraLuxSignature s;
+   s.width = analysis.width;
+   s.height = analysis.height;
+   s.channels = analysis.channels;
+   s.sampleCount = size_type( analysis.sample.Width() );
+
+   // The analysis has solved the statistical anchor on its reference stride
+   // and the selected one; only the adaptive candidate may be missing
+   s.anchor = analysis.anchor;
+   s.statisticalAnchor = analysis.statisticalAnchor;
+   s.adaptiveAnchor = adaptiveAnchor ?
+      analysis.anchor : VeraLuxEngine::CalculateAnchorAdaptive( analysis.sample, profile );
+
+   Image luma;
+   VeraLuxEngine::ExtractLuminance( luma, analysis.sample, s.anchor, profile );
+   const float* L = luma[0];
+   const size_type n = luma.NumberOfPixels();
+
+   // Dispersion around the median of the analysis
+   s.median = analysis.luminanceMedian;
+   {
+      std::vector<float> deviations( n );
+      for ( size_type i = 0; i < n; ++i )
+         deviations[i] = float( Abs( L[i] - s.median ) );
+      s.mad = VeraLuxStatistics::Percentile( deviations, 50 );
+   }
+
+   // Tail of the nonzero luminance, with the ranks of EstimateStarPressure()
+   std::vector<float> tail;
+   tail.reserve( n );
+   for ( size_type i = 0; i < n; ++i )
+      if ( L[i] > 1e-7f )
+         tail.push_back( L[i] );
+   luma.FreeData();
+
+   if ( tail.size() >= 100 )
+   {
+      const size_type count = tail.size();
+      s.p99 = VeraLuxStatistics::OrderStatistic( tail, size_type( count * 0.99 ) );
+      s.p999 = VeraLuxStatistics::OrderStatistic( tail, size_type( count * 0.999 ) );
+      s.p9999 = VeraLuxStatistics::OrderStatistic( tail, size_type( count * 0.9999 ) );
+
+      size_type countBright = 0;
+      for ( float v : tail )
+         if ( v > s.p999 )
+            ++countBright;
+      s.starPressure = VeraLuxEngine::StarPressure( s.p999, s.p9999, double( countBright )/count );
+   }
+
+   // Smart Max test on the neighborhoods of the brightest pixels
+   if ( !analysis.peak.IsEmpty() )
+   {
+      Image peakLuma;
+      VeraLuxEngine::ExtractLuminance( peakLuma, analysis.peak, s.anchor, profile );
+      s.peak = peakLuma.MaximumSampleValue();
+      if ( s.peak > 0.001 )
+         s.physicalPeak = VeraLuxSmartMax::PhysicalMaximum( peakLuma, VeraLuxSmartMax::DefaultCandidates,
+                                                            &s.peakHasNeighbors );
+   }
+
+   return s;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxSignature VeraLuxSignature::Compute( VeraLuxRowSource& source, bool adaptiveAnchor,
+                                            const SensorProfile& profile, size_type budget,
+                                            StatusMonitor* monitor )
+{
+   return Compute( VeraLuxStreaming::Analyze( source, adaptiveAnchor, profile, budget, monitor ),
+                   adaptiveAnchor, profile );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
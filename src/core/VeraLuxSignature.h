@@ -0,0 +1,103 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// IMAGE SIGNATURE:
+//
+// The anchor, the luminance median, star pressure and the Smart Max test
+// are computed by different engine functions, each scanning (and often
+// subsampling) the image on its own. The signature gathers all of them from
+// the single strip scan of VeraLuxStreaming::Analyze(): every statistic is
+// derived from its strided subsample of at most a few million pixels and
+// from the neighborhoods of the brightest local maxima.
+//
+// For images up to the subsample size the subsample is the whole image.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxSignature_h
+#define __VeraLuxSignature_h
+
+#include "SensorProfiles.h"
+#include "VeraLuxStreaming.h"
+
+namespace pcl
+{
+
+class StatusMonitor;
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxSignature
+ * \brief Parameter-independent statistics of an image, from one scan.
+ *
+ * Luminance statistics refer to the anchored photometric luminance, as
+ * produced by VeraLuxEngine::ExtractLuminance() with the selected anchor.
+ * Tail percentiles and star pressure are measured on its nonzero values,
+ * as by VeraLuxEngine::EstimateStarPressure().
+ */
+struct VeraLuxSignature
+{
+   int       width = 0;                 //!< Image width in pixels
+   int       height = 0;                //!< Image height in pixels
+   int       channels = 0;              //!< Number of channels
+   size_type sampleCount = 0;           //!< Pixels in the subsample
+
+   double    anchor = 0;                //!< Selected black point
+   double    statisticalAnchor = 0;     //!< VeraLuxEngine::CalculateAnchor() candidate
+   double    adaptiveAnchor = 0;        //!< VeraLuxEngine::CalculateAnchorAdaptive() candidate
+
+   double    median = 0;                //!< Luminance median
+   double    mad = 0;                   //!< Median absolute deviation from the luminance median
+   double    p99 = 0;                   //!< 99th percentile of the nonzero luminance
+   double    p999 = 0;                  //!< 99.9th percentile of the nonzero luminance
+   double    p9999 = 0;                 //!< 99.99th percentile of the nonzero luminance
+   double    starPressure = 0;          //!< Stellar dominance in [0,1]
+
+   double    peak = 0;                  //!< Luminance of the brightest pixel
+   bool      peakHasNeighbors = false;  //!< Smart Max test: the peak is a star, not a hot pixel
+   double    physicalPeak = 0;          //!< Luminance of the brightest star core (Smart Max), or zero
+
+   /*!
+    * \brief Signature of a streamed analysis.
+    *
+    * \param analysis         Result of VeraLuxStreaming::Analyze()
+    * \param adaptiveAnchor   Whether the analysis used the adaptive anchor,
+    *                         which selects the candidate stored as anchor
+    * \param profile          Sensor profile used by the analysis
+    */
+   static VeraLuxSignature Compute( const VeraLuxStreamAnalysis& analysis, bool adaptiveAnchor,
+                                    const SensorProfile& profile );
+
+   /*!
+    * \brief Scans \a source once and computes its signature.
+    *
+    * \param monitor  Optional monitor, incremented by rows read
+    */
+   static VeraLuxSignature Compute( VeraLuxRowSource& source, bool adaptiveAnchor,
+                                    const SensorProfile& profile, size_type budget,
+                                    StatusMonitor* monitor = nullptr );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxSignature_h
+
+// ----------------------------------------------------------------------------
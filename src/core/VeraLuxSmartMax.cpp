@@ -0,0 +1,168 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+
+#include "VeraLuxSmartMax.h"
+#include "VeraLuxParallel.h"
+
+#include <pcl/AutoLock.h>
+#include <pcl/Mutex.h>
+
+#include <algorithm>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Whether the pixel at (x,y) with value v is a local maximum: no
+    * neighbor is brighter, and neighbors preceding it in scan order are
+    * strictly darker.
+    */
+   bool IsLocalMaximum( const Image& image, int x, int y, float v )
+   {
+      const int x0 = Max( 0, x - 1 );
+      const int x1 = Min( image.Width(), x + 2 );
+      const int y0 = Max( 0, y - 1 );
+      const int y1 = Min( image.Height(), y + 2 );
+      for ( int j = y0; j < y1; ++j )
+         for ( int i = x0; i < x1; ++i )
+            if ( i != x || j != y )
+            {
+               float u = VeraLuxSmartMax::PixelValue( image, i, j );
+               if ( u > v || (u == v && (j < y || (j == y && i < x))) )
+                  return false;
+            }
+      return true;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+std::vector<VeraLuxSmartMax::Candidate> VeraLuxSmartMax::Candidates( const Image& image, int count )
+{
+   std::vector<Candidate> candidates;
+   if ( image.IsEmpty() || count <= 0 )
+      return candidates;
+
+   const int width = image.Width();
+   const int nChannels = image.NumberOfChannels();
+   Mutex mutex;
+
+   VeraLuxParallel::ForEachRowBand( image.Height(), VeraLuxParallel::MaxThreads( image ),
+      [&]( int startRow, int endRow )
+      {
+         // Min-heap of the brightest local maxima of this band. Only pixels
+         // above the current minimum need the neighborhood test.
+         std::vector<Candidate> heap;
+         heap.reserve( count + 1 );
+         auto darker = []( const Candidate& a, const Candidate& b ) { return a < b; };
+
+         for ( int y = startRow; y < endRow; ++y )
+            for ( int x = 0; x < width; ++x )
+            {
+               float v = image( x, y, 0 );
+               for ( int c = 1; c < nChannels; ++c )
+                  v = Max( v, image( x, y, c ) );
+
+               if ( int( heap.size() ) == count && !(v > heap.front().value) )
+                  continue;
+               if ( !IsLocalMaximum( image, x, y, v ) )
+                  continue;
+
+               Candidate candidate;
+               candidate.value = v;
+               candidate.x = x;
+               candidate.y = y;
+               heap.push_back( candidate );
+               std::push_heap( heap.begin(), heap.end(), darker );
+               if ( int( heap.size() ) > count )
+               {
+                  std::pop_heap( heap.begin(), heap.end(), darker );
+                  heap.pop_back();
+               }
+            }
+
+         std::sort( heap.begin(), heap.end() );
+
+         volatile AutoLock lock( mutex );
+         Merge( candidates, heap, count );
+      } );
+
+   return candidates;
+}
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxSmartMax::IsStar( const Image& image, const Candidate& candidate )
+{
+   const double threshold = 0.20 * candidate.value;
+   const int x0 = Max( 0, candidate.x - 1 );
+   const int x1 = Min( image.Width(), candidate.x + 2 );
+   const int y0 = Max( 0, candidate.y - 1 );
+   const int y1 = Min( image.Height(), candidate.y + 2 );
+
+   int brightNeighbors = 0;
+   for ( int y = y0; y < y1; ++y )
+      for ( int x = x0; x < x1; ++x )
+         if ( x != candidate.x || y != candidate.y )
+            if ( PixelValue( image, x, y ) >= threshold )
+               ++brightNeighbors;
+
+   return brightNeighbors >= 2;
+}
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxSmartMax::PhysicalMaximum( const Image& image, int count, bool* brightestIsStar )
+{
+   if ( brightestIsStar != nullptr )
+      *brightestIsStar = false;
+
+   std::vector<Candidate> candidates = Candidates( image, count );
+   for ( size_type i = 0; i < candidates.size(); ++i )
+      if ( IsStar( image, candidates[i] ) )
+      {
+         if ( brightestIsStar != nullptr )
+            *brightestIsStar = i == 0;
+         return candidates[i].value;
+      }
+
+   return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxSmartMax::Merge( std::vector<Candidate>& candidates, const std::vector<Candidate>& other, int count )
+{
+   std::vector<Candidate> merged;
+   merged.reserve( candidates.size() + other.size() );
+   std::merge( candidates.begin(), candidates.end(), other.begin(), other.end(), std::back_inserter( merged ) );
+   if ( int( merged.size() ) > count )
+      merged.resize( count );
+   candidates.swap( merged );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+
+// SMART MAX (HOT PIXEL REJECTION):
+//
+// Linear expansion and Ready-to-Use output scaling map the brightest
+// physical signal of an image to the top of the range, but a hot pixel
+// must not take that role. The image is scanned once for the brightest
+// local maxima (candidates), and the brightest candidate whose 3x3
+// neighborhood looks like a star core, with at least two neighbors above
+// 20% of it, is the physical maximum. Brighter candidates are treated as
+// hot pixels, so an isolated hot pixel, or a pair of adjacent ones, does
+// not defeat the test as long as a star is found among the candidates.
+//
+// Local maxima are required to be strictly brighter than the neighbors
+// preceding them in scan order, so a flat (saturated) core yields a single
+// candidate.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxSmartMax_h
+#define __VeraLuxSmartMax_h
+
+#include <pcl/Image.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxSmartMax
+ * \brief Top-K bright pixel tracker and star/hot pixel test.
+ *
+ * The value of a pixel is its maximum sample over all channels.
+ */
+class VeraLuxSmartMax
+{
+public:
+
+   /*!
+    * Default number of candidates tracked.
+    */
+   static constexpr int DefaultCandidates = 16;
+
+   /*!
+    * \struct pcl::VeraLuxSmartMax::Candidate
+    * \brief A local maximum of an image.
+    */
+   struct Candidate
+   {
+      float value = 0;  //!< Pixel value
+      int   x = 0;      //!< Horizontal pixel coordinate
+      int   y = 0;      //!< Vertical pixel coordinate
+
+      /*!
+       * Brightest first; ties in scan order.
+       */
+      bool operator <( const Candidate& c ) const
+      {
+         return (value != c.value) ? value > c.value : ((y != c.y) ? y < c.y : x < c.x);
+      }
+   };
+
+   /*!
+    * \brief The brightest local maxima of an image, brightest first.
+    *
+    * One parallel scan. Returns at most \a count candidates.
+    */
+   static std::vector<Candidate> Candidates( const Image& image, int count = DefaultCandidates );
+
+   /*!
+    * \brief Whether the neighborhood of a candidate looks like a star core.
+    */
+   static bool IsStar( const Image& image, const Candidate& candidate );
+
+   /*!
+    * \brief Value of the brightest candidate that looks like a star.
+    *
+    * Returns zero if none of the \a count brightest candidates does.
+    *
+    * \param[out] brightestIsStar  Optional; whether the brightest candidate
+    *                              itself looks like a star
+    */
+   static double PhysicalMaximum( const Image& image, int count = DefaultCandidates,
+                                  bool* brightestIsStar = nullptr );
+
+   /*!
+    * \brief Merges two candidate lists, keeping the \a count brightest.
+    *
+    * Both lists must be sorted, brightest first.
+    */
+   static void Merge( std::vector<Candidate>& candidates, const std::vector<Candidate>& other,
+                      int count = DefaultCandidates );
+
+   /*!
+    * \brief Value of a pixel: its maximum sample over all channels.
+    */
+   static float PixelValue( const Image& image, int x, int y )
+   {
+      float v = image( x, y, 0 );
+      for ( int c = 1; c < image.NumberOfChannels(); ++c )
+         v = Max( v, image( x, y, c ) );
+      return v;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxSmartMax_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,167 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxStatistics.h"
+
+#include <pcl/Math.h>
+
+#include <algorithm>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+double VeraLuxStatistics::Percentile( std::vector<float>& sample, double pct )
+{
+   double result = 0;
+   Percentiles( sample, &pct, &result, 1 );
+   return result;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxStatistics::Percentiles( std::vector<float>& sample,
+                                     const double* pct, double* result, size_type count )
+{
+   if ( count == 0 )
+      return;
+
+   if ( sample.empty() )
+   {
+      for ( size_type j = 0; j < count; ++j )
+         result[j] = 0.0;
+      return;
+   }
+
+   const size_type n = sample.size();
+   if ( n == 1 )
+   {
+      for ( size_type j = 0; j < count; ++j )
+         result[j] = sample[0];
+      return;
+   }
+
+   /*
+    * NumPy 'linear' method: pos = (p/100)*(n-1), interpolating between the
+    * order statistics floor(pos) and floor(pos)+1.
+    */
+   std::vector<double> pos( count );
+   std::vector<size_type> ranks;
+   ranks.reserve( 2*count );
+   for ( size_type j = 0; j < count; ++j )
+   {
+      pos[j] = (Max( 0.0, Min( pct[j], 100.0 ) )/100.0) * double( n - 1 );
+      const size_type i0 = size_type( Floor( pos[j] ) );
+      ranks.push_back( i0 );
+      ranks.push_back( Min( i0 + 1, n - 1 ) );
+   }
+   std::sort( ranks.begin(), ranks.end() );
+   ranks.erase( std::unique( ranks.begin(), ranks.end() ), ranks.end() );
+
+   /*
+    * Select ranks in ascending order. After each selection everything at or
+    * below the selected rank is partitioned, so the next selection only has
+    * to scan the remaining upper part of the sample.
+    */
+   std::vector<float> values( ranks.size() );
+   size_type lo = 0;
+   for ( size_type k = 0; k < ranks.size(); ++k )
+   {
+      const size_type r = ranks[k];
+      std::nth_element( sample.begin() + lo, sample.begin() + r, sample.end() );
+      values[k] = sample[r];
+      lo = r + 1;
+   }
+
+   auto valueAt = [&]( size_type r ) -> double
+   {
+      return values[std::lower_bound( ranks.begin(), ranks.end(), r ) - ranks.begin()];
+   };
+
+   for ( size_type j = 0; j < count; ++j )
+   {
+      const size_type i0 = size_type( Floor( pos[j] ) );
+      const size_type i1 = Min( i0 + 1, n - 1 );
+      const double f = pos[j] - double( i0 );
+
+      const double v0 = valueAt( i0 );
+      const double v1 = valueAt( i1 );
+      result[j] = v0 + f * (v1 - v0);
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+float VeraLuxStatistics::OrderStatistic( std::vector<float>& sample, size_type k )
+{
+   std::nth_element( sample.begin(), sample.begin() + k, sample.end() );
+   return sample[k];
+}
+
+// ----------------------------------------------------------------------------
+
+StreamingHistogram::StreamingHistogram( int bins )
+   : m_bins( Max( 1, bins ) )
+   , m_hist( size_type( Max( 1, bins ) ), 0 )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void StreamingHistogram::Add( const float* data, size_type count, size_type stride )
+{
+   if ( data == nullptr )
+      return;
+
+   stride = Max( size_type( 1 ), stride );
+   for ( size_type i = 0; i < count; i += stride )
+      Add( data[i] );
+}
+
+// ----------------------------------------------------------------------------
+
+double StreamingHistogram::Percentile( double pct ) const
+{
+   if ( m_count == 0 )
+      return 0.0;
+
+   // Same target rank as the NumPy 'linear' method.
+   const double pos = (Max( 0.0, Min( pct, 100.0 ) )/100.0) * double( m_count - 1 );
+
+   uint64 cumulative = 0;
+   for ( int i = 0; i < m_bins; ++i )
+   {
+      const uint64 n = m_hist[i];
+      if ( n > 0 && double( cumulative + n ) > pos )
+      {
+         // Spread the n samples of this bin uniformly over its width.
+         const double f = (pos - double( cumulative ) + 0.5) / double( n );
+         return Min( 1.0, (double( i ) + f) / m_bins );
+      }
+      cumulative += n;
+   }
+
+   return 1.0;
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
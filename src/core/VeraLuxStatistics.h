@@ -0,0 +1,149 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxStatistics_h
+#define __VeraLuxStatistics_h
+
+#include <pcl/Defs.h>
+#include <pcl/Utility.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxStatistics
+ * \brief Selection-based order statistics for the VeraLux engine.
+ *
+ * Percentiles follow NumPy's default linear interpolation between adjacent
+ * ranks exactly, but are computed with std::nth_element instead of a full
+ * sort: O(n) per requested rank instead of O(n log n). Several percentiles
+ * can be answered from a single sample, each selection working only on the
+ * part of the sample not yet partitioned by the previous one.
+ *
+ * All functions reorder the sample in place.
+ */
+class VeraLuxStatistics
+{
+public:
+
+   /*!
+    * \brief Computes a single percentile of a sample.
+    *
+    * \param[in,out] sample   Sample values (reordered)
+    * \param         pct      Percentile in [0,100]
+    * \return                 Interpolated percentile, 0 for an empty sample
+    */
+   static double Percentile( std::vector<float>& sample, double pct );
+
+   /*!
+    * \brief Computes several percentiles of a sample in one call.
+    *
+    * Percentiles may be given in any order.
+    *
+    * \param[in,out] sample   Sample values (reordered)
+    * \param         pct      Array of percentiles in [0,100]
+    * \param[out]    result   Array receiving the interpolated percentiles
+    * \param         count    Number of percentiles
+    */
+   static void Percentiles( std::vector<float>& sample,
+                            const double* pct, double* result, size_type count );
+
+   /*!
+    * \brief Returns the value of rank \a k (0-based) in ascending order.
+    *
+    * Equivalent to sorting the sample and reading element \a k.
+    *
+    * \param[in,out] sample   Sample values (reordered)
+    * \param         k        Rank, must be smaller than sample.size()
+    */
+   static float OrderStatistic( std::vector<float>& sample, size_type k );
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class StreamingHistogram
+ * \brief Fixed-range histogram quantile estimator for data in [0,1].
+ *
+ * Samples are accumulated without being stored, so memory use is constant
+ * and no reordering takes place. Quantiles use the same rank convention as
+ * VeraLuxStatistics::Percentiles(), interpolating uniformly inside the bin
+ * that contains the requested rank. The error is bounded by one bin width
+ * (1/65536 with the default resolution).
+ */
+class StreamingHistogram
+{
+public:
+
+   /*!
+    * Constructs an empty histogram with \a bins uniform bins over [0,1].
+    */
+   StreamingHistogram( int bins = 65536 );
+
+   /*!
+    * Adds a sample value. Values outside [0,1] go to the extreme bins.
+    */
+   void Add( float v )
+   {
+      int bin;
+      if ( !(v > 0) ) // also catches NaN
+         bin = 0;
+      else if ( v >= 1 )
+         bin = m_bins - 1;
+      else
+         bin = Min( int( v * m_bins ), m_bins - 1 );
+      ++m_hist[bin];
+      ++m_count;
+   }
+
+   /*!
+    * Adds every \a stride-th value of a contiguous array.
+    */
+   void Add( const float* data, size_type count, size_type stride = 1 );
+
+   /*!
+    * Number of accumulated samples.
+    */
+   size_type Count() const
+   {
+      return m_count;
+   }
+
+   /*!
+    * Estimated percentile \a pct in [0,100]. Returns 0 when empty.
+    */
+   double Percentile( double pct ) const;
+
+private:
+
+   int                 m_bins;
+   std::vector<uint64> m_hist;
+   size_type           m_count = 0;
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxStatistics_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,313 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxStreaming.h"
+#include "VeraLuxGPU.h"
+#include "VeraLuxSmartMax.h"
+
+#include <pcl/ImageStatistics.h>
+#include <pcl/Math.h>
+#include <pcl/StatusMonitor.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   /*
+    * Removes candidates adjacent to a brighter one. Strips are searched
+    * independently, so a pixel on the first or last row of a strip can be
+    * a local maximum of its strip only, next to a brighter pixel across the
+    * strip boundary.
+    */
+   void RemoveAdjacentCandidates( std::vector<VeraLuxSmartMax::Candidate>& candidates )
+   {
+      std::vector<VeraLuxSmartMax::Candidate> kept;
+      for ( const VeraLuxSmartMax::Candidate& c : candidates )
+      {
+         bool adjacent = false;
+         for ( const VeraLuxSmartMax::Candidate& k : kept )
+            if ( Abs( c.x - k.x ) <= 1 && Abs( c.y - k.y ) <= 1 )
+            {
+               adjacent = true;
+               break;
+            }
+         if ( !adjacent )
+            kept.push_back( c );
+      }
+      candidates.swap( kept );
+   }
+
+   /*
+    * Anchored, stretched luminance, as produced by the fused pipeline before
+    * linear expansion.
+    */
+   void StretchedLuminance( Image& luma, const Image& image, double anchor,
+                            const SensorProfile& profile, const FusedStretchParameters& params )
+   {
+      VeraLuxEngine::ExtractLuminance( luma, image, anchor, profile );
+      VeraLuxEngine::HyperbolicStretch( luma, params.D, params.b, 0.0, params.transfer );
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+VeraLuxImageRowSource::VeraLuxImageRowSource( const ImageVariant& image )
+   : m_image( image )
+   , m_divisor( VeraLuxEngine::NormalizationDivisor( image ) )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxImageRowSource::ReadRows( Image& rows, int startRow, int rowCount )
+{
+   VeraLuxEngine::NormalizeInput( rows, m_image, Rect( 0, startRow, Width(), startRow + rowCount ), m_divisor );
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxImageRowSink::VeraLuxImageRowSink( ImageVariant& image )
+   : m_image( image )
+{
+   if ( image.IsComplexSample() )
+      throw Error( "Complex images are not supported." );
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxImageRowSink::WriteRows( const Image& rows, int startRow )
+{
+   // Converted directly into the output rows
+   VeraLuxEngine::StoreOutput( m_image, rows, startRow );
+}
+
+// ----------------------------------------------------------------------------
+
+int VeraLuxStreaming::RowsPerStrip( int width, int channels, size_type budget )
+{
+   // Float strip, I/O buffer of up to 64-bit samples, luminance plane
+   size_type bytesPerRow = size_type( Max( 1, width ) ) * (size_type( Max( 1, channels ) )*(4 + 8) + 4);
+   return int( Max( size_type( 1 ), Min( budget/bytesPerRow, size_type( int32_max ) ) ) );
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxStreamAnalysis VeraLuxStreaming::Analyze( VeraLuxRowSource& source, bool adaptiveAnchor,
+                                                 const SensorProfile& profile, size_type budget,
+                                                 StatusMonitor* monitor )
+{
+   VeraLuxStreamAnalysis a;
+   a.width = source.Width();
+   a.height = source.Height();
+   a.channels = source.NumberOfChannels();
+
+   const size_type N = size_type( a.width ) * size_type( a.height );
+   if ( N == 0 || a.channels <= 0 )
+      throw Error( "Empty image." );
+
+   /*
+    * The subsample keeps pixels at offsets that are multiples of the
+    * stride. For N >= SampleSize it holds between SampleSize and
+    * 2*SampleSize pixels, so the adaptive anchor uses all of them: the same
+    * pixels it would select from the whole image.
+    */
+   a.stride = Max( size_type( 1 ), N/SampleSize );
+   const size_type count = (N + a.stride - 1)/a.stride;
+   a.sample.AllocateData( int( count ), 1, a.channels );
+
+   /*
+    * The statistical anchor keeps its own reference stride, so it selects
+    * the same pixels as VeraLuxEngine::CalculateAnchor() on the whole image.
+    */
+   const size_type anchorStride = VeraLuxEngine::AnchorStride( N, a.channels );
+   const size_type anchorCount = (N + anchorStride - 1)/anchorStride;
+   Image anchorSample;
+   anchorSample.AllocateData( int( anchorCount ), 1, a.channels );
+
+   const int stripRows = Min( RowsPerStrip( a.width, a.channels, budget ), a.height );
+   const size_type width = size_type( a.width );
+
+   Image rows;
+   std::vector<VeraLuxSmartMax::Candidate> candidates;
+   size_type next = 0, nextAnchor = 0;
+   for ( int y0 = 0; y0 < a.height; y0 += stripRows )
+   {
+      const int n = Min( stripRows, a.height - y0 );
+      source.ReadRows( rows, y0, n );
+
+      const size_type first = size_type( y0 )*width;
+      const size_type last = first + size_type( n )*width;
+      for ( ; next < count && next*a.stride < last; ++next )
+         for ( int c = 0; c < a.channels; ++c )
+            a.sample[c][next] = rows[c][next*a.stride - first];
+      for ( ; nextAnchor < anchorCount && nextAnchor*anchorStride < last; ++nextAnchor )
+         for ( int c = 0; c < a.channels; ++c )
+            anchorSample[c][nextAnchor] = rows[c][nextAnchor*anchorStride - first];
+
+      std::vector<VeraLuxSmartMax::Candidate> strip = VeraLuxSmartMax::Candidates( rows );
+      for ( VeraLuxSmartMax::Candidate& c : strip )
+         c.y += y0;
+      VeraLuxSmartMax::Merge( candidates, strip );
+
+      if ( monitor != nullptr )
+         *monitor += size_type( n );
+   }
+
+   RemoveAdjacentCandidates( candidates );
+
+   /*
+    * Mosaic of the 3x3 neighborhoods of the candidates, separated by zero
+    * columns and zero-padded at the image borders, so each candidate keeps
+    * its true neighbors for the Smart Max test.
+    */
+   const int tiles = Max( 1, int( candidates.size() ) );
+   a.peak.AllocateData( 4*tiles - 1, 3, a.channels );
+   a.peak.Zero();
+   for ( size_type k = 0; k < candidates.size(); ++k )
+   {
+      const VeraLuxSmartMax::Candidate& c = candidates[k];
+      const int y0 = Max( 0, c.y - 1 );
+      const int y1 = Min( a.height, c.y + 2 );
+      source.ReadRows( rows, y0, y1 - y0 );
+      for ( int y = y0; y < y1; ++y )
+         for ( int x = Max( 0, c.x - 1 ), x1 = Min( a.width, c.x + 2 ); x < x1; ++x )
+            for ( int ch = 0; ch < a.channels; ++ch )
+               a.peak( int( 4*k ) + 1 + x - c.x, 1 + y - c.y, ch ) = rows( x, y - y0, ch );
+   }
+   rows.FreeData();
+
+   a.statisticalAnchor = VeraLuxEngine::CalculateAnchor( anchorSample, 1 );
+   anchorSample.FreeData();
+
+   a.anchor = adaptiveAnchor ?
+      VeraLuxEngine::CalculateAnchorAdaptive( a.sample, profile ) : a.statisticalAnchor;
+
+   Image luma;
+   VeraLuxEngine::ExtractLuminance( luma, a.sample, a.anchor, profile );
+   ImageStatistics stats;
+   stats.DisableVariance();
+   stats.DisableExtremes();
+   stats.DisableMean();
+   stats << luma;
+   a.luminanceMedian = stats.Median();
+
+   return a;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxStreaming::SolveLinearExpansion( const VeraLuxStreamAnalysis& analysis, const SensorProfile& profile,
+                                             FusedStretchParameters& params,
+                                             LinearExpansionStats* diagnostics )
+{
+   if ( params.linearExpansion <= 0.001 )
+      return;
+
+   Image luma, peakLuma;
+   StretchedLuminance( luma, analysis.sample, analysis.anchor, profile, params );
+   StretchedLuminance( peakLuma, analysis.peak, analysis.anchor, profile, params );
+
+   LinearExpansionStats stats;
+   VeraLuxEngine::ApplyLinearExpansion( luma, float( params.linearExpansion ), &stats, params.estimator, &peakLuma );
+
+   params.fixedExpansionBounds = true;
+   params.expansionLow = stats.low;
+   params.expansionHigh = stats.high;
+
+   if ( diagnostics != nullptr )
+      *diagnostics = stats;
+}
+
+// ----------------------------------------------------------------------------
+
+OutputScalingStats VeraLuxStreaming::SolveOutputScaling( const VeraLuxStreamAnalysis& analysis,
+                                                         const SensorProfile& profile,
+                                                         const FusedStretchParameters& params,
+                                                         double targetBg,
+                                                         StatisticsEstimator::value_type estimator )
+{
+   Image sample, peak;
+   sample.Assign( analysis.sample );
+   peak.Assign( analysis.peak );
+   VeraLuxPipeline::Run( sample, profile, params );
+   VeraLuxPipeline::Run( peak, profile, params );
+
+   OutputScalingStats scaling;
+   VeraLuxEngine::AdaptiveOutputScaling( sample, profile, targetBg, estimator, &scaling, params.transfer, &peak );
+   return scaling;
+}
+
+// ----------------------------------------------------------------------------
+
+bool VeraLuxStreaming::Stretch( Image& rows, const SensorProfile& profile, const FusedStretchParameters& params,
+                                const OutputScalingStats* scaling )
+{
+   // Bounds measured on a single strip would differ from strip to strip
+   if ( params.linearExpansion > 0.001 && !params.fixedExpansionBounds )
+      throw Error( "Streamed linear expansion requires fixed expansion bounds." );
+
+   // Every stage below is per-pixel, so the whole chain can run on the GPU
+   if ( VeraLuxGPU::Stretch( rows, profile, params, scaling ) )
+      return true;
+
+   VeraLuxPipeline::Run( rows, profile, params );
+   if ( scaling != nullptr )
+   {
+      VeraLuxEngine::ApplyOutputScaling( rows, *scaling, params.transfer );
+      VeraLuxEngine::ApplyReadyToUseSoftClip( rows, 0.98, 2.0, params.transfer );
+   }
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxStreaming::Apply( VeraLuxRowSource& source, VeraLuxRowSink& sink,
+                              const SensorProfile& profile, const FusedStretchParameters& params,
+                              const OutputScalingStats* scaling, size_type budget,
+                              StatusMonitor* monitor )
+{
+   // Bounds measured on a single strip would differ from strip to strip
+   if ( params.linearExpansion > 0.001 && !params.fixedExpansionBounds )
+      throw Error( "Streamed linear expansion requires fixed expansion bounds." );
+
+   const int height = source.Height();
+   const int stripRows = Min( RowsPerStrip( source.Width(), source.NumberOfChannels(), budget ), height );
+
+   Image rows;
+   for ( int y0 = 0; y0 < height; y0 += stripRows )
+   {
+      const int n = Min( stripRows, height - y0 );
+      source.ReadRows( rows, y0, n );
+      Stretch( rows, profile, params, scaling );
+      sink.WriteRows( rows, y0 );
+
+      if ( monitor != nullptr )
+         *monitor += size_type( n );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
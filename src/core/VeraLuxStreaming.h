@@ -0,0 +1,294 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// STREAMED EXECUTION:
+//
+// The in-memory pipeline holds a normalized float copy of the whole image
+// plus several full-size temporaries. Streamed execution runs the fused
+// pipeline over horizontal strips instead, in two phases:
+//
+// 1. Analyze: one scan over all strips gathers a strided subsample of at
+//    most about two million pixels and tracks the brightest local maxima,
+//    whose 3x3 neighborhoods are read back for the Smart Max test. All global
+//    statistics (anchor, luminance median, expansion bounds, output
+//    scaling) are solved on the subsample.
+//
+// 2. Apply: each strip is read, stretched with the solved parameters and
+//    written back.
+//
+// Strips are read from a VeraLuxRowSource and written to a VeraLuxRowSink,
+// so the image may live in memory or be decoded and encoded incrementally
+// from disk. Working memory is bounded by the strip size, chosen from a
+// byte budget, plus the subsample: it does not depend on the image size.
+//
+// For images up to the subsample size the subsample is the whole image and
+// results match the in-memory pipeline.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxStreaming_h
+#define __VeraLuxStreaming_h
+
+#include "SensorProfiles.h"
+#include "VeraLuxEngine.h"
+#include "VeraLuxPipeline.h"
+
+#include <pcl/Image.h>
+#include <pcl/ImageVariant.h>
+
+namespace pcl
+{
+
+class StatusMonitor;
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxRowSource
+ * \brief Provides an image as normalized [0,1] float strips of rows.
+ */
+class VeraLuxRowSource
+{
+public:
+
+   virtual ~VeraLuxRowSource()
+   {
+   }
+
+   virtual int Width() const = 0;
+   virtual int Height() const = 0;
+   virtual int NumberOfChannels() const = 0;
+
+   /*!
+    * \brief Reads rows [startRow, startRow+rowCount) into \a rows.
+    *
+    * \a rows is reallocated as needed. Samples must be normalized as
+    * VeraLuxEngine::NormalizeInput() does for the whole image.
+    */
+   virtual void ReadRows( Image& rows, int startRow, int rowCount ) = 0;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxRowSink
+ * \brief Receives the stretched image as float strips of rows.
+ */
+class VeraLuxRowSink
+{
+public:
+
+   virtual ~VeraLuxRowSink()
+   {
+   }
+
+   /*!
+    * \brief Stores \a rows starting at \a startRow of the output image.
+    */
+   virtual void WriteRows( const Image& rows, int startRow ) = 0;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxImageRowSource
+ * \brief Row source over an image of any real sample type.
+ *
+ * The normalization divisor is determined once for the whole image.
+ */
+class VeraLuxImageRowSource : public VeraLuxRowSource
+{
+public:
+
+   VeraLuxImageRowSource( const ImageVariant& image );
+
+   int Width() const override
+   {
+      return m_image.Width();
+   }
+
+   int Height() const override
+   {
+      return m_image.Height();
+   }
+
+   int NumberOfChannels() const override
+   {
+      return m_image.NumberOfChannels();
+   }
+
+   void ReadRows( Image& rows, int startRow, int rowCount ) override;
+
+private:
+
+   ImageVariant m_image;
+   double       m_divisor;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxImageRowSink
+ * \brief Row sink over an existing image of any real sample type.
+ *
+ * The image may be the one read by a VeraLuxImageRowSource: each strip is
+ * read completely before it is written.
+ */
+class VeraLuxImageRowSink : public VeraLuxRowSink
+{
+public:
+
+   VeraLuxImageRowSink( ImageVariant& image );
+
+   void WriteRows( const Image& rows, int startRow ) override;
+
+private:
+
+   ImageVariant m_image;
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \struct VeraLuxStreamAnalysis
+ * \brief Global statistics of a streamed image.
+ */
+struct VeraLuxStreamAnalysis
+{
+   Image     sample;                //!< Every stride-th pixel, as a single row
+   Image     peak;                  //!< 3x3 neighborhoods of the brightest local maxima, side by side
+   size_type stride = 1;            //!< Subsample stride in pixels
+   double    anchor = 0.0;          //!< Selected black point
+   double    statisticalAnchor = 0; //!< Statistical black point, on the reference stride of the whole image
+   double    luminanceMedian = 0;   //!< Median of the anchored luminance of the subsample
+   int       width = 0;             //!< Image width in pixels
+   int       height = 0;            //!< Image height in pixels
+   int       channels = 0;          //!< Number of channels
+};
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxStreaming
+ * \brief Two-phase streamed execution of the fused stretch pipeline.
+ */
+class VeraLuxStreaming
+{
+public:
+
+   /*!
+    * Maximum number of pixels in the analysis subsample. Equal to the
+    * subsample size of the adaptive anchor, so both select the same pixels.
+    */
+   static constexpr size_type SampleSize = 2000000;
+
+   /*!
+    * \brief Number of rows per strip for a working memory budget in bytes.
+    *
+    * Accounts for the float strip, a native sample buffer for I/O and the
+    * stretched luminance plane of linear expansion. At least one row.
+    */
+   static int RowsPerStrip( int width, int channels, size_type budget );
+
+   /*!
+    * \brief Phase 1: scans \a source and computes its global statistics.
+    *
+    * \param source           Image to analyze
+    * \param adaptiveAnchor   Use the morphological (adaptive) anchor
+    * \param profile          Sensor profile for luminance weights
+    * \param budget           Working memory budget in bytes
+    * \param monitor          Optional monitor, incremented by rows read
+    */
+   static VeraLuxStreamAnalysis Analyze( VeraLuxRowSource& source, bool adaptiveAnchor,
+                                         const SensorProfile& profile, size_type budget,
+                                         StatusMonitor* monitor = nullptr );
+
+   /*!
+    * \brief Solves the linear expansion bounds on the analysis.
+    *
+    * When linear expansion is enabled in \a params, its bounds are measured
+    * on the stretched luminance of the subsample, using the peaks for Smart
+    * Max, and stored as fixed bounds in \a params.
+    *
+    * \param[out] diagnostics  Optional bounds and clipping estimated on the
+    *                          subsample
+    */
+   static void SolveLinearExpansion( const VeraLuxStreamAnalysis& analysis, const SensorProfile& profile,
+                                     FusedStretchParameters& params,
+                                     LinearExpansionStats* diagnostics = nullptr );
+
+   /*!
+    * \brief Solves the Ready-to-Use output scaling on the analysis.
+    *
+    * Runs the pipeline and VeraLuxEngine::AdaptiveOutputScaling() on the
+    * subsample and the peaks. \a params must already hold fixed expansion
+    * bounds, if any.
+    */
+   static OutputScalingStats SolveOutputScaling( const VeraLuxStreamAnalysis& analysis,
+                                                 const SensorProfile& profile,
+                                                 const FusedStretchParameters& params,
+                                                 double targetBg,
+                                                 StatisticsEstimator::value_type estimator );
+
+   /*!
+    * \brief Stretches a strip (or any image) with solved parameters.
+    *
+    * Runs the pipeline followed, when \a scaling is given, by the
+    * Ready-to-Use output scaling and soft clip. Nothing is measured on
+    * \a rows, so any part of the image, at any resolution, is transformed
+    * exactly as it is in the full image.
+    *
+    * \param[in,out] rows      Normalized input; stretched output
+    * \param         profile   Sensor profile for luminance weights
+    * \param         params    Pipeline parameters, with fixed expansion
+    *                          bounds if linear expansion is enabled
+    * \param         scaling   Ready-to-Use output scaling, or nullptr for
+    *                          Scientific mode
+    *
+    * Runs on the GPU when VeraLuxGPU is enabled and available, and on the
+    * CPU otherwise. Returns true if the GPU was used.
+    */
+   static bool Stretch( Image& rows, const SensorProfile& profile, const FusedStretchParameters& params,
+                        const OutputScalingStats* scaling );
+
+   /*!
+    * \brief Phase 2: stretches \a source strip by strip into \a sink.
+    *
+    * \param source     Image to stretch
+    * \param sink       Output image
+    * \param profile    Sensor profile for luminance weights
+    * \param params     Pipeline parameters, with fixed expansion bounds if
+    *                   linear expansion is enabled
+    * \param scaling    Ready-to-Use output scaling followed by the soft clip,
+    *                   or nullptr for Scientific mode
+    * \param budget     Working memory budget in bytes
+    * \param monitor    Optional monitor, incremented by rows written
+    */
+   static void Apply( VeraLuxRowSource& source, VeraLuxRowSink& sink,
+                      const SensorProfile& profile, const FusedStretchParameters& params,
+                      const OutputScalingStats* scaling, size_type budget,
+                      StatusMonitor* monitor = nullptr );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxStreaming_h
+
+// ----------------------------------------------------------------------------
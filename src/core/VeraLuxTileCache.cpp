@@ -0,0 +1,111 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxTileCache.h"
+
+#include <pcl/AutoLock.h>
+
+#include <iterator>
+#include <utility>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+uint64 VeraLuxTileCache::ContextHash( const IsoString& context )
+{
+   // FNV-1a
+   uint64 h = 14695981039346656037ull;
+   const char* p = context.c_str();
+   for ( size_type i = 0, n = context.Length(); i < n; ++i )
+   {
+      h ^= uint8( p[i] );
+      h *= 1099511628211ull;
+   }
+   return h;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxTileCache::tile_ptr VeraLuxTileCache::Find( uint64 context, int x, int y )
+{
+   volatile AutoLock lock( m_mutex );
+   auto i = m_index.find( Key{ context, x, y } );
+   if ( i == m_index.end() )
+      return nullptr;
+   m_entries.splice( m_entries.begin(), m_entries, i->second );
+   return i->second->second;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxTileCache::tile_ptr VeraLuxTileCache::Insert( uint64 context, int x, int y, tile_data&& data )
+{
+   tile_ptr tile = std::make_shared<const tile_data>( std::move( data ) );
+   if ( Bytes( tile ) > m_capacity )
+      return tile;
+
+   const Key key{ context, x, y };
+   volatile AutoLock lock( m_mutex );
+   auto i = m_index.find( key );
+   if ( i != m_index.end() )
+      Erase( i->second );
+
+   m_entries.emplace_front( key, tile );
+   m_index[key] = m_entries.begin();
+   m_size += Bytes( tile );
+
+   while ( m_size > m_capacity )
+      Erase( std::prev( m_entries.end() ) );
+   return tile;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTileCache::Clear()
+{
+   volatile AutoLock lock( m_mutex );
+   m_entries.clear();
+   m_index.clear();
+   m_size = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+size_type VeraLuxTileCache::CachedSize() const
+{
+   volatile AutoLock lock( m_mutex );
+   return m_size;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTileCache::Erase( entry_list::iterator e )
+{
+   // Called with the mutex locked
+   m_size -= Bytes( e->second );
+   m_index.erase( e->first );
+   m_entries.erase( e );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
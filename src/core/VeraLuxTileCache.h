@@ -0,0 +1,151 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// TILE CACHE:
+//
+// The real-time preview stretches an image with global statistics and a
+// stretch solution that are fixed while the parameters do not change, so
+// every pixel of the result depends only on the pixel itself. The preview
+// can therefore be rendered in independent tiles, and only the tiles in the
+// visible region need to be computed.
+//
+// A tile cache keeps rendered tiles keyed by a hash of the render context
+// (image, parameters, decimation) and the tile coordinates, so panning over
+// the image, toggling the preview or returning to a previous parameter set
+// reuses the tiles already rendered. Cached memory is bounded by a byte
+// capacity; the least recently used tiles are evicted first.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxTileCache_h
+#define __VeraLuxTileCache_h
+
+#include <pcl/Mutex.h>
+#include <pcl/String.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxTileCache
+ * \brief Least recently used cache of rendered 16-bit preview tiles.
+ *
+ * Tiles are opaque sample vectors; their layout is defined by the caller.
+ * All member functions are thread-safe.
+ */
+class VeraLuxTileCache
+{
+public:
+
+   /*!
+    * Default capacity of cached tiles in bytes.
+    */
+   static constexpr size_type DefaultCapacity = size_type( 64 ) << 20;
+
+   typedef std::vector<uint16>              tile_data;
+   typedef std::shared_ptr<const tile_data> tile_ptr;
+
+   /*!
+    * \brief Constructs an empty cache.
+    *
+    * \param capacity   Maximum size of cached tiles in bytes
+    */
+   VeraLuxTileCache( size_type capacity = DefaultCapacity )
+      : m_capacity( capacity )
+   {
+   }
+
+   VeraLuxTileCache( const VeraLuxTileCache& ) = delete;
+   VeraLuxTileCache& operator =( const VeraLuxTileCache& ) = delete;
+
+   /*!
+    * \brief 64-bit hash of a render context description.
+    */
+   static uint64 ContextHash( const IsoString& context );
+
+   /*!
+    * \brief Tile (x,y) of a render context, or null if not cached.
+    *
+    * A found tile becomes the most recently used one.
+    */
+   tile_ptr Find( uint64 context, int x, int y );
+
+   /*!
+    * \brief Stores tile (x,y) of a render context.
+    *
+    * Replaces a cached tile with the same key and evicts the least recently
+    * used tiles beyond the capacity. Tiles larger than the capacity are not
+    * stored.
+    *
+    * \return  The tile, shared with the cache if stored
+    */
+   tile_ptr Insert( uint64 context, int x, int y, tile_data&& data );
+
+   /*!
+    * \brief Frees all cached tiles.
+    */
+   void Clear();
+
+   /*!
+    * \brief Size of cached tiles in bytes.
+    */
+   size_type CachedSize() const;
+
+private:
+
+   struct Key
+   {
+      uint64 context;
+      int    x, y;
+
+      bool operator <( const Key& k ) const
+      {
+         return (context != k.context) ? context < k.context : ((y != k.y) ? y < k.y : x < k.x);
+      }
+   };
+
+   typedef std::list<std::pair<Key, tile_ptr>> entry_list;
+
+   mutable Mutex                       m_mutex;
+   size_type                           m_capacity;
+   size_type                           m_size = 0;
+   entry_list                          m_entries;  // most recently used first
+   std::map<Key, entry_list::iterator> m_index;
+
+   static size_type Bytes( const tile_ptr& tile )
+   {
+      return tile->size()*sizeof( uint16 );
+   }
+
+   void Erase( entry_list::iterator );
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxTileCache_h
+
+// ----------------------------------------------------------------------------
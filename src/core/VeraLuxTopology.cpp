@@ -0,0 +1,338 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxContext.h"
+#include "VeraLuxTopology.h"
+
+#include <pcl/AutoLock.h>
+#include <pcl/Math.h>
+#include <pcl/Mutex.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#ifdef __PCL_WINDOWS
+#  include <windows.h>
+#endif
+
+#ifdef __PCL_LINUX
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+   Mutex            s_mutex;
+   std::vector<int> s_load;   // reservations per processor, guarded by s_mutex
+
+   thread_local const VeraLuxTopology::Reservation* t_reservation = nullptr;
+
+   std::vector<int> AllProcessors()
+   {
+      std::vector<int> processors( size_type( Max( 1, int( std::thread::hardware_concurrency() ) ) ) );
+      for ( size_type i = 0; i < processors.size(); ++i )
+         processors[i] = int( i );
+      return processors;
+   }
+
+#ifdef __PCL_LINUX
+
+   /*
+    * Parses a kernel CPU list, e.g. "0-15,32-47".
+    */
+   std::vector<int> ParseCPUList( const char* text )
+   {
+      std::vector<int> list;
+      const char* p = text;
+      while ( *p != '\0' && *p != '\n' )
+      {
+         char* end;
+         long first = std::strtol( p, &end, 10 );
+         if ( end == p )
+            break;
+         long last = first;
+         p = end;
+         if ( *p == '-' )
+         {
+            last = std::strtol( p+1, &end, 10 );
+            if ( end == p+1 )
+               break;
+            p = end;
+         }
+         for ( long i = first; i <= last; ++i )
+            list.push_back( int( i ) );
+         if ( *p == ',' )
+            ++p;
+      }
+      return list;
+   }
+
+   std::vector<int> ReadCPUList( const char* path )
+   {
+      std::vector<int> list;
+      if ( FILE* f = std::fopen( path, "r" ) )
+      {
+         char text[ 4096 ];
+         if ( std::fgets( text, int( sizeof( text ) ), f ) != nullptr )
+            list = ParseCPUList( text );
+         std::fclose( f );
+      }
+      return list;
+   }
+
+   std::vector<std::vector<int>> DetectNodes()
+   {
+      cpu_set_t allowed;
+      CPU_ZERO( &allowed );
+      bool haveMask = sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0;
+
+      std::vector<std::vector<int>> nodes;
+      for ( int node : ReadCPUList( "/sys/devices/system/node/online" ) )
+      {
+         char path[ 96 ];
+         std::snprintf( path, sizeof( path ), "/sys/devices/system/node/node%d/cpulist", node );
+         std::vector<int> processors;
+         for ( int cpu : ReadCPUList( path ) )
+            if ( !haveMask || (cpu < CPU_SETSIZE && CPU_ISSET( cpu, &allowed )) )
+               processors.push_back( cpu );
+         if ( !processors.empty() )
+            nodes.push_back( processors );
+      }
+      return nodes;
+   }
+
+#elif defined( __PCL_WINDOWS )
+
+   std::vector<std::vector<int>> DetectNodes()
+   {
+      // Processor group 0 only: PCL thread affinities address its processors.
+      DWORD_PTR processMask = 0, systemMask = 0;
+      if ( !GetProcessAffinityMask( GetCurrentProcess(), &processMask, &systemMask ) )
+         processMask = ~DWORD_PTR( 0 );
+
+      std::vector<std::vector<int>> nodes;
+      ULONG highest = 0;
+      if ( GetNumaHighestNodeNumber( &highest ) )
+         for ( ULONG node = 0; node <= highest; ++node )
+         {
+            ULONGLONG mask = 0;
+            if ( !GetNumaNodeProcessorMask( UCHAR( node ), &mask ) )
+               continue;
+            mask &= ULONGLONG( processMask );
+            std::vector<int> processors;
+            for ( int cpu = 0; cpu < 64; ++cpu )
+               if ( mask & (ULONGLONG( 1 ) << cpu) )
+                  processors.push_back( cpu );
+            if ( !processors.empty() )
+               nodes.push_back( processors );
+         }
+      return nodes;
+   }
+
+#else
+
+   std::vector<std::vector<int>> DetectNodes()
+   {
+      return std::vector<std::vector<int>>();
+   }
+
+#endif
+
+   size_type ThreadsPerNode( const std::vector<int>& node )
+   {
+      int limit = VeraLuxTopology::MaximumThreadsPerNode();
+      return (limit > 0) ? Min( node.size(), size_type( limit ) ) : node.size();
+   }
+
+   /*
+    * Up to the limit of threads per node, the processors of each node from
+    * least to most reserved. Called with s_mutex locked.
+    */
+   std::vector<std::vector<int>> Candidates()
+   {
+      std::vector<std::vector<int>> candidates;
+      for ( const std::vector<int>& node : VeraLuxTopology::Nodes() )
+      {
+         std::vector<int> processors = node;
+         std::stable_sort( processors.begin(), processors.end(),
+                           []( int a, int b )
+                           {
+                              return ((size_type( a ) < s_load.size()) ? s_load[a] : 0) <
+                                     ((size_type( b ) < s_load.size()) ? s_load[b] : 0);
+                           } );
+         processors.resize( ThreadsPerNode( node ) );
+         candidates.push_back( processors );
+      }
+      return candidates;
+   }
+
+   int Unreserved( const std::vector<int>& processors )
+   {
+      int count = 0;
+      for ( int p : processors )
+         if ( size_type( p ) >= s_load.size() || s_load[p] == 0 )
+            ++count;
+      return count;
+   }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+const std::vector<std::vector<int>>& VeraLuxTopology::Nodes()
+{
+   static const std::vector<std::vector<int>> nodes = []()
+   {
+      std::vector<std::vector<int>> detected = DetectNodes();
+      if ( detected.empty() )
+         detected.push_back( AllProcessors() );
+      return detected;
+   }();
+   return nodes;
+}
+
+// ----------------------------------------------------------------------------
+
+int VeraLuxTopology::MaximumThreadsPerNode()
+{
+   return Max( 0, VeraLuxContext::Current().maxThreadsPerNode );
+}
+
+// ----------------------------------------------------------------------------
+
+int VeraLuxTopology::AvailableThreads()
+{
+   size_type count = 0;
+   for ( const std::vector<int>& node : Nodes() )
+      count += ThreadsPerNode( node );
+   return int( Max( size_type( 1 ), count ) );
+}
+
+// ----------------------------------------------------------------------------
+
+std::vector<int> VeraLuxTopology::Processors()
+{
+   if ( t_reservation != nullptr )
+      return t_reservation->Processors();
+
+   volatile AutoLock lock( s_mutex );
+   std::vector<int> processors;
+   for ( std::vector<int>& node : Candidates() )
+   {
+      std::sort( node.begin(), node.end() );
+      processors.insert( processors.end(), node.begin(), node.end() );
+   }
+   return processors;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxTopology::PinCurrentThread( int processor )
+{
+#ifdef __PCL_LINUX
+   if ( processor < 0 || processor >= CPU_SETSIZE )
+      return;
+   cpu_set_t set;
+   CPU_ZERO( &set );
+   CPU_SET( processor, &set );
+   (void)pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+#else
+   (void)processor;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxTopology::Reservation::Reservation( int threads )
+   : m_previous( t_reservation )
+{
+   const size_type wanted = size_type( (threads > 0) ? threads : AvailableThreads() );
+
+   {
+      volatile AutoLock lock( s_mutex );
+
+      std::vector<std::vector<int>> candidates = Candidates();
+      std::vector<size_type> order( candidates.size() );
+      for ( size_type i = 0; i < order.size(); ++i )
+         order[i] = i;
+      std::stable_sort( order.begin(), order.end(),
+                        [&candidates]( size_type a, size_type b )
+                        {
+                           return Unreserved( candidates[a] ) > Unreserved( candidates[b] );
+                        } );
+
+      // A single node when it has room for the whole reservation
+      for ( size_type i : order )
+         if ( candidates[i].size() >= wanted && size_type( Unreserved( candidates[i] ) ) >= wanted )
+         {
+            m_processors.assign( candidates[i].begin(), candidates[i].begin() + wanted );
+            std::sort( m_processors.begin(), m_processors.end() );
+            break;
+         }
+
+      if ( m_processors.empty() )
+      {
+         // Nodes by decreasing availability, kept in node order so that
+         // consecutive bands stay on the same node.
+         std::vector<size_type> count( candidates.size(), 0 );
+         size_type taken = 0;
+         for ( size_type i : order )
+         {
+            count[i] = Min( candidates[i].size(), wanted - taken );
+            taken += count[i];
+         }
+         for ( size_type i = 0; i < candidates.size(); ++i )
+         {
+            std::sort( candidates[i].begin(), candidates[i].begin() + count[i] );
+            m_processors.insert( m_processors.end(), candidates[i].begin(), candidates[i].begin() + count[i] );
+         }
+      }
+
+      for ( int p : m_processors )
+      {
+         if ( size_type( p ) >= s_load.size() )
+            s_load.resize( size_type( p ) + 1, 0 );
+         ++s_load[p];
+      }
+   }
+
+   t_reservation = this;
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxTopology::Reservation::~Reservation()
+{
+   t_reservation = m_previous;
+
+   volatile AutoLock lock( s_mutex );
+   for ( int p : m_processors )
+      --s_load[p];
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
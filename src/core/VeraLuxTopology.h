@@ -0,0 +1,182 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// PROCESSOR TOPOLOGY:
+//
+// On multi-socket machines every socket (NUMA node) has its own memory
+// controllers. The engine kernels stream whole image planes, so once they
+// run on many threads they are bound by memory bandwidth, and a thread
+// reading pages that live on another node pays for the interconnect too.
+//
+// Pages are placed on the node of the thread that first writes them. The
+// working image and the luminance plane are first written by parallel row
+// band passes (normalization, luminance extraction), and every later pass
+// over the same geometry splits the rows into the same bands. Pinning band
+// i to the same processor in every pass therefore keeps each band on the
+// node that holds its pages, for the whole run.
+//
+// The topology lists the processors of each node. Execution contexts (a
+// view execution, each image of a batch) hold a processor reservation for
+// their lifetime: a reservation that fits in a node is taken from a single
+// node, preferring the least reserved one, so concurrent batch images run
+// on separate sockets instead of thrashing each other's caches and memory
+// channels. Within a reservation, consecutive bands go to processors of the
+// same node. A limit on the threads used per node, set by the execution
+// context (see VeraLuxContext), leaves room for other jobs running on the
+// same machine.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxTopology_h
+#define __VeraLuxTopology_h
+
+#include <pcl/Defs.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxTopology
+ * \brief NUMA node layout and processor reservations for the row band
+ * scheduler.
+ *
+ * Nodes are detected from the operating system on Linux and Windows, and
+ * limited to the processors the process may run on. Elsewhere, or when
+ * detection fails, all processors form a single node. All member functions
+ * are thread-safe.
+ */
+class VeraLuxTopology
+{
+public:
+
+   /*!
+    * \brief Logical processor indices of each NUMA node, in node order.
+    */
+   static const std::vector<std::vector<int>>& Nodes();
+
+   /*!
+    * \brief Number of NUMA nodes with at least one usable processor.
+    */
+   static int NumberOfNodes()
+   {
+      return int( Nodes().size() );
+   }
+
+   /*!
+    * \brief Limit of threads per node of the calling thread's execution
+    * context (VeraLuxContext::maxThreadsPerNode), or zero when unlimited.
+    */
+   static int MaximumThreadsPerNode();
+
+   /*!
+    * \brief Maximum number of threads of an execution context, accounting
+    * for its limit of threads per node.
+    */
+   static int AvailableThreads();
+
+   /*!
+    * \brief Processors for the row bands started by the calling thread.
+    *
+    * The processors of the innermost reservation held by the calling thread,
+    * or else the least reserved processors of every node, up to the limit of
+    * threads per node. Grouped by node, in node order.
+    */
+   static std::vector<int> Processors();
+
+   /*!
+    * \brief Processor for band \a band of \a bands consecutive row bands.
+    *
+    * Bands are mapped proportionally over \a processors, so consecutive
+    * bands share a node and the mapping only depends on the band count.
+    */
+   static int BandProcessor( const std::vector<int>& processors, int band, int bands )
+   {
+      if ( processors.empty() || bands <= 0 )
+         return -1;
+      return processors[size_type( int64( band )*int64( processors.size() )/bands )];
+   }
+
+   /*!
+    * \brief Binds the calling thread to a logical processor.
+    *
+    * For threads not started through PCL. Only implemented on Linux; a
+    * no-op elsewhere or for a negative \a processor.
+    */
+   static void PinCurrentThread( int processor );
+
+   /*!
+    * \class pcl::VeraLuxTopology::Reservation
+    * \brief Scoped processor reservation of an execution context.
+    *
+    * While it exists, row bands started by the thread that created it run on
+    * the reserved processors. Reservations must be destroyed by the thread
+    * that created them, in reverse order of creation.
+    */
+   class Reservation
+   {
+   public:
+
+      /*!
+       * \brief Reserves up to \a threads processors.
+       *
+       * A reservation that fits in a single node, within the limit of threads
+       * per node, takes processors only from the node with most unreserved
+       * processors. Larger ones take from nodes by decreasing availability.
+       * Zero or a negative value reserves AvailableThreads() processors.
+       */
+      Reservation( int threads = 0 );
+
+      ~Reservation();
+
+      Reservation( const Reservation& ) = delete;
+      Reservation& operator =( const Reservation& ) = delete;
+
+      /*!
+       * \brief Reserved processors, grouped by node.
+       */
+      const std::vector<int>& Processors() const
+      {
+         return m_processors;
+      }
+
+      /*!
+       * \brief Number of reserved processors.
+       */
+      int Count() const
+      {
+         return int( m_processors.size() );
+      }
+
+   private:
+
+      std::vector<int>   m_processors;
+      const Reservation* m_previous;
+   };
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxTopology_h
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,180 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+#include "VeraLuxWorkspace.h"
+
+#include <pcl/AutoLock.h>
+
+#include <utility>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+Image VeraLuxWorkspace::AcquireImage( int width, int height, int numberOfChannels )
+{
+   {
+      volatile AutoLock lock( m_mutex );
+      // Most recently released first
+      for ( size_type i = m_images.size(); i > 0; --i )
+      {
+         Image& pooled = m_images[i-1];
+         if ( pooled.Width() == width && pooled.Height() == height && pooled.NumberOfChannels() == numberOfChannels )
+         {
+            Image image( std::move( pooled ) );
+            m_images.erase( m_images.begin() + (i-1) );
+            m_size -= image.ImageSize();
+            return image;
+         }
+      }
+   }
+
+   Image image;
+   image.AllocateData( width, height, numberOfChannels );
+   return image;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxWorkspace::ReleaseImage( Image& image )
+{
+   if ( image.IsEmpty() || !image.IsUniqueImage() || image.ImageSize() > m_capacity )
+   {
+      image.FreeData();
+      return;
+   }
+
+   volatile AutoLock lock( m_mutex );
+   m_size += image.ImageSize();
+   m_images.push_back( std::move( image ) );
+   image = Image();
+   Trim();
+}
+
+// ----------------------------------------------------------------------------
+
+std::vector<float> VeraLuxWorkspace::AcquireSamples( size_type capacity )
+{
+   {
+      volatile AutoLock lock( m_mutex );
+      // Smallest pooled vector that fits
+      size_type best = m_samples.size();
+      for ( size_type i = 0; i < m_samples.size(); ++i )
+         if ( m_samples[i].capacity() >= capacity )
+            if ( best == m_samples.size() || m_samples[i].capacity() < m_samples[best].capacity() )
+               best = i;
+
+      if ( best < m_samples.size() )
+      {
+         std::vector<float> samples( std::move( m_samples[best] ) );
+         m_samples.erase( m_samples.begin() + best );
+         m_size -= samples.capacity()*sizeof( float );
+         samples.clear();
+         return samples;
+      }
+   }
+
+   std::vector<float> samples;
+   samples.reserve( capacity );
+   return samples;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxWorkspace::ReleaseSamples( std::vector<float>& samples )
+{
+   const size_type bytes = samples.capacity()*sizeof( float );
+   if ( bytes == 0 || bytes > m_capacity )
+   {
+      std::vector<float>().swap( samples );
+      return;
+   }
+
+   volatile AutoLock lock( m_mutex );
+   m_size += bytes;
+   m_samples.push_back( std::move( samples ) );
+   std::vector<float>().swap( samples );
+   Trim();
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxWorkspace::Clear()
+{
+   volatile AutoLock lock( m_mutex );
+   m_images.clear();
+   m_samples.clear();
+   m_size = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+size_type VeraLuxWorkspace::PooledSize() const
+{
+   volatile AutoLock lock( m_mutex );
+   return m_size;
+}
+
+// ----------------------------------------------------------------------------
+
+void VeraLuxWorkspace::Trim()
+{
+   // Evicts the oldest buffers, images before sample vectors since they are
+   // the largest. Called with the mutex locked.
+   while ( m_size > m_capacity && !m_images.empty() )
+   {
+      m_size -= m_images.front().ImageSize();
+      m_images.erase( m_images.begin() );
+   }
+   while ( m_size > m_capacity && !m_samples.empty() )
+   {
+      m_size -= m_samples.front().capacity()*sizeof( float );
+      m_samples.erase( m_samples.begin() );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxWorkspace::ImageLease::ImageLease( VeraLuxWorkspace* workspace, int width, int height, int numberOfChannels )
+   : m_workspace( workspace )
+{
+   if ( width <= 0 || height <= 0 || numberOfChannels <= 0 )
+      return;
+   if ( m_workspace != nullptr )
+      m_image = m_workspace->AcquireImage( width, height, numberOfChannels );
+   else
+      m_image.AllocateData( width, height, numberOfChannels );
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxWorkspace::SampleLease::SampleLease( VeraLuxWorkspace* workspace, size_type capacity )
+   : m_workspace( workspace )
+{
+   if ( m_workspace != nullptr )
+      m_samples = m_workspace->AcquireSamples( capacity );
+   else
+      m_samples.reserve( capacity );
+}
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,206 @@
+// This file is part of the VeraLux PixInsight module.
+//
+// Copyright (c) 2026 Lucas Saavedra Vaz (C++ Port for PixInsight)
+// Copyright (c) 2025 Riccardo Paterniti (Original Python implementation)
+//
+// This program is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <https://www.gnu.org/licenses/>.
+// ----------------------------------------------------------------------------
+
+// ENGINE WORKSPACE:
+//
+// Every preview refresh and every image of a batch needs the same set of
+// full-size temporaries: the working image, the luminance plane, the
+// anchored RGB copy and the percentile subsamples. Allocating and freeing
+// them each time maps and unmaps hundreds of megabytes, and the first write
+// to every page faults again.
+//
+// A workspace keeps released buffers and hands them out again to requests
+// of the same size, so a sequence of runs over images of the same geometry
+// (slider interaction on a preview, a batch of subframes) allocates only
+// once. Pooled memory is bounded by a byte capacity; the least recently
+// released buffers are freed first.
+//
+// ----------------------------------------------------------------------------
+
+#ifndef __VeraLuxWorkspace_h
+#define __VeraLuxWorkspace_h
+
+#include <pcl/Image.h>
+#include <pcl/Mutex.h>
+
+#include <vector>
+
+namespace pcl
+{
+
+// ----------------------------------------------------------------------------
+
+/*!
+ * \class VeraLuxWorkspace
+ * \brief Size-keyed pool of engine temporaries.
+ *
+ * Buffers are acquired through ImageLease and SampleLease objects, which
+ * return them to the pool when destroyed. A null workspace pointer is valid
+ * everywhere and means plain allocation.
+ *
+ * The contents of acquired buffers are undefined. All member functions are
+ * thread-safe, so a workspace can be shared by concurrent batch threads.
+ */
+class VeraLuxWorkspace
+{
+public:
+
+   /*!
+    * Default capacity of pooled memory in bytes.
+    */
+   static constexpr size_type DefaultCapacity = size_type( 1 ) << 30;
+
+   /*!
+    * \brief Constructs an empty workspace.
+    *
+    * \param capacity   Maximum size of pooled (released) memory in bytes
+    */
+   VeraLuxWorkspace( size_type capacity = DefaultCapacity )
+      : m_capacity( capacity )
+   {
+   }
+
+   VeraLuxWorkspace( const VeraLuxWorkspace& ) = delete;
+   VeraLuxWorkspace& operator =( const VeraLuxWorkspace& ) = delete;
+
+   /*!
+    * \brief Float image with the given geometry.
+    *
+    * Takes over the pixel data of a pooled image with exactly this geometry
+    * if there is one, or allocates a new image otherwise.
+    */
+   Image AcquireImage( int width, int height, int numberOfChannels );
+
+   /*!
+    * \brief Returns the pixel data of \a image to the pool.
+    *
+    * \a image is left empty. Shared images are simply released.
+    */
+   void ReleaseImage( Image& image );
+
+   /*!
+    * \brief Empty sample vector with a capacity of at least \a capacity.
+    */
+   std::vector<float> AcquireSamples( size_type capacity );
+
+   /*!
+    * \brief Returns the storage of \a samples to the pool.
+    */
+   void ReleaseSamples( std::vector<float>& samples );
+
+   /*!
+    * \brief Frees all pooled memory.
+    */
+   void Clear();
+
+   /*!
+    * \brief Size of pooled memory in bytes.
+    */
+   size_type PooledSize() const;
+
+   /*!
+    * \class pcl::VeraLuxWorkspace::ImageLease
+    * \brief Scoped float image acquired from an optional workspace.
+    *
+    * A lease of an empty geometry (no pixels or no channels) holds an empty
+    * image.
+    */
+   class ImageLease
+   {
+   public:
+
+      ImageLease( VeraLuxWorkspace* workspace, int width, int height, int numberOfChannels );
+
+      ~ImageLease()
+      {
+         if ( m_workspace != nullptr )
+            m_workspace->ReleaseImage( m_image );
+      }
+
+      ImageLease( const ImageLease& ) = delete;
+      ImageLease& operator =( const ImageLease& ) = delete;
+
+      Image& operator *()
+      {
+         return m_image;
+      }
+
+      Image* operator ->()
+      {
+         return &m_image;
+      }
+
+   private:
+
+      VeraLuxWorkspace* m_workspace;
+      Image             m_image;
+   };
+
+   /*!
+    * \class pcl::VeraLuxWorkspace::SampleLease
+    * \brief Scoped sample vector acquired from an optional workspace.
+    */
+   class SampleLease
+   {
+   public:
+
+      SampleLease( VeraLuxWorkspace* workspace, size_type capacity );
+
+      ~SampleLease()
+      {
+         if ( m_workspace != nullptr )
+            m_workspace->ReleaseSamples( m_samples );
+      }
+
+      SampleLease( const SampleLease& ) = delete;
+      SampleLease& operator =( const SampleLease& ) = delete;
+
+      std::vector<float>& operator *()
+      {
+         return m_samples;
+      }
+
+      std::vector<float>* operator ->()
+      {
+         return &m_samples;
+      }
+
+   private:
+
+      VeraLuxWorkspace*  m_workspace;
+      std::vector<float> m_samples;
+   };
+
+private:
+
+   mutable Mutex                   m_mutex;
+   size_type                       m_capacity;
+   size_type                       m_size = 0;
+   std::vector<Image>              m_images;   // least recently released first
+   std::vector<std::vector<float>> m_samples;  // least recently released first
+
+   void Trim();
+};
+
+// ----------------------------------------------------------------------------
+
+} // pcl
+
+#endif   // __VeraLuxWorkspace_h
+
+// ----------------------------------------------------------------------------
@@ -18,10 +18,26 @@
 
 #include "HyperMetricStretchInstance.h"
 #include "HyperMetricStretchParameters.h"
+#include "../../core/VeraLuxGPU.h"
+#include "../../core/VeraLuxParallel.h"
+#include "../../core/VeraLuxPipeline.h"
+#include "../../core/VeraLuxSIMD.h"
+#include "../../core/VeraLuxTopology.h"
 
+#include <pcl/AutoLock.h>
 #include <pcl/AutoViewLock.h>
 #include <pcl/Console.h>
+#include <pcl/ElapsedTime.h>
+#include <pcl/FITSHeaderKeyword.h>
+#include <pcl/File.h>
+#include <pcl/FileFormat.h>
+#include <pcl/FileFormatInstance.h>
+#include <pcl/ICCProfile.h>
+#include <pcl/ImageWindow.h>
+#include <pcl/MetaModule.h>
+#include <pcl/ReferenceArray.h>
 #include <pcl/StandardStatus.h>
+#include <pcl/Thread.h>
 #include <pcl/View.h>
 
 namespace pcl
@@ -42,6 +58,34 @@ HyperMetricStretchInstance::HyperMetricStretchInstance( const MetaProcess* m )
    , shadowConvergence( 0.0 )
    , linearExpansion( 0.0 )
    , adaptiveAnchor( true )
+   , pipelineMode( HMSPipelineMode::Default )
+   , statisticsEstimator( HMSStatisticsEstimator::Default )
+   , computePrecision( HMSComputePrecision::Default )
+   , outputPostfix( TheHMSOutputPostfixParameter->DefaultValue() )
+   , outputExtension( TheHMSOutputExtensionParameter->DefaultValue() )
+   , overwriteExistingFiles( TheHMSOverwriteExistingFilesParameter->DefaultValue() )
+   , batchAutoLogD( TheHMSBatchAutoLogDParameter->DefaultValue() )
+   , batchSharedStretch( TheHMSBatchSharedStretchParameter->DefaultValue() )
+   , batchConcurrency( int32( TheHMSBatchConcurrencyParameter->DefaultValue() ) )
+   , maxThreads( int32( TheHMSMaxThreadsParameter->DefaultValue() ) )
+   , maxThreadsPerNode( int32( TheHMSMaxThreadsPerNodeParameter->DefaultValue() ) )
+   , sweep( TheHMSSweepParameter->DefaultValue() )
+   , streaming( HMSStreamingMode::Default )
+   , streamingThreshold( int32( TheHMSStreamingThresholdParameter->DefaultValue() ) )
+   , streamingTileBudget( int32( TheHMSStreamingTileBudgetParameter->DefaultValue() ) )
+   , gpuAcceleration( TheHMSGPUAccelerationParameter->DefaultValue() )
+   , instrumentation( TheHMSInstrumentationParameter->DefaultValue() )
+   , signatureMedian( 0 )
+   , signatureMAD( 0 )
+   , signatureP99( 0 )
+   , signatureP999( 0 )
+   , signatureP9999( 0 )
+   , signatureStarPressure( 0 )
+   , signatureStatisticalAnchor( 0 )
+   , signatureAdaptiveAnchor( 0 )
+   , signaturePeak( 0 )
+   , signaturePeakIsStar( false )
+   , signaturePhysicalPeak( 0 )
 {
 }
 
@@ -62,6 +106,8 @@ void HyperMetricStretchInstance::Assign( const ProcessImplementation& p )
    {
       processingMode = x->processingMode;
       sensorProfile = x->sensorProfile;
+      sensorProfileFile = x->sensorProfileFile;
+      sensorProfileName = x->sensorProfileName;
       targetBackground = x->targetBackground;
       logD = x->logD;
       protectB = x->protectB;
@@ -71,6 +117,41 @@ void HyperMetricStretchInstance::Assign( const ProcessImplementation& p )
       shadowConvergence = x->shadowConvergence;
       linearExpansion = x->linearExpansion;
       adaptiveAnchor = x->adaptiveAnchor;
+      pipelineMode = x->pipelineMode;
+      statisticsEstimator = x->statisticsEstimator;
+      computePrecision = x->computePrecision;
+      targets = x->targets;
+      outputDirectory = x->outputDirectory;
+      outputPostfix = x->outputPostfix;
+      outputExtension = x->outputExtension;
+      overwriteExistingFiles = x->overwriteExistingFiles;
+      batchAutoLogD = x->batchAutoLogD;
+      batchSharedStretch = x->batchSharedStretch;
+      batchConcurrency = x->batchConcurrency;
+      maxThreads = x->maxThreads;
+      maxThreadsPerNode = x->maxThreadsPerNode;
+      sweep = x->sweep;
+      sweepLogD = x->sweepLogD;
+      sweepProtectB = x->sweepProtectB;
+      sweepColorStrategy = x->sweepColorStrategy;
+      sweepTargetBackground = x->sweepTargetBackground;
+      streaming = x->streaming;
+      streamingThreshold = x->streamingThreshold;
+      streamingTileBudget = x->streamingTileBudget;
+      gpuAcceleration = x->gpuAcceleration;
+      instrumentation = x->instrumentation;
+      instrumentationLog = x->instrumentationLog;
+      signatureMedian = x->signatureMedian;
+      signatureMAD = x->signatureMAD;
+      signatureP99 = x->signatureP99;
+      signatureP999 = x->signatureP999;
+      signatureP9999 = x->signatureP9999;
+      signatureStarPressure = x->signatureStarPressure;
+      signatureStatisticalAnchor = x->signatureStatisticalAnchor;
+      signatureAdaptiveAnchor = x->signatureAdaptiveAnchor;
+      signaturePeak = x->signaturePeak;
+      signaturePeakIsStar = x->signaturePeakIsStar;
+      signaturePhysicalPeak = x->signaturePhysicalPeak;
    }
 }
 
@@ -83,6 +164,14 @@ UndoFlags HyperMetricStretchInstance::UndoMode( const View& ) const
 
 // ----------------------------------------------------------------------------
 
+bool HyperMetricStretchInstance::IsHistoryUpdater( const View& ) const
+{
+   // Sweep variants go to new image windows
+   return !sweep;
+}
+
+// ----------------------------------------------------------------------------
+
 bool HyperMetricStretchInstance::CanExecuteOn( const View& view, String& whyNot ) const
 {
    if ( view.Image().IsComplexSample() )
@@ -91,17 +180,114 @@ bool HyperMetricStretchInstance::CanExecuteOn( const View& view, String& whyNot
       return false;
    }
 
-   return true;
+   if ( sweep )
+      try
+      {
+         (void)SweepVariants();
+      }
+      catch ( const Exception& x )
+      {
+         whyNot = x.Message();
+         return false;
+      }
+
+   return ValidateSensorProfile( whyNot );
+}
+
+// ----------------------------------------------------------------------------
+
+SensorProfile HyperMetricStretchInstance::GetSensorProfile() const
+{
+   if ( !sensorProfileFile.Trimmed().IsEmpty() )
+      try
+      {
+         return *CustomSensorProfile();
+      }
+      catch ( Exception& )
+      {
+         // Reported by ValidateSensorProfile()
+      }
+
+   // Map parameter index to global sensor profile array
+   if ( sensorProfile >= 0 && size_type( sensorProfile ) < g_numSensorProfiles )
+      return g_sensorProfiles[sensorProfile];
+   // Default fallback
+   return g_sensorProfiles[0];
+}
+
+// ----------------------------------------------------------------------------
+
+std::shared_ptr<const SensorProfile> HyperMetricStretchInstance::CustomSensorProfile() const
+{
+   const String path = sensorProfileFile.Trimmed();
+   if ( path.IsEmpty() )
+      return nullptr;
+   const String name = sensorProfileName.Trimmed();
+   const String key = path + '\n' + name;
+
+   volatile AutoLock lock( m_customProfileMutex );
+   if ( key != m_customProfileKey )
+   {
+      m_customProfileKey = key;
+      m_customProfile.reset();
+      m_customProfileError.Clear();
+      try
+      {
+         std::vector<SensorProfile> profiles = LoadSensorProfiles( path );
+         const IsoString wanted = name.ToUTF8();
+         for ( const SensorProfile& profile : profiles )
+            if ( wanted.IsEmpty() || profile.name == wanted )
+            {
+               m_customProfile = std::make_shared<const SensorProfile>( profile );
+               break;
+            }
+         if ( !m_customProfile )
+            m_customProfileError = name.IsEmpty() ?
+               path + ": No sensor profiles defined." :
+               path + ": No sensor profile named '" + name + "'.";
+      }
+      catch ( Exception& x )
+      {
+         m_customProfileError = x.Message();
+      }
+   }
+
+   if ( !m_customProfile )
+      throw Error( m_customProfileError );
+   return m_customProfile;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInstance::ValidateSensorProfile( String& whyNot ) const
+{
+   try
+   {
+      CustomSensorProfile();
+      return true;
+   }
+   catch ( Exception& x )
+   {
+      whyNot = x.Message();
+      return false;
+   }
 }
 
 // ----------------------------------------------------------------------------
 
 void HyperMetricStretchInstance::GetEffectiveParams( double& grip, double& shadow, double& linearExp ) const
+{
+   GetEffectiveParams( colorStrategy, grip, shadow, linearExp );
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::GetEffectiveParams( int32 strategy, double& grip, double& shadow, double& linearExp ) const
 {
    if ( processingMode == HMSProcessingMode::ReadyToUse )
    {
       // Ready-to-Use mode: derive from colorStrategy
-      int val = colorStrategy;
+      int val = strategy;
       if ( val < 0 )
       {
          // Left: Increase Shadow Convergence, Grip stays 1.0
@@ -127,6 +313,194 @@ void HyperMetricStretchInstance::GetEffectiveParams( double& grip, double& shado
 
 // ----------------------------------------------------------------------------
 
+static const char* StatisticsEstimatorName( StatisticsEstimator::value_type estimator )
+{
+   switch ( estimator )
+   {
+   default:
+   case StatisticsEstimator::Exact:     return "exact";
+   case StatisticsEstimator::Histogram: return "histogram";
+   case StatisticsEstimator::MAD:       return "MAD";
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+static void WriteTopology( Console& console )
+{
+   // Nothing to report on a single node without a thread limit
+   const std::vector<std::vector<int>>& nodes = VeraLuxTopology::Nodes();
+   const int limit = VeraLuxTopology::MaximumThreadsPerNode();
+   if ( nodes.size() < 2 && limit <= 0 )
+      return;
+
+   String text = String().Format( "NUMA nodes: %d (", int( nodes.size() ) );
+   for ( size_type i = 0; i < nodes.size(); ++i )
+      text.AppendFormat( (i > 0) ? "+%d" : "%d", int( nodes[i].size() ) );
+   text += " processors)";
+   if ( limit > 0 )
+      text.AppendFormat( ", at most %d thread(s) per node", limit );
+   console.WriteLn( text );
+}
+
+// ----------------------------------------------------------------------------
+
+static void WriteGPU( Console& console )
+{
+   if ( !VeraLuxGPU::IsEnabled() )
+      return;
+   if ( VeraLuxGPU::IsAvailable() )
+      console.WriteLn( String().Format( "GPU acceleration: %s (streamed strips)", VeraLuxGPU::DeviceName().c_str() ) );
+   else
+      console.WarningLn( "** Warning: GPU acceleration is enabled, but no OpenCL GPU device is available." );
+}
+
+// ----------------------------------------------------------------------------
+
+static String SignatureInfo( const VeraLuxSignature& signature )
+{
+   return String().Format( "Signature: median %.6f, MAD %.6f, p99.9 %.6f, star pressure %.3f, peak %.6f (%s), "
+                           "star peak %.6f",
+                           signature.median, signature.mad, signature.p999, signature.starPressure,
+                           signature.peak, signature.peakHasNeighbors ? "star" : "isolated",
+                           signature.physicalPeak );
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::ReportInstrumentation( const VeraLuxRunLog* log, const View& view,
+                                                        const ImageVariant& image ) const
+{
+   if ( log == nullptr )
+      return;
+
+   Console().WriteLn( log->Report() );
+
+   if ( !instrumentationLog.Trimmed().IsEmpty() )
+   {
+      try
+      {
+         log->AppendToFile( instrumentationLog.Trimmed(), IsoString( view.FullId() ),
+                            image.Width(), image.Height(), image.NumberOfChannels() );
+      }
+      catch ( ... )
+      {
+         // A log that cannot be written must not fail the execution
+         Console().WarningLn( "** Warning: Cannot write instrumentation log: " + instrumentationLog );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+static String SweepVariantInfo( const HyperMetricStretchInstance::SweepVariant& variant, bool readyToUse,
+                                bool solved )
+{
+   String info = String().Format( "Log D=%.2f, b=%.2f", variant.logD, variant.protectB );
+   if ( solved )
+      info.AppendFormat( " (target background=%.2f)", variant.targetBackground );
+   if ( readyToUse )
+      info.AppendFormat( ", color strategy=%d", int( variant.colorStrategy ) );
+   return info;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::ExecuteSweep( const View& view, const ImageVariant& image,
+                                               TransferEvaluation::value_type transfer,
+                                               VeraLuxRunLog* log, StatusCallback& status )
+{
+   Console console;
+
+   sweep_list variants = SweepVariants();
+   const bool solved = SweepSolvesLogD( false/*autoLogD*/ );
+   const StatisticsEstimator::value_type estimator = StatisticsEstimator::value_type( statisticsEstimator );
+   const bool readyToUse = processingMode == HMSProcessingMode::ReadyToUse;
+   const size_type N = image.NumberOfPixels();
+
+   // Throws if not even one variant fits the tile budget
+   const size_type groupSize = SweepGroupSize( image.Width(), image.Height(), image.NumberOfChannels() );
+
+   console.WriteLn( String().Format( "Parameter sweep: %d variant(s), %d per pass",
+                    int( variants.Length() ), int( Min( groupSize, variants.Length() ) ) ) );
+   if ( pipelineMode == HMSPipelineMode::StepByStep )
+      console.WarningLn( "** Warning: Parameter sweeps always use the fused pipeline." );
+   if ( UseStreaming( image.Width(), image.Height(), image.NumberOfChannels() ) )
+      console.WarningLn( "** Warning: Parameter sweeps are processed in memory; streamed execution is not used." );
+
+   // Signature, anchor and Smart Max peaks, from one strip scan of the
+   // unmodified image, shared by all variants
+   const VeraLuxStreamAnalysis analysis = AnalyzeImage( image, log, status );
+   const double anchor = analysis.anchor;
+   console.WriteLn( String().Format( "Anchor: %.6f", anchor ) );
+
+   // Log D of each swept target background, from the analysis median
+   if ( solved )
+      SolveSweepLogD( variants, analysis.luminanceMedian );
+
+   // The view is not modified, so the working image is always a copy
+   Image working;
+   {
+      VeraLuxStageTimer T( log, "NormalizeInput", N, N*sizeof( float )*image.NumberOfChannels() );
+      VeraLuxEngine::NormalizeInput( working, image );
+   }
+
+   FITSKeywordArray keywords;
+   view.Window().GetKeywords( keywords );
+
+   // Variants are rendered in groups whose outputs fit the tile budget.
+   // Each group goes to its windows and is released before the next one.
+   for ( size_type first = 0; first < variants.Length(); first += groupSize )
+   {
+      const sweep_list group = SweepGroup( variants, first, groupSize );
+
+      console.WriteLn( String().Format( "Rendering sweep variants %d-%d...",
+                                        int( first + 1 ), int( first + group.Length() ) ) );
+      std::vector<Image> outputs;
+      std::vector<LinearExpansionStats> expansion;
+      std::vector<OutputScalingStats> scaling;
+      {
+         VeraLuxStageTimer T( log, "ApplySweep", N*group.Length() );
+         ApplySweep( working, anchor, &analysis.peak, group, transfer, outputs, &expansion, &scaling );
+      }
+
+      for ( size_type j = 0; j < group.Length(); ++j )
+      {
+         const size_type k = first + j;
+         IsoString id = view.Id();
+         id += IsoString().Format( "_sweep%02d", int( k + 1 ) );
+         ImageWindow window( image.Width(), image.Height(), image.NumberOfChannels(),
+                             image.BitsPerSample(), image.IsFloatSample(), image.IsColor(), true/*initialProcessing*/, id );
+         ImageVariant output = window.MainView().Image();
+         {
+            VeraLuxStageTimer T( log, "StoreOutput", N );
+            VeraLuxEngine::StoreOutput( output, outputs[j] );
+         }
+         outputs[j].FreeData();
+
+         FITSKeywordArray variantKeywords = keywords;
+         variantKeywords.Add( FITSHeaderKeyword( "HISTORY", IsoString(),
+                              IsoString().Format( "HyperMetricStretch: logD=%.4f b=%.2f anchor=%.6f",
+                                                  group[j].logD, group[j].protectB, anchor ) ) );
+         window.SetKeywords( variantKeywords );
+         window.Show();
+
+         String info = String().Format( "Variant %d/%d: ", int( k + 1 ), int( variants.Length() ) );
+         info += SweepVariantInfo( group[j], readyToUse, solved );
+         console.WriteLn( info );
+         if ( !readyToUse && linearExpansion > 0.001 )
+            console.WriteLn( String().Format( "  Linear expansion bounds: [%.6f, %.6f] (%s estimator)",
+                             expansion[j].low, expansion[j].high, StatisticsEstimatorName( estimator ) ) );
+         if ( readyToUse )
+            console.WriteLn( String().Format( "  Soft ceiling: %.6f (%s estimator), scale: %.4f",
+                             scaling[j].softCeiling, StatisticsEstimatorName( estimator ), scaling[j].scale ) );
+         console.WriteLn( "  -> " + String( window.MainView().Id() ) );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+
 bool HyperMetricStretchInstance::ExecuteOn( View& view )
 {
    AutoViewLock lock( view );
@@ -142,12 +516,27 @@ bool HyperMetricStretchInstance::ExecuteOn( View& view )
    Console console;
    console.EnableAbort();
 
+   // The settings of this instance hold for the whole run, and every pass
+   // over the image runs its row bands on the same processors
+   VeraLuxContext::Scope context( EngineContext() );
+   VeraLuxTopology::Reservation reservation( maxThreads );
+
    // Get effective parameters
    double grip, shadow, linearExp;
    GetEffectiveParams( grip, shadow, linearExp );
 
-   const SensorProfile& profile = GetSensorProfile();
+   const SensorProfile profile = GetSensorProfile();
    double D = Pow10( logD );
+   const StatisticsEstimator::value_type estimator = StatisticsEstimator::value_type( statisticsEstimator );
+   // Lookup tables are accurate enough for integer results up to 16 bits
+   const TransferEvaluation::value_type transfer =
+      VeraLuxEngine::TransferEvaluationFor( image.BitsPerSample(), image.IsFloatSample() );
+
+   // Stage timers are disabled by a null log
+   VeraLuxRunLog runLog;
+   VeraLuxRunLog* log = instrumentation ? &runLog : nullptr;
+   const size_type N = image.NumberOfPixels();
+   const size_type planeBytes = N*sizeof( float );
 
    try
    {
@@ -156,86 +545,201 @@ bool HyperMetricStretchInstance::ExecuteOn( View& view )
       console.WriteLn( String().Format( "Mode: %s | Sensor: %s",
                        (processingMode == HMSProcessingMode::ReadyToUse) ? "Ready-to-Use" : "Scientific",
                        profile.name.c_str() ) );
+      console.WriteLn( String().Format( "Vector kernels: %s | Precision: %s",
+                       VeraLuxSIMD::InstructionSetName( VeraLuxSIMD::ActiveInstructionSet() ),
+                       VeraLuxSIMD::PrecisionName( VeraLuxSIMD::Precision() ) ) );
+      WriteTopology( console );
+      WriteGPU( console );
+      if ( transfer == TransferEvaluation::LookupTable )
+         console.WriteLn( "Transfer functions: lookup tables" );
 
-      Image working;
-      VeraLuxEngine::NormalizeInput( working, image );
+      if ( sweep )
+      {
+         // Steps 1-8 once for every variant, each one into a new window
+         ExecuteSweep( view, image, transfer, log, status );
+         ReportInstrumentation( log, view, image );
+         console.WriteLn( "<end><cbr>Done." );
+         return true;
+      }
+
+      if ( UseStreaming( image.Width(), image.Height(), image.NumberOfChannels() ) )
+      {
+         // Steps 1-8 over strips of rows, stretching the image in place
+         console.WriteLn( String().Format( "Streamed execution: %d rows per strip (%d MiB tile budget)",
+                          Min( VeraLuxStreaming::RowsPerStrip( image.Width(), image.NumberOfChannels(), StreamingBudget() ),
+                               image.Height() ), int( streamingTileBudget ) ) );
+         if ( pipelineMode == HMSPipelineMode::StepByStep )
+            console.WarningLn( "** Warning: Streamed execution always uses the fused pipeline." );
+
+         VeraLuxImageRowSource source( image );
+         VeraLuxImageRowSink sink( image );
+
+         VeraLuxSignature signature;
+         StretchSolution solution;
+         {
+            VeraLuxStageTimer T( log, "SolveStreamed", N );
+            solution = SolveStreamed( source, transfer, false/*autoLogD*/, nullptr, &status, &signature );
+         }
+         StoreSignature( signature );
+         console.WriteLn( SignatureInfo( signature ) );
+         console.WriteLn( String().Format( "Anchor: %.6f", solution.anchor ) );
+         if ( processingMode == HMSProcessingMode::Scientific && linearExp > 0.001 )
+            console.WriteLn( String().Format( "  Linear expansion bounds: [%.6f, %.6f] (%s estimator)",
+                             solution.expansion.low, solution.expansion.high, StatisticsEstimatorName( estimator ) ) );
+         if ( processingMode == HMSProcessingMode::ReadyToUse )
+            console.WriteLn( String().Format( "  Soft ceiling: %.6f (%s estimator), scale: %.4f",
+                             solution.scaling.softCeiling, StatisticsEstimatorName( estimator ), solution.scaling.scale ) );
+
+         console.WriteLn( String().Format( "Applying streamed stretch (Log D=%.2f, b=%.2f)...", logD, protectB ) );
+         {
+            VeraLuxStageTimer T( log, "ApplyStreamed", N );
+            ApplyStreamed( source, sink, solution, transfer, &status );
+         }
 
-      // Step 2: Calculate anchor
-      double anchor;
-      if ( adaptiveAnchor )
+         ReportInstrumentation( log, view, image );
+         console.WriteLn( "<end><cbr>Done." );
+         return true;
+      }
+
+      // Signature, anchor (step 2) and Smart Max peaks, from one strip scan
+      // of the unmodified image
+      const VeraLuxStreamAnalysis analysis = AnalyzeImage( image, log, status );
+
+      // 32-bit float images are normalized and stretched in place; other
+      // sample types need a float working image.
+      const bool inPlace = image.IsFloatSample() && image.BitsPerSample() == 32;
+      Image buffer;
+      if ( inPlace )
       {
-         console.WriteLn( "Calculating adaptive anchor (morphological)..." );
-         anchor = VeraLuxEngine::CalculateAnchorAdaptive( working, profile );
+         VeraLuxStageTimer T( log, "NormalizeInPlace", N );
+         VeraLuxEngine::NormalizeInPlace( static_cast<Image&>( *image ) );
       }
       else
       {
-         console.WriteLn( "Calculating anchor (statistical)..." );
-         anchor = VeraLuxEngine::CalculateAnchor( working );
+         VeraLuxStageTimer T( log, "NormalizeInput", N, planeBytes*image.NumberOfChannels() );
+         VeraLuxEngine::NormalizeInput( buffer, image );
       }
-      console.WriteLn( String().Format( "Anchor: %.6f", anchor ) );
+      Image& working = inPlace ? static_cast<Image&>( *image ) : buffer;
 
-      // Step 3: Extract luminance
-      console.WriteLn( "Extracting photometric luminance..." );
-      Image luma;
-      VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+      // Step 2: Anchor, measured by the analysis
+      const double anchor = analysis.anchor;
+      console.WriteLn( String().Format( "Anchor: %.6f (%s)", anchor,
+                                        adaptiveAnchor ? "adaptive, morphological" : "statistical" ) );
 
-      // Step 4: Apply hyperbolic stretch
-      console.WriteLn( String().Format( "Applying hyperbolic stretch (Log D=%.2f, b=%.2f)...", logD, protectB ) );
-      VeraLuxEngine::HyperbolicStretch( luma, D, protectB );
+      const bool expand = processingMode == HMSProcessingMode::Scientific && linearExp > 0.001;
+      FusedStretchParameters fused = FusedParameters( anchor, logD, transfer );
+      fused.peak = &analysis.peak;
+      LinearExpansionStats expansion;
 
-      // Step 5: Linear expansion (Scientific mode only)
-      if ( processingMode == HMSProcessingMode::Scientific && linearExp > 0.001 )
+      if ( pipelineMode == HMSPipelineMode::Fused )
       {
-         console.WriteLn( String().Format( "Applying linear expansion (%.2f)...", linearExp ) );
-         LinearExpansionStats stats;
-         VeraLuxEngine::ApplyLinearExpansion( luma, float( linearExp ), &stats );
+         // Steps 3-6 in a single pass: luminance, stretch, expansion, color
+         console.WriteLn( String().Format( "Applying fused stretch pipeline (Log D=%.2f, b=%.2f)...", logD, protectB ) );
+         if ( expand )
+            console.WriteLn( String().Format( "Applying linear expansion (%.2f)...", linearExp ) );
 
-         if ( stats.pctHigh >= 0.01 )
-            console.WarningLn( String().Format( "  Warning: %.3f%% of pixels clamped at high end", stats.pctHigh ) );
-      }
-
-      // Step 6: Reconstruct color with vector preservation
-      console.WriteLn( "Reconstructing color (vector preservation)..." );
+         {
+            VeraLuxStageTimer T( log, "FusedPipeline", N );
+            VeraLuxPipeline::Run( working, profile, fused, &expansion );
+         }
 
-      // Need anchored RGB for color reconstruction
-      Image anchoredRGB;
-      if ( working.NumberOfChannels() == 3 )
-      {
-         anchoredRGB.AllocateData( working.Width(), working.Height(), 3 );
-         float anchorF = float( anchor );
-         for ( int c = 0; c < 3; ++c )
+         if ( expand )
          {
-            const float* src = working[c];
-            float* dst = anchoredRGB[c];
-            size_t N = working.NumberOfPixels();
-            for ( size_t i = 0; i < N; ++i )
-               dst[i] = Max( 0.0f, src[i] - anchorF );
+            console.WriteLn( String().Format( "  Bounds: [%.6f, %.6f] (%s estimator, %.3f ms)",
+                             expansion.low, expansion.high, StatisticsEstimatorName( estimator ),
+                             expansion.estimatorTime*1000 ) );
+            if ( expansion.pctHigh >= 0.01 )
+               console.WarningLn( String().Format( "  Warning: %.3f%% of pixels clamped at high end", expansion.pctHigh ) );
          }
       }
       else
       {
-         anchoredRGB.Assign( working );
-         anchoredRGB.Truncate( float( anchor ), 1.0f );
-         anchoredRGB -= anchor;
-      }
+         // Step 3: Extract luminance
+         console.WriteLn( "Extracting photometric luminance..." );
+         Image luma;
+         {
+            VeraLuxStageTimer T( log, "ExtractLuminance", N, planeBytes );
+            VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+         }
 
-      VeraLuxEngine::ReconstructColor( working, luma, anchoredRGB,
-                                        colorConvergence, grip, shadow, D, protectB );
+         // Step 4: Apply hyperbolic stretch
+         console.WriteLn( String().Format( "Applying hyperbolic stretch (Log D=%.2f, b=%.2f)...", logD, protectB ) );
+         {
+            VeraLuxStageTimer T( log, "HyperbolicStretch", N );
+            VeraLuxEngine::HyperbolicStretch( luma, D, protectB, 0.0, transfer );
+         }
+
+         // Step 5: Linear expansion (Scientific mode only)
+         if ( expand )
+         {
+            console.WriteLn( String().Format( "Applying linear expansion (%.2f)...", linearExp ) );
+            {
+               VeraLuxStageTimer T( log, "ApplyLinearExpansion", N );
+               // Smart Max on the analysis peaks, stretched like luma
+               Image peakLuma;
+               if ( !analysis.peak.IsEmpty() )
+               {
+                  VeraLuxEngine::ExtractLuminance( peakLuma, analysis.peak, anchor, profile );
+                  VeraLuxEngine::HyperbolicStretch( peakLuma, D, protectB, 0.0, transfer );
+               }
+               VeraLuxEngine::ApplyLinearExpansion( luma, float( linearExp ), &expansion, estimator,
+                                                    peakLuma.IsEmpty() ? nullptr : &peakLuma );
+            }
+
+            console.WriteLn( String().Format( "  Bounds: [%.6f, %.6f] (%s estimator, %.3f ms)",
+                             expansion.low, expansion.high, StatisticsEstimatorName( estimator ),
+                             expansion.estimatorTime*1000 ) );
+            if ( expansion.pctHigh >= 0.01 )
+               console.WarningLn( String().Format( "  Warning: %.3f%% of pixels clamped at high end", expansion.pctHigh ) );
+         }
+
+         // Step 6: Reconstruct color with vector preservation
+         console.WriteLn( "Reconstructing color (vector preservation)..." );
+
+         // Need anchored RGB for color reconstruction
+         Image anchoredRGB;
+         {
+            VeraLuxStageTimer T( log, "SubtractAnchor", N, planeBytes*working.NumberOfChannels() );
+            VeraLuxEngine::SubtractAnchor( anchoredRGB, working, anchor );
+         }
+
+         VeraLuxStageTimer T( log, "ReconstructColor", N );
+         VeraLuxEngine::ReconstructColor( working, luma, anchoredRGB,
+                                           colorConvergence, grip, shadow, D, protectB, transfer );
+      }
 
       // Step 7: Output scaling (Ready-to-Use mode only)
       if ( processingMode == HMSProcessingMode::ReadyToUse )
       {
          console.WriteLn( "Applying adaptive output scaling..." );
-         VeraLuxEngine::AdaptiveOutputScaling( working, profile, targetBackground );
+         OutputScalingStats scaling;
+         {
+            VeraLuxStageTimer T( log, "AdaptiveOutputScaling", N, planeBytes );
+            Image peak;
+            StretchPeak( peak, analysis.peak, fused, expansion );
+            VeraLuxEngine::AdaptiveOutputScaling( working, profile, targetBackground, estimator, &scaling, transfer,
+                                                  peak.IsEmpty() ? nullptr : &peak );
+         }
+         console.WriteLn( String().Format( "  Soft ceiling: %.6f (%s estimator, %.3f ms), scale: %.4f",
+                          scaling.softCeiling, StatisticsEstimatorName( estimator ), scaling.estimatorTime*1000, scaling.scale ) );
 
          console.WriteLn( "Applying soft-clipping..." );
-         VeraLuxEngine::ApplyReadyToUseSoftClip( working, 0.98, 2.0 );
+         VeraLuxStageTimer T( log, "ApplyReadyToUseSoftClip", N );
+         VeraLuxEngine::ApplyReadyToUseSoftClip( working, 0.98, 2.0, transfer );
       }
 
       // Step 8: Write back
-      console.WriteLn( "Writing result..." );
-      image.CopyImage( working );
+      if ( !inPlace )
+      {
+         console.WriteLn( "Writing result..." );
+         {
+            VeraLuxStageTimer T( log, "StoreOutput", N );
+            VeraLuxEngine::StoreOutput( image, buffer );
+         }
+         buffer.FreeData();
+      }
 
+      ReportInstrumentation( log, view, image );
       console.WriteLn( "<end><cbr>Done." );
       return true;
    }
@@ -259,133 +763,1536 @@ bool HyperMetricStretchInstance::ExecuteOn( View& view )
 
 // ----------------------------------------------------------------------------
 
-bool HyperMetricStretchInstance::Preview( Image& img ) const
+bool HyperMetricStretchInstance::CanExecuteGlobal( String& whyNot ) const
 {
-   // Simplified version for real-time preview (no console output)
-   double grip, shadow, linearExp;
-   GetEffectiveParams( grip, shadow, linearExp );
-
-   const SensorProfile& profile = GetSensorProfile();
-   double D = Pow10( logD );
+   if ( !ValidateSensorProfile( whyNot ) )
+      return false;
 
-   try
+   if ( sweep )
    {
-      // Normalize (match Python and ExecuteOn behavior)
-      Image working;
-      ImageVariant source( &img );
-      VeraLuxEngine::NormalizeInput( working, source );
+      if ( batchSharedStretch )
+      {
+         whyNot = "A parameter sweep cannot be combined with the shared batch stretch.";
+         return false;
+      }
+      try
+      {
+         (void)SweepVariants();
+      }
+      catch ( const Exception& x )
+      {
+         whyNot = x.Message();
+         return false;
+      }
+   }
 
-      // Anchor
-      double anchor = adaptiveAnchor ?
-         VeraLuxEngine::CalculateAnchorAdaptive( working, profile ) :
-         VeraLuxEngine::CalculateAnchor( working );
+   for ( const Item& item : targets )
+      if ( item.enabled )
+         return true;
 
-      // Luminance
-      Image luma;
-      VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+   whyNot = "No target files have been specified.";
+   return false;
+}
 
-      // Stretch
-      VeraLuxEngine::HyperbolicStretch( luma, D, protectB );
+// ----------------------------------------------------------------------------
 
-      // Linear expansion (Scientific only)
-      if ( processingMode == HMSProcessingMode::Scientific && linearExp > 0.001 )
-         VeraLuxEngine::ApplyLinearExpansion( luma, float( linearExp ) );
+/*
+ * Batch target state. Written only by the worker thread processing it until
+ * the target is reported as finished.
+ */
+struct HMSBatchItem
+{
+   String path;
+   String outputPath;
+   int    width = 0, height = 0, channels = 0;
+   double anchor = 0, logD = 0;
+   double readTime = 0, stretchTime = 0, writeTime = 0;
+   bool   streamed = false;   // stretched in strips
+   bool   outOfCore = false;  // decoded and encoded in strips
+   Array<String> variantPaths;  // parameter sweep outputs, one per variant
+   String note;
+   String error;
+};
 
-      // Color reconstruction
-      Image anchoredRGB;
-      if ( working.NumberOfChannels() == 3 )
-      {
-         anchoredRGB.AllocateData( working.Width(), working.Height(), 3 );
-         float anchorF = float( anchor );
-         for ( int c = 0; c < 3; ++c )
-         {
-            const float* src = working[c];
-            float* dst = anchoredRGB[c];
-            size_t N = working.NumberOfPixels();
-            for ( size_t i = 0; i < N; ++i )
-               dst[i] = Max( 0.0f, src[i] - anchorF );
-         }
-      }
-      else
-      {
-         anchoredRGB.Assign( working );
-         anchoredRGB.Truncate( float( anchor ), 1.0f );
-         anchoredRGB -= anchor;
-      }
+/*
+ * Anchor, Log D and output scaling solved on the reference (first) target
+ * and applied to all others in shared stretch mode.
+ */
+typedef HyperMetricStretchInstance::StretchSolution HMSBatchStretch;
 
-      VeraLuxEngine::ReconstructColor( working, luma, anchoredRGB,
-                                        colorConvergence, grip, shadow, D, protectB );
+struct HMSBatchState
+{
+   Array<HMSBatchItem> items;
+   HMSBatchStretch     shared;
+   bool                useShared = false;  // workers apply the shared stretch
+   bool                reference = false;  // the worker solves the shared stretch
+   int                 threadsPerImage = 1;
+   VeraLuxContext      context;            // engine settings of every worker
+   AtomicInt           next;
+   int                 end = 0;
+   AtomicInt           abort;
+   Mutex               mutex;
+   Array<int>          finished;           // protected by mutex
+   VeraLuxWorkspace    workspace;          // temporaries reused across images
+   HyperMetricStretchInstance::sweep_list sweep;  // parameter sweep variants, empty if not sweeping
+};
 
-      // Output scaling (Ready-to-Use only)
-      if ( processingMode == HMSProcessingMode::ReadyToUse )
+// ----------------------------------------------------------------------------
+
+/*
+ * Row source decoding strips of the selected image of an open file, for
+ * formats able to read incrementally. Float files are scanned once first
+ * for the maximum sample, which selects the normalization divisor.
+ */
+class HMSFileRowSource : public VeraLuxRowSource
+{
+public:
+
+   HMSFileRowSource( FileFormatInstance& file, const ImageInfo& info, const ImageOptions& options,
+                     size_type budget, int threads )
+      : m_file( file )
+      , m_info( info )
+   {
+      m_buffer.CreateImage( options.ieeefpSampleFormat, false, options.bitsPerSample );
+      m_buffer->EnableParallelProcessing( true, threads );
+
+      double maximum = 0;
+      if ( options.ieeefpSampleFormat )
       {
-         VeraLuxEngine::AdaptiveOutputScaling( working, profile, targetBackground );
-         VeraLuxEngine::ApplyReadyToUseSoftClip( working, 0.98, 2.0 );
+         const int rows = Min( VeraLuxStreaming::RowsPerStrip( Width(), NumberOfChannels(), budget ), Height() );
+         for ( int y0 = 0; y0 < Height(); y0 += rows )
+         {
+            Decode( y0, Min( rows, Height() - y0 ) );
+            maximum = Max( maximum, (options.bitsPerSample == 64) ?
+                                    static_cast<const DImage&>( *m_buffer ).MaximumSampleValue() :
+                                    static_cast<const Image&>( *m_buffer ).MaximumSampleValue() );
+         }
       }
+      m_divisor = VeraLuxEngine::NormalizationDivisor( maximum, options.ieeefpSampleFormat, options.bitsPerSample );
+   }
 
-      // Copy back
-      img.Assign( working );
-      return true;
+   int Width() const override
+   {
+      return m_info.width;
    }
-   catch ( const std::exception& e )
+
+   int Height() const override
    {
-#ifdef DEBUG
-      Console console;
-      console.WarningLn( "<end><cbr>* Preview failed *" );
-      console.WarningLn( String().Format( "Exception: %s", e.what() ) );
-#endif
-      return false;
+      return m_info.height;
    }
-   catch ( ... )
+
+   int NumberOfChannels() const override
    {
-#ifdef DEBUG
-      Console().WarningLn( "<end><cbr>* Preview failed with unknown exception *" );
-#endif
-      return false;
+      return m_info.numberOfChannels;
    }
-}
 
-// ----------------------------------------------------------------------------
+   void ReadRows( Image& rows, int startRow, int rowCount ) override
+   {
+      Decode( startRow, rowCount );
+      VeraLuxEngine::NormalizeInput( rows, m_buffer, Rect( 0 ), m_divisor );
+   }
 
-void* HyperMetricStretchInstance::LockParameter( const MetaParameter* p, size_type /*tableRow*/ )
-{
-   if ( p == TheHMSProcessingModeParameter )
-      return &processingMode;
-   if ( p == TheHMSSensorProfileParameter )
-      return &sensorProfile;
-   if ( p == TheHMSTargetBackgroundParameter )
-      return &targetBackground;
-   if ( p == TheHMSLogDParameter )
-      return &logD;
-   if ( p == TheHMSProtectBParameter )
-      return &protectB;
-   if ( p == TheHMSColorConvergenceParameter )
-      return &colorConvergence;
-   if ( p == TheHMSColorStrategyParameter )
-      return &colorStrategy;
-   if ( p == TheHMSColorGripParameter )
-      return &colorGrip;
-   if ( p == TheHMSShadowConvergenceParameter )
-      return &shadowConvergence;
-   if ( p == TheHMSLinearExpansionParameter )
-      return &linearExpansion;
-   if ( p == TheHMSAdaptiveAnchorParameter )
-      return &adaptiveAnchor;
+private:
 
-   return nullptr;
-}
+   FileFormatInstance& m_file;
+   ImageInfo           m_info;
+   ImageVariant        m_buffer;   // strip in the file sample type
+   double              m_divisor = 1;
 
-// ----------------------------------------------------------------------------
+   template <class P>
+   void DecodeStrip( GenericImage<P>& strip, int startRow, int rowCount )
+   {
+      strip.AllocateData( Width(), rowCount, NumberOfChannels() );
+      for ( int c = 0; c < NumberOfChannels(); ++c )
+         if ( !m_file.ReadSamples( strip[c], startRow, rowCount, c ) )
+            throw Error( "Unable to read image" );
+   }
 
-bool HyperMetricStretchInstance::AllocateParameter( size_type /*sizeOrLength*/, const MetaParameter* /*p*/, size_type /*tableRow*/ )
-{
-   return true;
-}
+   void Decode( int startRow, int rowCount )
+   {
+      if ( m_buffer.IsFloatSample() )
+      {
+         if ( m_buffer.BitsPerSample() == 32 )
+            DecodeStrip( static_cast<Image&>( *m_buffer ), startRow, rowCount );
+         else
+            DecodeStrip( static_cast<DImage&>( *m_buffer ), startRow, rowCount );
+      }
+      else
+      {
+         if ( m_buffer.BitsPerSample() == 8 )
+            DecodeStrip( static_cast<UInt8Image&>( *m_buffer ), startRow, rowCount );
+         else if ( m_buffer.BitsPerSample() == 16 )
+            DecodeStrip( static_cast<UInt16Image&>( *m_buffer ), startRow, rowCount );
+         else
+            DecodeStrip( static_cast<UInt32Image&>( *m_buffer ), startRow, rowCount );
+      }
+   }
+};
 
 // ----------------------------------------------------------------------------
 
-size_type HyperMetricStretchInstance::ParameterLength( const MetaParameter* /*p*/, size_type /*tableRow*/ ) const
+/*
+ * Row sink encoding strips into a new image of an output file, for formats
+ * able to write incrementally. The caller must close the image after the
+ * last strip.
+ */
+class HMSFileRowSink : public VeraLuxRowSink
 {
+public:
+
+   HMSFileRowSink( FileFormatInstance& file, const ImageInfo& info, const ImageOptions& options )
+      : m_file( file )
+   {
+      m_buffer.CreateImage( options.ieeefpSampleFormat, false, options.bitsPerSample );
+      if ( !m_file.CreateImage( info ) )
+         throw Error( "Unable to create image" );
+   }
+
+   void WriteRows( const Image& rows, int startRow ) override
+   {
+      // Same sample conversion as writing back a whole image
+      m_buffer.CopyImage( rows );
+
+      if ( m_buffer.IsFloatSample() )
+      {
+         if ( m_buffer.BitsPerSample() == 32 )
+            EncodeStrip( static_cast<const Image&>( *m_buffer ), startRow );
+         else
+            EncodeStrip( static_cast<const DImage&>( *m_buffer ), startRow );
+      }
+      else
+      {
+         if ( m_buffer.BitsPerSample() == 8 )
+            EncodeStrip( static_cast<const UInt8Image&>( *m_buffer ), startRow );
+         else if ( m_buffer.BitsPerSample() == 16 )
+            EncodeStrip( static_cast<const UInt16Image&>( *m_buffer ), startRow );
+         else
+            EncodeStrip( static_cast<const UInt32Image&>( *m_buffer ), startRow );
+      }
+   }
+
+private:
+
+   FileFormatInstance& m_file;
+   ImageVariant        m_buffer;   // strip in the file sample type
+
+   template <class P>
+   void EncodeStrip( const GenericImage<P>& strip, int startRow )
+   {
+      for ( int c = 0; c < strip.NumberOfChannels(); ++c )
+         if ( !m_file.WriteSamples( strip[c], startRow, strip.Height(), c ) )
+            throw Error( "Unable to write image" );
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Status callback of streamed batch targets. Reports nothing (workers never
+ * write to the console) and aborts the stream when the batch is aborted.
+ */
+class HMSBatchAbortCallback : public StatusCallback
+{
+public:
+
+   HMSBatchAbortCallback( AtomicInt& abort )
+      : m_abort( abort )
+   {
+   }
+
+   int Initialized( const StatusMonitor& ) const override
+   {
+      return m_abort.Load();
+   }
+
+   int Updated( const StatusMonitor& ) const override
+   {
+      return m_abort.Load();
+   }
+
+   int Completed( const StatusMonitor& ) const override
+   {
+      return 0;
+   }
+
+   void InfoUpdated( const StatusMonitor& ) const override
+   {
+   }
+
+private:
+
+   AtomicInt& m_abort;
+};
+// ----------------------------------------------------------------------------
+
+/*
+ * Batch worker. Each thread takes the next pending target and runs it
+ * through all stages (read, analyze, stretch, write), so with N threads up
+ * to N images are in flight at different stages and memory use is bounded
+ * by the concurrency. Worker threads never write to the console; finished
+ * targets are reported by the calling thread.
+ */
+class HMSBatchThread : public Thread
+{
+public:
+
+   HMSBatchThread( const HyperMetricStretchInstance& instance, HMSBatchState& state )
+      : m_instance( instance )
+      , m_state( state )
+      , m_callback( state.abort )
+   {
+   }
+
+   void Run() override
+   {
+      // Row bands of every image processed by this thread stay on the same
+      // processors, on a single NUMA node when they fit in one.
+      VeraLuxContext::Scope context( m_state.context );
+      VeraLuxTopology::Reservation reservation( m_state.threadsPerImage );
+
+      for ( ;; )
+      {
+         if ( m_state.abort.Load() )
+            break;
+         int i = m_state.next.FetchAndAdd( 1 );
+         if ( i >= m_state.end )
+            break;
+
+         HMSBatchItem& item = m_state.items[i];
+         try
+         {
+            Process( item );
+         }
+         catch ( const Exception& x )
+         {
+            item.error = x.Message();
+         }
+         catch ( const std::bad_alloc& )
+         {
+            item.error = "Out of memory";
+         }
+         catch ( const std::exception& x )
+         {
+            item.error = x.what();
+         }
+         catch ( ... )
+         {
+            item.error = "Unknown exception";
+         }
+
+         volatile AutoLock lock( m_state.mutex );
+         m_state.finished.Add( i );
+      }
+   }
+
+private:
+
+   const HyperMetricStretchInstance& m_instance;
+   HMSBatchState&                    m_state;
+   HMSBatchAbortCallback             m_callback;
+
+   void Process( HMSBatchItem& item )
+   {
+      const HyperMetricStretchInstance& I = m_instance;
+      ElapsedTime T;
+
+      // Decode
+      FileFormat inputFormat( File::ExtractExtension( item.path ), true/*read*/, false/*write*/ );
+      FileFormatInstance inputFile( inputFormat );
+
+      ImageDescriptionArray images;
+      if ( !inputFile.Open( images, item.path ) )
+         throw Error( "Unable to open file" );
+      if ( images.IsEmpty() )
+         throw Error( "Empty image file" );
+      if ( images.Length() > 1 )
+         item.note = String().Format( "%u images in file, only the first one has been processed", images.Length() );
+
+      const ImageInfo info = images[0].info;
+      const ImageOptions options = images[0].options;
+      if ( options.complexSample )
+         throw Error( "HyperMetric Stretch cannot be executed on complex images" );
+
+      if ( !inputFile.SelectImage( 0 ) )
+         throw Error( "Unable to select image" );
+
+      FITSKeywordArray keywords;
+      if ( inputFormat.CanStoreKeywords() )
+         inputFile.ReadFITSKeywords( keywords );
+      ICCProfile icc;
+      if ( inputFormat.CanStoreICCProfiles() )
+         inputFile.ReadICCProfile( icc );
+
+      item.width = info.width;
+      item.height = info.height;
+      item.channels = info.numberOfChannels;
+
+      const TransferEvaluation::value_type transfer =
+         VeraLuxEngine::TransferEvaluationFor( options.bitsPerSample, options.ieeefpSampleFormat );
+
+      FileFormat outputFormat( File::ExtractExtension( item.outputPath ), false/*read*/, true/*write*/ );
+
+      const bool sweeping = !m_state.sweep.IsEmpty();
+      item.streamed = I.UseStreaming( info.width, info.height, info.numberOfChannels );
+      if ( item.streamed && sweeping )
+      {
+         // Variants are rendered from the decoded image
+         item.streamed = false;
+         AddNote( item, "parameter sweeps are processed in memory" );
+      }
+      if ( item.streamed )
+         if ( inputFormat.CanReadIncrementally() && outputFormat.CanWriteIncrementally() )
+         {
+            item.outOfCore = true;
+            ProcessStreamed( item, inputFile, outputFormat, info, options, keywords, icc, transfer, T );
+            return;
+         }
+
+      ImageVariant image;
+      image.CreateImage( options.ieeefpSampleFormat, false, options.bitsPerSample );
+      image->EnableParallelProcessing( true, m_state.threadsPerImage );
+      if ( !inputFile.ReadImage( image ) )
+         throw Error( "Unable to read image" );
+
+      inputFile.Close();
+
+      item.readTime = T();
+      T.Reset();
+
+      if ( item.streamed )
+      {
+         // Whole-file codecs: strips over the decoded image still avoid the
+         // full-size working copies
+         AddNote( item, "file formats cannot be streamed, the image has been decoded in memory" );
+         VeraLuxImageRowSource source( image );
+         VeraLuxImageRowSink sink( image );
+         HMSBatchStretch solution = I.SolveStreamed( source, transfer, I.batchAutoLogD,
+                                                     m_state.useShared ? &m_state.shared : nullptr, &m_callback );
+         I.ApplyStreamed( source, sink, solution, transfer, &m_callback );
+         SetSolution( item, solution );
+      }
+      else if ( sweeping )
+      {
+         ProcessSweep( item, image, outputFormat, options, keywords, icc, transfer, T );
+         return;
+      }
+      else
+         Stretch( item, image, transfer );
+
+      item.stretchTime = T();
+      T.Reset();
+
+      // Encode
+      FileFormatInstance outputFile( outputFormat );
+      CreateOutput( outputFile, outputFormat, item.outputPath, item.logD, I.protectB, item.anchor,
+                    options, keywords, icc );
+
+      if ( !outputFile.WriteImage( image ) )
+         throw Error( "Unable to write file: " + item.outputPath );
+
+      outputFile.Close();
+
+      item.writeTime = T();
+   }
+
+   // In-memory analysis and stretch of a decoded image, with the strip
+   // scan statistics of the view and streamed paths
+   void Stretch( HMSBatchItem& item, ImageVariant& image, TransferEvaluation::value_type transfer )
+   {
+      const HyperMetricStretchInstance& I = m_instance;
+
+      // Analyze. Targets using the shared stretch only need the Smart Max
+      // peaks, for linear expansion bounds measured per file.
+      double grip, shadow, linearExp;
+      I.GetEffectiveParams( grip, shadow, linearExp );
+      const bool expand = I.processingMode == HMSProcessingMode::Scientific && linearExp > 0.001;
+      VeraLuxStreamAnalysis analysis;
+      if ( !m_state.useShared || expand )
+      {
+         VeraLuxImageRowSource source( image );
+         analysis = VeraLuxStreaming::Analyze( source, I.adaptiveAnchor, I.GetSensorProfile(), I.StreamingBudget() );
+      }
+
+      if ( m_state.useShared )
+      {
+         item.anchor = m_state.shared.anchor;
+         item.logD = m_state.shared.logD;
+      }
+      else
+      {
+         item.anchor = analysis.anchor;
+         item.logD = I.batchAutoLogD ?
+            VeraLuxEngine::SolveLogD( analysis.luminanceMedian, I.targetBackground, I.protectB ) : I.logD;
+      }
+
+      // Stretch
+      Image working = m_state.workspace.AcquireImage( image.Width(), image.Height(), image.NumberOfChannels() );
+      VeraLuxEngine::NormalizeInput( working, image );
+      OutputScalingStats scaling;
+      I.ApplyStretch( working, item.anchor, analysis.peak.IsEmpty() ? nullptr : &analysis.peak,
+                      item.logD, transfer,
+                      m_state.useShared ? &m_state.shared.scaling : nullptr, &scaling, &m_state.workspace );
+      analysis = VeraLuxStreamAnalysis();
+
+      if ( m_state.reference )
+      {
+         m_state.shared.anchor = item.anchor;
+         m_state.shared.logD = item.logD;
+         m_state.shared.scaling = scaling;
+      }
+
+      VeraLuxEngine::StoreOutput( image, working );
+      m_state.workspace.ReleaseImage( working );
+   }
+
+   // In-memory analysis of a decoded image and rendering of every sweep
+   // variant, with Log D values solved if automatic. Variants are rendered
+   // in groups whose outputs fit the tile budget; each group is encoded
+   // through the decoded image and released before the next one.
+   void ProcessSweep( HMSBatchItem& item, ImageVariant& image, const FileFormat& outputFormat,
+                      const ImageOptions& options, const FITSKeywordArray& keywords, const ICCProfile& icc,
+                      TransferEvaluation::value_type transfer, ElapsedTime& T )
+   {
+      const HyperMetricStretchInstance& I = m_instance;
+
+      // Throws if not even one variant fits the tile budget
+      const size_type groupSize = I.SweepGroupSize( image.Width(), image.Height(), image.NumberOfChannels() );
+
+      // Anchor, median and Smart Max peaks from a strip scan, as for a view
+      VeraLuxStreamAnalysis analysis;
+      {
+         VeraLuxImageRowSource source( image );
+         analysis = VeraLuxStreaming::Analyze( source, I.adaptiveAnchor, I.GetSensorProfile(), I.StreamingBudget() );
+      }
+      Image working = m_state.workspace.AcquireImage( image.Width(), image.Height(), image.NumberOfChannels() );
+      VeraLuxEngine::NormalizeInput( working, image );
+
+      // With automatic Log D and no swept Log D values, or with swept target
+      // backgrounds, each variant is solved for its target background with
+      // its own highlight protection.
+      HyperMetricStretchInstance::sweep_list variants = m_state.sweep;
+      if ( I.SweepSolvesLogD( I.batchAutoLogD ) )
+         HyperMetricStretchInstance::SolveSweepLogD( variants, analysis.luminanceMedian );
+
+      item.anchor = analysis.anchor;
+      item.logD = variants[0].logD;
+
+      for ( size_type first = 0; first < variants.Length(); first += groupSize )
+      {
+         const HyperMetricStretchInstance::sweep_list group =
+            HyperMetricStretchInstance::SweepGroup( variants, first, groupSize );
+         std::vector<Image> outputs;
+         I.ApplySweep( working, item.anchor, &analysis.peak, group, transfer, outputs,
+                       nullptr, nullptr, &m_state.workspace );
+
+         item.stretchTime += T();
+         T.Reset();
+
+         // Encode each variant through the decoded image
+         for ( size_type j = 0; j < outputs.size(); ++j )
+         {
+            VeraLuxEngine::StoreOutput( image, outputs[j] );
+            m_state.workspace.ReleaseImage( outputs[j] );
+
+            const String& path = item.variantPaths[first + j];
+            FileFormatInstance outputFile( outputFormat );
+            CreateOutput( outputFile, outputFormat, path, group[j].logD, group[j].protectB, item.anchor,
+                          options, keywords, icc );
+            if ( !outputFile.WriteImage( image ) )
+               throw Error( "Unable to write file: " + path );
+            outputFile.Close();
+         }
+
+         item.writeTime += T();
+         T.Reset();
+      }
+
+      m_state.workspace.ReleaseImage( working );
+   }
+
+   // Out-of-core stretch: strips are decoded, stretched and encoded one at
+   // a time, so the image is never completely in memory.
+   void ProcessStreamed( HMSBatchItem& item, FileFormatInstance& inputFile, const FileFormat& outputFormat,
+                         const ImageInfo& info, const ImageOptions& options,
+                         FITSKeywordArray& keywords, const ICCProfile& icc,
+                         TransferEvaluation::value_type transfer, ElapsedTime& T )
+   {
+      const HyperMetricStretchInstance& I = m_instance;
+
+      HMSFileRowSource source( inputFile, info, options, I.StreamingBudget(), m_state.threadsPerImage );
+      HMSBatchStretch solution = I.SolveStreamed( source, transfer, I.batchAutoLogD,
+                                                  m_state.useShared ? &m_state.shared : nullptr, &m_callback );
+      SetSolution( item, solution );
+
+      item.readTime = T();
+      T.Reset();
+
+      FileFormatInstance outputFile( outputFormat );
+      CreateOutput( outputFile, outputFormat, item.outputPath, item.logD, I.protectB, item.anchor,
+                    options, keywords, icc );
+      {
+         HMSFileRowSink sink( outputFile, info, options );
+         I.ApplyStreamed( source, sink, solution, transfer, &m_callback );
+      }
+      if ( !outputFile.CloseImage() )
+         throw Error( "Unable to write file: " + item.outputPath );
+      outputFile.Close();
+      inputFile.Close();
+
+      item.stretchTime = T();
+   }
+
+   void SetSolution( HMSBatchItem& item, const HMSBatchStretch& solution )
+   {
+      item.anchor = solution.anchor;
+      item.logD = solution.logD;
+      if ( m_state.reference )
+         m_state.shared = solution;
+   }
+
+   // Creates an output file and writes its metadata: the input keywords
+   // plus a history record of the stretch.
+   void CreateOutput( FileFormatInstance& outputFile, const FileFormat& outputFormat, const String& path,
+                      double logD, double protectB, double anchor,
+                      const ImageOptions& options, FITSKeywordArray keywords, const ICCProfile& icc )
+   {
+      keywords.Add( FITSHeaderKeyword( "HISTORY", IsoString(),
+                    IsoString().Format( "HyperMetricStretch: logD=%.4f b=%.2f anchor=%.6f",
+                                        logD, protectB, anchor ) ) );
+
+      if ( !outputFile.Create( path ) )
+         throw Error( "Unable to create file: " + path );
+
+      ImageOptions outputOptions = options;
+      outputFile.SetOptions( outputOptions );
+      if ( outputFormat.CanStoreKeywords() )
+         outputFile.WriteFITSKeywords( keywords );
+      if ( icc.IsProfile() && outputFormat.CanStoreICCProfiles() )
+         outputFile.WriteICCProfile( icc );
+   }
+
+   static void AddNote( HMSBatchItem& item, const String& note )
+   {
+      if ( !item.note.IsEmpty() )
+         item.note += "; ";
+      item.note += note;
+   }
+};
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Prints the targets finished since the last call.
+ */
+static void ReportBatchItems( HMSBatchState& state, Console& console, int& done, int& failed )
+{
+   Array<int> finished;
+   {
+      volatile AutoLock lock( state.mutex );
+      finished = state.finished;
+      state.finished.Clear();
+   }
+
+   for ( int i : finished )
+   {
+      const HMSBatchItem& item = state.items[i];
+      ++done;
+      String prefix = String().Format( "[%d/%d] ", done, int( state.items.Length() ) ) + File::ExtractNameAndExtension( item.path );
+      if ( !item.error.IsEmpty() )
+      {
+         ++failed;
+         console.CriticalLn( "<end><cbr>" + prefix + ": *** Error: " + item.error );
+         continue;
+      }
+
+      double mp = double( item.width )*item.height/1.0e6;
+      double t = item.readTime + item.stretchTime + item.writeTime;
+      console.WriteLn( "<end><cbr>" + prefix + String().Format(
+                       ": %.2f MP, %.3f s (%s %.3f s, stretch %.3f s, write %.3f s), %.2f MP/s, Log D=%.2f, anchor=%.6f",
+                       mp, t, item.outOfCore ? "analyze" : "read", item.readTime, item.stretchTime, item.writeTime,
+                       mp/Max( t, 1.0e-6 ), item.logD, item.anchor ) );
+      if ( item.streamed )
+         console.WriteLn( item.outOfCore ? "   streamed from and to disk" : "   streamed in memory" );
+      if ( item.variantPaths.IsEmpty() )
+         console.WriteLn( "   -> " + item.outputPath );
+      else
+         for ( const String& path : item.variantPaths )
+            console.WriteLn( "   -> " + path );
+      if ( !item.note.IsEmpty() )
+         console.WarningLn( "   ** Warning: " + item.note );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Processes targets [begin,end) with up to concurrency worker threads,
+ * reporting progress and polling for user abort on the calling thread.
+ */
+static void RunBatch( const HyperMetricStretchInstance& instance, HMSBatchState& state,
+                      int begin, int end, int concurrency, Console& console, int& done, int& failed )
+{
+   state.next.Store( begin );
+   state.end = end;
+
+   ReferenceArray<HMSBatchThread> threads;
+   for ( int i = 0, n = Min( concurrency, end - begin ); i < n; ++i )
+      threads.Add( new HMSBatchThread( instance, state ) );
+   for ( HMSBatchThread& thread : threads )
+      thread.Start( ThreadPriority::DefaultMax );
+
+   for ( ;; )
+   {
+      HMSBatchThread* active = nullptr;
+      for ( HMSBatchThread& thread : threads )
+         if ( thread.IsActive() )
+         {
+            active = &thread;
+            break;
+         }
+
+      ReportBatchItems( state, console, done, failed );
+      if ( active == nullptr )
+         break;
+
+      active->Wait( 150 );
+      Module->ProcessEvents();
+      if ( console.AbortRequested() )
+         state.abort.Store( 1 );
+   }
+
+   threads.Destroy();
+
+   if ( state.abort.Load() )
+      throw ProcessAborted();
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInstance::ExecuteGlobal()
+{
+   {
+      String why;
+      if ( !CanExecuteGlobal( why ) )
+         throw Error( why );
+   }
+
+   Console console;
+   console.EnableAbort();
+
+   String extension = outputExtension.Trimmed();
+   if ( extension.IsEmpty() )
+      extension = TheHMSOutputExtensionParameter->DefaultValue();
+   if ( !extension.StartsWith( '.' ) )
+      extension.Prepend( '.' );
+   // Throws if no installed format can write this extension
+   FileFormat( extension, false/*read*/, true/*write*/ );
+
+   String directory = outputDirectory.Trimmed();
+   if ( !directory.IsEmpty() )
+   {
+      if ( !File::DirectoryExists( directory ) )
+         throw Error( "The specified output directory does not exist: " + directory );
+      if ( !directory.EndsWith( '/' ) )
+         directory += '/';
+   }
+
+   // Output paths are resolved here, so workers never compete for names
+   HMSBatchState state;
+   if ( sweep )
+      state.sweep = SweepVariants();
+
+   Array<String> outputPaths;
+   auto uniquePath = [&]( const String& path )
+   {
+      if ( outputPaths.Contains( path ) || (!overwriteExistingFiles && File::Exists( path )) )
+         for ( unsigned u = 1; ; ++u )
+         {
+            String tryPath = File::AppendToName( path, String().Format( "_%u", u ) );
+            if ( !File::Exists( tryPath ) && !outputPaths.Contains( tryPath ) )
+            {
+               outputPaths.Add( tryPath );
+               return tryPath;
+            }
+         }
+      outputPaths.Add( path );
+      return path;
+   };
+
+   for ( const Item& target : targets )
+      if ( target.enabled )
+      {
+         if ( !File::Exists( target.path ) )
+            throw Error( "No such file: " + target.path );
+
+         HMSBatchItem item;
+         item.path = target.path;
+         String dir = directory.IsEmpty() ?
+            File::ExtractDrive( target.path ) + File::ExtractDirectory( target.path ) + '/' : directory;
+         String outputPath = dir + File::ExtractName( target.path ) + outputPostfix + extension;
+
+         if ( File::FullPath( outputPath ) == File::FullPath( target.path ) )
+            throw Error( "The output file would overwrite its input file: " + target.path );
+
+         if ( state.sweep.IsEmpty() )
+            item.outputPath = uniquePath( outputPath );
+         else
+         {
+            for ( size_type k = 0; k < state.sweep.Length(); ++k )
+               item.variantPaths.Add( uniquePath( File::AppendToName( outputPath,
+                                                  String().Format( "_sweep%02d", int( k + 1 ) ) ) ) );
+            item.outputPath = item.variantPaths[0];
+         }
+         state.items.Add( item );
+      }
+
+   const int count = int( state.items.Length() );
+   const int concurrency = Range( int( batchConcurrency ), 1, count );
+   state.context = EngineContext();
+   VeraLuxContext::Scope context( state.context );
+   state.threadsPerImage = VeraLuxParallel::ThreadLimit( Min( Thread::NumberOfThreads( PCL_MAX_PROCESSORS, 1 ),
+                                                              VeraLuxTopology::AvailableThreads() )/concurrency );
+
+   console.WriteLn( "<end><cbr>VeraLux HyperMetric Stretch - batch" );
+   console.WriteLn( String().Format( "Mode: %s | Sensor: %s | %d file(s), %d concurrent, %d thread(s) per image",
+                    (processingMode == HMSProcessingMode::ReadyToUse) ? "Ready-to-Use" : "Scientific",
+                    GetSensorProfile().name.c_str(), count, concurrency, state.threadsPerImage ) );
+   console.WriteLn( String().Format( "Vector kernels: %s | Precision: %s",
+                    VeraLuxSIMD::InstructionSetName( VeraLuxSIMD::ActiveInstructionSet() ),
+                    VeraLuxSIMD::PrecisionName( VeraLuxSIMD::Precision() ) ) );
+   WriteTopology( console );
+   WriteGPU( console );
+   if ( !state.sweep.IsEmpty() )
+      console.WriteLn( String().Format( "Parameter sweep: %d variant(s) per file", int( state.sweep.Length() ) ) );
+   console.Flush();
+
+   ElapsedTime T;
+   int done = 0, failed = 0;
+
+   try
+   {
+      int begin = 0;
+      if ( batchSharedStretch )
+      {
+         // Solve the shared stretch on the reference target alone
+         console.WriteLn( "<end><cbr>Solving shared stretch on the reference image..." );
+         state.reference = true;
+         RunBatch( *this, state, 0, 1, 1, console, done, failed );
+         if ( !state.items[0].error.IsEmpty() )
+            throw Error( "The reference image could not be processed: " + state.items[0].path );
+         console.WriteLn( String().Format( "Shared stretch: anchor=%.6f, Log D=%.2f",
+                                           state.shared.anchor, state.shared.logD ) );
+         if ( processingMode == HMSProcessingMode::ReadyToUse )
+            console.WriteLn( String().Format( "   floor=%.6f, scale=%.4f, midtones=%.6f",
+                                              state.shared.scaling.floor, state.shared.scaling.scale,
+                                              state.shared.scaling.midtones ) );
+         state.reference = false;
+         state.useShared = true;
+         begin = 1;
+      }
+
+      RunBatch( *this, state, begin, count, concurrency, console, done, failed );
+   }
+   catch ( ProcessAborted& )
+   {
+      console.NoteLn( String().Format( "<end><cbr>* Batch aborted by user after %d of %d file(s).", done, count ) );
+      throw;
+   }
+
+   double megapixels = 0;
+   for ( const HMSBatchItem& item : state.items )
+      if ( item.error.IsEmpty() )
+         megapixels += double( item.width )*item.height/1.0e6;
+
+   double t = T();
+   console.WriteLn( String().Format( "<end><cbr>%d of %d file(s) processed: %.2f MP in %.3f s, %.2f MP/s",
+                                     count - failed, count, megapixels, t, megapixels/Max( t, 1.0e-6 ) ) );
+   if ( failed > 0 )
+      console.WarningLn( String().Format( "** Warning: %d file(s) failed.", failed ) );
+
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::ApplyStretch( Image& working, double anchor, const Image* peak, double stretchLogD,
+                                               TransferEvaluation::value_type transfer,
+                                               const OutputScalingStats* sharedScaling,
+                                               OutputScalingStats* scaling,
+                                               VeraLuxWorkspace* workspace ) const
+{
+   double grip, shadow, linearExp;
+   GetEffectiveParams( grip, shadow, linearExp );
+
+   const SensorProfile profile = GetSensorProfile();
+   double D = Pow10( stretchLogD );
+   const StatisticsEstimator::value_type estimator = StatisticsEstimator::value_type( statisticsEstimator );
+
+   const bool expand = processingMode == HMSProcessingMode::Scientific && linearExp > 0.001;
+
+   FusedStretchParameters fused = FusedParameters( anchor, stretchLogD, transfer );
+   fused.peak = peak;
+   LinearExpansionStats expansion;
+
+   if ( pipelineMode == HMSPipelineMode::Fused )
+   {
+      // Luminance, stretch, expansion and color in a single pass
+      VeraLuxPipeline::Run( working, profile, fused, &expansion, workspace );
+   }
+   else
+   {
+      // Luminance
+      VeraLuxWorkspace::ImageLease lumaLease( workspace, working.Width(), working.Height(), 1 );
+      Image& luma = *lumaLease;
+      VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+
+      // Stretch
+      VeraLuxEngine::HyperbolicStretch( luma, D, protectB, 0.0, transfer );
+
+      // Linear expansion (Scientific only), Smart Max on the stretched peaks
+      if ( expand )
+      {
+         Image peakLuma;
+         if ( peak != nullptr && !peak->IsEmpty() )
+         {
+            VeraLuxEngine::ExtractLuminance( peakLuma, *peak, anchor, profile );
+            VeraLuxEngine::HyperbolicStretch( peakLuma, D, protectB, 0.0, transfer );
+         }
+         VeraLuxEngine::ApplyLinearExpansion( luma, float( linearExp ), &expansion, estimator,
+                                              peakLuma.IsEmpty() ? nullptr : &peakLuma );
+      }
+
+      // Color reconstruction
+      VeraLuxWorkspace::ImageLease anchoredLease( workspace, working.Width(), working.Height(), working.NumberOfChannels() );
+      Image& anchoredRGB = *anchoredLease;
+      VeraLuxEngine::SubtractAnchor( anchoredRGB, working, anchor );
+
+      VeraLuxEngine::ReconstructColor( working, luma, anchoredRGB,
+                                        colorConvergence, grip, shadow, D, protectB, transfer );
+   }
+
+   // Output scaling (Ready-to-Use only)
+   if ( processingMode == HMSProcessingMode::ReadyToUse )
+   {
+      if ( sharedScaling != nullptr )
+      {
+         VeraLuxEngine::ApplyOutputScaling( working, *sharedScaling, transfer );
+         if ( scaling != nullptr )
+            *scaling = *sharedScaling;
+      }
+      else
+      {
+         Image stretchedPeak;
+         if ( peak != nullptr )
+            StretchPeak( stretchedPeak, *peak, fused, expansion );
+         VeraLuxEngine::AdaptiveOutputScaling( working, profile, targetBackground, estimator, scaling, transfer,
+                                               stretchedPeak.IsEmpty() ? nullptr : &stretchedPeak, workspace );
+      }
+      VeraLuxEngine::ApplyReadyToUseSoftClip( working, 0.98, 2.0, transfer );
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxContext HyperMetricStretchInstance::EngineContext() const
+{
+   VeraLuxContext context;
+   context.precision = ComputePrecision::value_type( computePrecision );
+   context.gpuAcceleration = gpuAcceleration;
+   context.maxThreads = maxThreads;
+   context.maxThreadsPerNode = maxThreadsPerNode;
+   return context;
+}
+
+// ----------------------------------------------------------------------------
+
+FusedStretchParameters HyperMetricStretchInstance::FusedParameters( double anchor, double stretchLogD,
+                                                                    TransferEvaluation::value_type transfer ) const
+{
+   SweepVariant variant;
+   variant.logD = stretchLogD;
+   variant.protectB = protectB;
+   variant.colorStrategy = colorStrategy;
+   return FusedParameters( anchor, variant, transfer );
+}
+
+// ----------------------------------------------------------------------------
+
+FusedStretchParameters HyperMetricStretchInstance::FusedParameters( double anchor, const SweepVariant& variant,
+                                                                    TransferEvaluation::value_type transfer ) const
+{
+   double grip, shadow, linearExp;
+   GetEffectiveParams( variant.colorStrategy, grip, shadow, linearExp );
+
+   const bool expand = processingMode == HMSProcessingMode::Scientific && linearExp > 0.001;
+
+   FusedStretchParameters fused;
+   fused.anchor = anchor;
+   fused.D = Pow10( variant.logD );
+   fused.b = variant.protectB;
+   fused.colorConvergence = colorConvergence;
+   fused.colorGrip = grip;
+   fused.shadowConvergence = shadow;
+   fused.linearExpansion = expand ? linearExp : 0.0;
+   fused.estimator = StatisticsEstimator::value_type( statisticsEstimator );
+   fused.transfer = transfer;
+   return fused;
+}
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Values of a comma-separated sweep list, or the current value of its
+ * parameter if the list is empty.
+ */
+static Array<double> SweepValues( const String& list, double current, const char* id,
+                                  double minValue, double maxValue, bool integer )
+{
+   Array<double> values;
+   StringList tokens;
+   list.Break( tokens, ',', true/*trim*/ );
+   for ( const String& token : tokens )
+   {
+      if ( token.IsEmpty() )
+         continue;
+      double value;
+      try
+      {
+         value = token.ToDouble();
+      }
+      catch ( ... )
+      {
+         throw Error( String( id ) + ": invalid value: " + token );
+      }
+      if ( integer && value != Round( value ) )
+         throw Error( String( id ) + ": integer value expected: " + token );
+      if ( value < minValue || value > maxValue )
+         throw Error( String().Format( "%s: value out of range [%g,%g]: ", id, minValue, maxValue ) + token );
+      values.Add( value );
+   }
+   if ( values.IsEmpty() )
+      values.Add( current );
+   return values;
+}
+
+// ----------------------------------------------------------------------------
+
+HyperMetricStretchInstance::sweep_list HyperMetricStretchInstance::SweepVariants() const
+{
+   // Log D is solved for each swept target background
+   const bool targets = !sweepTargetBackground.Trimmed().IsEmpty();
+   if ( targets && !sweepLogD.Trimmed().IsEmpty() )
+      throw Error( "sweepLogD and sweepTargetBackground cannot be combined: "
+                   "Log D is solved for each target background." );
+
+   const Array<double> logDs = SweepValues( sweepLogD, logD, "sweepLogD",
+                                            TheHMSLogDParameter->MinimumValue(),
+                                            TheHMSLogDParameter->MaximumValue(), false );
+   const Array<double> backgrounds = SweepValues( sweepTargetBackground, targetBackground, "sweepTargetBackground",
+                                                  TheHMSTargetBackgroundParameter->MinimumValue(),
+                                                  TheHMSTargetBackgroundParameter->MaximumValue(), false );
+   const Array<double> bs = SweepValues( sweepProtectB, protectB, "sweepProtectB",
+                                         TheHMSProtectBParameter->MinimumValue(),
+                                         TheHMSProtectBParameter->MaximumValue(), false );
+   const Array<double> strategies = SweepValues( sweepColorStrategy, colorStrategy, "sweepColorStrategy",
+                                                 TheHMSColorStrategyParameter->MinimumValue(),
+                                                 TheHMSColorStrategyParameter->MaximumValue(), true );
+
+   const size_type count = logDs.Length()*backgrounds.Length()*bs.Length()*strategies.Length();
+   if ( count > size_type( MaxSweepVariants ) )
+      throw Error( String().Format( "Too many parameter sweep variants: %u (at most %d).",
+                                    unsigned( count ), MaxSweepVariants ) );
+
+   sweep_list variants;
+   for ( double d : logDs )
+      for ( double t : backgrounds )
+         for ( double b : bs )
+            for ( double strategy : strategies )
+            {
+               SweepVariant variant;
+               variant.logD = d;
+               variant.protectB = b;
+               variant.colorStrategy = int32( RoundInt( strategy ) );
+               variant.targetBackground = t;
+               variants.Add( variant );
+            }
+   return variants;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInstance::SweepSolvesLogD( bool autoLogD ) const
+{
+   if ( !sweepTargetBackground.Trimmed().IsEmpty() )
+      return true;
+   return autoLogD && sweepLogD.Trimmed().IsEmpty();
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::SolveSweepLogD( sweep_list& variants, double luminanceMedian )
+{
+   std::vector<bool> solved( variants.Length(), false );
+   for ( size_type i = 0; i < variants.Length(); ++i )
+      if ( !solved[i] )
+      {
+         // All targets of the same highlight protection in one call
+         std::vector<size_type> indices;
+         std::vector<double> targets;
+         for ( size_type j = i; j < variants.Length(); ++j )
+            if ( !solved[j] && variants[j].protectB == variants[i].protectB )
+            {
+               indices.push_back( j );
+               targets.push_back( variants[j].targetBackground );
+               solved[j] = true;
+            }
+
+         const std::vector<double> logDs = VeraLuxEngine::SolveLogD( luminanceMedian, targets, variants[i].protectB );
+         for ( size_type k = 0; k < indices.size(); ++k )
+            variants[indices[k]].logD = logDs[k];
+      }
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::ApplySweep( const Image& working, double anchor, const Image* peak,
+                                             const sweep_list& variants,
+                                             TransferEvaluation::value_type transfer, std::vector<Image>& outputs,
+                                             std::vector<LinearExpansionStats>* expansion,
+                                             std::vector<OutputScalingStats>* scaling,
+                                             VeraLuxWorkspace* workspace ) const
+{
+   const SensorProfile profile = GetSensorProfile();
+   const StatisticsEstimator::value_type estimator = StatisticsEstimator::value_type( statisticsEstimator );
+
+   std::vector<FusedStretchParameters> params;
+   for ( const SweepVariant& variant : variants )
+   {
+      params.push_back( FusedParameters( anchor, variant, transfer ) );
+      params.back().peak = peak;
+   }
+
+   // Output scaling transforms the peaks with the solved expansion bounds
+   std::vector<LinearExpansionStats> bounds;
+   if ( expansion == nullptr && peak != nullptr && processingMode == HMSProcessingMode::ReadyToUse )
+      expansion = &bounds;
+
+   outputs.clear();
+   if ( workspace != nullptr )
+      for ( size_type k = 0; k < params.size(); ++k )
+         outputs.push_back( workspace->AcquireImage( working.Width(), working.Height(), working.NumberOfChannels() ) );
+
+   // Luminance, stretch, expansion and color of all variants in one pass
+   VeraLuxPipeline::Run( working, outputs, profile, params, expansion, workspace );
+
+   // Output scaling (Ready-to-Use only), measured on each variant
+   if ( scaling != nullptr )
+      scaling->assign( params.size(), OutputScalingStats() );
+   if ( processingMode == HMSProcessingMode::ReadyToUse )
+      for ( size_type k = 0; k < outputs.size(); ++k )
+      {
+         Image variantPeak;
+         if ( peak != nullptr )
+            StretchPeak( variantPeak, *peak, params[k], (expansion != nullptr) ? (*expansion)[k] : LinearExpansionStats() );
+         VeraLuxEngine::AdaptiveOutputScaling( outputs[k], profile, variants[k].targetBackground, estimator,
+                                               (scaling != nullptr) ? &(*scaling)[k] : nullptr, transfer,
+                                               variantPeak.IsEmpty() ? nullptr : &variantPeak, workspace );
+         VeraLuxEngine::ApplyReadyToUseSoftClip( outputs[k], 0.98, 2.0, transfer );
+      }
+}
+
+// ----------------------------------------------------------------------------
+
+size_type HyperMetricStretchInstance::SweepGroupSize( int width, int height, int numberOfChannels ) const
+{
+   // The float output of a variant and its stretched luminance plane
+   const double variantBytes = double( width )*height*(numberOfChannels + 1)*sizeof( float );
+   const double groupSize = double( StreamingBudget() )/variantBytes;
+   if ( groupSize < 1 )
+      throw Error( String().Format( "A parameter sweep variant of a %dx%dx%d image needs %.0f MiB, "
+                                    "more than the streaming tile budget of %d MiB.",
+                                    width, height, numberOfChannels, variantBytes/1024/1024, int( streamingTileBudget ) ) );
+   return size_type( Min( groupSize, double( MaxSweepVariants ) ) );
+}
+
+// ----------------------------------------------------------------------------
+
+HyperMetricStretchInstance::sweep_list
+HyperMetricStretchInstance::SweepGroup( const sweep_list& variants, size_type first, size_type count )
+{
+   sweep_list group;
+   for ( size_type k = first, end = Min( first + count, variants.Length() ); k < end; ++k )
+      group.Add( variants[k] );
+   return group;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::StretchPeak( Image& result, const Image& peak, FusedStretchParameters params,
+                                              const LinearExpansionStats& expansion ) const
+{
+   result.FreeData();
+   if ( peak.IsEmpty() )
+      return;
+
+   // The bounds were measured on the whole image; the mosaic must not
+   // measure its own.
+   if ( params.linearExpansion > 0.001 )
+   {
+      params.fixedExpansionBounds = true;
+      params.expansionLow = expansion.low;
+      params.expansionHigh = expansion.high;
+   }
+   params.peak = nullptr;
+
+   result.Assign( peak );
+   VeraLuxPipeline::Run( result, GetSensorProfile(), params );
+}
+
+// ----------------------------------------------------------------------------
+
+VeraLuxStreamAnalysis HyperMetricStretchInstance::AnalyzeImage( const ImageVariant& image, VeraLuxRunLog* log,
+                                                                StatusCallback& status )
+{
+   VeraLuxImageRowSource source( image );
+   StatusMonitor monitor;
+   monitor.SetCallback( &status );
+   monitor.Initialize( "Analyzing image", size_type( image.Height() ) );
+
+   VeraLuxStreamAnalysis analysis;
+   {
+      VeraLuxStageTimer T( log, "AnalyzeImage", image.NumberOfPixels() );
+      analysis = VeraLuxStreaming::Analyze( source, adaptiveAnchor, GetSensorProfile(), StreamingBudget(), &monitor );
+   }
+   const VeraLuxSignature signature = VeraLuxSignature::Compute( analysis, adaptiveAnchor, GetSensorProfile() );
+   StoreSignature( signature );
+   Console().WriteLn( SignatureInfo( signature ) );
+   return analysis;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInstance::UseStreaming( int width, int height, int numberOfChannels ) const
+{
+   switch ( streaming )
+   {
+   case HMSStreamingMode::Off:
+      return false;
+   case HMSStreamingMode::Always:
+      return true;
+   default:
+   case HMSStreamingMode::Auto:
+      // Size of the normalized float working image
+      return double( width )*height*numberOfChannels*sizeof( float ) > double( streamingThreshold )*1024*1024;
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+HyperMetricStretchInstance::StretchSolution
+HyperMetricStretchInstance::SolveStreamed( VeraLuxRowSource& source, TransferEvaluation::value_type transfer,
+                                           bool autoLogD, const StretchSolution* shared,
+                                           StatusCallback* callback, VeraLuxSignature* signature ) const
+{
+   StretchSolution solution;
+   FusedStretchParameters fused = FusedParameters( 0, logD, transfer );
+
+   // A shared stretch only leaves the linear expansion bounds to measure
+   if ( shared != nullptr )
+   {
+      solution = *shared;
+      if ( fused.linearExpansion <= 0.001 )
+         return solution;
+   }
+
+   const SensorProfile profile = GetSensorProfile();
+
+   StatusMonitor monitor;
+   if ( callback != nullptr )
+      monitor.SetCallback( callback );
+   monitor.Initialize( "Analyzing image strips", size_type( source.Height() ) );
+
+   VeraLuxStreamAnalysis analysis = VeraLuxStreaming::Analyze( source, adaptiveAnchor, profile,
+                                                               StreamingBudget(), &monitor );
+   if ( signature != nullptr )
+      *signature = VeraLuxSignature::Compute( analysis, adaptiveAnchor, profile );
+   if ( shared != nullptr )
+      analysis.anchor = shared->anchor;
+   else
+   {
+      solution.anchor = analysis.anchor;
+      solution.logD = autoLogD ?
+         VeraLuxEngine::SolveLogD( analysis.luminanceMedian, targetBackground, protectB ) : logD;
+   }
+
+   fused = FusedParameters( solution.anchor, solution.logD, transfer );
+   VeraLuxStreaming::SolveLinearExpansion( analysis, profile, fused, &solution.expansion );
+
+   if ( processingMode == HMSProcessingMode::ReadyToUse && shared == nullptr )
+      solution.scaling = VeraLuxStreaming::SolveOutputScaling( analysis, profile, fused, targetBackground,
+                                                               StatisticsEstimator::value_type( statisticsEstimator ) );
+   return solution;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::StoreSignature( const VeraLuxSignature& signature )
+{
+   signatureMedian = signature.median;
+   signatureMAD = signature.mad;
+   signatureP99 = signature.p99;
+   signatureP999 = signature.p999;
+   signatureP9999 = signature.p9999;
+   signatureStarPressure = signature.starPressure;
+   signatureStatisticalAnchor = signature.statisticalAnchor;
+   signatureAdaptiveAnchor = signature.adaptiveAnchor;
+   signaturePeak = signature.peak;
+   signaturePeakIsStar = signature.peakHasNeighbors;
+   signaturePhysicalPeak = signature.physicalPeak;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInstance::ApplyStreamed( VeraLuxRowSource& source, VeraLuxRowSink& sink,
+                                                const StretchSolution& solution,
+                                                TransferEvaluation::value_type transfer,
+                                                StatusCallback* callback ) const
+{
+   FusedStretchParameters fused = FusedParameters( solution.anchor, solution.logD, transfer );
+   if ( fused.linearExpansion > 0.001 )
+   {
+      fused.fixedExpansionBounds = true;
+      fused.expansionLow = solution.expansion.low;
+      fused.expansionHigh = solution.expansion.high;
+   }
+
+   StatusMonitor monitor;
+   if ( callback != nullptr )
+      monitor.SetCallback( callback );
+   monitor.Initialize( "Stretching image strips", size_type( source.Height() ) );
+
+   VeraLuxStreaming::Apply( source, sink, GetSensorProfile(), fused,
+                            (processingMode == HMSProcessingMode::ReadyToUse) ? &solution.scaling : nullptr,
+                            StreamingBudget(), &monitor );
+}
+
+// ----------------------------------------------------------------------------
+
+void* HyperMetricStretchInstance::LockParameter( const MetaParameter* p, size_type tableRow )
+{
+   if ( p == TheHMSProcessingModeParameter )
+      return &processingMode;
+   if ( p == TheHMSSensorProfileParameter )
+      return &sensorProfile;
+   if ( p == TheHMSSensorProfileFileParameter )
+      return sensorProfileFile.Begin();
+   if ( p == TheHMSSensorProfileNameParameter )
+      return sensorProfileName.Begin();
+   if ( p == TheHMSTargetBackgroundParameter )
+      return &targetBackground;
+   if ( p == TheHMSLogDParameter )
+      return &logD;
+   if ( p == TheHMSProtectBParameter )
+      return &protectB;
+   if ( p == TheHMSColorConvergenceParameter )
+      return &colorConvergence;
+   if ( p == TheHMSColorStrategyParameter )
+      return &colorStrategy;
+   if ( p == TheHMSColorGripParameter )
+      return &colorGrip;
+   if ( p == TheHMSShadowConvergenceParameter )
+      return &shadowConvergence;
+   if ( p == TheHMSLinearExpansionParameter )
+      return &linearExpansion;
+   if ( p == TheHMSAdaptiveAnchorParameter )
+      return &adaptiveAnchor;
+   if ( p == TheHMSPipelineModeParameter )
+      return &pipelineMode;
+   if ( p == TheHMSStatisticsEstimatorParameter )
+      return &statisticsEstimator;
+   if ( p == TheHMSComputePrecisionParameter )
+      return &computePrecision;
+   if ( p == TheHMSTargetEnabledParameter )
+      return &targets[tableRow].enabled;
+   if ( p == TheHMSTargetPathParameter )
+      return targets[tableRow].path.Begin();
+   if ( p == TheHMSOutputDirectoryParameter )
+      return outputDirectory.Begin();
+   if ( p == TheHMSOutputPostfixParameter )
+      return outputPostfix.Begin();
+   if ( p == TheHMSOutputExtensionParameter )
+      return outputExtension.Begin();
+   if ( p == TheHMSOverwriteExistingFilesParameter )
+      return &overwriteExistingFiles;
+   if ( p == TheHMSBatchAutoLogDParameter )
+      return &batchAutoLogD;
+   if ( p == TheHMSBatchSharedStretchParameter )
+      return &batchSharedStretch;
+   if ( p == TheHMSBatchConcurrencyParameter )
+      return &batchConcurrency;
+   if ( p == TheHMSMaxThreadsParameter )
+      return &maxThreads;
+   if ( p == TheHMSMaxThreadsPerNodeParameter )
+      return &maxThreadsPerNode;
+   if ( p == TheHMSSweepParameter )
+      return &sweep;
+   if ( p == TheHMSSweepLogDParameter )
+      return sweepLogD.Begin();
+   if ( p == TheHMSSweepProtectBParameter )
+      return sweepProtectB.Begin();
+   if ( p == TheHMSSweepColorStrategyParameter )
+      return sweepColorStrategy.Begin();
+   if ( p == TheHMSSweepTargetBackgroundParameter )
+      return sweepTargetBackground.Begin();
+   if ( p == TheHMSStreamingModeParameter )
+      return &streaming;
+   if ( p == TheHMSStreamingThresholdParameter )
+      return &streamingThreshold;
+   if ( p == TheHMSStreamingTileBudgetParameter )
+      return &streamingTileBudget;
+   if ( p == TheHMSGPUAccelerationParameter )
+      return &gpuAcceleration;
+   if ( p == TheHMSInstrumentationParameter )
+      return &instrumentation;
+   if ( p == TheHMSInstrumentationLogParameter )
+      return instrumentationLog.Begin();
+   if ( p == TheHMSSignatureMedianParameter )
+      return &signatureMedian;
+   if ( p == TheHMSSignatureMADParameter )
+      return &signatureMAD;
+   if ( p == TheHMSSignatureP99Parameter )
+      return &signatureP99;
+   if ( p == TheHMSSignatureP999Parameter )
+      return &signatureP999;
+   if ( p == TheHMSSignatureP9999Parameter )
+      return &signatureP9999;
+   if ( p == TheHMSSignatureStarPressureParameter )
+      return &signatureStarPressure;
+   if ( p == TheHMSSignatureStatisticalAnchorParameter )
+      return &signatureStatisticalAnchor;
+   if ( p == TheHMSSignatureAdaptiveAnchorParameter )
+      return &signatureAdaptiveAnchor;
+   if ( p == TheHMSSignaturePeakParameter )
+      return &signaturePeak;
+   if ( p == TheHMSSignaturePeakIsStarParameter )
+      return &signaturePeakIsStar;
+   if ( p == TheHMSSignaturePhysicalPeakParameter )
+      return &signaturePhysicalPeak;
+
+   return nullptr;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInstance::AllocateParameter( size_type sizeOrLength, const MetaParameter* p, size_type tableRow )
+{
+   if ( p == TheHMSTargetsParameter )
+   {
+      targets.Clear();
+      if ( sizeOrLength > 0 )
+         targets.Add( Item(), sizeOrLength );
+   }
+   else if ( p == TheHMSTargetPathParameter )
+   {
+      targets[tableRow].path.Clear();
+      if ( sizeOrLength > 0 )
+         targets[tableRow].path.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSOutputDirectoryParameter )
+   {
+      outputDirectory.Clear();
+      if ( sizeOrLength > 0 )
+         outputDirectory.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSOutputPostfixParameter )
+   {
+      outputPostfix.Clear();
+      if ( sizeOrLength > 0 )
+         outputPostfix.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSOutputExtensionParameter )
+   {
+      outputExtension.Clear();
+      if ( sizeOrLength > 0 )
+         outputExtension.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSInstrumentationLogParameter )
+   {
+      instrumentationLog.Clear();
+      if ( sizeOrLength > 0 )
+         instrumentationLog.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSensorProfileFileParameter )
+   {
+      sensorProfileFile.Clear();
+      if ( sizeOrLength > 0 )
+         sensorProfileFile.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSensorProfileNameParameter )
+   {
+      sensorProfileName.Clear();
+      if ( sizeOrLength > 0 )
+         sensorProfileName.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSweepLogDParameter )
+   {
+      sweepLogD.Clear();
+      if ( sizeOrLength > 0 )
+         sweepLogD.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSweepProtectBParameter )
+   {
+      sweepProtectB.Clear();
+      if ( sizeOrLength > 0 )
+         sweepProtectB.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSweepColorStrategyParameter )
+   {
+      sweepColorStrategy.Clear();
+      if ( sizeOrLength > 0 )
+         sweepColorStrategy.SetLength( sizeOrLength );
+   }
+   else if ( p == TheHMSSweepTargetBackgroundParameter )
+   {
+      sweepTargetBackground.Clear();
+      if ( sizeOrLength > 0 )
+         sweepTargetBackground.SetLength( sizeOrLength );
+   }
+   else
+      return false;
+
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+size_type HyperMetricStretchInstance::ParameterLength( const MetaParameter* p, size_type tableRow ) const
+{
+   if ( p == TheHMSTargetsParameter )
+      return targets.Length();
+   if ( p == TheHMSTargetPathParameter )
+      return targets[tableRow].path.Length();
+   if ( p == TheHMSOutputDirectoryParameter )
+      return outputDirectory.Length();
+   if ( p == TheHMSOutputPostfixParameter )
+      return outputPostfix.Length();
+   if ( p == TheHMSOutputExtensionParameter )
+      return outputExtension.Length();
+   if ( p == TheHMSInstrumentationLogParameter )
+      return instrumentationLog.Length();
+   if ( p == TheHMSSensorProfileFileParameter )
+      return sensorProfileFile.Length();
+   if ( p == TheHMSSensorProfileNameParameter )
+      return sensorProfileName.Length();
+   if ( p == TheHMSSweepLogDParameter )
+      return sweepLogD.Length();
+   if ( p == TheHMSSweepProtectBParameter )
+      return sweepProtectB.Length();
+   if ( p == TheHMSSweepColorStrategyParameter )
+      return sweepColorStrategy.Length();
+   if ( p == TheHMSSweepTargetBackgroundParameter )
+      return sweepTargetBackground.Length();
+
    return 0;
 }
 
@@ -19,11 +19,23 @@
 #ifndef __HyperMetricStretchInstance_h
 #define __HyperMetricStretchInstance_h
 
+#include <pcl/Array.h>
 #include <pcl/ProcessImplementation.h>
 #include <pcl/MetaParameter.h>
+#include <pcl/Mutex.h>
+#include <pcl/StatusMonitor.h>
 
 #include "../../core/SensorProfiles.h"
+#include "../../core/VeraLuxContext.h"
 #include "../../core/VeraLuxEngine.h"
+#include "../../core/VeraLuxInstrumentation.h"
+#include "../../core/VeraLuxPipeline.h"
+#include "../../core/VeraLuxSignature.h"
+#include "../../core/VeraLuxStreaming.h"
+#include "../../core/VeraLuxWorkspace.h"
+
+#include <memory>
+#include <vector>
 
 namespace pcl
 {
@@ -39,33 +51,186 @@ public:
 
    void Assign( const ProcessImplementation& ) override;
    UndoFlags UndoMode( const View& ) const override;
+   bool IsHistoryUpdater( const View& ) const override;
    bool CanExecuteOn( const View&, String& whyNot ) const override;
    bool ExecuteOn( View& ) override;
+   bool CanExecuteGlobal( String& whyNot ) const override;
+   bool ExecuteGlobal() override;
    void* LockParameter( const MetaParameter*, size_type tableRow ) override;
    bool AllocateParameter( size_type sizeOrLength, const MetaParameter* p, size_type tableRow ) override;
    size_type ParameterLength( const MetaParameter* p, size_type tableRow ) const override;
 
-   // Helper for real-time preview
-   bool Preview( Image& ) const;
-
-   // Access to sensor profile
-   const SensorProfile& GetSensorProfile() const
-   {
-      // Map parameter index to global sensor profile array
-      if ( sensorProfile >= 0 && size_type( sensorProfile ) < g_numSensorProfiles )
-         return g_sensorProfiles[sensorProfile];
-      // Default fallback
-      return g_sensorProfiles[0];
-   }
+   // Active sensor profile: the custom profile selected by sensorProfileFile
+   // and sensorProfileName if a file is set, otherwise the built-in profile.
+   // Falls back to the built-in profile if the custom one cannot be loaded;
+   // CanExecuteOn() and CanExecuteGlobal() report the error. Returned by
+   // value: a custom profile is released when the selection changes, which
+   // may happen while a preview or a batch thread is still using it.
+   SensorProfile GetSensorProfile() const;
 
    // Calculate effective parameters based on mode
    void GetEffectiveParams( double& grip, double& shadow, double& linearExp ) const;
 
+   // Effective parameters for a given color strategy (Ready-to-Use mode)
+   void GetEffectiveParams( int32 strategy, double& grip, double& shadow, double& linearExp ) const;
+
+   // Batch target file
+   struct Item
+   {
+      pcl_bool enabled = true;
+      String   path;
+
+      Item( const String& path_ = String() ) : path( path_ )
+      {
+      }
+   };
+
+   typedef Array<Item> target_list;
+
+   // Global statistics solved for one image, or shared by a batch
+   struct StretchSolution
+   {
+      double               anchor = 0;
+      double               logD = 0;
+      OutputScalingStats   scaling;
+      LinearExpansionStats expansion;  // fixed bounds of streamed execution
+   };
+
+   // Parameters varied by a parameter sweep
+   struct SweepVariant
+   {
+      double logD = 0;
+      double protectB = 0;
+      int32  colorStrategy = 0;
+      double targetBackground = 0;
+   };
+
+   typedef Array<SweepVariant> sweep_list;
+
+   // Maximum number of variants of a parameter sweep
+   static constexpr int MaxSweepVariants = 32;
+
+   // Variants of the parameter sweep: every combination of the sweepLogD or
+   // sweepTargetBackground, sweepProtectB and sweepColorStrategy values, the
+   // first list varying slowest. An empty list contributes the current value
+   // of its parameter. Throws an Error for invalid or out of range values,
+   // or if Log D and the target background are both swept.
+   sweep_list SweepVariants() const;
+
+   // Whether the Log D of each sweep variant is solved for its target
+   // background: always when target backgrounds are swept, and with
+   // automatic Log D (batchAutoLogD) unless Log D values are swept.
+   bool SweepSolvesLogD( bool autoLogD ) const;
+
+   // Solves the Log D of every variant for its target background from the
+   // luminance median of the analysis, with one multi-target solve per
+   // highlight protection value.
+   static void SolveSweepLogD( sweep_list& variants, double luminanceMedian );
+
 private:
 
+   // Steps 3-7 on a normalized image, without console output. Smart Max
+   // searches the optional peak neighborhoods of the analysis
+   // (VeraLuxStreamAnalysis::peak) instead of the stretched image; the
+   // optional shared scaling replaces the Ready-to-Use adaptive output
+   // scaling. Temporaries are taken from the optional workspace.
+   void ApplyStretch( Image& working, double anchor, const Image* peak, double stretchLogD,
+                      TransferEvaluation::value_type transfer,
+                      const OutputScalingStats* sharedScaling = nullptr,
+                      OutputScalingStats* scaling = nullptr,
+                      VeraLuxWorkspace* workspace = nullptr ) const;
+
+   // Fused pipeline parameters for the current processing mode
+   FusedStretchParameters FusedParameters( double anchor, double stretchLogD,
+                                           TransferEvaluation::value_type transfer ) const;
+
+   // Fused pipeline parameters of a sweep variant
+   FusedStretchParameters FusedParameters( double anchor, const SweepVariant& variant,
+                                           TransferEvaluation::value_type transfer ) const;
+
+   // Number of sweep variants rendered at once on an image of the given
+   // geometry: as many as the tile budget holds with their outputs and
+   // luminance planes. Throws an Error if not even one variant fits.
+   size_type SweepGroupSize( int width, int height, int numberOfChannels ) const;
+
+   // Up to count variants, starting at first
+   static sweep_list SweepGroup( const sweep_list& variants, size_type first, size_type count );
+
+   // Steps 3-7 of a group of sweep variants on a normalized image, without
+   // console output. All variants are rendered in one pass over working;
+   // the outputs are taken from the optional workspace. The optional
+   // vectors receive the linear expansion and output scaling of each one.
+   // Smart Max searches the optional peak neighborhoods of the analysis
+   // (VeraLuxStreamAnalysis::peak) instead of each stretched variant.
+   void ApplySweep( const Image& working, double anchor, const Image* peak, const sweep_list& variants,
+                    TransferEvaluation::value_type transfer, std::vector<Image>& outputs,
+                    std::vector<LinearExpansionStats>* expansion = nullptr,
+                    std::vector<OutputScalingStats>* scaling = nullptr,
+                    VeraLuxWorkspace* workspace = nullptr ) const;
+
+   // Parameter sweep on a view: every variant goes to a new image window and
+   // the view is left unmodified.
+   void ExecuteSweep( const View& view, const ImageVariant& image, TransferEvaluation::value_type transfer,
+                      VeraLuxRunLog* log, StatusCallback& status );
+
+   // Whether an image of the given geometry is stretched in strips
+   bool UseStreaming( int width, int height, int numberOfChannels ) const;
+
+   // Engine settings of an execution of this instance, installed with a
+   // VeraLuxContext::Scope for the whole run
+   VeraLuxContext EngineContext() const;
+
+   // Tile budget of streamed execution in bytes
+   size_type StreamingBudget() const
+   {
+      return size_type( streamingTileBudget ) << 20;
+   }
+
+   // Streamed execution, phase 1: solves anchor, Log D (from the luminance
+   // median if autoLogD) and the Ready-to-Use scaling, or takes them from
+   // shared. Reads the source only when something must be measured.
+   // The optional signature receives the image signature of the source,
+   // when it has been read.
+   StretchSolution SolveStreamed( VeraLuxRowSource& source, TransferEvaluation::value_type transfer,
+                                  bool autoLogD, const StretchSolution* shared,
+                                  StatusCallback* callback, VeraLuxSignature* signature = nullptr ) const;
+
+   // Custom sensor profile selected by sensorProfileFile and
+   // sensorProfileName (the first profile of the file if no name is set), or
+   // null if no file is set. Throws an Error if the file cannot be read or
+   // has no such profile. The result, or the error, is cached until the
+   // file or the name change.
+   std::shared_ptr<const SensorProfile> CustomSensorProfile() const;
+
+   // Whether the selected sensor profile can be used; why not otherwise.
+   bool ValidateSensorProfile( String& whyNot ) const;
+
+   // Publishes an image signature as read-only output parameters
+   void StoreSignature( const VeraLuxSignature& );
+
+   // Scans an image once for its signature, anchor and Smart Max peaks.
+   // Publishes the signature and writes it to the console.
+   VeraLuxStreamAnalysis AnalyzeImage( const ImageVariant& image, VeraLuxRunLog* log, StatusCallback& status );
+
+   // Transforms the Smart Max peaks of the analysis like the output of the
+   // fused pipeline, with the expansion bounds solved on the whole image,
+   // for the output scaling of an in-memory stretch. Empty if peak is.
+   void StretchPeak( Image& result, const Image& peak, FusedStretchParameters params,
+                     const LinearExpansionStats& expansion ) const;
+
+   // Writes the stage timings of an execution on a view to the console and,
+   // if set, to the instrumentation log file. Does nothing if log is null.
+   void ReportInstrumentation( const VeraLuxRunLog* log, const View& view, const ImageVariant& image ) const;
+
+   // Streamed execution, phase 2: stretches the source into the sink.
+   void ApplyStreamed( VeraLuxRowSource& source, VeraLuxRowSink& sink, const StretchSolution& solution,
+                       TransferEvaluation::value_type transfer, StatusCallback* callback ) const;
+
    // Parameters
    pcl_enum processingMode;        // 0=ReadyToUse, 1=Scientific
    pcl_enum sensorProfile;         // Index into g_sensorProfiles
+   String   sensorProfileFile;     // Custom profiles (JSON), empty = built-in profile
+   String   sensorProfileName;     // Custom profile name, empty = first in the file
    double   targetBackground;      // Target median value
    double   logD;                  // Stretch intensity (log10)
    double   protectB;              // Highlight protection
@@ -75,7 +240,61 @@ private:
    double   shadowConvergence;     // Shadow noise damping (0-3, Scientific only)
    double   linearExpansion;       // Range normalization (0-1, Scientific only)
    pcl_bool adaptiveAnchor;        // Use morphological anchor
+   pcl_enum pipelineMode;          // 0=Fused, 1=StepByStep (validation)
+   pcl_enum statisticsEstimator;   // 0=Exact, 1=Histogram, 2=MAD
+   pcl_enum computePrecision;      // 0=Mixed, 1=Float
+
+   // Batch (global) execution
+   target_list targets;            // Input files
+   String   outputDirectory;       // Empty = same as each input file
+   String   outputPostfix;         // Appended to output file names
+   String   outputExtension;       // Output file format
+   pcl_bool overwriteExistingFiles;
+   pcl_bool batchAutoLogD;         // Solve Log D for the target background
+   pcl_bool batchSharedStretch;    // Reuse the first target's anchor, Log D and scaling
+   int32    batchConcurrency;      // Images processed simultaneously
+   int32    maxThreads;            // Threads of each execution, 0 = unlimited
+   int32    maxThreadsPerNode;     // Threads per NUMA node of each execution, 0 = unlimited
+
+   // Parameter sweep (bracketing)
+   pcl_bool sweep;                 // Render every combination of the sweep values
+   String   sweepLogD;             // Comma-separated Log D values, empty = logD
+   String   sweepProtectB;         // Comma-separated highlight protection values, empty = protectB
+   String   sweepColorStrategy;    // Comma-separated color strategies, empty = colorStrategy
+   String   sweepTargetBackground; // Comma-separated target backgrounds, empty = targetBackground
+
+   // Streamed (out-of-core) execution
+   pcl_enum streaming;             // 0=Off, 1=Auto, 2=Always
+   int32    streamingThreshold;    // Auto: stream images larger than this (MiB as float)
+   int32    streamingTileBudget;   // Working memory for strips (MiB)
+
+   // Stretches with solved parameters (preview tiles, streamed strips) on an OpenCL GPU
+   pcl_bool gpuAcceleration;       // Falls back to the CPU without a usable device
+
+   // Per-stage timing of executions on views
+   pcl_bool instrumentation;       // Report stage timings and memory
+   String   instrumentationLog;    // Append stage timings to this file (JSON Lines), empty = console only
+
+   // Image signature of the last execution on a view (read-only outputs)
+   double   signatureMedian;
+   double   signatureMAD;
+   double   signatureP99;
+   double   signatureP999;
+   double   signatureP9999;
+   double   signatureStarPressure;
+   double   signatureStatisticalAnchor;
+   double   signatureAdaptiveAnchor;
+   double   signaturePeak;
+   pcl_bool signaturePeakIsStar;
+   double   signaturePhysicalPeak;
+
+   // Loaded custom sensor profile
+   mutable Mutex                                m_customProfileMutex;
+   mutable String                               m_customProfileKey;
+   mutable std::shared_ptr<const SensorProfile> m_customProfile;
+   mutable String                               m_customProfileError;
 
+   friend class HMSBatchThread;
    friend class HyperMetricStretchProcess;
    friend class HyperMetricStretchInterface;
 };
@@ -20,10 +20,19 @@
 #include "HyperMetricStretchProcess.h"
 #include "HyperMetricStretchParameters.h"
 
+#include "../../core/VeraLuxGPU.h"
+#include "../../core/VeraLuxParallel.h"
+#include "../../core/VeraLuxTileCache.h"
+
+#include <pcl/AutoLock.h>
 #include <pcl/Console.h>
 #include <pcl/ErrorHandler.h>
+#include <pcl/File.h>
+#include <pcl/FileDialog.h>
 #include <pcl/MessageBox.h>
 #include <pcl/RealTimePreview.h>
+#include <pcl/StatusMonitor.h>
+#include <pcl/Thread.h>
 
 namespace pcl
 {
@@ -34,6 +43,283 @@ HyperMetricStretchInterface* TheHyperMetricStretchInterface = nullptr;
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+   /*
+    * Real-time previews larger than this are first rendered on a decimated
+    * proxy of about this many pixels.
+    */
+   constexpr size_type PreviewProxyPixels = 256*1024;
+
+   /*
+    * Idle time in seconds before (and between) refinement steps.
+    */
+   constexpr double PreviewRefineDelay = 0.25;
+
+   int PreviewProxyFactor( const UInt16Image& image )
+   {
+      double ratio = double( image.NumberOfPixels() )/PreviewProxyPixels;
+      return (ratio > 1) ? int( Ceil( Sqrt( ratio ) ) ) : 1;
+   }
+
+   /*
+    * Preview tiles are square blocks of this many proxy pixels, that is,
+    * PreviewTileSize*factor preview pixels at decimation factor.
+    */
+   constexpr int PreviewTileSize = 128;
+
+   /*
+    * Region of the preview image to render. The visible rect is given in
+    * view image coordinates, which differ from those of the preview image
+    * when it has been reduced for a zoomed out view. The whole image if the
+    * rect is not usable.
+    */
+   Rect PreviewVisibleRect( const UInt16Image& image, int viewWidth, int viewHeight, const Rect& rect )
+   {
+      Rect r = rect.Ordered();
+      if ( viewWidth > 0 && viewHeight > 0 && (viewWidth != image.Width() || viewHeight != image.Height()) )
+      {
+         double sx = double( image.Width() )/viewWidth;
+         double sy = double( image.Height() )/viewHeight;
+         r = Rect( TruncInt( r.x0*sx ), TruncInt( r.y0*sy ), int( Ceil( r.x1*sx ) ), int( Ceil( r.y1*sy ) ) );
+      }
+      r = r.Intersection( image.Bounds() );
+      return r.IsRect() ? r : image.Bounds();
+   }
+
+   /*
+    * Tile of the preview at decimation factor: proxy pixels [x0,x0+width)
+    * and [y0,y0+height), cached as 16-bit samples in channel-major order.
+    */
+   struct PreviewTile
+   {
+      int                        tx, ty;
+      int                        x0, y0;
+      int                        width, height;
+      VeraLuxTileCache::tile_ptr data;
+   };
+
+   /*
+    * Normalized float samples of every factor-th pixel of every factor-th
+    * row of the pending tiles, stacked vertically in a mosaic of
+    * PreviewTileSize-square cells. Cell areas outside a tile are zeroed.
+    */
+   void DecimateTiles( Image& mosaic, const UInt16Image& image, const std::vector<PreviewTile*>& tiles, int factor )
+   {
+      const int nChannels = mosaic.NumberOfChannels();
+      VeraLuxParallel::ForEachRowBand( mosaic.Height(), VeraLuxParallel::MaxThreads( mosaic ),
+         [&]( int startRow, int endRow )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+               for ( int row = startRow; row < endRow; ++row )
+               {
+                  const PreviewTile& tile = *tiles[row/PreviewTileSize];
+                  const int y = row % PreviewTileSize;
+                  float* p = mosaic.ScanLine( row, c );
+                  int x = 0;
+                  if ( y < tile.height )
+                  {
+                     const UInt16Image::sample* s = image.ScanLine( (tile.y0 + y)*factor, c ) + size_type( tile.x0 )*factor;
+                     for ( ; x < tile.width; ++x )
+                        p[x] = s[x*factor]/65535.0f;
+                  }
+                  for ( ; x < PreviewTileSize; ++x )
+                     p[x] = 0;
+               }
+         } );
+   }
+
+   /*
+    * Cache tile of a mosaic cell, in 16-bit samples.
+    */
+   VeraLuxTileCache::tile_data TileSamples( const Image& mosaic, int cell, const PreviewTile& tile )
+   {
+      const int nChannels = mosaic.NumberOfChannels();
+      VeraLuxTileCache::tile_data data( size_type( tile.width )*tile.height*nChannels );
+      uint16* d = data.data();
+      for ( int c = 0; c < nChannels; ++c )
+         for ( int y = 0; y < tile.height; ++y )
+         {
+            const float* p = mosaic.ScanLine( cell*PreviewTileSize + y, c );
+            for ( int x = 0; x < tile.width; ++x )
+               *d++ = UInt16PixelTraits::ToSample( p[x] );
+         }
+      return data;
+   }
+
+   /*
+    * Writes every proxy pixel of a grid of tiles over its factor x factor
+    * block of the preview, clipped to the preview bounds.
+    */
+   void ExpandTiles( UInt16Image& image, const std::vector<PreviewTile>& tiles, int columns, int factor )
+   {
+      const int nChannels = image.NumberOfChannels();
+      const int step = PreviewTileSize*factor;
+      const int rowOffset = tiles.front().ty*step;
+      const int rows = Min( image.Height(), (tiles.back().ty + 1)*step ) - rowOffset;
+      VeraLuxParallel::ForEachRowBand( rows, VeraLuxParallel::MaxThreads( image ),
+         [&]( int startRow, int endRow )
+         {
+            for ( int c = 0; c < nChannels; ++c )
+               for ( int Y = rowOffset + startRow; Y < rowOffset + endRow; ++Y )
+               {
+                  UInt16Image::sample* s = image.ScanLine( Y, c );
+                  const int py = Y/factor;
+                  const PreviewTile* row = tiles.data() + size_type( (Y - rowOffset)/step )*columns;
+                  for ( int i = 0; i < columns; ++i )
+                  {
+                     const PreviewTile& tile = row[i];
+                     const uint16* p = tile.data->data() + (size_type( c )*tile.height + (py - tile.y0))*tile.width;
+                     const int X0 = tile.x0*factor;
+                     const int X1 = Min( image.Width(), (tile.x0 + tile.width)*factor );
+                     for ( int X = X0; X < X1; ++X )
+                        s[X] = p[X/factor - tile.x0];
+                  }
+               }
+         } );
+   }
+
+   /*
+    * Polling interval in seconds of a running Auto-Calc thread.
+    */
+   constexpr double AutoCalcPollInterval = 0.1;
+
+   /*
+    * Status callback of the Auto-Calc thread. Publishes the progress in
+    * permille for the GUI thread and aborts the monitor on request.
+    */
+   class HMSAutoCalcCallback : public StatusCallback
+   {
+   public:
+
+      HMSAutoCalcCallback( AtomicInt& abort, AtomicInt& progress )
+         : m_abort( abort )
+         , m_progress( progress )
+      {
+      }
+
+      int Initialized( const StatusMonitor& ) const override
+      {
+         m_progress.Store( 0 );
+         return m_abort.Load();
+      }
+
+      int Updated( const StatusMonitor& monitor ) const override
+      {
+         if ( monitor.Total() > 0 )
+            m_progress.Store( int( Min( size_type( 1000 ), 1000*monitor.Count()/monitor.Total() ) ) );
+         return m_abort.Load();
+      }
+
+      int Completed( const StatusMonitor& ) const override
+      {
+         m_progress.Store( 1000 );
+         return 0;
+      }
+
+      void InfoUpdated( const StatusMonitor& ) const override
+      {
+      }
+
+   private:
+
+      AtomicInt& m_abort;
+      AtomicInt& m_progress;
+   };
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+/*
+ * Auto-Calc analysis. Computes the image signature of a view, from the
+ * statistics of the real-time preview when they are available or from one
+ * strip scan of the view otherwise. Never touches the GUI or the console:
+ * the interface polls it from a timer and solves Log D on the GUI thread,
+ * with the parameters current at that time.
+ */
+class HMSAutoCalcThread : public Thread
+{
+public:
+
+   AtomicInt             abort;
+   AtomicInt             progress;   // permille
+   IsoString             statsKey;   // HyperMetricStretchInterface::PreviewStatisticsKey()
+   uint64                revision;
+   VeraLuxStreamAnalysis stats;      // full-image statistics
+   bool                  analyzed = false;  // stats computed by this thread
+   VeraLuxSignature      signature;
+   String                error;      // empty on success
+
+   HMSAutoCalcThread( const View& view, const IsoString& key, uint64 imageRevision,
+                      const VeraLuxStreamAnalysis* cachedStats,
+                      bool adaptiveAnchor, const SensorProfile& profile, size_type budget,
+                      const VeraLuxContext& context )
+      : statsKey( key )
+      , revision( imageRevision )
+      , m_image( view.Image() )
+      , m_adaptiveAnchor( adaptiveAnchor )
+      , m_profile( profile )
+      , m_budget( budget )
+      , m_context( context )
+      , m_callback( abort, progress )
+   {
+      if ( cachedStats != nullptr )
+         stats = *cachedStats;
+   }
+
+   void Run() override
+   {
+      VeraLuxContext::Scope context( m_context );
+      try
+      {
+         if ( stats.sample.IsEmpty() )
+         {
+            StatusMonitor monitor;
+            monitor.SetCallback( &m_callback );
+            monitor.Initialize( "Auto-Calc", size_type( m_image.Height() ) );
+
+            VeraLuxImageRowSource source( m_image );
+            stats = VeraLuxStreaming::Analyze( source, m_adaptiveAnchor, m_profile, m_budget, &monitor );
+            monitor.Complete();
+            analyzed = true;
+         }
+
+         signature = VeraLuxSignature::Compute( stats, m_adaptiveAnchor, m_profile );
+      }
+      catch ( const ProcessAborted& )
+      {
+         abort.Store( 1 );
+      }
+      catch ( const Exception& x )
+      {
+         error = x.Message();
+      }
+      catch ( const std::bad_alloc& )
+      {
+         error = "Out of memory";
+      }
+      catch ( const std::exception& x )
+      {
+         error = x.what();
+      }
+      catch ( ... )
+      {
+         error = "Unknown exception";
+      }
+   }
+
+private:
+
+   ImageVariant          m_image;
+   bool                  m_adaptiveAnchor;
+   SensorProfile         m_profile;
+   size_type             m_budget;
+   VeraLuxContext        m_context;   // engine settings of the analysis
+   HMSAutoCalcCallback   m_callback;
+};
+
+// ----------------------------------------------------------------------------
+
 HyperMetricStretchInterface::HyperMetricStretchInterface()
    : m_instance( TheHyperMetricStretchProcess )
 {
@@ -47,6 +333,7 @@ HyperMetricStretchInterface::HyperMetricStretchInterface()
 
 HyperMetricStretchInterface::~HyperMetricStretchInterface()
 {
+   StopAutoCalc();
    if ( GUI != nullptr )
       delete GUI, GUI = nullptr;
 }
@@ -76,7 +363,7 @@ String HyperMetricStretchInterface::IconImageSVGFile() const
 
 InterfaceFeatures HyperMetricStretchInterface::Features() const
 {
-   return InterfaceFeature::Default | InterfaceFeature::RealTimeButton;
+   return InterfaceFeature::Default | InterfaceFeature::ApplyGlobalButton | InterfaceFeature::RealTimeButton;
 }
 
 // ----------------------------------------------------------------------------
@@ -88,6 +375,13 @@ void HyperMetricStretchInterface::ApplyInstance() const
 
 // ----------------------------------------------------------------------------
 
+void HyperMetricStretchInterface::ApplyInstanceGlobal() const
+{
+   m_instance.LaunchGlobal();
+}
+
+// ----------------------------------------------------------------------------
+
 void HyperMetricStretchInterface::ResetInstance()
 {
    // Preserve the current processing mode when resetting
@@ -193,30 +487,210 @@ bool HyperMetricStretchInterface::ImportProcess( const ProcessImplementation& p
 
 // ----------------------------------------------------------------------------
 
-bool HyperMetricStretchInterface::RequiresRealTimePreviewUpdate( const UInt16Image&, const View&, 
-                                                                   const Rect&, int ) const
+bool HyperMetricStretchInterface::RequiresRealTimePreviewUpdate( const UInt16Image&, const View& view,
+                                                                   const Rect& rect, int zoomLevel ) const
+{
+   // Only when a relevant parameter, the image or the requested resolution
+   // changed since the last generated preview
+   IsoString key = PreviewRenderKey( view, rect, zoomLevel );
+   volatile AutoLock lock( m_previewMutex );
+   return key != m_previewRenderedKey;
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInterface::WantsImageNotifications() const
 {
    return true;
 }
 
 // ----------------------------------------------------------------------------
 
-bool HyperMetricStretchInterface::GenerateRealTimePreview( UInt16Image& image, const View&, 
-                                                             const Rect&, int, String& info ) const
+void HyperMetricStretchInterface::ImageUpdated( const View& )
+{
+   m_imageRevision.Increment();
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::ImageDeleted( const View& )
 {
-   // Convert to working format
-   Image work;
-   work.Assign( image );
+   // The solver may be reading the deleted image
+   StopAutoCalc();
+   m_imageRevision.Increment();
+   {
+      volatile AutoLock lock( m_previewMutex );
+      m_previewStatsKey.Clear();
+      m_previewStats = VeraLuxStreamAnalysis();
+      m_previewSolutionKey.Clear();
+   }
+   m_previewWorkspace.Clear();
+   m_previewTiles.Clear();
+   VeraLuxGPU::ReleaseBuffers();
+}
+
+// ----------------------------------------------------------------------------
+
+bool HyperMetricStretchInterface::GenerateRealTimePreview( UInt16Image& image, const View& view,
+                                                             const Rect& rect, int zoomLevel, String& info ) const
+{
+   const HyperMetricStretchInstance& I = m_instance;
+   const SensorProfile profile = I.GetSensorProfile();
+   const int requested = m_previewRequestedFactor.Load();
+   const IsoString renderKey = PreviewRenderKey( view, rect, zoomLevel );
+
+   // Settings of the interface instance for this render only; executions
+   // running at the same time keep their own
+   VeraLuxContext::Scope engineContext( I.EngineContext() );
+
+   const IsoString statsKey = PreviewStatisticsKey( view );
+   const IsoString solutionKey = PreviewSolutionKey();
+   VeraLuxStreamAnalysis stats;
+   FusedStretchParameters params;
+   OutputScalingStats scaling;
+   IsoString contextKey;
+   try
+   {
+      // Cached results are copied, and new ones published, under short locks.
+      // Analyses and solves run unlocked, so they never block the interface.
+      bool haveStats = false;
+      bool haveSolution = false;
+      {
+         volatile AutoLock lock( m_previewMutex );
+         if ( statsKey == m_previewStatsKey )
+         {
+            stats = m_previewStats;
+            haveStats = true;
+            if ( solutionKey == m_previewSolutionKey )
+            {
+               params = m_previewParams;
+               scaling = m_previewScaling;
+               haveSolution = true;
+            }
+         }
+      }
+
+      // Global statistics of the full view image, not of the previewed
+      // region, until the view or its pixel data change
+      if ( !haveStats )
+      {
+         VeraLuxImageRowSource source( view.Image() );
+         stats = VeraLuxStreaming::Analyze( source, I.adaptiveAnchor, profile, I.StreamingBudget() );
+      }
+
+      // Expansion bounds and output scaling, solved on the full-image
+      // subsample as in streamed execution
+      if ( !haveSolution )
+      {
+         params = I.FusedParameters( stats.anchor, I.logD, VeraLuxEngine::TransferEvaluationFor( 16, false ) );
+         VeraLuxStreaming::SolveLinearExpansion( stats, profile, params );
+         if ( I.processingMode == HMSProcessingMode::ReadyToUse )
+            scaling = VeraLuxStreaming::SolveOutputScaling( stats, profile, params, I.targetBackground,
+                                                            StatisticsEstimator::value_type( I.statisticsEstimator ) );
+      }
+
+      if ( !haveStats || !haveSolution )
+      {
+         volatile AutoLock lock( m_previewMutex );
+         if ( !haveStats )
+         {
+            m_previewStats = stats;
+            m_previewStatsKey = statsKey;
+            m_previewSolutionKey.Clear();
+         }
+         // Auto-Calc may have published other statistics in the meantime
+         if ( m_previewStatsKey == statsKey )
+         {
+            m_previewParams = params;
+            m_previewScaling = scaling;
+            m_previewSolutionKey = solutionKey;
+         }
+      }
 
-   // Apply stretch
-   if ( !m_instance.Preview( work ) )
+      contextKey = statsKey;
+      contextKey += '|';
+      contextKey += solutionKey;
+   }
+   catch ( ... )
+   {
       return false;
+   }
 
-   // Convert back
-   image.Assign( work );
+   // Decimated proxy while controls change, refined while they stay idle
+   const int proxyFactor = PreviewProxyFactor( image );
+   const int factor = (requested > 0) ? Min( requested, proxyFactor ) : proxyFactor;
+
+   /*
+    * Only the tiles of the visible region are rendered. Every output pixel
+    * depends on its input pixel and the shared solution alone, so tiles
+    * rendered before in the same context are reused as they are.
+    */
+   IsoString context = contextKey;
+   context.AppendFormat( "|%d,%d,%d|%d", image.Width(), image.Height(), image.NumberOfChannels(), factor );
+   const uint64 contextHash = VeraLuxTileCache::ContextHash( context );
+   const Rect visible = PreviewVisibleRect( image, view.Image().Width(), view.Image().Height(), rect );
+   const int step = PreviewTileSize*factor;
+   const int proxyWidth = (image.Width() + factor - 1)/factor;
+   const int proxyHeight = (image.Height() + factor - 1)/factor;
+   const int tx0 = visible.x0/step, tx1 = (visible.x1 - 1)/step;
+   const int ty0 = visible.y0/step, ty1 = (visible.y1 - 1)/step;
+
+   std::vector<PreviewTile> tiles;
+   std::vector<PreviewTile*> pending;
+   tiles.reserve( size_type( tx1 - tx0 + 1 )*(ty1 - ty0 + 1) );
+   for ( int ty = ty0; ty <= ty1; ++ty )
+      for ( int tx = tx0; tx <= tx1; ++tx )
+      {
+         PreviewTile tile;
+         tile.tx = tx;
+         tile.ty = ty;
+         tile.x0 = tx*PreviewTileSize;
+         tile.y0 = ty*PreviewTileSize;
+         tile.width = Min( PreviewTileSize, proxyWidth - tile.x0 );
+         tile.height = Min( PreviewTileSize, proxyHeight - tile.y0 );
+         tile.data = m_previewTiles.Find( contextHash, tx, ty );
+         tiles.push_back( tile );
+      }
+   for ( PreviewTile& tile : tiles )
+      if ( !tile.data )
+         pending.push_back( &tile );
+
+   bool gpu = false;
+   try
+   {
+      if ( !pending.empty() )
+      {
+         VeraLuxWorkspace::ImageLease mosaic( &m_previewWorkspace, PreviewTileSize,
+                                              int( pending.size() )*PreviewTileSize, image.NumberOfChannels() );
+         DecimateTiles( *mosaic, image, pending, factor );
+         gpu = VeraLuxStreaming::Stretch( *mosaic, profile, params,
+                                          (I.processingMode == HMSProcessingMode::ReadyToUse) ? &scaling : nullptr );
+         for ( size_type k = 0; k < pending.size(); ++k )
+         {
+            PreviewTile& tile = *pending[k];
+            tile.data = m_previewTiles.Insert( contextHash, tile.tx, tile.ty, TileSamples( *mosaic, int( k ), tile ) );
+         }
+      }
+      ExpandTiles( image, tiles, tx1 - tx0 + 1, factor );
+   }
+   catch ( ... )
+   {
+      return false;
+   }
+
+   {
+      volatile AutoLock lock( m_previewMutex );
+      m_previewRenderedKey = renderKey;
+      m_previewFactor = factor;
+   }
 
    // Update info string
-   info = String().Format( "Log D: %.2f | Bg: %.2f", m_instance.logD, m_instance.targetBackground );
+   info = String().Format( "Log D: %.2f | Bg: %.2f", I.logD, I.targetBackground );
+   if ( factor > 1 )
+      info.AppendFormat( " | Proxy 1:%d", factor );
+   info.AppendFormat( " | Tiles: %d new, %d cached", int( pending.size() ), int( tiles.size() - pending.size() ) );
+   if ( gpu )
+      info += " | GPU";
 
    return true;
 }
@@ -234,6 +708,7 @@ void HyperMetricStretchInterface::UpdateControls()
 
    // Update checkboxes
    GUI->AdaptiveAnchor_CheckBox.SetChecked( m_instance.adaptiveAnchor );
+   GUI->GPUAcceleration_CheckBox.SetChecked( m_instance.gpuAcceleration );
 
    // Update numeric controls
    GUI->TargetBg_NumericControl.SetValue( m_instance.targetBackground );
@@ -250,6 +725,7 @@ void HyperMetricStretchInterface::UpdateControls()
    UpdateModeControls();
    UpdateSensorInfo();
    UpdateColorStrategyInfo();
+   UpdateBatchControls();
 }
 
 // ----------------------------------------------------------------------------
@@ -272,9 +748,17 @@ void HyperMetricStretchInterface::UpdateModeControls()
 
 void HyperMetricStretchInterface::UpdateSensorInfo()
 {
-   const SensorProfile& profile = m_instance.GetSensorProfile();
+   const SensorProfile profile = m_instance.GetSensorProfile();
    String info = String().Format( "R: %.4f, G: %.4f, B: %.4f",
-                                  profile.rWeight, profile.gWeight, profile.bWeight );
+                                  profile.weights.r, profile.weights.g, profile.weights.b );
+   if ( !m_instance.sensorProfileFile.Trimmed().IsEmpty() )
+   {
+      String whyNot;
+      if ( m_instance.ValidateSensorProfile( whyNot ) )
+         info = "Custom: " + String( profile.name ) + " - " + info;
+      else
+         info = "Custom profile unavailable - " + info;
+   }
    GUI->SensorProfile_Info.SetText( info );
 }
 
@@ -302,7 +786,126 @@ void HyperMetricStretchInterface::UpdateColorStrategyInfo()
 void HyperMetricStretchInterface::UpdateRealTimePreview()
 {
    if ( IsRealTimePreviewActive() )
+   {
+      // Proxy first; refinement starts when the controls go idle
+      m_previewRequestedFactor.Store( 0 );
+      GUI->PreviewRefine_Timer.Stop();
+      GUI->PreviewRefine_Timer.Start();
       RealTimePreview::Update();
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::RefineRealTimePreview()
+{
+   if ( !IsRealTimePreviewActive() )
+      return;
+
+   // Wait for the preview being generated to know its resolution
+   if ( RealTimePreview::IsUpdating() )
+   {
+      GUI->PreviewRefine_Timer.Start();
+      return;
+   }
+
+   int factor;
+   {
+      volatile AutoLock lock( m_previewMutex );
+      factor = m_previewFactor;
+   }
+   if ( factor <= 1 )
+      return;
+
+   m_previewRequestedFactor.Store( factor/2 );
+   RealTimePreview::Update();
+   GUI->PreviewRefine_Timer.Start();
+}
+
+// ----------------------------------------------------------------------------
+
+IsoString HyperMetricStretchInterface::PreviewStatisticsKey( const View& view ) const
+{
+   const SensorProfile profile = m_instance.GetSensorProfile();
+   IsoString key = view.FullId();
+   key.AppendFormat( "#%d:%d:%.10g,%.10g,%.10g:%d", m_imageRevision.Load(), int( bool( m_instance.adaptiveAnchor ) ),
+                     profile.weights.r, profile.weights.g, profile.weights.b, int( m_instance.computePrecision ) );
+   return key;
+}
+
+// ----------------------------------------------------------------------------
+
+IsoString HyperMetricStretchInterface::PreviewSolutionKey() const
+{
+   const HyperMetricStretchInstance& I = m_instance;
+   double grip, shadow, linearExp;
+   I.GetEffectiveParams( grip, shadow, linearExp );
+   return IsoString().Format( "%d:%.10g:%.10g:%.10g:%.10g:%.10g:%.10g:%.10g:%d",
+                              int( I.processingMode ), I.logD, I.protectB, I.targetBackground,
+                              I.colorConvergence, grip, shadow, linearExp, int( I.statisticsEstimator ) );
+}
+
+// ----------------------------------------------------------------------------
+
+IsoString HyperMetricStretchInterface::PreviewRenderKey( const View& view, const Rect& rect, int zoomLevel ) const
+{
+   IsoString key = PreviewStatisticsKey( view );
+   key += '|';
+   key += PreviewSolutionKey();
+   key.AppendFormat( "|%d,%d,%d,%d:%d|%d", rect.x0, rect.y0, rect.x1, rect.y1, zoomLevel,
+                     m_previewRequestedFactor.Load() );
+   return key;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::UpdateBatchControls()
+{
+   UpdateTargetsList();
+
+   GUI->OutputDirectory_Edit.SetText( m_instance.outputDirectory );
+   GUI->OutputPostfix_Edit.SetText( m_instance.outputPostfix );
+   GUI->OutputExtension_Edit.SetText( m_instance.outputExtension );
+   GUI->Concurrency_SpinBox.SetValue( m_instance.batchConcurrency );
+   GUI->Threads_SpinBox.SetValue( m_instance.maxThreads );
+   GUI->ThreadsPerNode_SpinBox.SetValue( m_instance.maxThreadsPerNode );
+   GUI->BatchAutoLogD_CheckBox.SetChecked( m_instance.batchAutoLogD );
+   GUI->BatchSharedStretch_CheckBox.SetChecked( m_instance.batchSharedStretch );
+   GUI->OverwriteExistingFiles_CheckBox.SetChecked( m_instance.overwriteExistingFiles );
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::UpdateTargetsList()
+{
+   int currentIndex = GUI->Targets_TreeBox.ChildIndex( GUI->Targets_TreeBox.CurrentNode() );
+
+   GUI->Targets_TreeBox.DisableUpdates();
+   GUI->Targets_TreeBox.Clear();
+
+   for ( size_type i = 0; i < m_instance.targets.Length(); ++i )
+   {
+      const HyperMetricStretchInstance::Item& item = m_instance.targets[i];
+
+      TreeBox::Node* node = new TreeBox::Node( GUI->Targets_TreeBox );
+      node->SetText( 0, String( i + 1 ) );
+      node->SetAlignment( 0, TextAlign::Right );
+      node->SetIcon( 1, Bitmap( ScaledResource( item.enabled ? ":/browser/enabled.png" : ":/browser/disabled.png" ) ) );
+      node->SetAlignment( 1, TextAlign::Left );
+      node->SetText( 2, File::ExtractNameAndExtension( item.path ) );
+      node->SetToolTip( 2, item.path );
+      node->SetAlignment( 2, TextAlign::Left );
+   }
+
+   GUI->Targets_TreeBox.AdjustColumnWidthToContents( 0 );
+   GUI->Targets_TreeBox.AdjustColumnWidthToContents( 1 );
+   GUI->Targets_TreeBox.AdjustColumnWidthToContents( 2 );
+
+   if ( !m_instance.targets.IsEmpty() )
+      if ( currentIndex >= 0 && currentIndex < GUI->Targets_TreeBox.NumberOfChildren() )
+         GUI->Targets_TreeBox.SetCurrentNode( GUI->Targets_TreeBox[currentIndex] );
+
+   GUI->Targets_TreeBox.EnableUpdates();
 }
 
 // ----------------------------------------------------------------------------
@@ -342,6 +945,14 @@ void HyperMetricStretchInterface::e_AdaptiveAnchor_Click( Button& /*sender*/, bo
 
 // ----------------------------------------------------------------------------
 
+void HyperMetricStretchInterface::e_GPUAcceleration_Click( Button& /*sender*/, bool checked )
+{
+   m_instance.gpuAcceleration = checked;
+   UpdateRealTimePreview();
+}
+
+// ----------------------------------------------------------------------------
+
 void HyperMetricStretchInterface::e_NumericControl_ValueUpdated( NumericEdit& sender, double value )
 {
    if ( sender == GUI->TargetBg_NumericControl )
@@ -371,6 +982,14 @@ void HyperMetricStretchInterface::e_NumericControl_ValueUpdated( NumericEdit& se
 
 void HyperMetricStretchInterface::e_AutoCalc_Click( Button& /*sender*/, bool /*checked*/ )
 {
+   // A second click cancels a running solver
+   if ( m_autoCalcThread != nullptr )
+   {
+      m_autoCalcThread->abort.Store( 1 );
+      GUI->AutoCalc_PushButton.SetText( "Cancelling..." );
+      return;
+   }
+
    try
    {
       // Get current image
@@ -394,46 +1013,229 @@ void HyperMetricStretchInterface::e_AutoCalc_Click( Button& /*sender*/, bool /*c
       console.WriteLn( "<end><cbr>Computing optimal Log D..." );
       console.Flush();
 
-      // Prepare luminance
-      ImageVariant img = view.Image();
-      Image working;
-      VeraLuxEngine::NormalizeInput( working, img );
+      // Image signature in the background. The full-image statistics are
+      // shared with the real-time preview, so either one reuses the other's.
+      IsoString statsKey = PreviewStatisticsKey( view );
+      VeraLuxStreamAnalysis cachedStats;
+      {
+         volatile AutoLock lock( m_previewMutex );
+         if ( statsKey == m_previewStatsKey )
+            cachedStats = m_previewStats;
+      }
+      m_autoCalcThread = new HMSAutoCalcThread( view, statsKey, uint64( m_imageRevision.Load() ),
+                                                cachedStats.sample.IsEmpty() ? nullptr : &cachedStats,
+                                                m_instance.adaptiveAnchor, m_instance.GetSensorProfile(),
+                                                m_instance.StreamingBudget(), m_instance.EngineContext() );
+      m_autoCalcThread->Start( ThreadPriority::DefaultMax );
+
+      GUI->AutoCalc_PushButton.SetText( "Cancel" );
+      GUI->AutoCalc_Timer.Start();
+   }
+   catch ( Exception& x )
+   {
+      x.Show();
+   }
+   catch ( ... )
+   {
+      try
+      {
+         throw;
+      }
+      ERROR_HANDLER
+   }
+}
 
-      const SensorProfile& profile = m_instance.GetSensorProfile();
-      double anchor = m_instance.adaptiveAnchor ?
-         VeraLuxEngine::CalculateAnchorAdaptive( working, profile ) :
-         VeraLuxEngine::CalculateAnchor( working );
+// ----------------------------------------------------------------------------
 
-      Image luma;
-      VeraLuxEngine::ExtractLuminance( luma, working, anchor, profile );
+void HyperMetricStretchInterface::e_AutoCalc_Timeout( Timer& /*sender*/ )
+{
+   if ( m_autoCalcThread == nullptr )
+   {
+      GUI->AutoCalc_Timer.Stop();
+      return;
+   }
+
+   if ( m_autoCalcThread->IsActive() )
+   {
+      if ( !m_autoCalcThread->abort.Load() )
+         GUI->AutoCalc_PushButton.SetText( String().Format( "Cancel (%d%%)", m_autoCalcThread->progress.Load()/10 ) );
+      return;
+   }
+
+   GUI->AutoCalc_Timer.Stop();
+   GUI->AutoCalc_PushButton.SetText( "Auto-Calc" );
+
+   HMSAutoCalcThread* thread = m_autoCalcThread;
+   m_autoCalcThread = nullptr;
+
+   Console console;
+   if ( !thread->error.IsEmpty() )
+      console.CriticalLn( "<end><cbr>*** Error: Auto-Calc failed: " + thread->error );
+   else if ( thread->abort.Load() )
+      console.WriteLn( "<end><cbr>Auto-Calc cancelled." );
+   else if ( thread->revision != uint64( m_imageRevision.Load() ) )
+      console.WarningLn( "<end><cbr>** Auto-Calc discarded: the image changed during the analysis." );
+   else
+   {
+      if ( thread->analyzed )
+      {
+         volatile AutoLock lock( m_previewMutex );
+         if ( thread->statsKey != m_previewStatsKey )
+         {
+            m_previewStats = thread->stats;
+            m_previewStatsKey = thread->statsKey;
+            m_previewSolutionKey.Clear();
+         }
+      }
 
-      // Calculate optimal Log D
-      double logD = VeraLuxEngine::SolveLogD( luma, m_instance.targetBackground, m_instance.protectB );
+      // Calculate optimal Log D from the luminance median of the signature
+      const VeraLuxSignature& signature = thread->signature;
+      double logD = VeraLuxEngine::SolveLogD( signature.median, m_instance.targetBackground, m_instance.protectB );
 
       // Update instance and GUI
       m_instance.logD = logD;
       GUI->LogD_NumericControl.SetValue( logD );
-      
+
       console.WriteLn( String().Format( "<end><cbr>Auto-Calc complete: Log D = %.2f", logD ) );
-      
+      console.WriteLn( String().Format( "Signature: median %.6f, MAD %.6f, p99.9 %.6f, star pressure %.3f",
+                                        signature.median, signature.mad, signature.p999, signature.starPressure ) );
+
       UpdateRealTimePreview();
    }
-   catch ( Exception& x )
+
+   delete thread;
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::StopAutoCalc()
+{
+   if ( m_autoCalcThread != nullptr )
    {
-      x.Show();
+      m_autoCalcThread->abort.Store( 1 );
+      m_autoCalcThread->Wait();
+      delete m_autoCalcThread, m_autoCalcThread = nullptr;
    }
-   catch ( ... )
+
+   if ( GUI != nullptr )
    {
-      try
+      GUI->AutoCalc_Timer.Stop();
+      GUI->AutoCalc_PushButton.SetText( "Auto-Calc" );
+   }
+}
+
+// ----------------------------------------------------------------------------
+// GUI Data Construction
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::e_PreviewRefine_Timeout( Timer& /*sender*/ )
+{
+   RefineRealTimePreview();
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::e_Batch_Click( Button& sender, bool checked )
+{
+   if ( sender == GUI->AddFiles_PushButton )
+   {
+      OpenFileDialog d;
+      d.SetCaption( "HyperMetricStretch: Select Target Files" );
+      d.LoadImageFilters();
+      d.EnableMultipleSelections();
+      if ( d.Execute() )
       {
-         throw;
+         for ( const String& fileName : d.FileNames() )
+            m_instance.targets.Add( HyperMetricStretchInstance::Item( fileName ) );
+         UpdateTargetsList();
       }
-      ERROR_HANDLER
    }
+   else if ( sender == GUI->ToggleSelected_PushButton )
+   {
+      for ( int i = 0, n = GUI->Targets_TreeBox.NumberOfChildren(); i < n; ++i )
+         if ( GUI->Targets_TreeBox[i]->IsSelected() )
+            m_instance.targets[i].enabled = !m_instance.targets[i].enabled;
+      UpdateTargetsList();
+   }
+   else if ( sender == GUI->RemoveSelected_PushButton )
+   {
+      HyperMetricStretchInstance::target_list newTargets;
+      for ( int i = 0, n = GUI->Targets_TreeBox.NumberOfChildren(); i < n; ++i )
+         if ( !GUI->Targets_TreeBox[i]->IsSelected() )
+            newTargets.Add( m_instance.targets[i] );
+      m_instance.targets = newTargets;
+      UpdateTargetsList();
+   }
+   else if ( sender == GUI->Clear_PushButton )
+   {
+      m_instance.targets.Clear();
+      UpdateTargetsList();
+   }
+   else if ( sender == GUI->OutputDirectory_ToolButton )
+   {
+      GetDirectoryDialog d;
+      d.SetCaption( "HyperMetricStretch: Select Output Directory" );
+      if ( d.Execute() )
+         GUI->OutputDirectory_Edit.SetText( m_instance.outputDirectory = d.Directory() );
+   }
+   else if ( sender == GUI->BatchAutoLogD_CheckBox )
+      m_instance.batchAutoLogD = checked;
+   else if ( sender == GUI->BatchSharedStretch_CheckBox )
+      m_instance.batchSharedStretch = checked;
+   else if ( sender == GUI->OverwriteExistingFiles_CheckBox )
+      m_instance.overwriteExistingFiles = checked;
 }
 
 // ----------------------------------------------------------------------------
-// GUI Data Construction
+
+void HyperMetricStretchInterface::e_Targets_NodeActivated( TreeBox& sender, TreeBox::Node& node, int col )
+{
+   int index = sender.ChildIndex( &node );
+   if ( index < 0 || size_type( index ) >= m_instance.targets.Length() )
+      return;
+
+   // Double-click on the enabled icon toggles the target
+   if ( col == 1 )
+   {
+      m_instance.targets[index].enabled = !m_instance.targets[index].enabled;
+      UpdateTargetsList();
+   }
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::e_Batch_EditCompleted( Edit& sender )
+{
+   String text = sender.Text().Trimmed();
+
+   if ( sender == GUI->OutputDirectory_Edit )
+      m_instance.outputDirectory = text;
+   else if ( sender == GUI->OutputPostfix_Edit )
+      m_instance.outputPostfix = text;
+   else if ( sender == GUI->OutputExtension_Edit )
+   {
+      if ( text.IsEmpty() )
+         text = TheHMSOutputExtensionParameter->DefaultValue();
+      if ( !text.StartsWith( '.' ) )
+         text.Prepend( '.' );
+      m_instance.outputExtension = text;
+   }
+
+   sender.SetText( text );
+}
+
+// ----------------------------------------------------------------------------
+
+void HyperMetricStretchInterface::e_Batch_SpinValueUpdated( SpinBox& sender, int value )
+{
+   if ( sender == GUI->Concurrency_SpinBox )
+      m_instance.batchConcurrency = value;
+   else if ( sender == GUI->Threads_SpinBox )
+      m_instance.maxThreads = value;
+   else if ( sender == GUI->ThreadsPerNode_SpinBox )
+      m_instance.maxThreadsPerNode = value;
+}
+
 // ----------------------------------------------------------------------------
 
 HyperMetricStretchInterface::GUIData::GUIData( HyperMetricStretchInterface& w )
@@ -548,8 +1350,19 @@ HyperMetricStretchInterface::GUIData::GUIData( HyperMetricStretchInterface& w )
       "<p>Disable if you observe crushed shadows or when working with data that has strong background variations.</p>" );
    AdaptiveAnchor_CheckBox.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_AdaptiveAnchor_Click, w );
 
+   GPUAcceleration_CheckBox.SetText( "GPU Acceleration" );
+   GPUAcceleration_CheckBox.SetToolTip(
+      "<p><b>GPU Acceleration:</b></p>"
+      "<p>Renders the real-time preview and the strips of streamed execution on an OpenCL GPU. The statistics are "
+      "still computed on the CPU; only the per-pixel stretch, color reconstruction and output scaling run on the device.</p>"
+      "<p>Without an OpenCL runtime or GPU device, or while the device is busy with another image, the CPU is used "
+      "automatically. Results agree with the CPU well within 16-bit resolution.</p>" );
+   GPUAcceleration_CheckBox.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_GPUAcceleration_Click, w );
+
    AdaptiveAnchor_Sizer.AddUnscaledSpacing( labelWidth1 + ui4 );
    AdaptiveAnchor_Sizer.Add( AdaptiveAnchor_CheckBox );
+   AdaptiveAnchor_Sizer.AddSpacing( 16 );
+   AdaptiveAnchor_Sizer.Add( GPUAcceleration_CheckBox );
    AdaptiveAnchor_Sizer.AddStretch();
 
    LogD_NumericControl.label.SetText( "Log D:" );
@@ -743,6 +1556,176 @@ HyperMetricStretchInterface::GUIData::GUIData( HyperMetricStretchInterface& w )
 
    //
 
+   Batch_SectionBar.SetTitle( "Batch Processing" );
+   Batch_SectionBar.SetSection( Batch_Control );
+   Batch_SectionBar.SetToolTip(
+      "<p><b>Batch Processing (global execution):</b></p>"
+      "<p>Files processed with the current parameters when the process is executed in the global context "
+      "(Apply Global button or F6). Each file is read, analyzed, stretched and written independently; "
+      "several files are processed simultaneously.</p>" );
+
+   Targets_TreeBox.SetMinHeight( w.LogicalPixelsToPhysical( 120 ) );
+   Targets_TreeBox.SetNumberOfColumns( 3 );
+   Targets_TreeBox.HideHeader();
+   Targets_TreeBox.EnableMultipleSelections();
+   Targets_TreeBox.DisableRootDecoration();
+   Targets_TreeBox.EnableAlternateRowColor();
+   Targets_TreeBox.SetToolTip( "<p>Target files. Double-click the icon column to enable or disable a file.</p>" );
+   Targets_TreeBox.OnNodeActivated( (TreeBox::node_event_handler)&HyperMetricStretchInterface::e_Targets_NodeActivated, w );
+
+   AddFiles_PushButton.SetText( "Add Files" );
+   AddFiles_PushButton.SetToolTip( "<p>Add image files to the list of batch targets.</p>" );
+   AddFiles_PushButton.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   ToggleSelected_PushButton.SetText( "Toggle Selected" );
+   ToggleSelected_PushButton.SetToolTip( "<p>Enable or disable the selected target files.</p>" );
+   ToggleSelected_PushButton.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   RemoveSelected_PushButton.SetText( "Remove Selected" );
+   RemoveSelected_PushButton.SetToolTip( "<p>Remove the selected target files from the list.</p>" );
+   RemoveSelected_PushButton.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   Clear_PushButton.SetText( "Clear" );
+   Clear_PushButton.SetToolTip( "<p>Remove all target files.</p>" );
+   Clear_PushButton.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   TargetButtons_Sizer.SetSpacing( ui4 );
+   TargetButtons_Sizer.Add( AddFiles_PushButton );
+   TargetButtons_Sizer.Add( ToggleSelected_PushButton );
+   TargetButtons_Sizer.Add( RemoveSelected_PushButton );
+   TargetButtons_Sizer.Add( Clear_PushButton );
+   TargetButtons_Sizer.AddStretch();
+
+   Targets_Sizer.SetSpacing( ui4 );
+   Targets_Sizer.Add( Targets_TreeBox, 100 );
+   Targets_Sizer.Add( TargetButtons_Sizer );
+
+   const char* outputDirectoryToolTip =
+      "<p>Directory where output files are written. Leave empty to write each output file "
+      "in the directory of its input file.</p>";
+
+   OutputDirectory_Label.SetText( "Output Dir:" );
+   OutputDirectory_Label.SetFixedWidth( labelWidth1 );
+   OutputDirectory_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+   OutputDirectory_Label.SetToolTip( outputDirectoryToolTip );
+
+   OutputDirectory_Edit.SetToolTip( outputDirectoryToolTip );
+   OutputDirectory_Edit.OnEditCompleted( (Edit::edit_event_handler)&HyperMetricStretchInterface::e_Batch_EditCompleted, w );
+
+   OutputDirectory_ToolButton.SetIcon( Bitmap( w.ScaledResource( ":/icons/select-file.png" ) ) );
+   OutputDirectory_ToolButton.SetScaledFixedSize( 20, 20 );
+   OutputDirectory_ToolButton.SetToolTip( "<p>Select the output directory.</p>" );
+   OutputDirectory_ToolButton.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   OutputDirectory_Sizer.SetSpacing( ui4 );
+   OutputDirectory_Sizer.Add( OutputDirectory_Label );
+   OutputDirectory_Sizer.Add( OutputDirectory_Edit, 100 );
+   OutputDirectory_Sizer.Add( OutputDirectory_ToolButton );
+
+   OutputPostfix_Label.SetText( "Postfix:" );
+   OutputPostfix_Label.SetFixedWidth( labelWidth1 );
+   OutputPostfix_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   OutputPostfix_Edit.SetMinWidth( fnt.Width( String( 'M', 8 ) ) );
+   OutputPostfix_Edit.SetToolTip( "<p>Appended to the input file name to build the output file name.</p>" );
+   OutputPostfix_Edit.OnEditCompleted( (Edit::edit_event_handler)&HyperMetricStretchInterface::e_Batch_EditCompleted, w );
+
+   OutputExtension_Label.SetText( "Extension:" );
+   OutputExtension_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   OutputExtension_Edit.SetMinWidth( fnt.Width( String( 'M', 6 ) ) );
+   OutputExtension_Edit.SetToolTip( "<p>Output file format, selected by file extension (default: .xisf).</p>" );
+   OutputExtension_Edit.OnEditCompleted( (Edit::edit_event_handler)&HyperMetricStretchInterface::e_Batch_EditCompleted, w );
+
+   Concurrency_Label.SetText( "Concurrent:" );
+   Concurrency_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   Concurrency_SpinBox.SetRange( int( TheHMSBatchConcurrencyParameter->MinimumValue() ),
+                                 int( TheHMSBatchConcurrencyParameter->MaximumValue() ) );
+   Concurrency_SpinBox.SetToolTip(
+      "<p>Maximum number of files processed simultaneously. Processor threads are shared evenly among them. "
+      "Memory use grows with this value: each file in flight holds its image and the working buffers.</p>" );
+   Concurrency_SpinBox.OnValueUpdated( (SpinBox::value_event_handler)&HyperMetricStretchInterface::e_Batch_SpinValueUpdated, w );
+
+   Threads_Label.SetText( "Threads:" );
+   Threads_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   Threads_SpinBox.SetRange( int( TheHMSMaxThreadsParameter->MinimumValue() ),
+                             int( TheHMSMaxThreadsParameter->MaximumValue() ) );
+   Threads_SpinBox.SetMinimumValueText( "All" );
+   Threads_SpinBox.SetToolTip(
+      "<p>Maximum number of processor threads used by every pass of an execution, and by every file in flight "
+      "of a batch.</p>"
+      "<p>The default value (All) uses every processor allowed by the PixInsight preferences.</p>" );
+   Threads_SpinBox.OnValueUpdated( (SpinBox::value_event_handler)&HyperMetricStretchInterface::e_Batch_SpinValueUpdated, w );
+
+   ThreadsPerNode_Label.SetText( "Threads/node:" );
+   ThreadsPerNode_Label.SetTextAlignment( TextAlign::Right|TextAlign::VertCenter );
+
+   ThreadsPerNode_SpinBox.SetRange( int( TheHMSMaxThreadsPerNodeParameter->MinimumValue() ),
+                                    int( TheHMSMaxThreadsPerNodeParameter->MaximumValue() ) );
+   ThreadsPerNode_SpinBox.SetMinimumValueText( "All" );
+   ThreadsPerNode_SpinBox.SetToolTip(
+      "<p>Maximum number of processor threads used on each NUMA node (processor socket) by every execution, "
+      "and by every file in flight of a batch. Limit it to leave room for other jobs running on the same machine. "
+      "Memory-bound passes gain little from more threads than a node has memory channels for.</p>"
+      "<p>The default value (All) uses every processor of each node.</p>" );
+   ThreadsPerNode_SpinBox.OnValueUpdated( (SpinBox::value_event_handler)&HyperMetricStretchInterface::e_Batch_SpinValueUpdated, w );
+
+   OutputPostfix_Sizer.SetSpacing( ui4 );
+   OutputPostfix_Sizer.Add( OutputPostfix_Label );
+   OutputPostfix_Sizer.Add( OutputPostfix_Edit );
+   OutputPostfix_Sizer.AddSpacing( 8 );
+   OutputPostfix_Sizer.Add( OutputExtension_Label );
+   OutputPostfix_Sizer.Add( OutputExtension_Edit );
+   OutputPostfix_Sizer.AddSpacing( 8 );
+   OutputPostfix_Sizer.Add( Concurrency_Label );
+   OutputPostfix_Sizer.Add( Concurrency_SpinBox );
+   OutputPostfix_Sizer.AddSpacing( 8 );
+   OutputPostfix_Sizer.Add( Threads_Label );
+   OutputPostfix_Sizer.Add( Threads_SpinBox );
+   OutputPostfix_Sizer.AddSpacing( 8 );
+   OutputPostfix_Sizer.Add( ThreadsPerNode_Label );
+   OutputPostfix_Sizer.Add( ThreadsPerNode_SpinBox );
+   OutputPostfix_Sizer.AddStretch();
+
+   BatchAutoLogD_CheckBox.SetText( "Auto Log D" );
+   BatchAutoLogD_CheckBox.SetToolTip(
+      "<p><b>Auto Log D:</b></p>"
+      "<p>Solves Log D for each file (or once, for the shared stretch) so that its background is placed at the "
+      "Target Background level, as Auto-Calc does for the active image. When disabled, the current Log D is used.</p>" );
+   BatchAutoLogD_CheckBox.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   BatchSharedStretch_CheckBox.SetText( "Shared stretch" );
+   BatchSharedStretch_CheckBox.SetToolTip(
+      "<p><b>Shared Stretch:</b></p>"
+      "<p>Solves the anchor, Log D and Ready-to-Use output scaling on the first enabled file and applies exactly "
+      "the same transfer functions to all other files. Use it for mosaic panels, so that all tiles match.</p>" );
+   BatchSharedStretch_CheckBox.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   OverwriteExistingFiles_CheckBox.SetText( "Overwrite" );
+   OverwriteExistingFiles_CheckBox.SetToolTip(
+      "<p>Overwrite existing output files. When disabled, a unique file name is generated by appending a numeric suffix.</p>" );
+   OverwriteExistingFiles_CheckBox.OnClick( (Button::click_event_handler)&HyperMetricStretchInterface::e_Batch_Click, w );
+
+   BatchOptions_Sizer.SetSpacing( ui4*2 );
+   BatchOptions_Sizer.AddUnscaledSpacing( labelWidth1 + ui4 );
+   BatchOptions_Sizer.Add( BatchAutoLogD_CheckBox );
+   BatchOptions_Sizer.Add( BatchSharedStretch_CheckBox );
+   BatchOptions_Sizer.Add( OverwriteExistingFiles_CheckBox );
+   BatchOptions_Sizer.AddStretch();
+
+   Batch_Sizer.SetMargin( 6 );
+   Batch_Sizer.SetSpacing( ui4 );
+   Batch_Sizer.Add( Targets_Sizer, 100 );
+   Batch_Sizer.Add( OutputDirectory_Sizer );
+   Batch_Sizer.Add( OutputPostfix_Sizer );
+   Batch_Sizer.Add( BatchOptions_Sizer );
+
+   Batch_Control.SetSizer( Batch_Sizer );
+
+   //
+
    Global_Sizer.SetMargin( 8 );
    Global_Sizer.SetSpacing( ui4 );
    Global_Sizer.Add( Mode_SectionBar );
@@ -755,13 +1738,26 @@ HyperMetricStretchInterface::GUIData::GUIData( HyperMetricStretchInterface& w )
    Global_Sizer.Add( ReadyToUse_Control );
    Global_Sizer.Add( Scientific_SectionBar );
    Global_Sizer.Add( Scientific_Control );
+   Global_Sizer.Add( Batch_SectionBar );
+   Global_Sizer.Add( Batch_Control, 100 );
 
    w.SetSizer( Global_Sizer );
 
+   PreviewRefine_Timer.SetSingleShot();
+   PreviewRefine_Timer.SetInterval( PreviewRefineDelay );
+   PreviewRefine_Timer.OnTimeout( (Timer::timer_event_handler)&HyperMetricStretchInterface::e_PreviewRefine_Timeout, w );
+
+   AutoCalc_Timer.SetInterval( AutoCalcPollInterval );
+   AutoCalc_Timer.SetSingleShot( false );
+   AutoCalc_Timer.OnTimeout( (Timer::timer_event_handler)&HyperMetricStretchInterface::e_AutoCalc_Timeout, w );
+
    // Hide Scientific mode sections initially (Ready-to-Use is default)
    Scientific_SectionBar.Hide();
    Scientific_Control.Hide();
 
+   // Batch processing is collapsed until needed
+   Batch_Control.Hide();
+
    w.EnsureLayoutUpdated();
    w.AdjustToContents();
    w.SetMinWidth();
@@ -19,10 +19,13 @@
 #ifndef __HyperMetricStretchInterface_h
 #define __HyperMetricStretchInterface_h
 
+#include <pcl/Atomic.h>
 #include <pcl/CheckBox.h>
 #include <pcl/ComboBox.h>
 #include <pcl/Control.h>
+#include <pcl/Edit.h>
 #include <pcl/Label.h>
+#include <pcl/Mutex.h>
 #include <pcl/NumericControl.h>
 #include <pcl/ProcessInterface.h>
 #include <pcl/PushButton.h>
@@ -30,12 +33,18 @@
 #include <pcl/SectionBar.h>
 #include <pcl/Sizer.h>
 #include <pcl/SpinBox.h>
+#include <pcl/Timer.h>
+#include <pcl/ToolButton.h>
+#include <pcl/TreeBox.h>
 
 #include "HyperMetricStretchInstance.h"
+#include "../../core/VeraLuxTileCache.h"
 
 namespace pcl
 {
 
+class HMSAutoCalcThread;
+
 // ----------------------------------------------------------------------------
 
 class HyperMetricStretchInterface : public ProcessInterface
@@ -50,6 +59,7 @@ public:
    String IconImageSVGFile() const override;
    InterfaceFeatures Features() const override;
    void ApplyInstance() const override;
+   void ApplyInstanceGlobal() const override;
    void ResetInstance() override;
    void RealTimePreviewUpdated( bool active ) override;
    bool Launch( const MetaProcess&, const ProcessImplementation*, bool& dynamic, unsigned& flags ) override;
@@ -59,11 +69,44 @@ public:
    bool ImportProcess( const ProcessImplementation& ) override;
    bool RequiresRealTimePreviewUpdate( const UInt16Image&, const View&, const Rect&, int zoomLevel ) const override;
    bool GenerateRealTimePreview( UInt16Image&, const View&, const Rect&, int zoomLevel, String& info ) const override;
+   bool WantsImageNotifications() const override;
+   void ImageUpdated( const View& ) override;
+   void ImageDeleted( const View& ) override;
 
 private:
 
    HyperMetricStretchInstance m_instance;
 
+   // Bumped on every image notification, invalidating all caches
+   AtomicInt                    m_imageRevision;
+
+   // Real-time preview. Global statistics are measured once on the full
+   // view image, and the stretch solution (expansion bounds and output
+   // scaling) once per parameter set, so every preview looks like the final
+   // result at any decimation. All protected by m_previewMutex, which is
+   // never held while they are computed.
+   mutable Mutex                  m_previewMutex;
+   mutable IsoString              m_previewStatsKey;
+   mutable VeraLuxStreamAnalysis  m_previewStats;
+   mutable IsoString              m_previewSolutionKey;
+   mutable FusedStretchParameters m_previewParams;
+   mutable OutputScalingStats     m_previewScaling;
+   mutable IsoString              m_previewRenderedKey;      // last generated preview
+   mutable int                    m_previewFactor = 1;       // its decimation factor
+
+   // Decimation requested for the next preview: 0 for the proxy, rendered
+   // while controls change, then halved by every idle refinement step.
+   AtomicInt                      m_previewRequestedFactor;
+
+   // Preview temporaries, reused by every refresh
+   mutable VeraLuxWorkspace       m_previewWorkspace;
+
+   // Rendered preview tiles, keyed by render context and tile coordinates
+   mutable VeraLuxTileCache       m_previewTiles;
+
+   // Auto-Calc solver running in the background, polled by AutoCalc_Timer
+   HMSAutoCalcThread*             m_autoCalcThread = nullptr;
+
    // GUI Data
    struct GUIData
    {
@@ -95,6 +138,7 @@ private:
             NumericControl    TargetBg_NumericControl;
             HorizontalSizer   AdaptiveAnchor_Sizer;
                CheckBox          AdaptiveAnchor_CheckBox;
+               CheckBox          GPUAcceleration_CheckBox;
             HorizontalSizer   LogD_Sizer;
                NumericControl    LogD_NumericControl;
                PushButton        AutoCalc_PushButton;
@@ -116,6 +160,40 @@ private:
             NumericControl    LinearExpansion_NumericControl;
             NumericControl    ColorGrip_NumericControl;
             NumericControl    ShadowConvergence_NumericControl;
+
+         // Batch (global) execution
+         SectionBar        Batch_SectionBar;
+         Control           Batch_Control;
+         VerticalSizer     Batch_Sizer;
+            HorizontalSizer   Targets_Sizer;
+               TreeBox           Targets_TreeBox;
+               VerticalSizer     TargetButtons_Sizer;
+                  PushButton        AddFiles_PushButton;
+                  PushButton        ToggleSelected_PushButton;
+                  PushButton        RemoveSelected_PushButton;
+                  PushButton        Clear_PushButton;
+            HorizontalSizer   OutputDirectory_Sizer;
+               Label             OutputDirectory_Label;
+               Edit              OutputDirectory_Edit;
+               ToolButton        OutputDirectory_ToolButton;
+            HorizontalSizer   OutputPostfix_Sizer;
+               Label             OutputPostfix_Label;
+               Edit              OutputPostfix_Edit;
+               Label             OutputExtension_Label;
+               Edit              OutputExtension_Edit;
+               Label             Concurrency_Label;
+               SpinBox           Concurrency_SpinBox;
+               Label             Threads_Label;
+               SpinBox           Threads_SpinBox;
+               Label             ThreadsPerNode_Label;
+               SpinBox           ThreadsPerNode_SpinBox;
+            HorizontalSizer   BatchOptions_Sizer;
+               CheckBox          BatchAutoLogD_CheckBox;
+               CheckBox          BatchSharedStretch_CheckBox;
+               CheckBox          OverwriteExistingFiles_CheckBox;
+
+      Timer             PreviewRefine_Timer;
+      Timer             AutoCalc_Timer;
    };
 
    GUIData* GUI = nullptr;
@@ -125,12 +203,27 @@ private:
    void UpdateSensorInfo();
    void UpdateColorStrategyInfo();
    void UpdateRealTimePreview();
+   void RefineRealTimePreview();
+
+   IsoString PreviewStatisticsKey( const View& ) const;
+   IsoString PreviewSolutionKey() const;
+   IsoString PreviewRenderKey( const View&, const Rect&, int zoomLevel ) const;
+   void UpdateBatchControls();
+   void UpdateTargetsList();
+   void StopAutoCalc();
 
    void e_Mode_Click( Button& sender, bool checked );
    void e_SensorProfile_Selected( ComboBox& sender, int itemIndex );
    void e_AdaptiveAnchor_Click( Button& sender, bool checked );
+   void e_GPUAcceleration_Click( Button& sender, bool checked );
    void e_NumericControl_ValueUpdated( NumericEdit& sender, double value );
    void e_AutoCalc_Click( Button& sender, bool checked );
+   void e_Batch_Click( Button& sender, bool checked );
+   void e_Targets_NodeActivated( TreeBox& sender, TreeBox::Node& node, int col );
+   void e_Batch_EditCompleted( Edit& sender );
+   void e_Batch_SpinValueUpdated( SpinBox& sender, int value );
+   void e_PreviewRefine_Timeout( Timer& sender );
+   void e_AutoCalc_Timeout( Timer& sender );
 
    friend struct GUIData;
 };
@@ -26,6 +26,8 @@ namespace pcl
 
 HMSProcessingMode* TheHMSProcessingModeParameter = nullptr;
 HMSSensorProfile* TheHMSSensorProfileParameter = nullptr;
+HMSSensorProfileFile* TheHMSSensorProfileFileParameter = nullptr;
+HMSSensorProfileName* TheHMSSensorProfileNameParameter = nullptr;
 HMSTargetBackground* TheHMSTargetBackgroundParameter = nullptr;
 HMSLogD* TheHMSLogDParameter = nullptr;
 HMSProtectB* TheHMSProtectBParameter = nullptr;
@@ -35,6 +37,43 @@ HMSColorGrip* TheHMSColorGripParameter = nullptr;
 HMSShadowConvergence* TheHMSShadowConvergenceParameter = nullptr;
 HMSLinearExpansion* TheHMSLinearExpansionParameter = nullptr;
 HMSAdaptiveAnchor* TheHMSAdaptiveAnchorParameter = nullptr;
+HMSPipelineMode* TheHMSPipelineModeParameter = nullptr;
+HMSStatisticsEstimator* TheHMSStatisticsEstimatorParameter = nullptr;
+HMSComputePrecision* TheHMSComputePrecisionParameter = nullptr;
+HMSTargets* TheHMSTargetsParameter = nullptr;
+HMSTargetEnabled* TheHMSTargetEnabledParameter = nullptr;
+HMSTargetPath* TheHMSTargetPathParameter = nullptr;
+HMSOutputDirectory* TheHMSOutputDirectoryParameter = nullptr;
+HMSOutputPostfix* TheHMSOutputPostfixParameter = nullptr;
+HMSOutputExtension* TheHMSOutputExtensionParameter = nullptr;
+HMSOverwriteExistingFiles* TheHMSOverwriteExistingFilesParameter = nullptr;
+HMSBatchAutoLogD* TheHMSBatchAutoLogDParameter = nullptr;
+HMSBatchSharedStretch* TheHMSBatchSharedStretchParameter = nullptr;
+HMSBatchConcurrency* TheHMSBatchConcurrencyParameter = nullptr;
+HMSMaxThreads* TheHMSMaxThreadsParameter = nullptr;
+HMSMaxThreadsPerNode* TheHMSMaxThreadsPerNodeParameter = nullptr;
+HMSSweep* TheHMSSweepParameter = nullptr;
+HMSSweepLogD* TheHMSSweepLogDParameter = nullptr;
+HMSSweepProtectB* TheHMSSweepProtectBParameter = nullptr;
+HMSSweepColorStrategy* TheHMSSweepColorStrategyParameter = nullptr;
+HMSSweepTargetBackground* TheHMSSweepTargetBackgroundParameter = nullptr;
+HMSStreamingMode* TheHMSStreamingModeParameter = nullptr;
+HMSStreamingThreshold* TheHMSStreamingThresholdParameter = nullptr;
+HMSStreamingTileBudget* TheHMSStreamingTileBudgetParameter = nullptr;
+HMSGPUAcceleration* TheHMSGPUAccelerationParameter = nullptr;
+HMSInstrumentation* TheHMSInstrumentationParameter = nullptr;
+HMSInstrumentationLog* TheHMSInstrumentationLogParameter = nullptr;
+HMSSignatureMedian* TheHMSSignatureMedianParameter = nullptr;
+HMSSignatureMAD* TheHMSSignatureMADParameter = nullptr;
+HMSSignatureP99* TheHMSSignatureP99Parameter = nullptr;
+HMSSignatureP999* TheHMSSignatureP999Parameter = nullptr;
+HMSSignatureP9999* TheHMSSignatureP9999Parameter = nullptr;
+HMSSignatureStarPressure* TheHMSSignatureStarPressureParameter = nullptr;
+HMSSignatureStatisticalAnchor* TheHMSSignatureStatisticalAnchorParameter = nullptr;
+HMSSignatureAdaptiveAnchor* TheHMSSignatureAdaptiveAnchorParameter = nullptr;
+HMSSignaturePeak* TheHMSSignaturePeakParameter = nullptr;
+HMSSignaturePeakIsStar* TheHMSSignaturePeakIsStarParameter = nullptr;
+HMSSignaturePhysicalPeak* TheHMSSignaturePhysicalPeakParameter = nullptr;
 
 // ----------------------------------------------------------------------------
 
@@ -139,6 +178,30 @@ size_type HMSSensorProfile::DefaultValueIndex() const
 
 // ----------------------------------------------------------------------------
 
+HMSSensorProfileFile::HMSSensorProfileFile( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSensorProfileFileParameter = this;
+}
+
+IsoString HMSSensorProfileFile::Id() const
+{
+   return "sensorProfileFile";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSensorProfileName::HMSSensorProfileName( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSensorProfileNameParameter = this;
+}
+
+IsoString HMSSensorProfileName::Id() const
+{
+   return "sensorProfileName";
+}
+
+// ----------------------------------------------------------------------------
+
 HMSTargetBackground::HMSTargetBackground( MetaProcess* P ) : MetaDouble( P )
 {
    TheHMSTargetBackgroundParameter = this;
@@ -407,6 +470,777 @@ bool HMSAdaptiveAnchor::DefaultValue() const
 
 // ----------------------------------------------------------------------------
 
+HMSPipelineMode::HMSPipelineMode( MetaProcess* P ) : MetaEnumeration( P )
+{
+   TheHMSPipelineModeParameter = this;
+}
+
+IsoString HMSPipelineMode::Id() const
+{
+   return "pipelineMode";
+}
+
+size_type HMSPipelineMode::NumberOfElements() const
+{
+   return NumberOfModes;
+}
+
+IsoString HMSPipelineMode::ElementId( size_type i ) const
+{
+   switch ( i )
+   {
+   default:
+   case Fused:      return "Fused";
+   case StepByStep: return "StepByStep";
+   }
+}
+
+int HMSPipelineMode::ElementValue( size_type i ) const
+{
+   return int( i );
+}
+
+size_type HMSPipelineMode::DefaultValueIndex() const
+{
+   return Default;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSStatisticsEstimator::HMSStatisticsEstimator( MetaProcess* P ) : MetaEnumeration( P )
+{
+   TheHMSStatisticsEstimatorParameter = this;
+}
+
+IsoString HMSStatisticsEstimator::Id() const
+{
+   return "statisticsEstimator";
+}
+
+size_type HMSStatisticsEstimator::NumberOfElements() const
+{
+   return NumberOfEstimators;
+}
+
+IsoString HMSStatisticsEstimator::ElementId( size_type i ) const
+{
+   switch ( i )
+   {
+   default:
+   case Exact:     return "Exact";
+   case Histogram: return "Histogram";
+   case MAD:       return "MAD";
+   }
+}
+
+int HMSStatisticsEstimator::ElementValue( size_type i ) const
+{
+   return int( i );
+}
+
+size_type HMSStatisticsEstimator::DefaultValueIndex() const
+{
+   return Default;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSComputePrecision::HMSComputePrecision( MetaProcess* P ) : MetaEnumeration( P )
+{
+   TheHMSComputePrecisionParameter = this;
+}
+
+IsoString HMSComputePrecision::Id() const
+{
+   return "computePrecision";
+}
+
+size_type HMSComputePrecision::NumberOfElements() const
+{
+   return NumberOfPrecisions;
+}
+
+IsoString HMSComputePrecision::ElementId( size_type i ) const
+{
+   switch ( i )
+   {
+   default:
+   case Mixed: return "Mixed";
+   case Float: return "Float";
+   }
+}
+
+int HMSComputePrecision::ElementValue( size_type i ) const
+{
+   return int( i );
+}
+
+size_type HMSComputePrecision::DefaultValueIndex() const
+{
+   return Default;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSTargets::HMSTargets( MetaProcess* P ) : MetaTable( P )
+{
+   TheHMSTargetsParameter = this;
+}
+
+IsoString HMSTargets::Id() const
+{
+   return "targets";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSTargetEnabled::HMSTargetEnabled( MetaTable* T ) : MetaBoolean( T )
+{
+   TheHMSTargetEnabledParameter = this;
+}
+
+IsoString HMSTargetEnabled::Id() const
+{
+   return "enabled";
+}
+
+bool HMSTargetEnabled::DefaultValue() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSTargetPath::HMSTargetPath( MetaTable* T ) : MetaString( T )
+{
+   TheHMSTargetPathParameter = this;
+}
+
+IsoString HMSTargetPath::Id() const
+{
+   return "path";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSOutputDirectory::HMSOutputDirectory( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSOutputDirectoryParameter = this;
+}
+
+IsoString HMSOutputDirectory::Id() const
+{
+   return "outputDirectory";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSOutputPostfix::HMSOutputPostfix( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSOutputPostfixParameter = this;
+}
+
+IsoString HMSOutputPostfix::Id() const
+{
+   return "outputPostfix";
+}
+
+String HMSOutputPostfix::DefaultValue() const
+{
+   return "_hms";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSOutputExtension::HMSOutputExtension( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSOutputExtensionParameter = this;
+}
+
+IsoString HMSOutputExtension::Id() const
+{
+   return "outputExtension";
+}
+
+String HMSOutputExtension::DefaultValue() const
+{
+   return ".xisf";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSOverwriteExistingFiles::HMSOverwriteExistingFiles( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSOverwriteExistingFilesParameter = this;
+}
+
+IsoString HMSOverwriteExistingFiles::Id() const
+{
+   return "overwriteExistingFiles";
+}
+
+bool HMSOverwriteExistingFiles::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSBatchAutoLogD::HMSBatchAutoLogD( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSBatchAutoLogDParameter = this;
+}
+
+IsoString HMSBatchAutoLogD::Id() const
+{
+   return "batchAutoLogD";
+}
+
+bool HMSBatchAutoLogD::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSBatchSharedStretch::HMSBatchSharedStretch( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSBatchSharedStretchParameter = this;
+}
+
+IsoString HMSBatchSharedStretch::Id() const
+{
+   return "batchSharedStretch";
+}
+
+bool HMSBatchSharedStretch::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSBatchConcurrency::HMSBatchConcurrency( MetaProcess* P ) : MetaInt32( P )
+{
+   TheHMSBatchConcurrencyParameter = this;
+}
+
+IsoString HMSBatchConcurrency::Id() const
+{
+   return "batchConcurrency";
+}
+
+double HMSBatchConcurrency::MinimumValue() const
+{
+   return 1;
+}
+
+double HMSBatchConcurrency::MaximumValue() const
+{
+   return 16;
+}
+
+double HMSBatchConcurrency::DefaultValue() const
+{
+   return 2;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSMaxThreads::HMSMaxThreads( MetaProcess* P ) : MetaInt32( P )
+{
+   TheHMSMaxThreadsParameter = this;
+}
+
+IsoString HMSMaxThreads::Id() const
+{
+   return "maxThreads";
+}
+
+double HMSMaxThreads::MinimumValue() const
+{
+   return 0;
+}
+
+double HMSMaxThreads::MaximumValue() const
+{
+   return 1024;
+}
+
+double HMSMaxThreads::DefaultValue() const
+{
+   return 0; // unlimited
+}
+
+// ----------------------------------------------------------------------------
+
+HMSMaxThreadsPerNode::HMSMaxThreadsPerNode( MetaProcess* P ) : MetaInt32( P )
+{
+   TheHMSMaxThreadsPerNodeParameter = this;
+}
+
+IsoString HMSMaxThreadsPerNode::Id() const
+{
+   return "maxThreadsPerNode";
+}
+
+double HMSMaxThreadsPerNode::MinimumValue() const
+{
+   return 0;
+}
+
+double HMSMaxThreadsPerNode::MaximumValue() const
+{
+   return 1024;
+}
+
+double HMSMaxThreadsPerNode::DefaultValue() const
+{
+   return 0; // unlimited
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSweep::HMSSweep( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSSweepParameter = this;
+}
+
+IsoString HMSSweep::Id() const
+{
+   return "sweep";
+}
+
+bool HMSSweep::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSweepLogD::HMSSweepLogD( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSweepLogDParameter = this;
+}
+
+IsoString HMSSweepLogD::Id() const
+{
+   return "sweepLogD";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSweepProtectB::HMSSweepProtectB( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSweepProtectBParameter = this;
+}
+
+IsoString HMSSweepProtectB::Id() const
+{
+   return "sweepProtectB";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSweepColorStrategy::HMSSweepColorStrategy( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSweepColorStrategyParameter = this;
+}
+
+IsoString HMSSweepColorStrategy::Id() const
+{
+   return "sweepColorStrategy";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSweepTargetBackground::HMSSweepTargetBackground( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSSweepTargetBackgroundParameter = this;
+}
+
+IsoString HMSSweepTargetBackground::Id() const
+{
+   return "sweepTargetBackground";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSStreamingMode::HMSStreamingMode( MetaProcess* P ) : MetaEnumeration( P )
+{
+   TheHMSStreamingModeParameter = this;
+}
+
+IsoString HMSStreamingMode::Id() const
+{
+   return "streaming";
+}
+
+size_type HMSStreamingMode::NumberOfElements() const
+{
+   return NumberOfModes;
+}
+
+IsoString HMSStreamingMode::ElementId( size_type i ) const
+{
+   switch ( i )
+   {
+   case Off:    return "Streaming_Off";
+   default:
+   case Auto:   return "Streaming_Auto";
+   case Always: return "Streaming_Always";
+   }
+}
+
+int HMSStreamingMode::ElementValue( size_type i ) const
+{
+   return int( i );
+}
+
+size_type HMSStreamingMode::DefaultValueIndex() const
+{
+   return Default;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSStreamingThreshold::HMSStreamingThreshold( MetaProcess* P ) : MetaInt32( P )
+{
+   TheHMSStreamingThresholdParameter = this;
+}
+
+IsoString HMSStreamingThreshold::Id() const
+{
+   return "streamingThreshold";
+}
+
+double HMSStreamingThreshold::MinimumValue() const
+{
+   return 16;
+}
+
+double HMSStreamingThreshold::MaximumValue() const
+{
+   return 1048576;
+}
+
+double HMSStreamingThreshold::DefaultValue() const
+{
+   return 2048;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSStreamingTileBudget::HMSStreamingTileBudget( MetaProcess* P ) : MetaInt32( P )
+{
+   TheHMSStreamingTileBudgetParameter = this;
+}
+
+IsoString HMSStreamingTileBudget::Id() const
+{
+   return "streamingTileBudget";
+}
+
+double HMSStreamingTileBudget::MinimumValue() const
+{
+   return 16;
+}
+
+double HMSStreamingTileBudget::MaximumValue() const
+{
+   return 65536;
+}
+
+double HMSStreamingTileBudget::DefaultValue() const
+{
+   return 256;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSGPUAcceleration::HMSGPUAcceleration( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSGPUAccelerationParameter = this;
+}
+
+IsoString HMSGPUAcceleration::Id() const
+{
+   return "gpuAcceleration";
+}
+
+bool HMSGPUAcceleration::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSInstrumentation::HMSInstrumentation( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSInstrumentationParameter = this;
+}
+
+IsoString HMSInstrumentation::Id() const
+{
+   return "instrumentation";
+}
+
+bool HMSInstrumentation::DefaultValue() const
+{
+   return false;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSInstrumentationLog::HMSInstrumentationLog( MetaProcess* P ) : MetaString( P )
+{
+   TheHMSInstrumentationLogParameter = this;
+}
+
+IsoString HMSInstrumentationLog::Id() const
+{
+   return "instrumentationLog";
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureMedian::HMSSignatureMedian( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureMedianParameter = this;
+}
+
+IsoString HMSSignatureMedian::Id() const
+{
+   return "signatureMedian";
+}
+
+int HMSSignatureMedian::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureMedian::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureMAD::HMSSignatureMAD( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureMADParameter = this;
+}
+
+IsoString HMSSignatureMAD::Id() const
+{
+   return "signatureMAD";
+}
+
+int HMSSignatureMAD::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureMAD::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureP99::HMSSignatureP99( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureP99Parameter = this;
+}
+
+IsoString HMSSignatureP99::Id() const
+{
+   return "signatureP99";
+}
+
+int HMSSignatureP99::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureP99::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureP999::HMSSignatureP999( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureP999Parameter = this;
+}
+
+IsoString HMSSignatureP999::Id() const
+{
+   return "signatureP999";
+}
+
+int HMSSignatureP999::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureP999::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureP9999::HMSSignatureP9999( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureP9999Parameter = this;
+}
+
+IsoString HMSSignatureP9999::Id() const
+{
+   return "signatureP9999";
+}
+
+int HMSSignatureP9999::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureP9999::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureStarPressure::HMSSignatureStarPressure( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureStarPressureParameter = this;
+}
+
+IsoString HMSSignatureStarPressure::Id() const
+{
+   return "signatureStarPressure";
+}
+
+int HMSSignatureStarPressure::Precision() const
+{
+   return 4;
+}
+
+bool HMSSignatureStarPressure::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureStatisticalAnchor::HMSSignatureStatisticalAnchor( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureStatisticalAnchorParameter = this;
+}
+
+IsoString HMSSignatureStatisticalAnchor::Id() const
+{
+   return "signatureStatisticalAnchor";
+}
+
+int HMSSignatureStatisticalAnchor::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureStatisticalAnchor::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignatureAdaptiveAnchor::HMSSignatureAdaptiveAnchor( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignatureAdaptiveAnchorParameter = this;
+}
+
+IsoString HMSSignatureAdaptiveAnchor::Id() const
+{
+   return "signatureAdaptiveAnchor";
+}
+
+int HMSSignatureAdaptiveAnchor::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignatureAdaptiveAnchor::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignaturePeak::HMSSignaturePeak( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignaturePeakParameter = this;
+}
+
+IsoString HMSSignaturePeak::Id() const
+{
+   return "signaturePeak";
+}
+
+int HMSSignaturePeak::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignaturePeak::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignaturePeakIsStar::HMSSignaturePeakIsStar( MetaProcess* P ) : MetaBoolean( P )
+{
+   TheHMSSignaturePeakIsStarParameter = this;
+}
+
+IsoString HMSSignaturePeakIsStar::Id() const
+{
+   return "signaturePeakIsStar";
+}
+
+bool HMSSignaturePeakIsStar::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
+HMSSignaturePhysicalPeak::HMSSignaturePhysicalPeak( MetaProcess* P ) : MetaDouble( P )
+{
+   TheHMSSignaturePhysicalPeakParameter = this;
+}
+
+IsoString HMSSignaturePhysicalPeak::Id() const
+{
+   return "signaturePhysicalPeak";
+}
+
+int HMSSignaturePhysicalPeak::Precision() const
+{
+   return 6;
+}
+
+bool HMSSignaturePhysicalPeak::IsReadOnly() const
+{
+   return true;
+}
+
+// ----------------------------------------------------------------------------
+
 } // pcl
 
 // ----------------------------------------------------------------------------
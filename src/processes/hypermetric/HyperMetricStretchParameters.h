@@ -65,6 +65,30 @@ extern HMSSensorProfile* TheHMSSensorProfileParameter;
 
 // ----------------------------------------------------------------------------
 
+class HMSSensorProfileFile : public MetaString
+{
+public:
+   HMSSensorProfileFile( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSensorProfileFile* TheHMSSensorProfileFileParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSensorProfileName : public MetaString
+{
+public:
+   HMSSensorProfileName( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSensorProfileName* TheHMSSensorProfileNameParameter;
+
+// ----------------------------------------------------------------------------
+
 class HMSTargetBackground : public MetaDouble
 {
 public:
@@ -205,6 +229,533 @@ extern HMSAdaptiveAnchor* TheHMSAdaptiveAnchorParameter;
 
 // ----------------------------------------------------------------------------
 
+class HMSPipelineMode : public MetaEnumeration
+{
+public:
+   enum { Fused,
+          StepByStep,
+          NumberOfModes,
+          Default = Fused };
+
+   HMSPipelineMode( MetaProcess* );
+
+   IsoString Id() const override;
+   size_type NumberOfElements() const override;
+   IsoString ElementId( size_type ) const override;
+   int ElementValue( size_type ) const override;
+   size_type DefaultValueIndex() const override;
+};
+
+extern HMSPipelineMode* TheHMSPipelineModeParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSStatisticsEstimator : public MetaEnumeration
+{
+public:
+   enum { Exact,
+          Histogram,
+          MAD,
+          NumberOfEstimators,
+          Default = Exact };
+
+   HMSStatisticsEstimator( MetaProcess* );
+
+   IsoString Id() const override;
+   size_type NumberOfElements() const override;
+   IsoString ElementId( size_type ) const override;
+   int ElementValue( size_type ) const override;
+   size_type DefaultValueIndex() const override;
+};
+
+extern HMSStatisticsEstimator* TheHMSStatisticsEstimatorParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSComputePrecision : public MetaEnumeration
+{
+public:
+   enum { Mixed,
+          Float,
+          NumberOfPrecisions,
+          Default = Mixed };
+
+   HMSComputePrecision( MetaProcess* );
+
+   IsoString Id() const override;
+   size_type NumberOfElements() const override;
+   IsoString ElementId( size_type ) const override;
+   int ElementValue( size_type ) const override;
+   size_type DefaultValueIndex() const override;
+};
+
+extern HMSComputePrecision* TheHMSComputePrecisionParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSTargets : public MetaTable
+{
+public:
+   HMSTargets( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSTargets* TheHMSTargetsParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSTargetEnabled : public MetaBoolean
+{
+public:
+   HMSTargetEnabled( MetaTable* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSTargetEnabled* TheHMSTargetEnabledParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSTargetPath : public MetaString
+{
+public:
+   HMSTargetPath( MetaTable* );
+
+   IsoString Id() const override;
+};
+
+extern HMSTargetPath* TheHMSTargetPathParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSOutputDirectory : public MetaString
+{
+public:
+   HMSOutputDirectory( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSOutputDirectory* TheHMSOutputDirectoryParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSOutputPostfix : public MetaString
+{
+public:
+   HMSOutputPostfix( MetaProcess* );
+
+   IsoString Id() const override;
+   String DefaultValue() const override;
+};
+
+extern HMSOutputPostfix* TheHMSOutputPostfixParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSOutputExtension : public MetaString
+{
+public:
+   HMSOutputExtension( MetaProcess* );
+
+   IsoString Id() const override;
+   String DefaultValue() const override;
+};
+
+extern HMSOutputExtension* TheHMSOutputExtensionParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSOverwriteExistingFiles : public MetaBoolean
+{
+public:
+   HMSOverwriteExistingFiles( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSOverwriteExistingFiles* TheHMSOverwriteExistingFilesParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSBatchAutoLogD : public MetaBoolean
+{
+public:
+   HMSBatchAutoLogD( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSBatchAutoLogD* TheHMSBatchAutoLogDParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSBatchSharedStretch : public MetaBoolean
+{
+public:
+   HMSBatchSharedStretch( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSBatchSharedStretch* TheHMSBatchSharedStretchParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSBatchConcurrency : public MetaInt32
+{
+public:
+   HMSBatchConcurrency( MetaProcess* );
+
+   IsoString Id() const override;
+   double MinimumValue() const override;
+   double MaximumValue() const override;
+   double DefaultValue() const override;
+};
+
+extern HMSBatchConcurrency* TheHMSBatchConcurrencyParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSMaxThreads : public MetaInt32
+{
+public:
+   HMSMaxThreads( MetaProcess* );
+
+   IsoString Id() const override;
+   double MinimumValue() const override;
+   double MaximumValue() const override;
+   double DefaultValue() const override;
+};
+
+extern HMSMaxThreads* TheHMSMaxThreadsParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSMaxThreadsPerNode : public MetaInt32
+{
+public:
+   HMSMaxThreadsPerNode( MetaProcess* );
+
+   IsoString Id() const override;
+   double MinimumValue() const override;
+   double MaximumValue() const override;
+   double DefaultValue() const override;
+};
+
+extern HMSMaxThreadsPerNode* TheHMSMaxThreadsPerNodeParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSweep : public MetaBoolean
+{
+public:
+   HMSSweep( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSSweep* TheHMSSweepParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSweepLogD : public MetaString
+{
+public:
+   HMSSweepLogD( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSweepLogD* TheHMSSweepLogDParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSweepProtectB : public MetaString
+{
+public:
+   HMSSweepProtectB( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSweepProtectB* TheHMSSweepProtectBParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSweepColorStrategy : public MetaString
+{
+public:
+   HMSSweepColorStrategy( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSweepColorStrategy* TheHMSSweepColorStrategyParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSweepTargetBackground : public MetaString
+{
+public:
+   HMSSweepTargetBackground( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSSweepTargetBackground* TheHMSSweepTargetBackgroundParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSStreamingMode : public MetaEnumeration
+{
+public:
+   enum { Off,
+          Auto,
+          Always,
+          NumberOfModes,
+          Default = Auto };
+
+   HMSStreamingMode( MetaProcess* );
+
+   IsoString Id() const override;
+   size_type NumberOfElements() const override;
+   IsoString ElementId( size_type ) const override;
+   int ElementValue( size_type ) const override;
+   size_type DefaultValueIndex() const override;
+};
+
+extern HMSStreamingMode* TheHMSStreamingModeParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSStreamingThreshold : public MetaInt32
+{
+public:
+   HMSStreamingThreshold( MetaProcess* );
+
+   IsoString Id() const override;
+   double MinimumValue() const override;
+   double MaximumValue() const override;
+   double DefaultValue() const override;
+};
+
+extern HMSStreamingThreshold* TheHMSStreamingThresholdParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSStreamingTileBudget : public MetaInt32
+{
+public:
+   HMSStreamingTileBudget( MetaProcess* );
+
+   IsoString Id() const override;
+   double MinimumValue() const override;
+   double MaximumValue() const override;
+   double DefaultValue() const override;
+};
+
+extern HMSStreamingTileBudget* TheHMSStreamingTileBudgetParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSGPUAcceleration : public MetaBoolean
+{
+public:
+   HMSGPUAcceleration( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSGPUAcceleration* TheHMSGPUAccelerationParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSInstrumentation : public MetaBoolean
+{
+public:
+   HMSInstrumentation( MetaProcess* );
+
+   IsoString Id() const override;
+   bool DefaultValue() const override;
+};
+
+extern HMSInstrumentation* TheHMSInstrumentationParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSInstrumentationLog : public MetaString
+{
+public:
+   HMSInstrumentationLog( MetaProcess* );
+
+   IsoString Id() const override;
+};
+
+extern HMSInstrumentationLog* TheHMSInstrumentationLogParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureMedian : public MetaDouble
+{
+public:
+   HMSSignatureMedian( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureMedian* TheHMSSignatureMedianParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureMAD : public MetaDouble
+{
+public:
+   HMSSignatureMAD( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureMAD* TheHMSSignatureMADParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureP99 : public MetaDouble
+{
+public:
+   HMSSignatureP99( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureP99* TheHMSSignatureP99Parameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureP999 : public MetaDouble
+{
+public:
+   HMSSignatureP999( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureP999* TheHMSSignatureP999Parameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureP9999 : public MetaDouble
+{
+public:
+   HMSSignatureP9999( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureP9999* TheHMSSignatureP9999Parameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureStarPressure : public MetaDouble
+{
+public:
+   HMSSignatureStarPressure( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureStarPressure* TheHMSSignatureStarPressureParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureStatisticalAnchor : public MetaDouble
+{
+public:
+   HMSSignatureStatisticalAnchor( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureStatisticalAnchor* TheHMSSignatureStatisticalAnchorParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignatureAdaptiveAnchor : public MetaDouble
+{
+public:
+   HMSSignatureAdaptiveAnchor( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignatureAdaptiveAnchor* TheHMSSignatureAdaptiveAnchorParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignaturePeak : public MetaDouble
+{
+public:
+   HMSSignaturePeak( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignaturePeak* TheHMSSignaturePeakParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignaturePeakIsStar : public MetaBoolean
+{
+public:
+   HMSSignaturePeakIsStar( MetaProcess* );
+
+   IsoString Id() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignaturePeakIsStar* TheHMSSignaturePeakIsStarParameter;
+
+// ----------------------------------------------------------------------------
+
+class HMSSignaturePhysicalPeak : public MetaDouble
+{
+public:
+   HMSSignaturePhysicalPeak( MetaProcess* );
+
+   IsoString Id() const override;
+   int Precision() const override;
+   bool IsReadOnly() const override;
+};
+
+extern HMSSignaturePhysicalPeak* TheHMSSignaturePhysicalPeakParameter;
+
+// ----------------------------------------------------------------------------
+
 PCL_END_LOCAL
 
 } // pcl
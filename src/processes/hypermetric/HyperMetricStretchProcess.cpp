@@ -41,6 +41,8 @@ HyperMetricStretchProcess::HyperMetricStretchProcess()
    
    new HMSProcessingMode( this );
    new HMSSensorProfile( this );
+   new HMSSensorProfileFile( this );
+   new HMSSensorProfileName( this );
    new HMSTargetBackground( this );
    new HMSLogD( this );
    new HMSProtectB( this );
@@ -50,6 +52,43 @@ HyperMetricStretchProcess::HyperMetricStretchProcess()
    new HMSShadowConvergence( this );
    new HMSLinearExpansion( this );
    new HMSAdaptiveAnchor( this );
+   new HMSPipelineMode( this );
+   new HMSStatisticsEstimator( this );
+   new HMSComputePrecision( this );
+   new HMSTargets( this );
+   new HMSTargetEnabled( TheHMSTargetsParameter );
+   new HMSTargetPath( TheHMSTargetsParameter );
+   new HMSOutputDirectory( this );
+   new HMSOutputPostfix( this );
+   new HMSOutputExtension( this );
+   new HMSOverwriteExistingFiles( this );
+   new HMSBatchAutoLogD( this );
+   new HMSBatchSharedStretch( this );
+   new HMSBatchConcurrency( this );
+   new HMSMaxThreads( this );
+   new HMSMaxThreadsPerNode( this );
+   new HMSSweep( this );
+   new HMSSweepLogD( this );
+   new HMSSweepProtectB( this );
+   new HMSSweepColorStrategy( this );
+   new HMSSweepTargetBackground( this );
+   new HMSStreamingMode( this );
+   new HMSStreamingThreshold( this );
+   new HMSStreamingTileBudget( this );
+   new HMSGPUAcceleration( this );
+   new HMSInstrumentation( this );
+   new HMSInstrumentationLog( this );
+   new HMSSignatureMedian( this );
+   new HMSSignatureMAD( this );
+   new HMSSignatureP99( this );
+   new HMSSignatureP999( this );
+   new HMSSignatureP9999( this );
+   new HMSSignatureStarPressure( this );
+   new HMSSignatureStatisticalAnchor( this );
+   new HMSSignatureAdaptiveAnchor( this );
+   new HMSSignaturePeak( this );
+   new HMSSignaturePeakIsStar( this );
+   new HMSSignaturePhysicalPeak( this );
 }
 
 // ----------------------------------------------------------------------------